@@ -1,6 +1,10 @@
 #ifndef __BLIB_H__
 #define __BLIB_H__
+#include "concurrency/concurrency.h"
 #include "datastructures/datastructures.h"
+#include "logging/logging.h"
+#include "memory/memory.h"
+#include "parsing/parsing.h"
 #include "testing/testing.h"
 
 #endif // !__BLIB_H__
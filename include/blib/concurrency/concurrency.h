@@ -0,0 +1,5 @@
+#ifndef __BLIB_CONCURRENCY_CONCURRENCY_H__
+#define __BLIB_CONCURRENCY_CONCURRENCY_H__
+#include "scheduler.h"
+
+#endif // !__BLIB_CONCURRENCY_CONCURRENCY_H__
@@ -0,0 +1,151 @@
+#ifndef __BLIB_CONCURRENCY_SCHEDULER_H__
+#define __BLIB_CONCURRENCY_SCHEDULER_H__
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  unsigned int workers; /* Number of worker threads */
+  bool pinned; /* Is every worker pinned to its own CPU */
+  void* __state__; /* Workers, their deques and the queue of other threads */
+} scheduler;
+
+/**
+ * @struct scheduler_group
+ * @brief Tasks waited for together (see `scheduler_wait()')
+ */
+typedef struct {
+  unsigned long __pending__; /* Spawned tasks that haven't finished */
+} scheduler_group;
+
+/**
+ * @struct scheduler_stats
+ * @brief What a worker did since the scheduler started
+ * @var tasks
+ * Tasks run
+ * @var spawns
+ * Tasks spawned
+ * @var steals
+ * Tasks taken from the deques of other workers or the queue of other threads
+ * @var failed_steals
+ * Attempts to steal that found nothing or lost a race
+ * @var sleeps
+ * Times the worker went to sleep for lack of work
+ * @var idle_ns
+ * Nanoseconds spent looking for work or sleeping, including the time idle so far
+ */
+typedef struct {
+  uint64_t tasks;
+  uint64_t spawns;
+  uint64_t steals;
+  uint64_t failed_steals;
+  uint64_t sleeps;
+  uint64_t idle_ns;
+} scheduler_stats;
+
+/**
+ * @function scheduler_group_new
+ * @brief Create a group without tasks
+ */
+#define scheduler_group_new() ((scheduler_group) {0})
+
+/**
+ * @function scheduler_start
+ * @brief Start the worker threads of a scheduler
+ * @param self
+ * [out] The scheduler
+ * @param workers
+ * [in] Number of worker threads, 0 for one per CPU the process may run on
+ * @param pin
+ * [in] Pin every worker to its own CPU with `sched_setaffinity()'
+ *
+ * Every worker owns a Chase-Lev deque: it pushes and pops tasks at the bottom, idle workers
+ * steal from the top. Threads that aren't workers of the scheduler share a locked queue.
+ * Returns false if a thread couldn't be started (errno is set), no worker is left running.
+ */
+bool scheduler_start(scheduler* self, unsigned int workers, bool pin);
+/**
+ * @function scheduler_stop
+ * @brief Stop the workers once no task is left and free the scheduler
+ * @param self
+ * [in,out] The scheduler
+ *
+ * Must not be called from a worker of the scheduler.
+ */
+void scheduler_stop(scheduler* self);
+
+/**
+ * @function scheduler_spawn
+ * @brief Run a task concurrently
+ * @param self
+ * [in,out] The scheduler
+ * @param group
+ * [in,out] Group to wait for the task with
+ * @param func
+ * [in] Function of the task
+ * @param data
+ * [in,opt] Argument of `func'
+ *
+ * Tasks spawned by a worker run last in, first out on that worker unless they are stolen.
+ */
+void scheduler_spawn(scheduler* self, scheduler_group* group, void (*func)(void* data), void* data);
+/**
+ * @function scheduler_wait
+ * @brief Wait for every task of a group, running queued tasks in the meantime
+ * @param self
+ * [in,out] The scheduler
+ * @param group
+ * [in,out] The group
+ *
+ * Can be called from any thread, including from tasks.
+ */
+void scheduler_wait(scheduler* self, scheduler_group* group);
+/**
+ * @function scheduler_for
+ * @brief Run a function over a range of indexes in parallel and wait for it
+ * @param self
+ * [in,out] The scheduler
+ * @param begin
+ * [in] First index
+ * @param end
+ * [in] End of the range
+ * @param grain
+ * [in] Fewest indexes handed to `func' at once, 0 to derive it from the range and the workers
+ * @param func
+ * [in] Function called with subranges [`begin', `end')
+ * @param data
+ * [in,opt] Argument of `func'
+ *
+ * Ranges are split lazily: a task only hands off the upper half of its range while its deque
+ * is empty, so idle workers find something to steal and busy ones run large pieces.
+ */
+void scheduler_for(scheduler* self, unsigned long begin, unsigned long end, unsigned long grain,
+    void (*func)(unsigned long begin, unsigned long end, void* data), void* data);
+
+/**
+ * @function scheduler_worker
+ * @brief Get the index of the worker calling, -1 if the calling thread isn't a worker of the scheduler
+ * @param self
+ * [in] The scheduler
+ */
+int scheduler_worker(const scheduler* self);
+
+/**
+ * @function scheduler_stats_get
+ * @brief Get the counters of a worker
+ * @param self
+ * [in] The scheduler
+ * @param worker
+ * [in] Index of the worker
+ *
+ * Threads that aren't workers don't count what they do while waiting.
+ */
+scheduler_stats scheduler_stats_get(const scheduler* self, unsigned int worker);
+/**
+ * @function scheduler_stats_total
+ * @brief Get the counters of all workers combined
+ * @param self
+ * [in] The scheduler
+ */
+scheduler_stats scheduler_stats_total(const scheduler* self);
+
+#endif // !__BLIB_CONCURRENCY_SCHEDULER_H__
@@ -1,5 +1,9 @@
 #ifndef __BLIB_DATASTRUCTURES_ARRAYS_ARRAYS_H__
 #define __BLIB_DATASTRUCTURES_ARRAYS_ARRAYS_H__
 #include "dynamic.h"
+#include "packed.h"
+#include "snapshot.h"
+#include "trace.h"
+#include "tree.h"
 
 #endif // !__BLIB_DATASTRUCTURES_ARRAYS_ARRAYS_H__
@@ -1,6 +1,7 @@
 #ifndef __BLIB_DATASTRUCTURES_ARRAYS_DYNAMIC_H__
 #define __BLIB_DATASTRUCTURES_ARRAYS_DYNAMIC_H__
 #include <stdint.h>
+#include <stdbool.h>
 
 typedef struct {
   unsigned long __cap__; /* Maximum capacity/memory allocated in array */
@@ -9,17 +10,42 @@ typedef struct {
 
   unsigned long __deadzone__; /* Zone in front of the array (results from any `*_quick()` functions) */
   uint8_t* __malloc_start__; /* Start/ptr to the start of the array */
+  unsigned long* __refs__; /* Holders of the memory if copy-on-write is enabled (see `dynamic_arr_enable_cow()') */
+  unsigned int __align__; /* Alignment of the start of the array, 0 if only aligned like `malloc()' */
+  unsigned long __id__; /* Identifies the array in traces (see `dynamic_arr_trace_start()') */
 } dynamic_arr;
 
 dynamic_arr __intern_dynamic_generic_arr_new(unsigned int element_size);
+dynamic_arr __intern_dynamic_generic_arr_new_aligned(unsigned int element_size, unsigned int alignment, bool pad);
 
 /**
  * @function dynamic_arr_copy
  * @brief Copy a specified dynamic array
  * @param src
  * [in,out] Dynamic array to be copied
+ *
+ * If copy-on-write is enabled for `src', the copy shares its memory and takes O(1).
  */
 dynamic_arr dynamic_arr_copy(const dynamic_arr* src);
+/**
+ * @function dynamic_arr_enable_cow
+ * @brief Make copies of the dynamic array share its memory until either of them is modified
+ * @param self
+ * [in,out] The dynamic array
+ *
+ * The reference count is atomic, so copies can be handed to other threads.
+ * Every modifying `dynamic_arr_*()' function makes a private copy first.
+ */
+void dynamic_arr_enable_cow(dynamic_arr* self);
+/**
+ * @function dynamic_arr_unshare
+ * @brief Make sure the memory of the dynamic array isn't shared with any copy
+ * @param self
+ * [in,out] The dynamic array
+ *
+ * Has to be called before writing through the pointer of `dynamic_arr_get_start()'.
+ */
+void dynamic_arr_unshare(dynamic_arr* self);
 /**
  * @function dynamic_arr_get_start
  * @brief Get the real start of a dynamic array
@@ -214,6 +240,15 @@ void dynamic_arr_truncate(dynamic_arr* self, void* out);
  * [in] New size of the array
  */
 void dynamic_arr_resize_to(dynamic_arr* self, void* out, unsigned long new_size);
+/**
+ * @function dynamic_arr_reserve
+ * @brief Make sure the specified number of elements can be added without reallocating
+ * @param self
+ * [in,out] The dynamic array
+ * @param num
+ * [in] Number of elements to reserve space for
+ */
+void dynamic_arr_reserve(dynamic_arr* self, unsigned long num);
 /**
  * @function dynamic_arr_trim
  * @brief Deallocate all unused space of array
@@ -272,4 +307,30 @@ void dynamic_arr_cleanup(dynamic_arr* self);
  */
 #define dynamic_arr_new(type) __intern_dynamic_generic_arr_new(sizeof(type))
 
+/**
+ * @function dynamic_arr_new_aligned
+ * @brief Create a new dynamic array, whose start is aligned to `alignment' bytes
+ * @param type
+ * [in] Type of the array-elements
+ * @param alignment
+ * [in] Power of two multiple of `sizeof(void*)', e.g. 32, 64 or the page size
+ *
+ * The alignment holds across growth and `dynamic_arr_trim()'. Unless the element size is a
+ * multiple of the alignment, the `*_quick()' functions fall back to their regular versions,
+ * since a deadzone would shift the start off the alignment.
+ */
+#define dynamic_arr_new_aligned(type, alignment) __intern_dynamic_generic_arr_new_aligned(sizeof(type), alignment, false)
+
+/**
+ * @function dynamic_arr_new_padded
+ * @brief Create a new aligned dynamic array, whose elements are padded to a multiple of `alignment' bytes
+ * @param type
+ * [in] Type of the array-elements
+ * @param alignment
+ * [in] Power of two multiple of `sizeof(void*)', e.g. 64 to put every element on its own cache line
+ *
+ * `element_size' is the padded size, every element passed to or read from the array has to be padded as well.
+ */
+#define dynamic_arr_new_padded(type, alignment) __intern_dynamic_generic_arr_new_aligned(sizeof(type), alignment, true)
+
 #endif // !__BLIB_DATASTRUCTURES_ARRAYS_DYNAMIC_H__
@@ -0,0 +1,142 @@
+#ifndef __BLIB_DATASTRUCTURES_ARRAYS_PACKED_H__
+#define __BLIB_DATASTRUCTURES_ARRAYS_PACKED_H__
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/memory/kernels.h>
+
+/* Integers packed together, every block has a header of its own */
+#define PACKED_ARR_BLOCK KERNEL_UNPACK_BLOCK
+
+typedef struct {
+  unsigned long num; /* Number of integers */
+  unsigned int element_size; /* Size of each integer, 4 or 8 */
+
+  dynamic_arr __blocks__; /* Header of every packed block */
+  dynamic_arr __words__; /* Packed blocks, 32-bit words */
+  void* __tail__; /* Integers after the last block, up to PACKED_ARR_BLOCK, not packed yet */
+  unsigned int __tail_num__; /* Number of integers in the tail */
+} packed_arr;
+
+/**
+ * @struct packed_arr_stats
+ * @brief Size of a packed array
+ * @var blocks
+ * Number of packed blocks
+ * @var for_blocks
+ * Blocks stored as offsets from their smallest integer
+ * @var delta_blocks
+ * Blocks stored as differences between neighbouring integers
+ * @var raw_blocks
+ * Blocks stored unpacked, since neither fit into 32 bits
+ * @var bytes
+ * Bytes of the packed blocks, their headers and the tail
+ * @var raw_bytes
+ * Bytes of the integers unpacked
+ */
+typedef struct {
+  unsigned long blocks;
+  unsigned long for_blocks;
+  unsigned long delta_blocks;
+  unsigned long raw_blocks;
+  unsigned long bytes;
+  unsigned long raw_bytes;
+} packed_arr_stats;
+
+packed_arr __intern_packed_arr_new(unsigned int element_size);
+
+/**
+ * @function packed_arr_new
+ * @brief Create a new packed array of unsigned integers
+ * @param type
+ * [in] Type of the integers, 32 or 64 bits
+ *
+ * Every block of PACKED_ARR_BLOCK integers is stored as offsets from its smallest integer
+ * (frame of reference) or as differences to the integer four before it (delta, for sorted
+ * or slowly varying integers), whichever takes fewer bits, with all offsets or differences
+ * packed into as many bits as the largest needs. Blocks are unpacked with the kernels of
+ * `<blib/memory/kernels.h>'.
+ */
+#define packed_arr_new(type) __intern_packed_arr_new(sizeof(type))
+
+/**
+ * @function packed_arr_from_dynamic
+ * @brief Create a packed array from the integers of a dynamic array
+ * @param src
+ * [in] The dynamic array, of 32 or 64-bit integers
+ */
+packed_arr packed_arr_from_dynamic(const dynamic_arr* src);
+/**
+ * @function packed_arr_to_dynamic
+ * @brief Unpack every integer of a packed array into a new dynamic array
+ * @param self
+ * [in] The packed array
+ */
+dynamic_arr packed_arr_to_dynamic(const packed_arr* self);
+
+/**
+ * @function packed_arr_append
+ * @brief Add an integer to the end of a packed array
+ * @param self
+ * [in,out] The packed array
+ * @param element
+ * [in] Pointer to the integer
+ *
+ * Integers are packed once a block is full, until then they are kept as they are.
+ */
+void packed_arr_append(packed_arr* self, const void* element);
+/**
+ * @function packed_arr_bulk_append
+ * @brief Add a specified amount of integers to the end of a packed array
+ * @param self
+ * [in,out] The packed array
+ * @param elements
+ * [in] The integers
+ * @param num
+ * [in] Number of integers
+ */
+void packed_arr_bulk_append(packed_arr* self, const void* elements, unsigned long num);
+
+/**
+ * @function packed_arr_peek
+ * @brief Read the integer at the specified index
+ * @param self
+ * [in] The packed array
+ * @param index
+ * [in] Index of the integer
+ * @param out
+ * [out] Pointer to write the integer to
+ *
+ * Takes O(1) in frame of reference blocks, in delta blocks the differences before the
+ * index in its lane (up to PACKED_ARR_BLOCK / 4) are summed.
+ */
+void packed_arr_peek(const packed_arr* self, unsigned long index, void* out);
+/**
+ * @function packed_arr_bulk_peek
+ * @brief Unpack a specified amount of integers from the specified index on
+ * @param self
+ * [in] The packed array
+ * @param index
+ * [in] Index of the first integer
+ * @param out
+ * [out] Memory of at least `num' integers
+ * @param num
+ * [in] Number of integers
+ */
+void packed_arr_bulk_peek(const packed_arr* self, unsigned long index, void* out, unsigned long num);
+
+/**
+ * @function packed_arr_stats_get
+ * @brief Get the size of a packed array
+ * @param self
+ * [in] The packed array
+ */
+packed_arr_stats packed_arr_stats_get(const packed_arr* self);
+
+/**
+ * @function packed_arr_cleanup
+ * @brief Free and cleanup the specified packed array
+ * @param self
+ * [in,out] The packed array
+ */
+void packed_arr_cleanup(packed_arr* self);
+
+#endif // !__BLIB_DATASTRUCTURES_ARRAYS_PACKED_H__
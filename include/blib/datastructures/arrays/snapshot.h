@@ -0,0 +1,142 @@
+#ifndef __BLIB_DATASTRUCTURES_ARRAYS_SNAPSHOT_H__
+#define __BLIB_DATASTRUCTURES_ARRAYS_SNAPSHOT_H__
+#include <blib/datastructures/arrays/dynamic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Threads reading with a slot of their own, other threads share a counter */
+#define SNAPSHOT_ARR_MAX_READERS 64
+
+typedef struct {
+  unsigned int element_size; /* Size of each element */
+
+  void* __current__; /* Published version, readers load it without locking */
+  uint64_t __epoch__; /* Global epoch, starts at 1 */
+  void* __readers__; /* Epoch every reader slot announced, 0 if not reading, a cache line each */
+  unsigned long __overflow__; /* Reading threads without slot, the epoch doesn't advance while there are any */
+
+  bool __lock__; /* Spinlock of the writers, the fields below */
+  void* __retired__; /* Replaced versions not freed yet, newest first */
+  unsigned long __retired_count__; /* Number of retired versions */
+  unsigned long __published__; /* Number of versions published */
+} snapshot_arr;
+
+/**
+ * @struct snapshot_arr_stats
+ * @brief Versions of a snapshot array
+ * @var published
+ * Versions published, including the first
+ * @var retired
+ * Replaced versions that readers may still use
+ * @var epoch
+ * Current epoch
+ */
+typedef struct {
+  unsigned long published;
+  unsigned long retired;
+  uint64_t epoch;
+} snapshot_arr_stats;
+
+snapshot_arr __intern_snapshot_arr_new(unsigned int element_size);
+
+/**
+ * @function snapshot_arr_new
+ * @brief Create a new snapshot array, whose first version is empty
+ * @param type
+ * [in] Type of the elements
+ *
+ * Many threads read the published version without locking while writers publish new
+ * versions. Replaced versions are freed once no reader can still use them (epoch-based reclamation).
+ */
+#define snapshot_arr_new(type) __intern_snapshot_arr_new(sizeof(type))
+/**
+ * @function snapshot_arr_from_dynamic
+ * @brief Create a new snapshot array, whose first version is a dynamic array
+ * @param src
+ * [in,out] The dynamic array, taken over and zeroed
+ */
+snapshot_arr snapshot_arr_from_dynamic(dynamic_arr* src);
+
+/**
+ * @function snapshot_arr_read_begin
+ * @brief Start reading the published version
+ * @param self
+ * [in,out] The snapshot array
+ *
+ * The version stays valid and unchanged until `snapshot_arr_read_end()', later publications
+ * aren't seen by it. Reads can be nested, a thread must not exit while reading.
+ * `dynamic_arr_copy()' keeps a version beyond the end of the read, it takes O(1).
+ */
+const dynamic_arr* snapshot_arr_read_begin(snapshot_arr* self);
+/**
+ * @function snapshot_arr_read_end
+ * @brief End reading the version returned by `snapshot_arr_read_begin()'
+ * @param self
+ * [in,out] The snapshot array
+ */
+void snapshot_arr_read_end(snapshot_arr* self);
+
+/**
+ * @function snapshot_arr_copy
+ * @brief Get a copy of the published version to build the next one from
+ * @param self
+ * [in,out] The snapshot array
+ *
+ * The copy shares the memory of the version until it is modified (see `dynamic_arr_enable_cow()').
+ * Publications between the copy and `snapshot_arr_publish()' are overwritten, writers that
+ * may run concurrently use `snapshot_arr_update()'.
+ */
+dynamic_arr snapshot_arr_copy(snapshot_arr* self);
+/**
+ * @function snapshot_arr_publish
+ * @brief Replace the published version
+ * @param self
+ * [in,out] The snapshot array
+ * @param version
+ * [in,out] The new version, taken over and zeroed
+ *
+ * The previous version is retired, retired versions no reader can use anymore are freed.
+ */
+void snapshot_arr_publish(snapshot_arr* self, dynamic_arr* version);
+/**
+ * @function snapshot_arr_update
+ * @brief Publish a modified copy of the published version, one writer at a time
+ * @param self
+ * [in,out] The snapshot array
+ * @param edit
+ * [in] Function applying the changes to the copy
+ * @param data
+ * [in,opt] Argument of `edit'
+ */
+void snapshot_arr_update(snapshot_arr* self, void (*edit)(dynamic_arr* version, void* data), void* data);
+
+/**
+ * @function snapshot_arr_reclaim
+ * @brief Free the retired versions no reader can use anymore
+ * @param self
+ * [in,out] The snapshot array
+ *
+ * Publishing reclaims as well, this is for writers that stopped publishing.
+ * Returns the number of retired versions left.
+ */
+unsigned long snapshot_arr_reclaim(snapshot_arr* self);
+
+/**
+ * @function snapshot_arr_stats_get
+ * @brief Get the number of versions of a snapshot array
+ * @param self
+ * [in] The snapshot array
+ */
+snapshot_arr_stats snapshot_arr_stats_get(const snapshot_arr* self);
+
+/**
+ * @function snapshot_arr_cleanup
+ * @brief Free every version of the specified snapshot array
+ * @param self
+ * [in,out] The snapshot array
+ *
+ * No thread may be reading.
+ */
+void snapshot_arr_cleanup(snapshot_arr* self);
+
+#endif // !__BLIB_DATASTRUCTURES_ARRAYS_SNAPSHOT_H__
@@ -0,0 +1,136 @@
+#ifndef __BLIB_DATASTRUCTURES_ARRAYS_TRACE_H__
+#define __BLIB_DATASTRUCTURES_ARRAYS_TRACE_H__
+#include <blib/datastructures/arrays/dynamic.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * @enum dynamic_arr_trace_op
+ * @brief Operations recorded in a trace, one per `dynamic_arr_*()' function
+ *
+ * Writes through the pointer of `dynamic_arr_get_start()' aren't recorded, the containers
+ * of this library that fill arrays through it record the new sizes as bulk appends and resizes.
+ */
+enum dynamic_arr_trace_op {
+  DYNAMIC_ARR_TRACE_NEW,
+  DYNAMIC_ARR_TRACE_COPY,
+  DYNAMIC_ARR_TRACE_ENABLE_COW,
+  DYNAMIC_ARR_TRACE_REPLACE,
+  DYNAMIC_ARR_TRACE_BULK_REPLACE,
+  DYNAMIC_ARR_TRACE_SET,
+  DYNAMIC_ARR_TRACE_FLIP,
+  DYNAMIC_ARR_TRACE_BULK_FLIP,
+  DYNAMIC_ARR_TRACE_PEEK,
+  DYNAMIC_ARR_TRACE_BULK_PEEK,
+  DYNAMIC_ARR_TRACE_APPEND,
+  DYNAMIC_ARR_TRACE_BULK_APPEND,
+  DYNAMIC_ARR_TRACE_PREPEND,
+  DYNAMIC_ARR_TRACE_BULK_PREPEND,
+  DYNAMIC_ARR_TRACE_INSERT_AT,
+  DYNAMIC_ARR_TRACE_BULK_INSERT_AT,
+  DYNAMIC_ARR_TRACE_PRECATE,
+  DYNAMIC_ARR_TRACE_QUICK_PRECATE,
+  DYNAMIC_ARR_TRACE_TRUNCATE,
+  DYNAMIC_ARR_TRACE_RESIZE_TO,
+  DYNAMIC_ARR_TRACE_RESERVE,
+  DYNAMIC_ARR_TRACE_TRIM,
+  DYNAMIC_ARR_TRACE_REMOVE_AT,
+  DYNAMIC_ARR_TRACE_BULK_REMOVE_AT,
+  DYNAMIC_ARR_TRACE_QUICK_REMOVE_AT,
+  DYNAMIC_ARR_TRACE_CLEANUP,
+};
+#define DYNAMIC_ARR_TRACE_OPS (DYNAMIC_ARR_TRACE_CLEANUP + 1)
+
+/**
+ * @struct dynamic_arr_trace_record
+ * @brief A recorded call of a `dynamic_arr_*()' function
+ * @var op
+ * The operation
+ * @var array
+ * Id of the array (`__id__' of the dynamic array)
+ * @var element_size
+ * Size of the elements of the array
+ * @var size
+ * Number of elements of the array before the operation
+ * @var index
+ * Index of the operation, the alignment for `DYNAMIC_ARR_TRACE_NEW'
+ * @var other
+ * Second index of flips, the id of the new array for `DYNAMIC_ARR_TRACE_COPY'
+ * @var count
+ * Number of elements of bulk operations, the new size or number of elements to reserve
+ */
+typedef struct {
+  enum dynamic_arr_trace_op op;
+  unsigned long array;
+  unsigned int element_size;
+  unsigned long size;
+  unsigned long index;
+  unsigned long other;
+  unsigned long count;
+} dynamic_arr_trace_record;
+
+/**
+ * @function dynamic_arr_trace_start
+ * @brief Record every `dynamic_arr_*()' call of the process to a trace file
+ * @param path
+ * [in] Path of the trace file, truncated if it exists
+ *
+ * Records are varint encoded, mostly 7 to 10 bytes each. Until tracing is started,
+ * every call only pays for an atomic load.
+ * Returns false if tracing is already running or the file couldn't be opened (errno is set).
+ */
+bool dynamic_arr_trace_start(const char* path);
+/**
+ * @function dynamic_arr_trace_stop
+ * @brief Stop recording and close the trace file
+ *
+ * No other thread may use a dynamic array while tracing stops.
+ */
+void dynamic_arr_trace_stop(void);
+
+/**
+ * @function dynamic_arr_trace_open
+ * @brief Open a trace file written by `dynamic_arr_trace_start()' for reading
+ * @param path
+ * [in] Path of the trace file
+ *
+ * Returns NULL if the file couldn't be opened or isn't a trace (errno is set).
+ */
+FILE* dynamic_arr_trace_open(const char* path);
+/**
+ * @function dynamic_arr_trace_read
+ * @brief Read the next record of a trace
+ * @param file
+ * [in] Trace opened by `dynamic_arr_trace_open()'
+ * @param record
+ * [out] The record
+ *
+ * Returns false at the end of the trace, or if it is truncated.
+ */
+bool dynamic_arr_trace_read(FILE* file, dynamic_arr_trace_record* record);
+/**
+ * @function dynamic_arr_trace_op_name
+ * @brief Get the name of a traced operation, the name of its function without `dynamic_arr_'
+ * @param op
+ * [in] The operation
+ */
+const char* dynamic_arr_trace_op_name(enum dynamic_arr_trace_op op);
+
+extern bool __intern_dynamic_arr_tracing;
+unsigned long __intern_dynamic_arr_next_id(void);
+void __intern_dynamic_arr_trace(const dynamic_arr* self, enum dynamic_arr_trace_op op, unsigned long index, unsigned long other, unsigned long count);
+void __intern_dynamic_arr_trace_num(const dynamic_arr* self, unsigned long num);
+
+/*
+ * Containers on dynamic arrays write the spare capacity directly and then set `num',
+ * the new number of elements is recorded so their traces replay to the same sizes
+ */
+#define __intern_dynamic_arr_set_num(self, new_num)                           \
+  do {                                                                        \
+    if (__atomic_load_n(&__intern_dynamic_arr_tracing, __ATOMIC_ACQUIRE))     \
+      __intern_dynamic_arr_trace_num(self, new_num);                          \
+    (self)->num = (new_num);                                                  \
+  } while (0)
+
+#endif // !__BLIB_DATASTRUCTURES_ARRAYS_TRACE_H__
@@ -0,0 +1,229 @@
+#ifndef __BLIB_DATASTRUCTURES_ARRAYS_TREE_H__
+#define __BLIB_DATASTRUCTURES_ARRAYS_TREE_H__
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/memory/pool.h>
+
+/* Bytes of elements in a leaf, at least TREE_ARR_MIN_LEAF elements */
+#define TREE_ARR_LEAF_BYTES 1024
+#define TREE_ARR_MIN_LEAF   8
+
+typedef struct {
+  unsigned long num; /* Number of elements */
+  unsigned int element_size; /* Size of each element */
+
+  unsigned int __leaf_cap__; /* Elements fitting into a leaf */
+  unsigned int __height__; /* Levels of inner nodes above the leaves */
+  void* __root__; /* Root node, a leaf if the height is 0, NULL if empty */
+  void* __first__; /* First leaf, the leaves are linked in order */
+  pool __leaves__; /* Backing store of the leaves */
+  pool __nodes__; /* Backing store of the inner nodes */
+} tree_arr;
+
+/**
+ * @struct tree_arr_iter
+ * @brief Position in a tree array, to iterate over its elements in order
+ */
+typedef struct {
+  void* __leaf__; /* Leaf of the next element, NULL at the end */
+  unsigned long __offset__; /* Index of the next element in its leaf */
+  unsigned int element_size; /* Size of each element */
+} tree_arr_iter;
+
+tree_arr __intern_tree_arr_new(unsigned int element_size);
+
+/**
+ * @function tree_arr_new
+ * @brief Create a new tree array
+ * @param type
+ * [in] Type of the elements
+ *
+ * Same index-based interface as a dynamic array, but elements are stored in leaves of about
+ * TREE_ARR_LEAF_BYTES under a counted B+tree, so inserting and removing anywhere takes
+ * O(log n) instead of moving the rest of the array, while reading an index takes O(log n)
+ * instead of O(1).
+ */
+#define tree_arr_new(type) __intern_tree_arr_new(sizeof(type))
+
+/**
+ * @function tree_arr_from_dynamic
+ * @brief Create a tree array from the elements of a dynamic array in O(n)
+ * @param src
+ * [in] The dynamic array
+ */
+tree_arr tree_arr_from_dynamic(const dynamic_arr* src);
+/**
+ * @function tree_arr_to_dynamic
+ * @brief Copy the elements of a tree array into a new dynamic array
+ * @param self
+ * [in] The tree array
+ */
+dynamic_arr tree_arr_to_dynamic(const tree_arr* self);
+
+/**
+ * @function tree_arr_peek
+ * @brief Read the element at the specified index
+ * @param self
+ * [in] The tree array
+ * @param index
+ * [in] Index of the element
+ * @param out
+ * [out] Pointer to write the element to
+ */
+void tree_arr_peek(const tree_arr* self, unsigned long index, void* out);
+/**
+ * @function tree_arr_bulk_peek
+ * @brief Read specified amount of elements from specified index on
+ * @param self
+ * [in] The tree array
+ * @param index
+ * [in] Index of the first element
+ * @param out
+ * [out] Memory of at least `num' elements
+ * @param num
+ * [in] Number of elements
+ */
+void tree_arr_bulk_peek(const tree_arr* self, unsigned long index, void* out, unsigned long num);
+/**
+ * @function tree_arr_get
+ * @brief Get a pointer to the element at the specified index
+ * @param self
+ * [in] The tree array
+ * @param index
+ * [in] Index of the element
+ *
+ * The pointer is invalidated by inserting or removing elements.
+ */
+void* tree_arr_get(const tree_arr* self, unsigned long index);
+
+/**
+ * @function tree_arr_replace
+ * @brief Replace the element at the specified index
+ * @param self
+ * [in,out] The tree array
+ * @param index
+ * [in] Index of the element
+ * @param element
+ * [in] Pointer to the new element
+ */
+void tree_arr_replace(tree_arr* self, unsigned long index, const void* element);
+/**
+ * @function tree_arr_bulk_replace
+ * @brief Replace specified number of elements at specified index
+ * @param self
+ * [in,out] The tree array
+ * @param index
+ * [in] Index of the first element
+ * @param elements
+ * [in] New elements
+ * @param num
+ * [in] Number of elements
+ */
+void tree_arr_bulk_replace(tree_arr* self, unsigned long index, const void* elements, unsigned long num);
+
+/**
+ * @function tree_arr_append
+ * @brief Add an element to the end of a tree array
+ * @param self
+ * [in,out] The tree array
+ * @param element
+ * [in] Pointer to the element
+ */
+void tree_arr_append(tree_arr* self, const void* element);
+/**
+ * @function tree_arr_bulk_append
+ * @brief Add a specified amount of elements to the end of a tree array
+ * @param self
+ * [in,out] The tree array
+ * @param elements
+ * [in] The elements
+ * @param num
+ * [in] Number of elements
+ */
+void tree_arr_bulk_append(tree_arr* self, const void* elements, unsigned long num);
+/**
+ * @function tree_arr_insert_at
+ * @brief Insert an element at the specified index
+ * @param self
+ * [in,out] The tree array
+ * @param index
+ * [in] Index of the new element, up to the number of elements
+ * @param element
+ * [in] Pointer to the element
+ */
+void tree_arr_insert_at(tree_arr* self, unsigned long index, const void* element);
+/**
+ * @function tree_arr_bulk_insert_at
+ * @brief Insert a specified number of elements at the specified index
+ * @param self
+ * [in,out] The tree array
+ * @param index
+ * [in] Index of the first new element, up to the number of elements
+ * @param elements
+ * [in] The elements
+ * @param num
+ * [in] Number of elements
+ */
+void tree_arr_bulk_insert_at(tree_arr* self, unsigned long index, const void* elements, unsigned long num);
+
+/**
+ * @function tree_arr_remove_at
+ * @brief Remove the element at the specified index
+ * @param self
+ * [in,out] The tree array
+ * @param index
+ * [in] Index of the element
+ * @param out
+ * [out,opt] Pointer to write the removed element to
+ */
+void tree_arr_remove_at(tree_arr* self, unsigned long index, void* out);
+/**
+ * @function tree_arr_bulk_remove_at
+ * @brief Remove specified amount of elements at index
+ * @param self
+ * [in,out] The tree array
+ * @param index
+ * [in] Index of the first element
+ * @param out
+ * [out,opt] Memory of at least `num' elements to write the removed elements to
+ * @param num
+ * [in] Number of elements
+ */
+void tree_arr_bulk_remove_at(tree_arr* self, unsigned long index, void* out, unsigned long num);
+
+/**
+ * @function tree_arr_iter_new
+ * @brief Start iterating over a tree array at an index, in O(log n)
+ * @param self
+ * [in] The tree array
+ * @param index
+ * [in] Index of the first element, up to the number of elements
+ *
+ * The iterator is invalidated by inserting or removing elements.
+ */
+tree_arr_iter tree_arr_iter_new(const tree_arr* self, unsigned long index);
+/**
+ * @function tree_arr_iter_next
+ * @brief Get a pointer to the next element, NULL at the end
+ * @param iter
+ * [in,out] The iterator
+ */
+void* tree_arr_iter_next(tree_arr_iter* iter);
+/**
+ * @function tree_arr_iter_block
+ * @brief Get the next elements stored contiguously, up to the end of their leaf, NULL at the end
+ * @param iter
+ * [in,out] The iterator
+ * @param num
+ * [out] Number of elements
+ */
+void* tree_arr_iter_block(tree_arr_iter* iter, unsigned long* num);
+
+/**
+ * @function tree_arr_cleanup
+ * @brief Free and cleanup the specified tree array
+ * @param self
+ * [in,out] The tree array
+ */
+void tree_arr_cleanup(tree_arr* self);
+
+#endif // !__BLIB_DATASTRUCTURES_ARRAYS_TREE_H__
@@ -1,5 +1,8 @@
 #ifndef __BLIB_DATASTRUCTURES_DATASTRUCTURES_H__
 #define __BLIB_DATASTRUCTURES_DATASTRUCTURES_H__
 #include "arrays/arrays.h"
+#include "flat/flat.h"
+#include "queues/queues.h"
+#include "strings/strings.h"
 
 #endif // !__BLIB_DATASTRUCTURES_DATASTRUCTURES_H__
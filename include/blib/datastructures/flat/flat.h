@@ -0,0 +1,6 @@
+#ifndef __BLIB_DATASTRUCTURES_FLAT_FLAT_H__
+#define __BLIB_DATASTRUCTURES_FLAT_FLAT_H__
+#include "set.h"
+#include "map.h"
+
+#endif // !__BLIB_DATASTRUCTURES_FLAT_FLAT_H__
@@ -0,0 +1,133 @@
+#ifndef __BLIB_DATASTRUCTURES_FLAT_MAP_H__
+#define __BLIB_DATASTRUCTURES_FLAT_MAP_H__
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/flat/set.h>
+#include <stdbool.h>
+
+typedef struct {
+  dynamic_arr __keys__; /* Sorted unique keys, contiguous to keep lookups cache friendly */
+  dynamic_arr __values__; /* Values, at the same index as their key */
+  flat_cmp cmp; /* Ordering of the keys */
+} flat_map;
+
+flat_map __intern_flat_map_new(unsigned int key_size, unsigned int value_size, flat_cmp cmp);
+
+/**
+ * @function flat_map_from_arrs
+ * @brief Turn existing dynamic arrays of keys and values into a flat map
+ * @param keys
+ * [in,out] The keys, owned by the flat map afterwards
+ * @param values
+ * [in,out] The values at the same indexes as their keys, owned by the flat map afterwards
+ * @param cmp
+ * [in] Ordering of the keys
+ *
+ * For duplicate keys the value appearing last wins.
+ */
+flat_map flat_map_from_arrs(dynamic_arr* keys, dynamic_arr* values, flat_cmp cmp);
+
+/**
+ * @function flat_map_len
+ * @brief Get the number of entries in the flat map
+ * @param self
+ * [in] The flat map
+ */
+unsigned long flat_map_len(const flat_map* self);
+/**
+ * @function flat_map_peek
+ * @brief Read the entry at the specified index (in sorted order of the keys)
+ * @param self
+ * [in] The flat map
+ * @param index
+ * [in] The index of the entry
+ * @param key
+ * [out,opt] Pointer to write the key to
+ * @param value
+ * [out,opt] Pointer to write the value to
+ */
+void flat_map_peek(const flat_map* self, unsigned long index, void* key, void* value);
+
+/**
+ * @function flat_map_find
+ * @brief Look up the index of a key
+ * @param self
+ * [in] The flat map
+ * @param key
+ * [in] The key to look for
+ * @param index
+ * [out,opt] Index of the entry, if found
+ */
+bool flat_map_find(const flat_map* self, const void* key, unsigned long* index);
+/**
+ * @function flat_map_get
+ * @brief Look up the value of a key
+ * @param self
+ * [in] The flat map
+ * @param key
+ * [in] The key to look for
+ * @param value
+ * [out,opt] Pointer to write the value to, if found
+ */
+bool flat_map_get(const flat_map* self, const void* key, void* value);
+
+/**
+ * @function flat_map_insert
+ * @brief Insert an entry or replace the value of an existing key
+ * @param self
+ * [in,out] The flat map
+ * @param key
+ * [in] The key
+ * @param value
+ * [in] The value
+ *
+ * Returns whether the key was newly inserted.
+ */
+bool flat_map_insert(flat_map* self, const void* key, const void* value);
+/**
+ * @function flat_map_bulk_insert
+ * @brief Insert a specified number of entries with a single merge
+ * @param self
+ * [in,out] The flat map
+ * @param keys
+ * [in] The keys, in any order
+ * @param values
+ * [in] The values at the same indexes as their keys
+ * @param num
+ * [in] Number of entries
+ *
+ * Values of the batch replace the values of existing keys, for duplicate keys inside of the batch the last one wins.
+ */
+void flat_map_bulk_insert(flat_map* self, const void* keys, const void* values, unsigned long num);
+/**
+ * @function flat_map_remove
+ * @brief Remove an entry, if present
+ * @param self
+ * [in,out] The flat map
+ * @param key
+ * [in] The key of the entry
+ * @param value
+ * [out,opt] Pointer to write the removed value to
+ */
+bool flat_map_remove(flat_map* self, const void* key, void* value);
+
+/**
+ * @function flat_map_cleanup
+ * @brief Free and cleanup the specified flat map
+ * @param self
+ * [in,out] The flat map
+ */
+void flat_map_cleanup(flat_map* self);
+
+/**
+ * @function flat_map_new
+ * @brief Create a new flat map
+ * @param key_type
+ * [in] Type of the keys
+ * @param value_type
+ * [in] Type of the values
+ * @param cmp
+ * [in] Ordering of the keys
+ */
+#define flat_map_new(key_type, value_type, cmp) __intern_flat_map_new(sizeof(key_type), sizeof(value_type), cmp)
+
+#endif // !__BLIB_DATASTRUCTURES_FLAT_MAP_H__
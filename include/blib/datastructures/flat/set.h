@@ -0,0 +1,156 @@
+#ifndef __BLIB_DATASTRUCTURES_FLAT_SET_H__
+#define __BLIB_DATASTRUCTURES_FLAT_SET_H__
+#include <blib/datastructures/arrays/dynamic.h>
+#include <stdbool.h>
+
+/**
+ * @typedef flat_cmp
+ * @brief Ordering of two elements/keys, negative if `a' is smaller than `b'
+ */
+typedef int (*flat_cmp)(const void* a, const void* b);
+
+typedef struct {
+  dynamic_arr __storage__; /* Sorted unique elements */
+  flat_cmp cmp; /* Ordering of the elements */
+} flat_set;
+
+flat_set __intern_flat_set_new(unsigned int element_size, flat_cmp cmp);
+void __intern_flat_sort(void* base, unsigned long num, unsigned int size, flat_cmp cmp);
+unsigned long __intern_flat_lower_bound(const void* base, unsigned long num, unsigned int size, flat_cmp cmp, const void* key);
+
+/**
+ * @function flat_set_from_arr
+ * @brief Turn an existing dynamic array into a flat set by sorting and removing duplicates
+ * @param arr
+ * [in,out] The dynamic array, owned by the flat set afterwards
+ * @param cmp
+ * [in] Ordering of the elements
+ */
+flat_set flat_set_from_arr(dynamic_arr* arr, flat_cmp cmp);
+
+/**
+ * @function flat_set_len
+ * @brief Get the number of elements in the flat set
+ * @param self
+ * [in] The flat set
+ */
+unsigned long flat_set_len(const flat_set* self);
+/**
+ * @function flat_set_get_start
+ * @brief Get a pointer to the sorted elements
+ * @param self
+ * [in] The flat set
+ */
+const void* flat_set_get_start(const flat_set* self);
+/**
+ * @function flat_set_peek
+ * @brief Read the element at the specified index (in sorted order)
+ * @param self
+ * [in] The flat set
+ * @param index
+ * [in] The index of the element
+ * @param out
+ * [out] Pointer to write the element to
+ */
+void flat_set_peek(const flat_set* self, unsigned long index, void* out);
+
+/**
+ * @function flat_set_lower_bound
+ * @brief Get the index of the first element not smaller than `key'
+ * @param self
+ * [in] The flat set
+ * @param key
+ * [in] The element to look for
+ */
+unsigned long flat_set_lower_bound(const flat_set* self, const void* key);
+/**
+ * @function flat_set_find
+ * @brief Look up an element
+ * @param self
+ * [in] The flat set
+ * @param key
+ * [in] The element to look for
+ * @param index
+ * [out,opt] Index of the element, if found
+ */
+bool flat_set_find(const flat_set* self, const void* key, unsigned long* index);
+
+/**
+ * @function flat_set_insert
+ * @brief Insert an element, if not already present
+ * @param self
+ * [in,out] The flat set
+ * @param element
+ * [in] The element to be inserted
+ */
+bool flat_set_insert(flat_set* self, const void* element);
+/**
+ * @function flat_set_bulk_insert
+ * @brief Insert a specified number of elements with a single merge
+ * @param self
+ * [in,out] The flat set
+ * @param elements
+ * [in] The elements to be inserted, in any order and possibly with duplicates
+ * @param num
+ * [in] Number of elements
+ *
+ * Elements already present are kept, for duplicates inside of the batch the first one wins.
+ */
+void flat_set_bulk_insert(flat_set* self, const void* elements, unsigned long num);
+/**
+ * @function flat_set_remove
+ * @brief Remove an element, if present
+ * @param self
+ * [in,out] The flat set
+ * @param key
+ * [in] The element to be removed
+ */
+bool flat_set_remove(flat_set* self, const void* key);
+
+/**
+ * @function flat_set_union
+ * @brief Create a new flat set of all elements in `a' or `b' in O(n + m)
+ * @param a
+ * [in] The first flat set
+ * @param b
+ * [in] The second flat set, with the same element size and ordering
+ */
+flat_set flat_set_union(const flat_set* a, const flat_set* b);
+/**
+ * @function flat_set_intersection
+ * @brief Create a new flat set of all elements in both `a' and `b' in O(n + m)
+ * @param a
+ * [in] The first flat set
+ * @param b
+ * [in] The second flat set, with the same element size and ordering
+ */
+flat_set flat_set_intersection(const flat_set* a, const flat_set* b);
+/**
+ * @function flat_set_difference
+ * @brief Create a new flat set of all elements in `a' but not in `b' in O(n + m)
+ * @param a
+ * [in] The first flat set
+ * @param b
+ * [in] The second flat set, with the same element size and ordering
+ */
+flat_set flat_set_difference(const flat_set* a, const flat_set* b);
+
+/**
+ * @function flat_set_cleanup
+ * @brief Free and cleanup the specified flat set
+ * @param self
+ * [in,out] The flat set
+ */
+void flat_set_cleanup(flat_set* self);
+
+/**
+ * @function flat_set_new
+ * @brief Create a new flat set
+ * @param type
+ * [in] Type of the elements
+ * @param cmp
+ * [in] Ordering of the elements
+ */
+#define flat_set_new(type, cmp) __intern_flat_set_new(sizeof(type), cmp)
+
+#endif // !__BLIB_DATASTRUCTURES_FLAT_SET_H__
@@ -0,0 +1,145 @@
+#ifndef __BLIB_DATASTRUCTURES_QUEUES_PRIORITY_H__
+#define __BLIB_DATASTRUCTURES_QUEUES_PRIORITY_H__
+#include <blib/datastructures/arrays/dynamic.h>
+
+/**
+ * @typedef priority_queue_cmp
+ * @brief Ordering of two elements, negative if `a' has to be popped before `b'
+ */
+typedef int (*priority_queue_cmp)(const void* a, const void* b);
+
+/**
+ * @typedef priority_queue_hook
+ * @brief Called every time an element is placed at a new index inside of the heap
+ */
+typedef void (*priority_queue_hook)(const void* element, unsigned long index, void* ctx);
+
+typedef struct {
+  dynamic_arr __storage__; /* Heap ordered elements */
+  unsigned int arity; /* Number of children of every node */
+  priority_queue_cmp cmp; /* Ordering of the elements */
+
+  priority_queue_hook __hook__; /* Handle tracking (see `priority_queue_set_hook()') */
+  void* __hook_ctx__; /* Data passed to the hook */
+
+  uint8_t* __scratch__; /* Buffer holding one element during sifting */
+} priority_queue;
+
+priority_queue __intern_priority_queue_new(unsigned int element_size, unsigned int arity, priority_queue_cmp cmp);
+
+/**
+ * @function priority_queue_from_arr
+ * @brief Turn an existing dynamic array into a priority queue in O(n)
+ * @param arr
+ * [in,out] The dynamic array, owned by the priority queue afterwards
+ * @param arity
+ * [in] Number of children of every node (2 or 4 recommended)
+ * @param cmp
+ * [in] Ordering of the elements
+ */
+priority_queue priority_queue_from_arr(dynamic_arr* arr, unsigned int arity, priority_queue_cmp cmp);
+
+/**
+ * @function priority_queue_set_hook
+ * @brief Set a function to be called whenever an element changes its index
+ * @param self
+ * [in,out] The priority queue
+ * @param hook
+ * [in,opt] The function, or NULL to disable handle tracking
+ * @param ctx
+ * [in,opt] Data passed to the hook
+ */
+void priority_queue_set_hook(priority_queue* self, priority_queue_hook hook, void* ctx);
+
+/**
+ * @function priority_queue_len
+ * @brief Get the number of elements in the priority queue
+ * @param self
+ * [in] The priority queue
+ */
+unsigned long priority_queue_len(const priority_queue* self);
+
+/**
+ * @function priority_queue_push
+ * @brief Add an element to the priority queue
+ * @param self
+ * [in,out] The priority queue
+ * @param element
+ * [in] The element to be added
+ */
+void priority_queue_push(priority_queue* self, const void* element);
+/**
+ * @function priority_queue_bulk_push
+ * @brief Add a specified number of elements to the priority queue
+ * @param self
+ * [in,out] The priority queue
+ * @param elements
+ * [in] The elements to be added
+ * @param num
+ * [in] Number of elements
+ */
+void priority_queue_bulk_push(priority_queue* self, const void* elements, unsigned long num);
+
+/**
+ * @function priority_queue_peek
+ * @brief Read the first element of the priority queue
+ * @param self
+ * [in] The priority queue
+ * @param out
+ * [out] Pointer to write the element to
+ */
+void priority_queue_peek(const priority_queue* self, void* out);
+/**
+ * @function priority_queue_pop
+ * @brief Remove the first element of the priority queue
+ * @param self
+ * [in,out] The priority queue
+ * @param out
+ * [out,opt] Pointer to write the element to
+ */
+void priority_queue_pop(priority_queue* self, void* out);
+
+/**
+ * @function priority_queue_update
+ * @brief Replace the element at the specified heap index (decrease-/increase-key)
+ * @param self
+ * [in,out] The priority queue
+ * @param index
+ * [in] Heap index of the element, as reported by the hook
+ * @param element
+ * [in] The new element
+ */
+void priority_queue_update(priority_queue* self, unsigned long index, const void* element);
+/**
+ * @function priority_queue_remove_at
+ * @brief Remove the element at the specified heap index
+ * @param self
+ * [in,out] The priority queue
+ * @param index
+ * [in] Heap index of the element, as reported by the hook
+ * @param out
+ * [out,opt] Pointer to write the element to
+ */
+void priority_queue_remove_at(priority_queue* self, unsigned long index, void* out);
+
+/**
+ * @function priority_queue_cleanup
+ * @brief Free and cleanup the specified priority queue
+ * @param self
+ * [in,out] The priority queue
+ */
+void priority_queue_cleanup(priority_queue* self);
+
+/**
+ * @function priority_queue_new
+ * @brief Create a new priority queue
+ * @param type
+ * [in] Type of the elements
+ * @param arity
+ * [in] Number of children of every node (2 or 4 recommended)
+ * @param cmp
+ * [in] Ordering of the elements
+ */
+#define priority_queue_new(type, arity, cmp) __intern_priority_queue_new(sizeof(type), arity, cmp)
+
+#endif // !__BLIB_DATASTRUCTURES_QUEUES_PRIORITY_H__
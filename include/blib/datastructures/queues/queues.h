@@ -0,0 +1,5 @@
+#ifndef __BLIB_DATASTRUCTURES_QUEUES_QUEUES_H__
+#define __BLIB_DATASTRUCTURES_QUEUES_QUEUES_H__
+#include "priority.h"
+
+#endif // !__BLIB_DATASTRUCTURES_QUEUES_QUEUES_H__
@@ -0,0 +1,142 @@
+#ifndef __BLIB_DATASTRUCTURES_STRINGS_BUILDER_H__
+#define __BLIB_DATASTRUCTURES_STRINGS_BUILDER_H__
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/memory/alloc.h>
+
+typedef struct {
+  dynamic_arr __storage__; /* Characters of the string, without terminating null byte */
+} string_builder;
+
+/**
+ * @function string_builder_new
+ * @brief Create a new, empty string builder
+ */
+string_builder string_builder_new(void);
+
+/**
+ * @function string_builder_len
+ * @brief Get the length of the built string
+ * @param self
+ * [in] The string builder
+ */
+unsigned long string_builder_len(const string_builder* self);
+
+/**
+ * @function string_builder_reserve
+ * @brief Make sure the specified number of bytes can be appended without reallocating
+ * @param self
+ * [in,out] The string builder
+ * @param num
+ * [in] Number of bytes
+ */
+void string_builder_reserve(string_builder* self, unsigned long num);
+/**
+ * @function string_builder_clear
+ * @brief Empty the string builder, but keep its memory
+ * @param self
+ * [in,out] The string builder
+ */
+void string_builder_clear(string_builder* self);
+
+/**
+ * @function string_builder_append_bytes
+ * @brief Append a specified number of bytes
+ * @param self
+ * [in,out] The string builder
+ * @param bytes
+ * [in] The bytes to be appended
+ * @param num
+ * [in] Number of bytes
+ */
+void string_builder_append_bytes(string_builder* self, const void* bytes, unsigned long num);
+/**
+ * @function string_builder_append_str
+ * @brief Append a null-terminated string
+ * @param self
+ * [in,out] The string builder
+ * @param str
+ * [in] The string to be appended
+ */
+void string_builder_append_str(string_builder* self, const char* str);
+/**
+ * @function string_builder_append_char
+ * @brief Append a single character
+ * @param self
+ * [in,out] The string builder
+ * @param c
+ * [in] The character to be appended
+ */
+void string_builder_append_char(string_builder* self, char c);
+/**
+ * @function string_builder_append_int
+ * @brief Append the decimal representation of a signed integer
+ * @param self
+ * [in,out] The string builder
+ * @param value
+ * [in] The integer
+ */
+void string_builder_append_int(string_builder* self, long long value);
+/**
+ * @function string_builder_append_uint
+ * @brief Append the decimal representation of an unsigned integer
+ * @param self
+ * [in,out] The string builder
+ * @param value
+ * [in] The integer
+ */
+void string_builder_append_uint(string_builder* self, unsigned long long value);
+/**
+ * @function string_builder_append_double
+ * @brief Append a floating point number in fixed notation (like "%.*f")
+ * @param self
+ * [in,out] The string builder
+ * @param value
+ * [in] The number
+ * @param precision
+ * [in] Number of digits after the decimal point
+ *
+ * Up to 9 digits of precision are formatted without printf as long as `value * 10^precision'
+ * stays below 2^52. The output is the same as printf's, the exact value of `value' is rounded
+ * to the nearest, halfway cases to even.
+ */
+void string_builder_append_double(string_builder* self, double value, unsigned int precision);
+/**
+ * @function string_builder_appendf
+ * @brief Append a printf-style formatted string
+ * @param self
+ * [in,out] The string builder
+ * @param fmt
+ * [in] The format string
+ */
+void string_builder_appendf(string_builder* self, const char* fmt, ...);
+
+/**
+ * @function string_builder_cstr
+ * @brief Get a null-terminated view of the built string
+ * @param self
+ * [in,out] The string builder
+ *
+ * The view is invalidated by the next modification of the string builder.
+ */
+const char* string_builder_cstr(string_builder* self);
+/**
+ * @function string_builder_release
+ * @brief Hand the null-terminated string over to the caller and empty the string builder
+ * @param self
+ * [in,out] The string builder
+ * @param len
+ * [out,opt] Length of the string
+ *
+ * The returned string has to be freed with `blib_free()'.
+ */
+char* string_builder_release(string_builder* self, unsigned long* len);
+
+/**
+ * @function string_builder_cleanup
+ * @brief Free and cleanup the specified string builder
+ * @param self
+ * [in,out] The string builder
+ */
+void string_builder_cleanup(string_builder* self);
+
+#endif // !__BLIB_DATASTRUCTURES_STRINGS_BUILDER_H__
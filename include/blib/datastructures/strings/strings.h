@@ -0,0 +1,5 @@
+#ifndef __BLIB_DATASTRUCTURES_STRINGS_STRINGS_H__
+#define __BLIB_DATASTRUCTURES_STRINGS_STRINGS_H__
+#include "builder.h"
+
+#endif // !__BLIB_DATASTRUCTURES_STRINGS_STRINGS_H__
@@ -0,0 +1,128 @@
+#ifndef __BLIB_LOGGING_LOGGER_H__
+#define __BLIB_LOGGING_LOGGER_H__
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * @enum logger_level
+ * @brief Severity of a record
+ * @var logger_level::LOGGER_DEBUG
+ * Details for debugging
+ * @var logger_level::LOGGER_INFO
+ * Progress and results
+ * @var logger_level::LOGGER_WARN
+ * Something unexpected, but handled
+ * @var logger_level::LOGGER_ERR
+ * An operation failed, the writer thread is woken up right away
+ */
+enum logger_level {
+  LOGGER_DEBUG,
+  LOGGER_INFO,
+  LOGGER_WARN,
+  LOGGER_ERR,
+};
+#define LOGGER_LEVELS (LOGGER_ERR + 1)
+
+/**
+ * @enum logger_policy
+ * @brief What a thread does if its ring buffer is full
+ * @var logger_policy::LOGGER_DROP
+ * Drop the record, the writer reports how many were dropped
+ * @var logger_policy::LOGGER_BLOCK
+ * Wait for the writer thread to make space
+ */
+enum logger_policy {
+  LOGGER_DROP,
+  LOGGER_BLOCK,
+};
+
+/* Records below this level are removed at compile time */
+#ifndef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL LOGGER_DEBUG
+#endif
+
+/* Longest message, longer ones are truncated */
+#define LOGGER_MAX_MESSAGE 4096
+
+extern enum logger_level __intern_logger_level;
+void __intern_logger_write(enum logger_level level, FILE* file, const char* prefix, const char* fmt, ...)
+  __attribute__((format(printf, 4, 5)));
+
+/**
+ * @function logger_log_to
+ * @brief Log a printf-style message with a prefix to a file
+ * @param level
+ * [in] Severity of the record
+ * @param file
+ * [in] Where the record is written to, NULL for stdout (debug and info) or stderr
+ * @param prefix
+ * [in] Prefix of the message, NULL for the name of the level
+ *
+ * The format string and the prefix have to be string literals: once the logger is started,
+ * records with integer, floating point, pointer and string (copied) arguments are only
+ * formatted by the writer thread. Every line is "<name>: <prefix> <message>".
+ */
+#define logger_log_to(level, file, prefix, ...)                                         \
+  ((level) >= LOGGER_MIN_LEVEL && (level) >= __atomic_load_n(&__intern_logger_level, __ATOMIC_RELAXED) \
+   ? __intern_logger_write(level, file, prefix, __VA_ARGS__) : (void)0)
+/**
+ * @function logger_log
+ * @brief Log a printf-style message (see `logger_log_to()')
+ * @param level
+ * [in] Severity of the record
+ */
+#define logger_log(level, ...) logger_log_to(level, NULL, NULL, __VA_ARGS__)
+
+#define logger_debug(...) logger_log(LOGGER_DEBUG, __VA_ARGS__)
+#define logger_info(...)  logger_log(LOGGER_INFO,  __VA_ARGS__)
+#define logger_warn(...)  logger_log(LOGGER_WARN,  __VA_ARGS__)
+#define logger_err(...)   logger_log(LOGGER_ERR,   __VA_ARGS__)
+
+/**
+ * @function logger_start
+ * @brief Start the writer thread, records are buffered per thread from now on
+ * @param policy
+ * [in] What a thread does if its ring buffer is full
+ * @param ring_size
+ * [in] Bytes of the ring buffer of every thread, 0 for 64 KiB (rounded up to a power of two of at least 16 KiB)
+ *
+ * Until the logger is started, every record is formatted and written with a single `fwrite()'.
+ * The writer batches the records of all threads into large `write()' calls, so output of stdio
+ * to the same files has to be flushed before logging. `logger_stop()' runs at exit.
+ * Returns false if the logger is already running (EBUSY) or the thread couldn't be created (errno is set).
+ */
+bool logger_start(enum logger_policy policy, unsigned long ring_size);
+/**
+ * @function logger_flush
+ * @brief Wait until the writer wrote every record logged before
+ */
+void logger_flush(void);
+/**
+ * @function logger_stop
+ * @brief Write every remaining record and stop the writer thread
+ *
+ * No other thread may log while the logger stops.
+ */
+void logger_stop(void);
+
+/**
+ * @function logger_set_level
+ * @brief Drop records below a level at runtime
+ * @param level
+ * [in] Lowest level that is logged
+ */
+void logger_set_level(enum logger_level level);
+/**
+ * @function logger_set_name
+ * @brief Set the name every line starts with, like the name of the program
+ * @param name
+ * [in] The name, NULL for none, must outlive the logger
+ */
+void logger_set_name(const char* name);
+/**
+ * @function logger_dropped
+ * @brief Get the number of records dropped because a ring buffer was full
+ */
+unsigned long logger_dropped(void);
+
+#endif // !__BLIB_LOGGING_LOGGER_H__
@@ -0,0 +1,5 @@
+#ifndef __BLIB_LOGGING_LOGGING_H__
+#define __BLIB_LOGGING_LOGGING_H__
+#include "logger.h"
+
+#endif // !__BLIB_LOGGING_LOGGING_H__
@@ -0,0 +1,91 @@
+#ifndef __BLIB_MEMORY_ALLOC_H__
+#define __BLIB_MEMORY_ALLOC_H__
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @struct blib_alloc_stats
+ * @brief Allocations made by blib, counted while tracking is enabled
+ * @var mallocs
+ * Number of allocations
+ * @var reallocs
+ * Number of reallocations
+ * @var frees
+ * Number of freed allocations
+ * @var bytes
+ * Bytes requested by allocations and reallocations
+ * @var live
+ * Bytes currently allocated (usable size)
+ * @var peak
+ * Most bytes allocated at once since the last `blib_alloc_reset_peak()'
+ * @var sized
+ * Are live and peak bytes counted, only if the allocator reports usable sizes (glibc)
+ */
+typedef struct {
+  uint64_t mallocs;
+  uint64_t reallocs;
+  uint64_t frees;
+  uint64_t bytes;
+  int64_t live;
+  int64_t peak;
+  bool sized;
+} blib_alloc_stats;
+
+/**
+ * @function blib_malloc
+ * @brief Allocate memory, as `malloc()'
+ * @param size
+ * [in] Number of bytes
+ */
+void* blib_malloc(size_t size);
+/**
+ * @function blib_realloc
+ * @brief Resize an allocation, as `realloc()'
+ * @param ptr
+ * [in,opt] The allocation
+ * @param size
+ * [in] New number of bytes
+ */
+void* blib_realloc(void* ptr, size_t size);
+/**
+ * @function blib_posix_memalign
+ * @brief Allocate aligned memory, as `posix_memalign()'
+ * @param ptr
+ * [out] Pointer to write the allocation to
+ * @param alignment
+ * [in] Alignment, a power of two multiple of sizeof(void*)
+ * @param size
+ * [in] Number of bytes
+ */
+int blib_posix_memalign(void** ptr, size_t alignment, size_t size);
+/**
+ * @function blib_free
+ * @brief Free an allocation, as `free()'
+ * @param ptr
+ * [in,opt] The allocation
+ */
+void blib_free(void* ptr);
+
+/**
+ * @function blib_alloc_track
+ * @brief Enable or disable counting of the allocations made by blib
+ * @param enable
+ * [in] Count allocations (off by default)
+ *
+ * Live bytes are only accurate for memory allocated and freed while tracking.
+ * Returns whether allocations were counted before, to restore it afterwards.
+ */
+bool blib_alloc_track(bool enable);
+/**
+ * @function blib_alloc_stats_get
+ * @brief Get the allocations counted so far
+ */
+blib_alloc_stats blib_alloc_stats_get(void);
+/**
+ * @function blib_alloc_reset_peak
+ * @brief Start measuring the peak from the currently live bytes
+ */
+void blib_alloc_reset_peak(void);
+
+#endif // !__BLIB_MEMORY_ALLOC_H__
@@ -0,0 +1,162 @@
+#ifndef __BLIB_MEMORY_KERNELS_H__
+#define __BLIB_MEMORY_KERNELS_H__
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @enum kernel_isa
+ * @brief Instruction set the kernels are compiled for
+ * @var kernel_isa::KERNEL_ISA_SCALAR
+ * Portable C, the only variant on other architectures
+ * @var kernel_isa::KERNEL_ISA_SSE2
+ * 16 byte vectors, every x86-64 CPU
+ * @var kernel_isa::KERNEL_ISA_AVX2
+ * 32 byte vectors
+ * @var kernel_isa::KERNEL_ISA_AVX512
+ * 64 byte vectors and mask registers (AVX-512F and AVX-512BW)
+ */
+enum kernel_isa {
+  KERNEL_ISA_SCALAR,
+  KERNEL_ISA_SSE2,
+  KERNEL_ISA_AVX2,
+  KERNEL_ISA_AVX512,
+};
+#define KERNEL_ISAS (KERNEL_ISA_AVX512 + 1)
+
+/* Values of a block of `kernel_unpack()' */
+#define KERNEL_UNPACK_BLOCK 128
+
+/* Environment variable forcing the variant, like BLIB_KERNELS=sse2 */
+#define KERNEL_ISA_ENV "BLIB_KERNELS"
+
+typedef struct {
+  void (*move)(void* dst, const void* src, unsigned long len);
+  void (*fill)(void* dst, const void* pattern, unsigned long size, unsigned long num);
+  void (*swap)(void* a, void* b, unsigned long len);
+  const char* (*find)(const char* p, const char* end, char a, char b);
+  unsigned long (*count)(const char* p, const char* end, char a, char b);
+  void (*unpack)(uint32_t* out, const void* in, unsigned int bits);
+} kernel_table;
+
+/* Kernels of the selected variant, the scalar ones until they are selected at startup */
+extern kernel_table __intern_kernels;
+
+/**
+ * @function kernel_move
+ * @brief Copy bytes between buffers that may overlap, like `memmove()'
+ * @param dst
+ * [out] Destination
+ * @param src
+ * [in] Source
+ * @param len
+ * [in] Number of bytes
+ */
+#define kernel_move(dst, src, len) (__intern_kernels.move(dst, src, len))
+/**
+ * @function kernel_fill
+ * @brief Repeat a pattern, like an element of an array
+ * @param dst
+ * [out] Destination of `size * num' bytes, not overlapping the pattern
+ * @param pattern
+ * [in] The pattern
+ * @param size
+ * [in] Bytes of the pattern
+ * @param num
+ * [in] Number of repetitions
+ */
+#define kernel_fill(dst, pattern, size, num) (__intern_kernels.fill(dst, pattern, size, num))
+/**
+ * @function kernel_swap
+ * @brief Swap the bytes of two buffers that don't overlap
+ * @param a
+ * [in,out] First buffer
+ * @param b
+ * [in,out] Second buffer
+ * @param len
+ * [in] Number of bytes
+ */
+#define kernel_swap(a, b, len) (__intern_kernels.swap(a, b, len))
+/**
+ * @function kernel_find
+ * @brief Find the first of two characters, `end' if there is none
+ * @param p
+ * [in] Start of the text
+ * @param end
+ * [in] End of the text
+ * @param a
+ * [in] First character
+ * @param b
+ * [in] Second character, can be the same as `a'
+ */
+#define kernel_find(p, end, a, b) (__intern_kernels.find(p, end, a, b))
+/**
+ * @function kernel_count
+ * @brief Count the occurrences of two characters
+ * @param p
+ * [in] Start of the text
+ * @param end
+ * [in] End of the text
+ * @param a
+ * [in] First character
+ * @param b
+ * [in] Second character, counted once if it is the same as `a'
+ */
+#define kernel_count(p, end, a, b) (__intern_kernels.count(p, end, a, b))
+/**
+ * @function kernel_unpack
+ * @brief Unpack a block of KERNEL_UNPACK_BLOCK integers of `bits' bits each
+ * @param out
+ * [out] KERNEL_UNPACK_BLOCK integers
+ * @param in
+ * [in] `bits * 4' 32-bit words, packed by `kernel_pack()'
+ * @param bits
+ * [in] Bits per integer, up to 32
+ */
+#define kernel_unpack(out, in, bits) (__intern_kernels.unpack(out, in, bits))
+/**
+ * @function kernel_pack
+ * @brief Pack a block of KERNEL_UNPACK_BLOCK integers into `bits' bits each
+ * @param out
+ * [out] `bits * 4' 32-bit words
+ * @param in
+ * [in] KERNEL_UNPACK_BLOCK integers, each below 2^`bits'
+ * @param bits
+ * [in] Bits per integer, up to 32
+ *
+ * Integer `i' is stored in lane `i % 4': word `w' of the block holds bits 32 * (w / 4) and
+ * up of the lane `w % 4', so 16 byte vectors unpack four integers at once whatever the width.
+ */
+void kernel_pack(uint32_t* out, const uint32_t* in, unsigned int bits);
+
+/**
+ * @function kernel_isa_supported
+ * @brief Get the widest variant the CPU and the operating system support
+ */
+enum kernel_isa kernel_isa_supported(void);
+/**
+ * @function kernel_isa_selected
+ * @brief Get the variant the kernels are running
+ *
+ * At startup the widest supported variant is selected, unless KERNEL_ISA_ENV names another
+ * one (scalar, sse2, avx2 or avx512). Naming an unknown or unsupported variant aborts.
+ */
+enum kernel_isa kernel_isa_selected(void);
+/**
+ * @function kernel_isa_select
+ * @brief Switch the kernels to another variant, to compare them
+ * @param isa
+ * [in] The variant
+ *
+ * Must not race with kernels running on other threads.
+ * Returns false if the variant isn't supported (ENOTSUP).
+ */
+bool kernel_isa_select(enum kernel_isa isa);
+/**
+ * @function kernel_isa_str
+ * @brief Get the name of a variant, as used by KERNEL_ISA_ENV
+ * @param isa
+ * [in] The variant
+ */
+const char* kernel_isa_str(enum kernel_isa isa);
+
+#endif // !__BLIB_MEMORY_KERNELS_H__
@@ -0,0 +1,7 @@
+#ifndef __BLIB_MEMORY_MEMORY_H__
+#define __BLIB_MEMORY_MEMORY_H__
+#include "alloc.h"
+#include "kernels.h"
+#include "pool.h"
+
+#endif // !__BLIB_MEMORY_MEMORY_H__
@@ -0,0 +1,151 @@
+#ifndef __BLIB_MEMORY_POOL_H__
+#define __BLIB_MEMORY_POOL_H__
+#include <stdbool.h>
+
+/* Threads with a magazine of their own, other threads share the locked depot */
+#define POOL_MAX_THREADS 64
+/* Objects a thread keeps for itself */
+#define POOL_MAGAZINE 64
+
+typedef struct {
+  unsigned long count; /* Cached objects */
+  unsigned long allocs; /* Objects allocated by the thread */
+  unsigned long frees; /* Objects freed by the thread */
+  void* objects[POOL_MAGAZINE];
+} pool_magazine;
+
+typedef struct {
+  unsigned int element_size; /* Size of the objects */
+  unsigned int __stride__; /* Bytes between objects, aligned */
+  unsigned long __slab_size__; /* Bytes of a slab, multiple of the page size */
+  unsigned long __per_slab__; /* Objects of a slab */
+
+  bool __lock__; /* Spinlock of the depot, the fields up to the magazines */
+  void* __free__; /* Intrusive list of freed objects */
+  void* __slabs__; /* First slab, linked in allocation order */
+  void* __cursor__; /* Slab new objects are carved from */
+  unsigned long __carved__; /* Objects carved from the cursor */
+  unsigned long __slab_count__; /* Number of slabs */
+  unsigned long __shared_allocs__; /* Objects allocated through the depot by threads without magazine */
+  unsigned long __shared_frees__; /* Objects freed through the depot by threads without magazine */
+
+  pool_magazine* __magazines__[POOL_MAX_THREADS]; /* Per-thread caches, allocated on first use */
+} pool;
+
+/**
+ * @struct pool_stats
+ * @brief Occupancy of a pool
+ * @var slabs
+ * Number of slabs
+ * @var bytes
+ * Bytes of all slabs
+ * @var capacity
+ * Objects fitting into the slabs
+ * @var live
+ * Objects allocated and not freed
+ * @var cached
+ * Free objects in the magazines of threads
+ */
+typedef struct {
+  unsigned long slabs;
+  unsigned long bytes;
+  unsigned long capacity;
+  unsigned long live;
+  unsigned long cached;
+} pool_stats;
+
+pool __intern_pool_new(unsigned int element_size);
+/**
+ * @function pool_new
+ * @brief Create a pool of objects of a type
+ * @param type
+ * [in] Type of the objects
+ *
+ * Objects are carved from slabs of at least a page, aligned to 16 bytes if the size is a
+ * multiple of 16 and to the size of a pointer otherwise.
+ */
+#define pool_new(type) (__intern_pool_new(sizeof(type)))
+/**
+ * @function pool_new_sized
+ * @brief Create a pool of objects of a size (see `pool_new()')
+ * @param element_size
+ * [in] Bytes of an object
+ */
+#define pool_new_sized(element_size) (__intern_pool_new(element_size))
+
+/**
+ * @function pool_alloc
+ * @brief Allocate an object
+ * @param self
+ * [in,out] The pool
+ *
+ * Served from the magazine of the thread without locking, which is refilled from the
+ * depot half at a time. Returns NULL if no slab could be allocated.
+ */
+void* pool_alloc(pool* self);
+/**
+ * @function pool_free
+ * @brief Free an object of the pool, on any thread
+ * @param self
+ * [in,out] The pool
+ * @param object
+ * [in,opt] The object
+ */
+void pool_free(pool* self, void* object);
+
+/**
+ * @function pool_alloc_bulk
+ * @brief Allocate several objects at once
+ * @param self
+ * [in,out] The pool
+ * @param objects
+ * [out] At least `num' objects
+ * @param num
+ * [in] Number of objects
+ *
+ * Takes the depot lock at most once. Returns the number of objects allocated, fewer than
+ * `num' only if no slab could be allocated.
+ */
+unsigned long pool_alloc_bulk(pool* self, void** objects, unsigned long num);
+/**
+ * @function pool_free_bulk
+ * @brief Free several objects at once
+ * @param self
+ * [in,out] The pool
+ * @param objects
+ * [in] The objects
+ * @param num
+ * [in] Number of objects
+ */
+void pool_free_bulk(pool* self, void* const* objects, unsigned long num);
+
+/**
+ * @function pool_reset
+ * @brief Free every object at once, keeping the slabs for new objects
+ * @param self
+ * [in,out] The pool
+ *
+ * No other thread may use the pool while it is reset.
+ */
+void pool_reset(pool* self);
+/**
+ * @function pool_stats_get
+ * @brief Get the occupancy of a pool
+ * @param self
+ * [in] The pool
+ *
+ * Exact while no other thread uses the pool.
+ */
+pool_stats pool_stats_get(pool* self);
+
+/**
+ * @function pool_cleanup
+ * @brief Free the slabs of a pool, invalidating every object
+ * @param self
+ * [in,out] The pool
+ *
+ * No other thread may use the pool while it is cleaned up.
+ */
+void pool_cleanup(pool* self);
+
+#endif // !__BLIB_MEMORY_POOL_H__
@@ -0,0 +1,146 @@
+#ifndef __BLIB_PARSING_ARGUMENTS_ARGS_H__
+#define __BLIB_PARSING_ARGUMENTS_ARGS_H__
+#include <stdbool.h>
+
+/* Most options of a parser */
+#define ARGS_MAX_OPTIONS 128
+/* Largest table of long options, twice the options rounded up to a power of two */
+#define ARGS_MAX_TABLE   (2 * ARGS_MAX_OPTIONS)
+
+/**
+ * @enum args_type
+ * @brief Type of the value of an option, and what `value' of the option points to
+ * @var args_type::ARGS_FLAG
+ * Takes no value, sets a `bool' to true
+ * @var args_type::ARGS_INT
+ * Integer in decimal, hexadecimal (0x) or octal (0), stored in a `long'
+ * @var args_type::ARGS_FLOAT
+ * Floating point number, stored in a `double'
+ * @var args_type::ARGS_STRING
+ * Any string, a `const char*' pointing into the arguments
+ * @var args_type::ARGS_ENUM
+ * One of the `choices' of the option, its index is stored in an `unsigned int'
+ */
+enum args_type {
+  ARGS_FLAG,
+  ARGS_INT,
+  ARGS_FLOAT,
+  ARGS_STRING,
+  ARGS_ENUM,
+};
+
+/**
+ * @enum args_error
+ * @brief Result of parsing the arguments
+ * @var args_error::ARGS_OK
+ * Every argument was parsed
+ * @var args_error::ARGS_UNKNOWN
+ * No option of that name
+ * @var args_error::ARGS_MISSING_VALUE
+ * The option takes a value, but it was the last argument
+ * @var args_error::ARGS_INVALID_VALUE
+ * The value isn't a number in range or one of the choices
+ * @var args_error::ARGS_UNEXPECTED_VALUE
+ * A flag was given a value with `--flag=value'
+ */
+enum args_error {
+  ARGS_OK,
+  ARGS_UNKNOWN,
+  ARGS_MISSING_VALUE,
+  ARGS_INVALID_VALUE,
+  ARGS_UNEXPECTED_VALUE,
+};
+#define ARGS_ERRORS (ARGS_UNEXPECTED_VALUE + 1)
+
+/**
+ * @struct args_option
+ * @brief An entry of the option table
+ * @var short_name
+ * Name of `-x', 0 if the option has none
+ * @var long_name
+ * Name of `--name', NULL if the option has none
+ * @var type
+ * Type of the value
+ * @var value
+ * Where the value is stored (see `args_type')
+ * @var choices
+ * NULL-terminated names of the values of `ARGS_ENUM' options
+ */
+typedef struct {
+  char short_name;
+  const char* long_name;
+  enum args_type type;
+  void* value;
+  const char* const* choices;
+} args_option;
+
+typedef struct {
+  const args_option* options; /* Option table, not copied */
+  unsigned int num; /* Number of options */
+
+  unsigned int __mask__; /* Size of `__table__' - 1 */
+  unsigned int __buckets__; /* Number of displacements - 1 */
+  unsigned char __short__[128]; /* Option index + 1 of every ASCII short name */
+  unsigned char __displace__[ARGS_MAX_OPTIONS]; /* Seed of every bucket of the perfect hash */
+  unsigned char __table__[ARGS_MAX_TABLE]; /* Option index + 1 of every slot of the perfect hash */
+} args_parser;
+
+/**
+ * @struct args_result
+ * @brief Outcome of `args_parse()'
+ * @var error
+ * ARGS_OK, or the first error
+ * @var positionals
+ * Number of positional arguments, moved to `av[1]' ... `av[positionals]'
+ * @var index
+ * Index of the argument of the error
+ * @var option
+ * Option of the error, NULL for `ARGS_UNKNOWN'
+ */
+typedef struct {
+  enum args_error error;
+  int positionals;
+  int index;
+  const args_option* option;
+} args_result;
+
+/**
+ * @function args_parser_new
+ * @brief Build the lookup tables of an option table
+ * @param options
+ * [in] The options, must outlive the parser
+ * @param num
+ * [in] Number of options, at most ARGS_MAX_OPTIONS
+ *
+ * Long names are looked up through a perfect hash (hash and displace), short names through
+ * a table of the ASCII characters, so every lookup compares at most one name.
+ * Nothing is allocated, the parser can live on the stack. Aborts on duplicate names.
+ */
+args_parser args_parser_new(const args_option* options, unsigned int num);
+
+/**
+ * @function args_parse
+ * @brief Parse the arguments of `main()' in place
+ * @param self
+ * [in] The parser
+ * @param ac
+ * [in] Number of arguments, including the program name
+ * @param av
+ * [in,out] The arguments, positional arguments are moved to the front
+ *
+ * Accepts `-x value', `-xvalue', clusters of flags (`-abc', `-abx value'), `--name value',
+ * `--name=value' and treats every argument after `--' as positional, like `-' on its own.
+ * Values are stored while parsing, so options before an error are already set.
+ * Nothing is allocated, strings point into `av'.
+ */
+args_result args_parse(const args_parser* self, int ac, const char** av);
+
+/**
+ * @function args_error_str
+ * @brief Describe an error of `args_parse()'
+ * @param error
+ * [in] The error
+ */
+const char* args_error_str(enum args_error error);
+
+#endif // !__BLIB_PARSING_ARGUMENTS_ARGS_H__
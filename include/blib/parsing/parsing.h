@@ -0,0 +1,7 @@
+#ifndef __BLIB_PARSING_PARSING_H__
+#define __BLIB_PARSING_PARSING_H__
+#include "arguments/args.h"
+#include "text/numbers.h"
+#include "text/splitter.h"
+
+#endif // !__BLIB_PARSING_PARSING_H__
@@ -0,0 +1,137 @@
+#ifndef __BLIB_PARSING_TEXT_NUMBERS_H__
+#define __BLIB_PARSING_TEXT_NUMBERS_H__
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/parsing/text/splitter.h>
+
+#include <stdint.h>
+
+/**
+ * @enum number_error
+ * @brief Result of parsing a number
+ * @var number_error::NUMBER_OK
+ * The field is a number
+ * @var number_error::NUMBER_EMPTY
+ * The field is empty or only blanks
+ * @var number_error::NUMBER_INVALID
+ * The field isn't a number, or has characters after it
+ * @var number_error::NUMBER_RANGE
+ * The number doesn't fit the type
+ */
+enum number_error {
+  NUMBER_OK,
+  NUMBER_EMPTY,
+  NUMBER_INVALID,
+  NUMBER_RANGE,
+};
+#define NUMBER_ERRORS (NUMBER_RANGE + 1)
+
+/**
+ * @struct number_field_error
+ * @brief A field of a bulk parse that isn't a number
+ * @var index
+ * Index of the field, and of its value (0) in the values
+ * @var offset
+ * Offset of the field in the text
+ * @var error
+ * Why the field was rejected
+ */
+typedef struct {
+  unsigned long index;
+  unsigned long offset;
+  enum number_error error;
+} number_field_error;
+
+/**
+ * @function number_parse_i64
+ * @brief Parse a decimal integer
+ * @param start
+ * [in] The text, not null-terminated
+ * @param len
+ * [in] Length of the text
+ * @param value
+ * [out] The integer, unchanged on errors
+ *
+ * Accepts blanks (spaces, tabs, carriage returns) around an optional sign and the digits.
+ * Independent of the locale, eight digits are converted at a time.
+ */
+enum number_error number_parse_i64(const char* start, unsigned long len, int64_t* value);
+/**
+ * @function number_parse_i32
+ * @brief Parse a decimal integer (see `number_parse_i64()')
+ * @param start
+ * [in] The text, not null-terminated
+ * @param len
+ * [in] Length of the text
+ * @param value
+ * [out] The integer, unchanged on errors
+ */
+enum number_error number_parse_i32(const char* start, unsigned long len, int32_t* value);
+/**
+ * @function number_parse_f64
+ * @brief Parse a decimal floating point number, correctly rounded
+ * @param start
+ * [in] The text, not null-terminated
+ * @param len
+ * [in] Length of the text
+ * @param value
+ * [out] The number, unchanged on errors
+ *
+ * Accepts blanks around `[+-]digits[.digits][(e|E)[+-]digits]', `inf', `infinity' and `nan'.
+ * Up to 19 significant digits with a small exponent are converted exactly with one
+ * multiplication or division, other numbers through `strtod()' with the '.' of the C locale.
+ * Numbers too large for a double are NUMBER_RANGE, too small ones round to zero.
+ */
+enum number_error number_parse_f64(const char* start, unsigned long len, double* value);
+
+/**
+ * @function number_parse_i64_arr
+ * @brief Append every field of delimited integers to a dynamic array of `int64_t'
+ * @param text
+ * [in] Fields separated by `delimiter' or newlines, a final newline ends the last field
+ * @param delimiter
+ * [in] Separator of the fields
+ * @param values
+ * [in,out] Dynamic array of `int64_t'
+ * @param errors
+ * [in,out] Dynamic array of `number_field_error' the rejected fields are appended to, or NULL
+ *
+ * Capacity for every field is reserved up front, rejected fields are appended as 0.
+ * Returns the number of fields.
+ */
+unsigned long number_parse_i64_arr(const text_span* text, char delimiter, dynamic_arr* values, dynamic_arr* errors);
+/**
+ * @function number_parse_i32_arr
+ * @brief Append every field of delimited integers to a dynamic array of `int32_t' (see `number_parse_i64_arr()')
+ * @param text
+ * [in] Fields separated by `delimiter' or newlines
+ * @param delimiter
+ * [in] Separator of the fields
+ * @param values
+ * [in,out] Dynamic array of `int32_t'
+ * @param errors
+ * [in,out] Dynamic array of `number_field_error', or NULL
+ */
+unsigned long number_parse_i32_arr(const text_span* text, char delimiter, dynamic_arr* values, dynamic_arr* errors);
+/**
+ * @function number_parse_f64_arr
+ * @brief Append every field of delimited numbers to a dynamic array of `double' (see `number_parse_i64_arr()')
+ * @param text
+ * [in] Fields separated by `delimiter' or newlines
+ * @param delimiter
+ * [in] Separator of the fields
+ * @param values
+ * [in,out] Dynamic array of `double'
+ * @param errors
+ * [in,out] Dynamic array of `number_field_error', or NULL
+ */
+unsigned long number_parse_f64_arr(const text_span* text, char delimiter, dynamic_arr* values, dynamic_arr* errors);
+
+/**
+ * @function number_error_str
+ * @brief Describe an error of the number parsers
+ * @param error
+ * [in] The error
+ */
+const char* number_error_str(enum number_error error);
+
+#endif // !__BLIB_PARSING_TEXT_NUMBERS_H__
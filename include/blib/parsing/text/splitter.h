@@ -0,0 +1,128 @@
+#ifndef __BLIB_PARSING_TEXT_SPLITTER_H__
+#define __BLIB_PARSING_TEXT_SPLITTER_H__
+#include <blib/datastructures/arrays/dynamic.h>
+
+#include <stdbool.h>
+
+/**
+ * @struct text_span
+ * @brief A line or field, pointing into the text of the splitter
+ * @var start
+ * First character, not null-terminated
+ * @var len
+ * Number of characters
+ * @var quoted
+ * The field was quoted, `start' is after the opening quote and doubled quotes are
+ * still doubled (see `text_span_unescape()')
+ */
+typedef struct {
+  const char* start;
+  unsigned long len;
+  bool quoted;
+} text_span;
+
+typedef struct {
+  const char* __pos__; /* Start of the next line */
+  const char* __end__; /* End of the text of the splitter */
+  char delimiter; /* Separator of the fields */
+  char quote; /* Quote of fields containing delimiters or newlines, 0 to disable quoting */
+
+  void* __map__; /* Mapping of `text_splitter_map()', NULL if the text isn't owned */
+  unsigned long __map_len__; /* Size of the mapping */
+} text_splitter;
+
+/**
+ * @function text_splitter_new
+ * @brief Create a splitter of a buffer
+ * @param data
+ * [in] The text, must outlive the splitter and its spans
+ * @param len
+ * [in] Length of the text
+ * @param delimiter
+ * [in] Separator of the fields
+ * @param quote
+ * [in] Quote of fields (like '"'), 0 to disable quoting
+ */
+text_splitter text_splitter_new(const char* data, unsigned long len, char delimiter, char quote);
+/**
+ * @function text_splitter_map
+ * @brief Create a splitter of a memory-mapped file
+ * @param self
+ * [out] The splitter
+ * @param path
+ * [in] Path of the file
+ * @param delimiter
+ * [in] Separator of the fields
+ * @param quote
+ * [in] Quote of fields (like '"'), 0 to disable quoting
+ *
+ * The mapping is read-only and advised to be read sequentially, spans stay valid
+ * until `text_splitter_cleanup()'. Returns false if the file couldn't be mapped (errno is set).
+ */
+bool text_splitter_map(text_splitter* self, const char* path, char delimiter, char quote);
+
+/**
+ * @function text_splitter_next_line
+ * @brief Get the next line, without its line feed (and carriage return)
+ * @param self
+ * [in,out] The splitter
+ * @param line
+ * [out] The line
+ *
+ * Newlines inside quoted fields don't end the line. Returns false at the end of the text.
+ */
+bool text_splitter_next_line(text_splitter* self, text_span* line);
+/**
+ * @function text_splitter_split
+ * @brief Append the fields of a line to a dynamic array of `text_span'
+ * @param self
+ * [in] The splitter
+ * @param line
+ * [in] Line of `text_splitter_next_line()'
+ * @param fields
+ * [in,out] Dynamic array of `text_span'
+ *
+ * An empty line has one empty field, characters between a closing quote and the
+ * next delimiter are dropped. Returns the number of fields.
+ */
+unsigned long text_splitter_split(const text_splitter* self, const text_span* line, dynamic_arr* fields);
+
+/**
+ * @function text_splitter_chunks
+ * @brief Split the remaining text into splitters of about the same size, to be used in parallel
+ * @param self
+ * [in] The splitter
+ * @param chunks
+ * [out] At least `num' splitters, they don't own the text
+ * @param num
+ * [in] Most chunks
+ *
+ * Chunks start at the beginning of a line. With quoting enabled, the text up to the
+ * last chunk is read once to find the newlines outside of quotes.
+ * Returns the number of chunks, fewer than `num' if the text has fewer lines.
+ */
+unsigned long text_splitter_chunks(const text_splitter* self, text_splitter* chunks, unsigned long num);
+
+/**
+ * @function text_span_unescape
+ * @brief Copy a field, replacing doubled quotes of quoted fields with single quotes
+ * @param span
+ * [in] The field
+ * @param quote
+ * [in] Quote of the splitter
+ * @param out
+ * [out] Buffer of at least `span->len' characters, not null-terminated
+ *
+ * Returns the number of characters written.
+ */
+unsigned long text_span_unescape(const text_span* span, char quote, char* out);
+
+/**
+ * @function text_splitter_cleanup
+ * @brief Unmap the file of `text_splitter_map()', invalidating every span
+ * @param self
+ * [in,out] The splitter
+ */
+void text_splitter_cleanup(text_splitter* self);
+
+#endif // !__BLIB_PARSING_TEXT_SPLITTER_H__
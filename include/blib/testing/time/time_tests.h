@@ -1,7 +1,11 @@
 #ifndef __BLIB_TESTING_TIME_TIME_TESTS_H__
 #define __BLIB_TESTING_TIME_TIME_TESTS_H__
-#include <time.h>
+#include <blib/concurrency/scheduler.h>
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/memory/alloc.h>
+#include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 /**
  * @enum TIMETEST_STATE
@@ -22,23 +26,79 @@ enum TIMETEST_STATE {
   TEST_SKIPPED,
 };
 
+/**
+ * @enum time_clock_source
+ * @brief Clock used to measure time tests
+ * @var time_clock_source::TIME_CLOCK_MONOTONIC_RAW
+ * Wall-clock time in nanoseconds, not affected by NTP adjustments
+ * @var time_clock_source::TIME_CLOCK_THREAD_CPU
+ * CPU time of the calling thread in nanoseconds
+ * @var time_clock_source::TIME_CLOCK_PROCESS_CPU
+ * CPU time of the process through `clock()'
+ * @var time_clock_source::TIME_CLOCK_TSC
+ * Serialized `rdtsc'/`rdtscp' cycles, converted to nanoseconds by calibration (x86 only)
+ */
+enum time_clock_source {
+  TIME_CLOCK_MONOTONIC_RAW,
+  TIME_CLOCK_THREAD_CPU,
+  TIME_CLOCK_PROCESS_CPU,
+  TIME_CLOCK_TSC,
+};
+
+/**
+ * @function time_clock_select
+ * @brief Select the clock used by `time_test_start()' and `time_test_end()'
+ * @param source
+ * [in] The clock source, falls back to TIME_CLOCK_MONOTONIC_RAW if unavailable
+ */
+void time_clock_select(enum time_clock_source source);
+/**
+ * @function time_clock_selected
+ * @brief Get the clock currently used by time tests
+ */
+enum time_clock_source time_clock_selected(void);
+/**
+ * @function time_clock_available
+ * @brief Check whether a clock source can be used on this machine
+ * @param source
+ * [in] The clock source
+ */
+bool time_clock_available(enum time_clock_source source);
+/**
+ * @function time_clock_name
+ * @brief Get a printable name of a clock source
+ * @param source
+ * [in] The clock source
+ */
+const char* time_clock_name(enum time_clock_source source);
+/**
+ * @function time_clock_overhead
+ * @brief Get the measured overhead of a start/end pair of a clock source in nanoseconds
+ * @param source
+ * [in] The clock source
+ */
+uint64_t time_clock_overhead(enum time_clock_source source);
+
 /**
  * @struct time_test
  * @brief A single measurement of time
  * @var time_test::caption
  * The title of the measurement
  * @var time_test::start
- * Time of the start of the measurement
+ * Raw reading of the clock at the start of the measurement
  * @var time_test::end
- * Time of the end of the measurement
+ * Raw reading of the clock at the end of the measurement
  * @var time_test::taken
- * Time delay between start and end
+ * Nanoseconds between start and end, without the overhead of the clock
+ * @var time_test::ops
+ * Number of operations measured, to report results per operation (0 counts as 1)
  */
 typedef struct {
   const char* caption;
-  clock_t start;
-  clock_t end;
-  clock_t taken;
+  uint64_t start;
+  uint64_t end;
+  uint64_t taken;
+  unsigned long ops;
 
   enum TIMETEST_STATE state;
 } time_test;
@@ -90,6 +150,26 @@ enum time_testrun_features {
  * Enable checking return of the tests
  * @var time_testrun_template::enable_time_tracking
  * Enable time measurement of the tests 
+ * @var time_testrun_template::clock
+ * Clock used to measure the tests (see `time_testrun_set_clock()')
+ * @var time_testrun_template::warmup
+ * Number of unrecorded tests run before the measurement (see `time_testrun_set_warmup()')
+ * @var time_testrun_template::batchfunc
+ * Function looping over the test body, replaces `testfunc' (see `time_testrun_new_batched()')
+ * @var time_testrun_template::target_ns
+ * Duration every batched sample is grown to (see `time_testrun_set_target()')
+ * @var time_testrun_template::bytes_per_iteration
+ * Bytes processed by one iteration, for throughput reports (see `time_testrun_set_bytes()')
+ * @var time_testrun_template::threads
+ * Number of threads running the tests concurrently (see `time_testrun_set_threads()')
+ * @var time_testrun_template::pin
+ * Pin every thread to its own CPU
+ * @var time_testrun_template::counters
+ * Capture hardware performance counters (see `time_testrun_set_counters()')
+ * @var time_testrun_template::memory
+ * Track allocations and the resident set (see `time_testrun_set_memory()')
+ * @var time_testrun_template::scheduler
+ * Scheduler whose counters are captured, NULL for none (see `time_testrun_set_scheduler()')
  */
 typedef struct {
   const char* caption;
@@ -99,6 +179,21 @@ typedef struct {
 
   bool enable_test_check;
   bool enable_time_tracking;
+
+  enum time_clock_source clock;
+  unsigned long warmup;
+
+  enum TIMETEST_STATE (*batchfunc)(unsigned long iterations, void* data);
+  uint64_t target_ns;
+  unsigned long bytes_per_iteration;
+
+  unsigned int threads;
+  bool pin;
+
+  bool counters;
+  bool memory;
+
+  const scheduler* scheduler;
 } time_testrun_template;
 
 /**
@@ -117,6 +212,288 @@ typedef struct {
  */
 time_testrun_template time_testrun_new(const char* caption, unsigned long testnumber, time_test (*testfunc)(unsigned int index, void* data), void* data, unsigned int features);
 
+/**
+ * @function time_testrun_new_batched
+ * @brief Create a new testrun, whose test body loops over a harness-provided iteration count
+ * @param caption
+ * [in,opt] Name of the testrun
+ * @param samples
+ * [in] number of samples
+ * @param batchfunc
+ * [in] Function running the test body `iterations' times
+ * @param data
+ * [in,opt] Data passed to the test function
+ * @param features
+ * [in] Features of the testrun (see `time_testrun_features')
+ *
+ * The iteration count is grown until a sample takes at least the target duration,
+ * results are reported per iteration.
+ */
+time_testrun_template time_testrun_new_batched(const char* caption, unsigned long samples, enum TIMETEST_STATE (*batchfunc)(unsigned long iterations, void* data), void* data, unsigned int features);
+
+/**
+ * @function time_testrun_set_target
+ * @brief Set the duration every sample of a batched testrun is grown to
+ * @param template
+ * [in,out] Testrun template created by `time_testrun_new_batched()'
+ * @param target_ns
+ * [in] Duration in nanoseconds (1ms by default)
+ */
+void time_testrun_set_target(time_testrun_template* template, uint64_t target_ns);
+/**
+ * @function time_testrun_set_bytes
+ * @brief Set the number of bytes processed by one iteration, to report bytes/s
+ * @param template
+ * [in,out] Testrun template
+ * @param bytes
+ * [in] Bytes per iteration
+ */
+void time_testrun_set_bytes(time_testrun_template* template, unsigned long bytes);
+
+/**
+ * @function time_testrun_set_threads
+ * @brief Run the tests concurrently on a number of threads
+ * @param template
+ * [in,out] Testrun template
+ * @param threads
+ * [in] Number of threads, 0 runs the tests on the calling thread (default)
+ * @param pin
+ * [in] Pin every thread to its own CPU with `sched_setaffinity()'
+ *
+ * The threads are released together after their warmup, every thread runs its own range of indexes.
+ * The test data is shared between the threads.
+ */
+void time_testrun_set_threads(time_testrun_template* template, unsigned int threads, bool pin);
+/**
+ * @function time_testrun_thread
+ * @brief Get the index of the thread calling the test function, to keep per-thread state
+ *
+ * Returns 0 outside of threaded testruns.
+ */
+unsigned int time_testrun_thread(void);
+
+/**
+ * @function time_testrun_set_counters
+ * @brief Capture hardware performance counters around every test
+ * @param template
+ * [in,out] Testrun template
+ * @param enable
+ * [in] Capture counters (off by default)
+ *
+ * Counters are read with `perf_event_open()', if they can't be opened the testrun still runs
+ * and reports why they are unavailable.
+ */
+void time_testrun_set_counters(time_testrun_template* template, bool enable);
+
+/**
+ * @function time_testrun_set_memory
+ * @brief Track the allocations made by blib and the resident set size during the tests
+ * @param template
+ * [in,out] Testrun template
+ * @param enable
+ * [in] Track memory (off by default)
+ *
+ * Only allocations made through blib (see `blib_malloc()') are counted, warmup and calibration are excluded.
+ */
+void time_testrun_set_memory(time_testrun_template* template, bool enable);
+
+/**
+ * @function time_testrun_set_scheduler
+ * @brief Capture the counters of the workers of a scheduler the tests run their tasks on
+ * @param template
+ * [in,out] Testrun template
+ * @param scheduler
+ * [in,opt] A started scheduler, NULL to stop capturing (default)
+ *
+ * Tasks, steals and idle time are reported per worker, warmup and calibration are excluded.
+ */
+void time_testrun_set_scheduler(time_testrun_template* template, const scheduler* scheduler);
+
+/**
+ * @function time_do_not_optimize
+ * @brief Keep the compiler from optimizing away the computation of a value
+ */
+#define time_do_not_optimize(value) __asm__ __volatile__("" : : "g"(value) : "memory")
+/**
+ * @function time_clobber_memory
+ * @brief Keep the compiler from optimizing away writes to memory
+ */
+#define time_clobber_memory() __asm__ __volatile__("" : : : "memory")
+
+/**
+ * @function time_testrun_set_clock
+ * @brief Select the clock used to measure the tests of a testrun
+ * @param template
+ * [in,out] Testrun template created by `time_testrun_new()'
+ * @param source
+ * [in] The clock source (TIME_CLOCK_MONOTONIC_RAW by default)
+ */
+void time_testrun_set_clock(time_testrun_template* template, enum time_clock_source source);
+/**
+ * @function time_testrun_set_warmup
+ * @brief Run a number of unrecorded tests before the measurement, to warm up caches and branch predictors
+ * @param template
+ * [in,out] Testrun template created by `time_testrun_new()'
+ * @param warmup
+ * [in] Number of warmup tests
+ */
+void time_testrun_set_warmup(time_testrun_template* template, unsigned long warmup);
+
+/**
+ * @struct time_stats
+ * @brief Statistics over a number of samples, all in nanoseconds
+ * @var min
+ * Smallest sample
+ * @var max
+ * Largest sample
+ * @var mean
+ * Arithmetic mean
+ * @var stddev
+ * Sample standard deviation
+ * @var median
+ * 50th percentile
+ * @var p90
+ * 90th percentile
+ * @var p99
+ * 99th percentile
+ * @var p999
+ * 99.9th percentile
+ * @var mad
+ * Median absolute deviation
+ * @var ci_low
+ * Lower bound of the 95% confidence interval of the mean
+ * @var ci_high
+ * Upper bound of the 95% confidence interval of the mean
+ * @var outliers
+ * Number of samples further than 3 scaled MADs from the median
+ */
+typedef struct {
+  double min;
+  double max;
+  double mean;
+  double stddev;
+
+  double median;
+  double p90;
+  double p99;
+  double p999;
+
+  double mad;
+  double ci_low;
+  double ci_high;
+  unsigned long outliers;
+} time_stats;
+
+/**
+ * @enum time_counter
+ * @brief Hardware performance counters captured around tests
+ * @var time_counter::TIME_COUNTER_CYCLES
+ * CPU cycles
+ * @var time_counter::TIME_COUNTER_INSTRUCTIONS
+ * Retired instructions
+ * @var time_counter::TIME_COUNTER_L1D_MISSES
+ * L1 data cache read misses
+ * @var time_counter::TIME_COUNTER_LLC_MISSES
+ * Last level cache misses
+ * @var time_counter::TIME_COUNTER_BRANCH_MISSES
+ * Mispredicted branches
+ * @var time_counter::TIME_COUNTER_PAGE_FAULTS
+ * Page faults
+ */
+enum time_counter {
+  TIME_COUNTER_CYCLES,
+  TIME_COUNTER_INSTRUCTIONS,
+  TIME_COUNTER_L1D_MISSES,
+  TIME_COUNTER_LLC_MISSES,
+  TIME_COUNTER_BRANCH_MISSES,
+  TIME_COUNTER_PAGE_FAULTS,
+};
+#define TIME_COUNTERS (TIME_COUNTER_PAGE_FAULTS + 1)
+
+/**
+ * @struct time_counters
+ * @brief Hardware performance counters of a testrun
+ * @var enabled
+ * Were counters requested
+ * @var error
+ * Why the counters are unavailable (an errno value), 0 if they were captured
+ * @var available
+ * Was the counter supported
+ * @var total
+ * Count over all tests
+ * @var per_op
+ * Count per iteration
+ * @var ipc
+ * Instructions per cycle
+ */
+typedef struct {
+  bool enabled;
+  int error;
+
+  bool available[TIME_COUNTERS];
+  uint64_t total[TIME_COUNTERS];
+  double per_op[TIME_COUNTERS];
+  double ipc;
+} time_counters;
+
+/**
+ * @function time_counter_name
+ * @brief Get the name of a hardware performance counter
+ * @param counter
+ * [in] The counter
+ */
+const char* time_counter_name(enum time_counter counter);
+
+/**
+ * @struct time_memory
+ * @brief Memory used by a testrun
+ * @var enabled
+ * Was memory tracking requested
+ * @var allocs
+ * Allocations counted during the tests
+ * @var peak
+ * Most bytes allocated at once during the tests, above those live before them (only if `allocs.sized')
+ * @var rss_delta
+ * Change of the resident set size in bytes
+ */
+typedef struct {
+  bool enabled;
+
+  blib_alloc_stats allocs;
+  int64_t peak;
+  int64_t rss_delta;
+} time_memory;
+
+/**
+ * @struct time_scheduling
+ * @brief Work done by the workers of a scheduler during a testrun
+ * @var enabled
+ * Was a scheduler set
+ * @var workers
+ * Number of workers of the scheduler
+ * @var total
+ * Counters of all workers combined
+ * @var per_worker
+ * Counters of every worker (dynamic array of scheduler_stats)
+ */
+typedef struct {
+  bool enabled;
+
+  unsigned int workers;
+  scheduler_stats total;
+  dynamic_arr per_worker;
+} time_scheduling;
+
+/**
+ * @function time_stats_compute
+ * @brief Compute statistics over a number of samples
+ * @param samples
+ * [in] The samples
+ * @param num
+ * [in] Number of samples
+ */
+time_stats time_stats_compute(const double* samples, unsigned long num);
+
 
 /**
  * @struct time_testrun_results
@@ -132,13 +509,47 @@ time_testrun_template time_testrun_new(const char* caption, unsigned long testnu
  * @var skipped
  * Number of skipped tests
  * @var min
- * Minimum time taken
+ * Minimum time taken by a test in nanoseconds
  * @var avg
- * Average time taken
+ * Average time taken by a test in nanoseconds
  * @var max
- * Maximum time taken
+ * Maximum time taken by a test in nanoseconds
  * @var total
- * Total time taken
+ * Total time taken in nanoseconds
+ * @var clock
+ * Clock used to measure the tests
+ * @var clock_overhead
+ * Overhead of the clock in nanoseconds, already subtracted from every test
+ * @var samples
+ * Time taken per iteration or operation of every test in nanoseconds (dynamic array of doubles)
+ * @var stats
+ * Statistics over the samples
+ * @var iterations
+ * Iterations per test, 1 unless batched
+ * @var size
+ * Input size the testrun was measured at by `time_testrun_complexity()', 0 otherwise
+ * @var ops
+ * Operations measured by all tests
+ * @var ops_per_sec
+ * Iterations (or operations) per second, based on the mean (of all threads combined, based on the wall time)
+ * @var bytes_per_sec
+ * Bytes per second, if the bytes per iteration are known
+ * @var warmup
+ * Number of unrecorded tests run before the measurement
+ * @var bytes_per_iteration
+ * Bytes processed by one iteration
+ * @var threads
+ * Number of threads the tests ran on
+ * @var pinned
+ * Were the threads pinned to CPUs
+ * @var per_thread
+ * Results of every thread of a threaded testrun (dynamic array of time_testrun_results)
+ * @var counters
+ * Hardware performance counters, if enabled
+ * @var memory
+ * Memory used, if enabled
+ * @var scheduling
+ * Work of the workers of a scheduler, if one was set
  * @var enable_test_check
  * Is test checking enabled
  * @var enable_time_tracking
@@ -152,10 +563,33 @@ typedef struct {
   unsigned long failure;
   unsigned long skipped;
 
-  clock_t min;
-  float   avg;
-  clock_t max;
-  clock_t total;
+  uint64_t min;
+  double   avg;
+  uint64_t max;
+  uint64_t total;
+
+  enum time_clock_source clock;
+  uint64_t clock_overhead;
+
+  dynamic_arr samples;
+  time_stats stats;
+
+  unsigned long iterations;
+  unsigned long size;
+  uint64_t ops;
+  double ops_per_sec;
+  double bytes_per_sec;
+
+  unsigned long warmup;
+  unsigned long bytes_per_iteration;
+
+  unsigned int threads;
+  bool pinned;
+  dynamic_arr per_thread;
+
+  time_counters counters;
+  time_memory memory;
+  time_scheduling scheduling;
 
   bool enable_test_check;
   bool enable_time_tracking;
@@ -177,4 +611,198 @@ time_testrun_results time_testrun_run(const time_testrun_template* template);
  */
 void time_testrun_print(const time_testrun_results* results);
 
+/**
+ * @function time_testrun_sweep
+ * @brief Run a testrun on 1 up to a number of threads
+ * @param template
+ * [in] Testrun template created by `time_testrun_new()'
+ * @param max_threads
+ * [in] Largest number of threads
+ *
+ * Returns a dynamic array of time_testrun_results, one per thread count.
+ */
+dynamic_arr time_testrun_sweep(const time_testrun_template* template, unsigned int max_threads);
+/**
+ * @function time_testrun_print_scaling
+ * @brief Print how the throughput scales with the number of threads
+ * @param results
+ * [in] Results generated by `time_testrun_sweep()'
+ * @param num
+ * [in] Number of results
+ */
+void time_testrun_print_scaling(const time_testrun_results* results, unsigned long num);
+
+/**
+ * @enum time_complexity
+ * @brief Complexities fitted by `time_testrun_complexity()'
+ * @var time_complexity::TIME_O_1
+ * Constant
+ * @var time_complexity::TIME_O_LOG_N
+ * Logarithmic
+ * @var time_complexity::TIME_O_N
+ * Linear
+ * @var time_complexity::TIME_O_N_LOG_N
+ * Linearithmic
+ * @var time_complexity::TIME_O_N_SQUARED
+ * Quadratic
+ */
+enum time_complexity {
+  TIME_O_1,
+  TIME_O_LOG_N,
+  TIME_O_N,
+  TIME_O_N_LOG_N,
+  TIME_O_N_SQUARED,
+};
+#define TIME_COMPLEXITIES (TIME_O_N_SQUARED + 1)
+
+/**
+ * @struct time_complexity_results
+ * @brief Results of a testrun over a range of input sizes
+ * @var results
+ * Results of every size, in the order of the sizes (dynamic array of time_testrun_results)
+ * @var best
+ * Complexity fitting the medians best
+ * @var coefficient
+ * Nanoseconds per f(n) of the best fit
+ * @var coefficients
+ * Nanoseconds per f(n) of every complexity
+ * @var rms
+ * Root mean square of the residuals of every complexity, relative to the mean of the medians
+ */
+typedef struct {
+  dynamic_arr results;
+
+  enum time_complexity best;
+  double coefficient;
+
+  double coefficients[TIME_COMPLEXITIES];
+  double rms[TIME_COMPLEXITIES];
+} time_complexity_results;
+
+/**
+ * @function time_complexity_name
+ * @brief Get the name of a complexity, "O(n log n)" for example
+ * @param complexity
+ * [in] The complexity
+ */
+const char* time_complexity_name(enum time_complexity complexity);
+
+/**
+ * @function time_testrun_sizes
+ * @brief Get a geometric range of input sizes
+ * @param from
+ * [in] Smallest size, at least 1
+ * @param to
+ * [in] Largest size
+ * @param factor
+ * [in] Factor between two sizes, greater than 1
+ *
+ * Returns a dynamic array of unsigned longs from `from' up to and including `to'.
+ */
+dynamic_arr time_testrun_sizes(unsigned long from, unsigned long to, double factor);
+
+/**
+ * @function time_testrun_complexity
+ * @brief Run a testrun at every input size and fit its complexity
+ * @param template
+ * [in] Testrun template created by `time_testrun_new()'
+ * @param sizes
+ * [in] Input sizes, ascending
+ * @param num
+ * [in] Number of sizes
+ * @param setup
+ * [in] Prepares the data of the template for a size, called untimed before every size
+ *
+ * The medians are fitted to c * f(n) for every complexity by least squares,
+ * the complexity with the smallest relative error wins.
+ */
+time_complexity_results time_testrun_complexity(const time_testrun_template* template, const unsigned long* sizes, unsigned long num, void (*setup)(unsigned long size, void* data));
+/**
+ * @function time_testrun_print_complexity
+ * @brief Print the results of every size and the fitted complexity
+ * @param complexity
+ * [in] Results generated by `time_testrun_complexity()'
+ */
+void time_testrun_print_complexity(const time_complexity_results* complexity);
+/**
+ * @function time_complexity_cleanup
+ * @brief Free the results of every size
+ * @param complexity
+ * [in,out] Results generated by `time_testrun_complexity()'
+ */
+void time_complexity_cleanup(time_complexity_results* complexity);
+
+/**
+ * @function time_testrun_cleanup
+ * @brief Free the samples of a testrun, including those of its threads
+ * @param results
+ * [in,out] Results generated by `time_testrun_run()'
+ */
+void time_testrun_cleanup(time_testrun_results* results);
+
+/**
+ * @struct time_env
+ * @brief Environment the testruns were measured in
+ * @var cpu
+ * CPU model
+ * @var compiler
+ * Compiler blib was built with
+ * @var cflags
+ * Flags blib was built with
+ */
+typedef struct {
+  const char* cpu;
+  const char* compiler;
+  const char* cflags;
+} time_env;
+
+/**
+ * @function time_env_get
+ * @brief Get the environment the testruns are measured in
+ */
+time_env time_env_get(void);
+
+/**
+ * @function time_testrun_export_json
+ * @brief Write the environment and results of testruns as a JSON document
+ * @param file
+ * [in] File to write to
+ * @param results
+ * [in] Results generated by `time_testrun_run()'
+ * @param num
+ * [in] Number of results
+ */
+void time_testrun_export_json(FILE* file, const time_testrun_results* results, unsigned long num);
+/**
+ * @function time_testrun_export_csv
+ * @brief Write the results of testruns as CSV, one row per testrun
+ * @param file
+ * [in] File to write to
+ * @param results
+ * [in] Results generated by `time_testrun_run()'
+ * @param num
+ * [in] Number of results
+ *
+ * The environment is written as `#' comment lines in front of the header.
+ */
+void time_testrun_export_csv(FILE* file, const time_testrun_results* results, unsigned long num);
+
+/**
+ * @function time_testrun_compare
+ * @brief Compare testruns against a baseline written by `time_testrun_export_csv()'
+ * @param baseline
+ * [in] Path to the baseline
+ * @param results
+ * [in] Results generated by `time_testrun_run()'
+ * @param num
+ * [in] Number of results
+ * @param threshold
+ * [in] Relative slowdown of the mean tolerated before a regression is reported (0.05 for 5%)
+ *
+ * Testruns are matched by caption and size, a regression has to be significant by Welch's t-test (95%)
+ * and slower than the threshold. A table of the comparisons is written to stdout.
+ * Returns the number of regressions, -1 if the baseline couldn't be read (errno is set).
+ */
+long time_testrun_compare(const char* baseline, const time_testrun_results* results, unsigned long num, double threshold);
+
 #endif // !__BLIB_TESTING_TIME_TIME_TESTS_H__
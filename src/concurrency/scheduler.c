@@ -0,0 +1,643 @@
+#define _GNU_SOURCE /* sched_setaffinity */
+#include <blib/concurrency/scheduler.h>
+#include <blib/memory/alloc.h>
+#include <blib/memory/pool.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define CACHE_LINE    64
+#define INITIAL_DEQUE 256
+#define SPINS         64 /* Failed searches for work before sleeping */
+#define SLEEP_NS      1000000 /* Longest sleep, in case a wakeup was missed */
+#define GRAIN_SPLITS  32 /* Pieces per worker an adaptive grain allows */
+#define IDLE_OPEN     (UINT64_C(1) << 63) /* Flags `idle' of a worker that is idle right now */
+
+/* Counters are only written by their worker and read by anyone */
+#define count(worker, field, n) \
+  __atomic_store_n(&(worker)->stats.field, (worker)->stats.field + (n), __ATOMIC_RELAXED)
+
+typedef struct scheduler_task {
+  struct scheduler_task* next; /* Next task in the queue of other threads */
+  scheduler_group* group;
+
+  void (*func)(void* data);
+  void* data;
+
+  /* Subrange of `scheduler_for()' if `range' is set */
+  void (*range)(unsigned long begin, unsigned long end, void* data);
+  unsigned long begin;
+  unsigned long end;
+  unsigned long grain;
+} scheduler_task;
+
+/* Circular array of a deque, replaced arrays are kept until the stop since thieves may still read them */
+typedef struct scheduler_array {
+  long size; /* Power of two */
+  struct scheduler_array* prev;
+  scheduler_task* tasks[];
+} scheduler_array;
+
+struct scheduler_state;
+
+typedef struct {
+  /* Written by thieves */
+  long top;
+  uint8_t __pad__[CACHE_LINE - sizeof(long)];
+
+  /* Written by the owner */
+  long bottom;
+  scheduler_array* array;
+  scheduler_stats stats;
+  uint64_t idle; /* Nanoseconds idle, while idle IDLE_OPEN and the time the worker would have been idle since all along */
+  uint64_t seed;
+
+  struct scheduler_state* state;
+  unsigned int index;
+  int cpu; /* CPU to pin to, -1 if not pinned */
+  pthread_t thread;
+} __attribute__((aligned(CACHE_LINE))) scheduler_thread;
+
+typedef struct scheduler_state {
+  scheduler_thread* workers;
+  unsigned int num;
+  pool tasks;
+
+  pthread_mutex_t lock; /* Protects the queue, the sleepers and the stop */
+  pthread_cond_t wakeup;
+  scheduler_task* head; /* Queue of tasks spawned by other threads */
+  scheduler_task* tail;
+  unsigned long queued;
+  unsigned int sleepers;
+  bool stopping;
+} scheduler_state;
+
+static __thread scheduler_thread* scheduler_current = NULL;
+static __thread uint64_t scheduler_external_seed = 0;
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+uint64_t scheduler_now(void);
+void scheduler_relax(unsigned int fails);
+scheduler_thread* scheduler_self(const scheduler_state* state);
+
+scheduler_array* scheduler_array_new(long size);
+void scheduler_deque_push(scheduler_thread* worker, scheduler_task* task);
+scheduler_task* scheduler_deque_take(scheduler_thread* worker);
+scheduler_task* scheduler_deque_steal(scheduler_thread* victim);
+
+scheduler_task* scheduler_task_new(scheduler_state* state, scheduler_group* group);
+void scheduler_submit(scheduler_state* state, scheduler_thread* self, scheduler_task* task);
+scheduler_task* scheduler_find(scheduler_state* state, scheduler_thread* self);
+bool scheduler_has_work(scheduler_state* state);
+void scheduler_run(scheduler_state* state, scheduler_thread* self, scheduler_task* task);
+void scheduler_range(scheduler_state* state, scheduler_group* group, unsigned long begin, unsigned long end, unsigned long grain,
+    void (*func)(unsigned long begin, unsigned long end, void* data), void* data);
+
+void* scheduler_loop(void* data);
+void scheduler_free(scheduler_state* state, unsigned int started);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+bool scheduler_start(scheduler* self, unsigned int workers, bool pin) {
+  /* Workers are pinned to the CPUs the process may run on, in order */
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  const bool affinity = !sched_getaffinity(0, sizeof(allowed), &allowed);
+  const int cpus = (affinity ? CPU_COUNT(&allowed) : 0);
+  if (!workers) {
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = (cpus > 0 ? (unsigned int)cpus : (online > 0 ? (unsigned int)online : 1));
+  }
+  pin = pin && affinity && cpus > 0;
+
+  scheduler_state* state = blib_malloc(sizeof(*state));
+  void* memory = NULL;
+  if (!state || blib_posix_memalign(&memory, CACHE_LINE, workers * sizeof(scheduler_thread))) {
+    blib_free(state);
+    errno = ENOMEM;
+    return false;
+  }
+
+  *state = (scheduler_state) {
+    .workers = memory,
+    .num = workers,
+    .tasks = pool_new(scheduler_task),
+  };
+
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&state->wakeup, &attr);
+  pthread_condattr_destroy(&attr);
+  pthread_mutex_init(&state->lock, NULL);
+
+  for (unsigned int w = 0; w < workers; w++) {
+    scheduler_thread* worker = &state->workers[w];
+    memset(worker, 0, sizeof(*worker));
+
+    worker->array = scheduler_array_new(INITIAL_DEQUE);
+    worker->seed = 0x9e3779b97f4a7c15ULL * (w + 1);
+    worker->state = state;
+    worker->index = w;
+    worker->cpu = -1;
+
+    for (int cpu = 0, nth = w % (cpus ? cpus : 1); pin && cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed) && !nth--) {
+        worker->cpu = cpu;
+        break;
+      }
+    }
+  }
+
+  for (unsigned int w = 0; w < workers; w++) {
+    const int error = pthread_create(&state->workers[w].thread, NULL, scheduler_loop, &state->workers[w]);
+    if (error) {
+      scheduler_free(state, w);
+      errno = error;
+      return false;
+    }
+  }
+
+  *self = (scheduler) {
+    .workers = workers,
+    .pinned = pin,
+    .__state__ = state,
+  };
+
+  return true;
+} /* scheduler_start */
+
+void scheduler_stop(scheduler* self) {
+  scheduler_free(self->__state__, self->workers);
+
+  *self = (scheduler) {0};
+
+  return;
+} /* scheduler_stop */
+
+void scheduler_spawn(scheduler* self, scheduler_group* group, void (*func)(void* data), void* data) {
+  scheduler_state* state = self->__state__;
+
+  scheduler_task* task = scheduler_task_new(state, group);
+  task->func = func;
+  task->data = data;
+
+  scheduler_submit(state, scheduler_self(state), task);
+
+  return;
+} /* scheduler_spawn */
+
+void scheduler_wait(scheduler* self, scheduler_group* group) {
+  scheduler_state* state = self->__state__;
+  scheduler_thread* worker = scheduler_self(state);
+  unsigned int fails = 0;
+
+  while (__atomic_load_n(&group->__pending__, __ATOMIC_ACQUIRE)) {
+    scheduler_task* task = scheduler_find(state, worker);
+    if (task) {
+      scheduler_run(state, worker, task);
+      fails = 0;
+    } else {
+      scheduler_relax(++fails);
+    }
+  }
+
+  return;
+} /* scheduler_wait */
+
+void scheduler_for(scheduler* self, unsigned long begin, unsigned long end, unsigned long grain,
+    void (*func)(unsigned long begin, unsigned long end, void* data), void* data) {
+  if (begin >= end)
+    return;
+
+  scheduler_state* state = self->__state__;
+  if (!grain) {
+    grain = (end - begin) / ((unsigned long)state->num * GRAIN_SPLITS);
+    if (!grain)
+      grain = 1;
+  }
+
+  /* The caller starts on the whole range, the rest is split off while workers are hungry */
+  scheduler_group group = scheduler_group_new();
+  scheduler_range(state, &group, begin, end, grain, func, data);
+  scheduler_wait(self, &group);
+
+  return;
+} /* scheduler_for */
+
+int scheduler_worker(const scheduler* self) {
+  const scheduler_thread* worker = scheduler_self(self->__state__);
+
+  return (worker ? (int)worker->index : -1);
+} /* scheduler_worker */
+
+scheduler_stats scheduler_stats_get(const scheduler* self, unsigned int worker) {
+  const scheduler_state* state = self->__state__;
+  if (worker >= state->num) {
+    fprintf(stderr,
+        "Attempt to get the counters of worker %u of scheduler with %u worker(s)!\n"
+        "=== ABORT ===\n",
+        worker, state->num);
+
+    abort();
+  }
+
+  const scheduler_stats* stats = &state->workers[worker].stats;
+  const uint64_t idle = __atomic_load_n(&state->workers[worker].idle, __ATOMIC_RELAXED);
+
+  return (scheduler_stats) {
+    .tasks = __atomic_load_n(&stats->tasks, __ATOMIC_RELAXED),
+    .spawns = __atomic_load_n(&stats->spawns, __ATOMIC_RELAXED),
+    .steals = __atomic_load_n(&stats->steals, __ATOMIC_RELAXED),
+    .failed_steals = __atomic_load_n(&stats->failed_steals, __ATOMIC_RELAXED),
+    .sleeps = __atomic_load_n(&stats->sleeps, __ATOMIC_RELAXED),
+    .idle_ns = (idle & IDLE_OPEN ? scheduler_now() - (idle & ~IDLE_OPEN) : idle),
+  };
+} /* scheduler_stats_get */
+
+scheduler_stats scheduler_stats_total(const scheduler* self) {
+  scheduler_stats total = {0};
+
+  for (unsigned int w = 0; w < self->workers; w++) {
+    const scheduler_stats stats = scheduler_stats_get(self, w);
+    total.tasks += stats.tasks;
+    total.spawns += stats.spawns;
+    total.steals += stats.steals;
+    total.failed_steals += stats.failed_steals;
+    total.sleeps += stats.sleeps;
+    total.idle_ns += stats.idle_ns;
+  }
+
+  return total;
+} /* scheduler_stats_total */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+uint64_t scheduler_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/* Spin briefly, then give the CPU to the workers that have something to do */
+void scheduler_relax(unsigned int fails) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (fails < 8) {
+    __builtin_ia32_pause();
+    return;
+  }
+#else
+  (void)fails;
+#endif
+  sched_yield();
+}
+
+scheduler_thread* scheduler_self(const scheduler_state* state) {
+  scheduler_thread* worker = scheduler_current;
+
+  return (worker && worker->state == state ? worker : NULL);
+}
+
+scheduler_array* scheduler_array_new(long size) {
+  scheduler_array* array = blib_malloc(sizeof(scheduler_array) + size * sizeof(scheduler_task*));
+  if (!array) {
+    fprintf(stderr,
+        "Failed to allocate deque of %ld tasks: %s\n"
+        "=== ABORT ===\n",
+        size, strerror(errno));
+
+    abort();
+  }
+
+  array->size = size;
+  array->prev = NULL;
+
+  return array;
+}
+
+/*
+ * Chase-Lev deque, with the orderings of "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (Lê et al.), except that the bottom is published with a release store.
+ */
+void scheduler_deque_push(scheduler_thread* worker, scheduler_task* task) {
+  const long bottom = __atomic_load_n(&worker->bottom, __ATOMIC_RELAXED);
+  const long top = __atomic_load_n(&worker->top, __ATOMIC_ACQUIRE);
+  scheduler_array* array = worker->array;
+
+  if (bottom - top > array->size - 1) {
+    scheduler_array* grown = scheduler_array_new(array->size * 2);
+    for (long i = top; i < bottom; i++)
+      grown->tasks[i & (grown->size - 1)] = __atomic_load_n(&array->tasks[i & (array->size - 1)], __ATOMIC_RELAXED);
+    grown->prev = array;
+
+    __atomic_store_n(&worker->array, grown, __ATOMIC_RELEASE);
+    array = grown;
+  }
+
+  __atomic_store_n(&array->tasks[bottom & (array->size - 1)], task, __ATOMIC_RELAXED);
+  __atomic_store_n(&worker->bottom, bottom + 1, __ATOMIC_RELEASE);
+}
+
+scheduler_task* scheduler_deque_take(scheduler_thread* worker) {
+  const long bottom = __atomic_load_n(&worker->bottom, __ATOMIC_RELAXED) - 1;
+  scheduler_array* array = worker->array;
+  __atomic_store_n(&worker->bottom, bottom, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  long top = __atomic_load_n(&worker->top, __ATOMIC_RELAXED);
+
+  if (top > bottom) {
+    __atomic_store_n(&worker->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return NULL;
+  }
+
+  scheduler_task* task = __atomic_load_n(&array->tasks[bottom & (array->size - 1)], __ATOMIC_RELAXED);
+  if (top == bottom) {
+    /* The last task, thieves may race for it */
+    if (!__atomic_compare_exchange_n(&worker->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+      task = NULL;
+    __atomic_store_n(&worker->bottom, bottom + 1, __ATOMIC_RELAXED);
+  }
+
+  return task;
+}
+
+scheduler_task* scheduler_deque_steal(scheduler_thread* victim) {
+  long top = __atomic_load_n(&victim->top, __ATOMIC_ACQUIRE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  const long bottom = __atomic_load_n(&victim->bottom, __ATOMIC_ACQUIRE);
+  if (top >= bottom)
+    return NULL;
+
+  const scheduler_array* array = __atomic_load_n(&victim->array, __ATOMIC_ACQUIRE);
+  scheduler_task* task = __atomic_load_n(&array->tasks[top & (array->size - 1)], __ATOMIC_RELAXED);
+  if (!__atomic_compare_exchange_n(&victim->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+    return NULL;
+
+  return task;
+}
+
+scheduler_task* scheduler_task_new(scheduler_state* state, scheduler_group* group) {
+  scheduler_task* task = pool_alloc(&state->tasks);
+  if (!task) {
+    fprintf(stderr,
+        "Failed to allocate task of scheduler: %s\n"
+        "=== ABORT ===\n",
+        strerror(errno));
+
+    abort();
+  }
+
+  *task = (scheduler_task) { .group = group };
+
+  return task;
+}
+
+void scheduler_submit(scheduler_state* state, scheduler_thread* self, scheduler_task* task) {
+  __atomic_add_fetch(&task->group->__pending__, 1, __ATOMIC_RELAXED);
+
+  if (self) {
+    scheduler_deque_push(self, task);
+    count(self, spawns, 1);
+  } else {
+    pthread_mutex_lock(&state->lock);
+    if (state->tail)
+      state->tail->next = task;
+    else
+      state->head = task;
+    state->tail = task;
+    __atomic_store_n(&state->queued, state->queued + 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&state->lock);
+  }
+
+  /* A wakeup missed here only delays a sleeper by SLEEP_NS */
+  if (__atomic_load_n(&state->sleepers, __ATOMIC_RELAXED)) {
+    pthread_mutex_lock(&state->lock);
+    pthread_cond_signal(&state->wakeup);
+    pthread_mutex_unlock(&state->lock);
+  }
+}
+
+/* The own deque first, then the queue of other threads, then the other workers from a random one on */
+scheduler_task* scheduler_find(scheduler_state* state, scheduler_thread* self) {
+  scheduler_task* task = (self ? scheduler_deque_take(self) : NULL);
+  if (task)
+    return task;
+
+  if (__atomic_load_n(&state->queued, __ATOMIC_RELAXED)) {
+    pthread_mutex_lock(&state->lock);
+    task = state->head;
+    if (task) {
+      state->head = task->next;
+      if (!state->head)
+        state->tail = NULL;
+      __atomic_store_n(&state->queued, state->queued - 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&state->lock);
+
+    if (task) {
+      if (self)
+        count(self, steals, 1);
+      return task;
+    }
+  }
+
+  uint64_t* seed = (self ? &self->seed : &scheduler_external_seed);
+  if (!*seed)
+    *seed = (uintptr_t)seed | 1;
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 7;
+  *seed ^= *seed << 17;
+
+  const unsigned int start = *seed % state->num;
+  for (unsigned int v = 0; v < state->num; v++) {
+    scheduler_thread* victim = &state->workers[(start + v) % state->num];
+    if (victim == self)
+      continue;
+
+    task = scheduler_deque_steal(victim);
+    if (!self) {
+      if (task)
+        return task;
+      continue;
+    }
+
+    if (task) {
+      count(self, steals, 1);
+      return task;
+    }
+    count(self, failed_steals, 1);
+  }
+
+  return NULL;
+}
+
+bool scheduler_has_work(scheduler_state* state) {
+  if (__atomic_load_n(&state->queued, __ATOMIC_RELAXED))
+    return true;
+
+  for (unsigned int w = 0; w < state->num; w++) {
+    const scheduler_thread* worker = &state->workers[w];
+    if (__atomic_load_n(&worker->bottom, __ATOMIC_RELAXED) > __atomic_load_n(&worker->top, __ATOMIC_RELAXED))
+      return true;
+  }
+
+  return false;
+}
+
+void scheduler_run(scheduler_state* state, scheduler_thread* self, scheduler_task* task) {
+  if (task->range)
+    scheduler_range(state, task->group, task->begin, task->end, task->grain, task->range, task->data);
+  else
+    task->func(task->data);
+
+  /* The group may be gone as soon as its count drops */
+  scheduler_group* group = task->group;
+  pool_free(&state->tasks, task);
+  if (self)
+    count(self, tasks, 1);
+  __atomic_sub_fetch(&group->__pending__, 1, __ATOMIC_RELEASE);
+}
+
+void scheduler_range(scheduler_state* state, scheduler_group* group, unsigned long begin, unsigned long end, unsigned long grain,
+    void (*func)(unsigned long begin, unsigned long end, void* data), void* data) {
+  scheduler_thread* self = scheduler_self(state);
+
+  while (begin < end) {
+    /* Hungry: nothing left in the own deque (or the queue) for thieves to take */
+    const bool hungry = (self
+        ? __atomic_load_n(&self->bottom, __ATOMIC_RELAXED) <= __atomic_load_n(&self->top, __ATOMIC_RELAXED)
+        : !__atomic_load_n(&state->queued, __ATOMIC_RELAXED));
+
+    if (end - begin > grain && hungry) {
+      const unsigned long middle = begin + (end - begin) / 2;
+
+      scheduler_task* task = scheduler_task_new(state, group);
+      task->range = func;
+      task->data = data;
+      task->begin = middle;
+      task->end = end;
+      task->grain = grain;
+      scheduler_submit(state, self, task);
+
+      end = middle;
+    } else {
+      const unsigned long piece = (end - begin < grain ? end - begin : grain);
+      func(begin, begin + piece, data);
+      begin += piece;
+    }
+  }
+}
+
+void* scheduler_loop(void* data) {
+  scheduler_thread* self = data;
+  scheduler_state* state = self->state;
+
+  if (self->cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(self->cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+  }
+  scheduler_current = self;
+
+  /* The idle period going on is published as where it would have started if every idle
+   * nanosecond so far was part of it, so readers count it without waiting for it to end */
+  uint64_t idle_ns = 0, idle_since = scheduler_now();
+  __atomic_store_n(&self->idle, IDLE_OPEN | idle_since, __ATOMIC_RELAXED);
+  unsigned int fails = 0;
+
+  while (true) {
+    scheduler_task* task = scheduler_find(state, self);
+    if (task) {
+      if (idle_since) {
+        idle_ns += scheduler_now() - idle_since;
+        idle_since = 0;
+        __atomic_store_n(&self->idle, idle_ns, __ATOMIC_RELAXED);
+      }
+      fails = 0;
+
+      scheduler_run(state, self, task);
+      continue;
+    }
+
+    if (!idle_since) {
+      idle_since = scheduler_now();
+      __atomic_store_n(&self->idle, IDLE_OPEN | (idle_since - idle_ns), __ATOMIC_RELAXED);
+    }
+
+    /* Tasks left at the stop are still run */
+    if (__atomic_load_n(&state->stopping, __ATOMIC_ACQUIRE))
+      break;
+
+    if (++fails < SPINS) {
+      scheduler_relax(fails);
+      continue;
+    }
+    fails = 0;
+
+    pthread_mutex_lock(&state->lock);
+    __atomic_add_fetch(&state->sleepers, 1, __ATOMIC_RELAXED);
+    if (!state->stopping && !scheduler_has_work(state)) {
+      count(self, sleeps, 1);
+
+      struct timespec until;
+      clock_gettime(CLOCK_MONOTONIC, &until);
+      until.tv_nsec += SLEEP_NS;
+      if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+      }
+      pthread_cond_timedwait(&state->wakeup, &state->lock, &until);
+    }
+    __atomic_sub_fetch(&state->sleepers, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&state->lock);
+  }
+
+  __atomic_store_n(&self->idle, idle_ns + (scheduler_now() - idle_since), __ATOMIC_RELAXED);
+  scheduler_current = NULL;
+
+  return NULL;
+}
+
+/* Stops and joins the first `started' workers */
+void scheduler_free(scheduler_state* state, unsigned int started) {
+  pthread_mutex_lock(&state->lock);
+  __atomic_store_n(&state->stopping, true, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&state->wakeup);
+  pthread_mutex_unlock(&state->lock);
+
+  for (unsigned int w = 0; w < started; w++)
+    pthread_join(state->workers[w].thread, NULL);
+
+  for (unsigned int w = 0; w < state->num; w++) {
+    scheduler_array* array = state->workers[w].array;
+    while (array) {
+      scheduler_array* prev = array->prev;
+      blib_free(array);
+      array = prev;
+    }
+  }
+
+  pthread_mutex_destroy(&state->lock);
+  pthread_cond_destroy(&state->wakeup);
+  pool_cleanup(&state->tasks);
+  blib_free(state->workers);
+  blib_free(state);
+}
+/* ===================== */
@@ -1,4 +1,8 @@
+#define _POSIX_C_SOURCE 200112L
 #include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/arrays/trace.h>
+#include <blib/memory/alloc.h>
+#include <blib/memory/kernels.h>
 
 #include <errno.h>
 #include <stdio.h>
@@ -68,6 +72,22 @@
   } while (0)
 #endif
 
+#define check_shared(self)    \
+  do {                       \
+    if (self->__refs__)      \
+      dynamic_arr_unshare(self); \
+  } while (0)
+
+/* Tracing is off unless `dynamic_arr_trace_start()' was called, so the check stays cheap */
+#define trace(self, op, index, other, count)                                \
+  do {                                                                      \
+    if (__atomic_load_n(&__intern_dynamic_arr_tracing, __ATOMIC_ACQUIRE))   \
+      __intern_dynamic_arr_trace(self, op, index, other, count);            \
+  } while (0)
+
+/* A deadzone would shift the start of aligned arrays off their alignment */
+#define deadzone_keeps_alignment(self) (!self->__align__ || !(self->element_size % self->__align__))
+
 #define index2off(self, i) ((i + self->__deadzone__) * self->element_size)
 
 #ifndef bug_notice
@@ -86,8 +106,11 @@
 /* ==================================
  * Convenience Function Declaractions
  * ================================== */
+uint8_t* dynamic_arr_alloc(const dynamic_arr* self, unsigned long cap);
+uint8_t* dynamic_arr_realloc(dynamic_arr* self, unsigned long newcap);
 void dynamic_arr_resize(dynamic_arr* self, long change, bool explicit_size);
 void dynamic_arr_move(dynamic_arr* self, long change, unsigned long offset, unsigned long len);
+void dynamic_arr_swap(dynamic_arr* self, unsigned long off1, unsigned long off2, unsigned long len);
 void dynamic_arr_print(const dynamic_arr* self);
 /* ================================== */
 
@@ -95,12 +118,29 @@ void dynamic_arr_print(const dynamic_arr* self);
  * API Functions
  * ============= */
 dynamic_arr __intern_dynamic_generic_arr_new(unsigned int element_size) {
+  return __intern_dynamic_generic_arr_new_aligned(element_size, 0, false);
+}
+
+dynamic_arr __intern_dynamic_generic_arr_new_aligned(unsigned int element_size, unsigned int alignment, bool pad) {
+  if (alignment && ((alignment & (alignment - 1)) || alignment % sizeof(void*))) {
+    fprintf(stderr,
+        "Attempt to create dynamic array with alignment %u (must be a power of two multiple of %zu)!\n"
+        "=== ABORT ===\n",
+        alignment, sizeof(void*));
+
+    abort();
+  }
+
   dynamic_arr arr = {0};
 
   arr.element_size = element_size;
+  arr.__align__ = alignment;
   arr.__cap__ = 1;
 
-  arr.__malloc_start__ = malloc(arr.element_size);
+  if (pad && alignment)
+    arr.element_size = (element_size + alignment - 1) & ~(alignment - 1);
+
+  arr.__malloc_start__ = dynamic_arr_alloc(&arr, arr.__cap__);
   if (!arr.__malloc_start__) {
     fprintf(stderr, 
         "Failed to allocate initial memory for dynamic array of size %u: %s\n"
@@ -110,18 +150,35 @@ dynamic_arr __intern_dynamic_generic_arr_new(unsigned int element_size) {
     abort();
   }
 
+  arr.__id__ = __intern_dynamic_arr_next_id();
+  trace((&arr), DYNAMIC_ARR_TRACE_NEW, alignment, 0, 0);
+
   return arr;
 }
 
 dynamic_arr dynamic_arr_copy(const dynamic_arr *src) {
+  const unsigned long id = __intern_dynamic_arr_next_id();
+  trace(src, DYNAMIC_ARR_TRACE_COPY, 0, id, 0);
+
+  if (src->__refs__) {
+    __atomic_add_fetch(src->__refs__, 1, __ATOMIC_RELAXED);
+
+    dynamic_arr shared = *src;
+    shared.__id__ = id;
+
+    return shared;
+  }
+
   dynamic_arr dst = {
-    .__cap__ = src->num,
+    .__cap__ = (src->num ? src->num : 1),
     .num = src->num,
     .element_size = src->element_size,
-    .__deadzone__ = 0
+    .__deadzone__ = 0,
+    .__align__ = src->__align__,
+    .__id__ = id,
   };
 
-  dst.__malloc_start__ = malloc(src->num * src->element_size);
+  dst.__malloc_start__ = dynamic_arr_alloc(&dst, dst.__cap__);
   if (!dst.__malloc_start__) {
     fprintf(stderr,
         "Failed to allocate initial memory for dynamic array copy of array size %lu: %s\n"
@@ -136,11 +193,62 @@ dynamic_arr dynamic_arr_copy(const dynamic_arr *src) {
   return dst;
 }
 
+void dynamic_arr_enable_cow(dynamic_arr* self) {
+  trace(self, DYNAMIC_ARR_TRACE_ENABLE_COW, 0, 0, 0);
+  if (self->__refs__)
+    return;
+
+  self->__refs__ = blib_malloc(sizeof(*self->__refs__));
+  if (!self->__refs__) {
+    fprintf(stderr,
+        "Failed to allocate reference count for dynamic array: %s\n"
+        "=== ABORT ===\n",
+        strerror(errno));
+
+    abort();
+  }
+  *self->__refs__ = 1;
+
+  return;
+} /* dynamic_arr_enable_cow */
+
+void dynamic_arr_unshare(dynamic_arr* self) {
+  if (!self->__refs__ || __atomic_load_n(self->__refs__, __ATOMIC_ACQUIRE) == 1)
+    return;
+
+  unsigned long* refs = blib_malloc(sizeof(*refs));
+  uint8_t* buffer = dynamic_arr_alloc(self, self->__cap__);
+  if (!refs || !buffer) {
+    fprintf(stderr,
+        "Failed to allocate private copy of shared dynamic array of size %lu: %s\n"
+        "=== ABORT ===\n",
+        self->__cap__ * self->element_size, strerror(errno));
+
+    abort();
+  }
+  *refs = 1;
+
+  memcpy(buffer + index2off(self, 0), self->__malloc_start__ + index2off(self, 0), self->num * self->element_size);
+
+  /* Another holder may have unshared concurrently, the last one out frees the old buffer */
+  if (!__atomic_sub_fetch(self->__refs__, 1, __ATOMIC_ACQ_REL)) {
+    blib_free(self->__malloc_start__);
+    blib_free(self->__refs__);
+  }
+
+  self->__malloc_start__ = buffer;
+  self->__refs__ = refs;
+
+  return;
+} /* dynamic_arr_unshare */
+
 void* dynamic_arr_get_start(const dynamic_arr* self) {
   return self->__malloc_start__ + index2off(self, 0);
 } /* dynamic_arr_get_start */
 
 void dynamic_arr_replace(dynamic_arr* self, unsigned long index, const void* element) {
+  trace(self, DYNAMIC_ARR_TRACE_REPLACE, index, 0, 1);
+  check_shared(self);
   check_index(self, "replace", index);
   memcpy(self->__malloc_start__ + index2off(self, index), element, self->element_size);
 
@@ -148,6 +256,8 @@ void dynamic_arr_replace(dynamic_arr* self, unsigned long index, const void* ele
 } /* dynamic_arr_replace */
 
 void dynamic_arr_bulk_replace(dynamic_arr* self, unsigned long index, const void* elements, unsigned long num) {
+  trace(self, DYNAMIC_ARR_TRACE_BULK_REPLACE, index, 0, num);
+  check_shared(self);
   check_index_len(self, "bulk-replace", index, num);
   memcpy(self->__malloc_start__ + index2off(self, index), elements, num * self->element_size);
 
@@ -155,69 +265,40 @@ void dynamic_arr_bulk_replace(dynamic_arr* self, unsigned long index, const void
 } /* dynamic_arr_bulk_replace */
 
 void dynamic_arr_set(dynamic_arr* self, unsigned long index, const void* element, unsigned long num) {
+  trace(self, DYNAMIC_ARR_TRACE_SET, index, 0, num);
+  check_shared(self);
   check_index_len(self, "set", index, num);
 
-  for (unsigned long i = index; i < num + index; i++)
-    memcpy(self->__malloc_start__ + index2off(self, i), element, self->element_size);
+  kernel_fill(self->__malloc_start__ + index2off(self, index), element, self->element_size, num);
 
   return;
 } /* dynamic_arr_set */
 void dynamic_arr_flip(dynamic_arr* self, unsigned long index1, unsigned long index2) {
-  uint8_t* buffer = NULL;
-  if (self->num < self->__cap__) {
-    buffer = self->__malloc_start__ + index2off(self, self->num);
-  } else if (self->__deadzone__) {
-    buffer = self->__malloc_start__;
-  } else {
-    dynamic_arr_resize(self, 1, false);
-    buffer = self->__malloc_start__ + (self->num * self->element_size);
-  }
+  trace(self, DYNAMIC_ARR_TRACE_FLIP, index1, index2, 1);
+  check_shared(self);
+  check_index(self, "flip", index1);
+  check_index(self, "flip", index2);
 
-  dynamic_arr_peek(self, index1, buffer);
-  dynamic_arr_replace(self, index1, self->__malloc_start__ + (index2 * self->element_size));
-  dynamic_arr_replace(self, index2, buffer);
+  if (index1 != index2)
+    dynamic_arr_swap(self, index2off(self, index1), index2off(self, index2), self->element_size);
 
   return;
 } /* dynamic_arr_flip */
 
 void dynamic_arr_bulk_flip(dynamic_arr* self, unsigned long index1, unsigned long index2, unsigned long num) {
+  trace(self, DYNAMIC_ARR_TRACE_BULK_FLIP, index1, index2, num);
+  check_shared(self);
   check_index_len(self, "bulk-flip (1)", index1, num);
   check_index_len(self, "bulk-flip (2)", index2, num);
-  if (!num)
-    return;
-
-  const unsigned long size = num * self->element_size;
-
-  uint8_t* ptr = self->__malloc_start__ + index2off(self, self->num);
-  unsigned long elems_size = (self->__cap__ - self->num) % (size + 1);
-  if (elems_size)
-    goto memory_cpy;
 
-  ptr = self->__malloc_start__;
-  elems_size = self->__deadzone__ % (size + 1);
-  if (elems_size)
-    goto memory_cpy;
-
-  dynamic_arr_resize(self, size, false);
-  ptr = self->__malloc_start__ + index2off(self, self->num);
-  elems_size = size;
-
-memory_cpy:
-  while (num) {
-    memcpy(ptr, self->__malloc_start__ + index2off(self, index1), size);
-    memcpy(self->__malloc_start__ + index2off(self, index1), self->__malloc_start__ + index2off(self, index2), size);
-    memcpy(self->__malloc_start__ + index2off(self, index2), ptr, size);
-
-    index1 += num;
-    index2 += num;
-
-    num -= elems_size % (size + 1);
-  }
+  if (index1 != index2)
+    dynamic_arr_swap(self, index2off(self, index1), index2off(self, index2), num * self->element_size);
 
   return;
 } /* dynamic_arr_bulk_flip */
 
 void dynamic_arr_peek(const dynamic_arr* self, unsigned long index, void* out) {
+  trace(self, DYNAMIC_ARR_TRACE_PEEK, index, 0, 1);
   check_index(self, "read", index);
 
   memcpy(out, self->__malloc_start__ + index2off(self, index), self->element_size);
@@ -226,6 +307,7 @@ void dynamic_arr_peek(const dynamic_arr* self, unsigned long index, void* out) {
 } /* dynamic_arr_peek */
 
 void dynamic_arr_bulk_peek(dynamic_arr* self, unsigned long index, void* out, unsigned long num) {
+  trace(self, DYNAMIC_ARR_TRACE_BULK_PEEK, index, 0, num);
   check_index_len(self, "bulk-peek", index, num);
   
   memcpy(out, self->__malloc_start__ + index2off(self, index), num * self->element_size);
@@ -234,6 +316,8 @@ void dynamic_arr_bulk_peek(dynamic_arr* self, unsigned long index, void* out, un
 } /* dynamic_arr_bulk_peek */
 
 void dynamic_arr_append(dynamic_arr* self, const void* element) {
+  trace(self, DYNAMIC_ARR_TRACE_APPEND, 0, 0, 1);
+  check_shared(self);
   dynamic_arr_resize(self, 1, false);
 
   memcpy(self->__malloc_start__ + index2off(self, self->num), element, self->element_size);
@@ -242,6 +326,8 @@ void dynamic_arr_append(dynamic_arr* self, const void* element) {
 } /* dynamic_arr_append */
 
 void dynamic_arr_bulk_append(dynamic_arr* self, const void* elements, unsigned long num) {
+  trace(self, DYNAMIC_ARR_TRACE_BULK_APPEND, 0, 0, num);
+  check_shared(self);
   dynamic_arr_resize(self, num, false);
 
   memcpy(self->__malloc_start__ + index2off(self, self->num), elements, num * self->element_size);
@@ -251,6 +337,8 @@ void dynamic_arr_bulk_append(dynamic_arr* self, const void* elements, unsigned l
 } /* dynamic_arr_bulk_append */
 
 void dynamic_arr_prepend(dynamic_arr* self, const void* element) {
+  trace(self, DYNAMIC_ARR_TRACE_PREPEND, 0, 0, 1);
+  check_shared(self);
   if (self->__deadzone__) {
     self->__deadzone__--;
     memcpy(self->__malloc_start__ + index2off(self, 0), element, self->element_size);
@@ -266,12 +354,14 @@ void dynamic_arr_prepend(dynamic_arr* self, const void* element) {
 } /* dynamic_arr_prepend */
 
 void dynamic_arr_bulk_prepend(dynamic_arr* self, const void* elements, unsigned long num) {
+  trace(self, DYNAMIC_ARR_TRACE_BULK_PREPEND, 0, 0, num);
+  check_shared(self);
   unsigned long deadzone_elems = num % (self->__deadzone__ + 1);
   unsigned long move_elems = num - deadzone_elems;
 
   dynamic_arr_resize(self, move_elems, false);
   dynamic_arr_move(self, move_elems, 0, self->num);
-  memcpy(self->__malloc_start__ + index2off(self, 0), (uint8_t*)elements + ((num - move_elems) * self->element_size), move_elems);
+  memcpy(self->__malloc_start__ + index2off(self, 0), (uint8_t*)elements + ((num - move_elems) * self->element_size), move_elems * self->element_size);
 
   self->__deadzone__ -= deadzone_elems;
   memcpy(self->__malloc_start__ + index2off(self, 0), elements, deadzone_elems * self->element_size);
@@ -282,13 +372,14 @@ void dynamic_arr_bulk_prepend(dynamic_arr* self, const void* elements, unsigned
 } /* dynamic_arr_bulk_prepend */
 
 void dynamic_arr_insert_at(dynamic_arr* self, unsigned long index, const void* element) {
+  trace(self, DYNAMIC_ARR_TRACE_INSERT_AT, index, 0, 1);
+  check_shared(self);
   check_index(self, "insert", index);
 
   if (self->__deadzone__ && self->num >> 1 >= index) {
     self->__deadzone__--;
-    index++;
 
-    dynamic_arr_move(self, -1, 0, index);
+    dynamic_arr_move(self, -1, 0, index + 1);
 
     memcpy(self->__malloc_start__ + index2off(self, index), element, self->element_size);
   } else {
@@ -303,17 +394,21 @@ void dynamic_arr_insert_at(dynamic_arr* self, unsigned long index, const void* e
 } /* dynamic_arr_insert_at */
 
 void dynamic_arr_bulk_insert_at(dynamic_arr* self, unsigned long index, void* elements, unsigned long num) {
-  check_index_len(self, "bulk-insert", index, num);
-  
-  const          uint8_t preferred_side   = self->num >> 1 < index;
-  const unsigned long    deadzone_inserts = preferred_side * (num % (self->__deadzone__ + 1));
-  const unsigned long    end_inserts      = num - deadzone_inserts;
+  trace(self, DYNAMIC_ARR_TRACE_BULK_INSERT_AT, index, 0, num);
+  check_shared(self);
+  check_index(self, "bulk-insert", index);
+  if (!num)
+    return;
 
-  dynamic_arr_move(self, -deadzone_inserts, 0, index + 1);
-  dynamic_arr_resize(self, end_inserts, false);
-  dynamic_arr_move(self, end_inserts, index + 1, self->num - index);
+  if (self->__deadzone__ >= num && self->num >> 1 >= index) {
+    self->__deadzone__ -= num;
+    dynamic_arr_move(self, -num, 0, index + num);
+  } else {
+    dynamic_arr_resize(self, num, false);
+    dynamic_arr_move(self, num, index, self->num - index);
+  }
 
-  memcpy(self->__malloc_start__ + index2off(self, index - deadzone_inserts), elements, num * self->element_size);
+  memcpy(self->__malloc_start__ + index2off(self, index), elements, num * self->element_size);
 
   self->num += num;
 
@@ -321,6 +416,8 @@ void dynamic_arr_bulk_insert_at(dynamic_arr* self, unsigned long index, void* el
 } /* dynamic_arr_bulk_insert_at */
 
 void dynamic_arr_precate(dynamic_arr* self, void* out) {
+  trace(self, DYNAMIC_ARR_TRACE_PRECATE, 0, 0, 1);
+  check_shared(self);
   check_rm_len(self, "precate", 1);
 
   if (out)
@@ -333,20 +430,31 @@ void dynamic_arr_precate(dynamic_arr* self, void* out) {
 } /* dynamic_arr_precate */
 
 void dynamic_arr_quick_precate(dynamic_arr *self, void *out) {
+  check_rm_len(self, "precate", 1);
+
+  if (!deadzone_keeps_alignment(self)) {
+    dynamic_arr_precate(self, out);
+
+    return;
+  }
+  trace(self, DYNAMIC_ARR_TRACE_QUICK_PRECATE, 0, 0, 1);
+
   if (out)
     memcpy(out, self->__malloc_start__ + index2off(self, 0), self->element_size);
 
   self->__deadzone__++;
+  self->num--;
 
   return;
 } /* dynamic_arr_quick_precate */
 
 void dynamic_arr_truncate(dynamic_arr *self, void *out) {
+  trace(self, DYNAMIC_ARR_TRACE_TRUNCATE, 0, 0, 1);
+  check_shared(self);
   check_rm_len(self, "truncate", 1);
 
-  self->num--;
   if (out)
-    memcpy(out, self->__malloc_start__ + index2off(self, self->num), self->element_size);
+    memcpy(out, self->__malloc_start__ + index2off(self, self->num - 1), self->element_size);
   dynamic_arr_resize(self, -1, false);
   self->num--;
 
@@ -354,6 +462,8 @@ void dynamic_arr_truncate(dynamic_arr *self, void *out) {
 } /* dynamic_arr_truncate */
 
 void dynamic_arr_resize_to(dynamic_arr* self, void* out, unsigned long new_size) {
+  trace(self, DYNAMIC_ARR_TRACE_RESIZE_TO, 0, 0, new_size);
+  check_shared(self);
   if (out && new_size < self->num)
     memcpy(out, self->__malloc_start__ + index2off(self, new_size), (self->num - new_size) * self->element_size);
 
@@ -364,14 +474,29 @@ void dynamic_arr_resize_to(dynamic_arr* self, void* out, unsigned long new_size)
   return;
 } /* dynamic_arr_resize_to */
 
+void dynamic_arr_reserve(dynamic_arr* self, unsigned long num) {
+  trace(self, DYNAMIC_ARR_TRACE_RESERVE, 0, 0, num);
+  check_shared(self);
+  dynamic_arr_resize(self, num, false);
+
+  return;
+} /* dynamic_arr_reserve */
+
 void dynamic_arr_trim(dynamic_arr *self) {
-  dynamic_arr_move(self, -self->__deadzone__, self->__deadzone__, self->num);
+  trace(self, DYNAMIC_ARR_TRACE_TRIM, 0, 0, 0);
+  check_shared(self);
+  if (self->__deadzone__) {
+    memmove(self->__malloc_start__, self->__malloc_start__ + index2off(self, 0), self->num * self->element_size);
+    self->__deadzone__ = 0;
+  }
   dynamic_arr_resize(self, (self->num ? self->num : 1), true);
 
   return;
 } /* dynamic_arr_trim */
 
 void dynamic_arr_remove_at(dynamic_arr* self, unsigned long index, void* out) {
+  trace(self, DYNAMIC_ARR_TRACE_REMOVE_AT, index, 0, 1);
+  check_shared(self);
   check_index(self, "remove", index);
 
   if (out)
@@ -385,11 +510,13 @@ void dynamic_arr_remove_at(dynamic_arr* self, unsigned long index, void* out) {
 } /* dynamic_arr_remove_at */
 
 void dynamic_arr_quick_remove_at(dynamic_arr* self, unsigned long index, void* out) {
+  trace(self, DYNAMIC_ARR_TRACE_QUICK_REMOVE_AT, index, 0, 1);
+  check_shared(self);
   check_index(self, "remove", index);
 
   if (out)
     memcpy(out, self->__malloc_start__ + index2off(self, index), self->element_size);
-  if (self->num >> 1 >= index) {
+  if (self->num >> 1 >= index && deadzone_keeps_alignment(self)) {
     dynamic_arr_move(self, 1, 0, index);
     self->__deadzone__++;
   } else {
@@ -403,12 +530,14 @@ void dynamic_arr_quick_remove_at(dynamic_arr* self, unsigned long index, void* o
 } /* dynamic_arr_quick_remove_at */
 
 void dynamic_arr_bulk_remove_at(dynamic_arr* self, unsigned long index, void* out, unsigned long num) {
+  trace(self, DYNAMIC_ARR_TRACE_BULK_REMOVE_AT, index, 0, num);
+  check_shared(self);
   check_index_len(self, "bulk-remove", index, num);
 
   if (out)
     memcpy(out, self->__malloc_start__ + index2off(self, index), num * self->element_size);
 
-  dynamic_arr_move(self, -num, index + num, self->num - index - num);
+  dynamic_arr_move(self, -num, index, self->num - index);
   dynamic_arr_resize(self, -num, false);
 
   self->num -= num;
@@ -417,7 +546,13 @@ void dynamic_arr_bulk_remove_at(dynamic_arr* self, unsigned long index, void* ou
 } /* dynamic_arr_bulk_remove_at */
 
 void dynamic_arr_cleanup(dynamic_arr* self) {
-  free(self->__malloc_start__);
+  trace(self, DYNAMIC_ARR_TRACE_CLEANUP, 0, 0, 0);
+  if (!self->__refs__) {
+    blib_free(self->__malloc_start__);
+  } else if (!__atomic_sub_fetch(self->__refs__, 1, __ATOMIC_ACQ_REL)) {
+    blib_free(self->__malloc_start__);
+    blib_free(self->__refs__);
+  }
   
   *self = (dynamic_arr) {0};
 
@@ -432,6 +567,9 @@ void dynamic_arr_resize(dynamic_arr* self, long change, const bool explicit_size
   if (!explicit_size && !change)
     return;
 
+  /* Elements in the deadzone still occupy the front of the memory */
+  const unsigned long used = self->num + self->__deadzone__;
+
   unsigned long newcap = self->__cap__;
   if (explicit_size) {
     if (change <= 0) {
@@ -443,7 +581,7 @@ void dynamic_arr_resize(dynamic_arr* self, long change, const bool explicit_size
 
       abort();
     }
-    newcap = change;
+    newcap = change + self->__deadzone__;
   } else if (change < 0) {
     if ((unsigned long)-change > self->num) {
       fprintf(stderr, 
@@ -454,10 +592,14 @@ void dynamic_arr_resize(dynamic_arr* self, long change, const bool explicit_size
       abort();
     }
 
-    const unsigned long back_deadzone = self->__cap__ - self->num;
-    newcap -= (back_deadzone >> 1);
-  } else if (self->num + change >= self->__cap__) {
-    newcap += (self->__cap__ >> 1) + 1;
+    /* Shrink once three quarters are unused, so alternating removals and insertions don't reallocate every time */
+    const unsigned long remaining = used + change;
+    if (remaining > (self->__cap__ >> 2))
+      return;
+    newcap = (remaining << 1) + 1;
+  } else if (used + change >= self->__cap__) {
+    while (used + change >= newcap)
+      newcap += (newcap >> 1) + 1;
   } else {
     return;
   }
@@ -468,7 +610,7 @@ void dynamic_arr_resize(dynamic_arr* self, long change, const bool explicit_size
 #if DEBUG_DYNAMIC_ARR_RESIZE
   printf("realloc: %lu -> %lu\n", self->cap, newcap);
 #endif
-  self->__malloc_start__ = realloc(self->__malloc_start__, newcap * self->element_size);
+  self->__malloc_start__ = dynamic_arr_realloc(self, newcap);
   if (!self->__malloc_start__) {
     fprintf(stderr, 
         "Failed to reallocate memory for dynamic array of old size %lu and new size %lu: %s\n"
@@ -482,35 +624,85 @@ void dynamic_arr_resize(dynamic_arr* self, long change, const bool explicit_size
   return;
 }
 
+uint8_t* dynamic_arr_alloc(const dynamic_arr* self, unsigned long cap) {
+  if (!self->__align__)
+    return blib_malloc(cap * self->element_size);
+
+  void* ptr = NULL;
+  const int error = blib_posix_memalign(&ptr, self->__align__, cap * self->element_size);
+  if (error) {
+    errno = error;
+
+    return NULL;
+  }
+
+  return ptr;
+}
+
+uint8_t* dynamic_arr_realloc(dynamic_arr* self, unsigned long newcap) {
+  if (!self->__align__)
+    return blib_realloc(self->__malloc_start__, newcap * self->element_size);
+
+  /* realloc() doesn't keep the alignment, move the elements by hand */
+  uint8_t* ptr = dynamic_arr_alloc(self, newcap);
+  if (!ptr)
+    return NULL;
+
+  memcpy(ptr, self->__malloc_start__, (newcap < self->__cap__ ? newcap : self->__cap__) * self->element_size);
+  blib_free(self->__malloc_start__);
+
+  return ptr;
+}
+
 void dynamic_arr_move(dynamic_arr* self, long change, unsigned long offset, unsigned long len) {
 #if DEBUG_DYNAMIC_ARR_MOVE
   printf("dynamic_arr_move: %ld %s {%lu SKIP, %lu byte(s)}\n", change, (change > 0 ? "->" : "<-"), offset, len);
 #endif
 
-  if (!change || !len 
-      || (change < 0 ? (unsigned long)(-change) > offset : (unsigned long)change > len))
+  /* Shifting right moves `len' elements from `offset', shifting left drops the first `-change' of them */
+  if (change < 0) {
+    if ((unsigned long)(-change) >= len)
+      return;
+
+    kernel_move(
+        self->__malloc_start__ + index2off(self, offset),
+        self->__malloc_start__ + index2off(self, offset + (-change)),
+        (len - (-change)) * self->element_size);
+
+    return;
+  }
+
+  if (!change || !len)
     return;
 
-  if (change < 0) {
-    for (unsigned long i = offset + (-change); i < offset + len; i++)
-      memcpy(
-          self->__malloc_start__ + index2off(self, i + change), 
-          self->__malloc_start__ + index2off(self, i), 
-          self->element_size);
+  kernel_move(
+      self->__malloc_start__ + index2off(self, offset + change),
+      self->__malloc_start__ + index2off(self, offset),
+      len * self->element_size);
 
+  return;
+}
+
+void dynamic_arr_swap(dynamic_arr* self, unsigned long off1, unsigned long off2, unsigned long len) {
+  if ((off1 < off2 ? off2 - off1 : off1 - off2) >= len) {
+    kernel_swap(self->__malloc_start__ + off1, self->__malloc_start__ + off2, len);
     return;
   }
 
-  for (unsigned long i = offset + len - change; i > offset; i--)
-    memcpy(
-        self->__malloc_start__ + index2off(self, i + change), 
-        self->__malloc_start__ + index2off(self, i), 
-        self->element_size);
+  /* Overlapping ranges are swapped through the stack, the spare capacity of the array may be shorter than `len' */
+  uint8_t buffer[256];
 
-  memcpy(
-      self->__malloc_start__ + index2off(self, offset + change), 
-      self->__malloc_start__ + index2off(self, offset), 
-      self->element_size);
+  while (len) {
+    const unsigned long chunk = (len < sizeof(buffer) ? len : sizeof(buffer));
+
+    memcpy(buffer, self->__malloc_start__ + off1, chunk);
+    memmove(self->__malloc_start__ + off1, self->__malloc_start__ + off2, chunk);
+    memcpy(self->__malloc_start__ + off2, buffer, chunk);
+
+    off1 += chunk;
+    off2 += chunk;
+    len -= chunk;
+  }
 
   return;
 }
@@ -0,0 +1,369 @@
+#include <blib/datastructures/arrays/packed.h>
+#include <blib/memory/alloc.h>
+#include <blib/memory/kernels.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define RAW_WORDS (PACKED_ARR_BLOCK * 2) /* Words of a block of unpacked 64-bit integers */
+
+#if DISABLE_RUNTIME_BOUNDS_CHECKS
+#define check_range(self, operation, index, number)
+#else
+#define check_range(self, operation, index, number) \
+  do {                                              \
+    if (index > self->num || number > self->num - index) { \
+      fprintf(stderr,                               \
+          "Attempt to " operation " %lu element(s) at index %lu of packed array of element count %lu!\n" \
+          "=== ABORT ===\n",                        \
+          (unsigned long)(number), index, self->num); \
+      abort();                                      \
+    }                                               \
+  } while(0)
+#endif
+
+/* Differences are zigzag encoded, so small negative ones take few bits as well */
+#define zigzag32(d) (((uint32_t)(d) << 1) ^ (uint32_t)((int32_t)(d) >> 31))
+#define zigzag64(d) (((uint64_t)(d) << 1) ^ (uint64_t)((int64_t)(d) >> 63))
+#define unzigzag32(z) (((uint32_t)(z) >> 1) ^ -((uint32_t)(z) & 1))
+#define unzigzag64(z) (((uint64_t)(z) >> 1) ^ -((uint64_t)(z) & 1))
+
+enum packed_arr_mode {
+  PACKED_FOR, /* Offsets from the smallest integer */
+  PACKED_DELTA, /* Differences to the integer four before, the first four to the first one */
+  PACKED_RAW, /* 64-bit integers as they are */
+};
+
+typedef struct {
+  uint64_t base; /* Smallest integer, or the first one of delta blocks */
+  unsigned long offset; /* Index of the first word of the block */
+  uint8_t bits; /* Bits of every offset or difference */
+  uint8_t mode; /* How the block is stored (see `packed_arr_mode') */
+} packed_arr_block;
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+unsigned int packed_arr_bits(uint64_t max);
+void packed_arr_encode(packed_arr* self, const void* elements);
+void packed_arr_decode(const packed_arr* self, unsigned long block, void* out);
+uint32_t packed_arr_extract(const uint32_t* words, unsigned int bits, unsigned int i);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+packed_arr __intern_packed_arr_new(unsigned int element_size) {
+  if (element_size != sizeof(uint32_t) && element_size != sizeof(uint64_t)) {
+    fprintf(stderr,
+        "Attempt to create packed array of integers of %u bytes, only 4 and 8 are supported!\n"
+        "=== ABORT ===\n",
+        element_size);
+
+    abort();
+  }
+
+  packed_arr self = {
+    .num = 0,
+    .element_size = element_size,
+    .__blocks__ = dynamic_arr_new(packed_arr_block),
+    .__words__ = dynamic_arr_new(uint32_t),
+    .__tail__ = blib_malloc(PACKED_ARR_BLOCK * element_size),
+    .__tail_num__ = 0,
+  };
+
+  if (!self.__tail__) {
+    fprintf(stderr,
+        "Failed to allocate tail of packed array: %s\n"
+        "=== ABORT ===\n",
+        strerror(errno));
+
+    abort();
+  }
+
+  return self;
+}
+
+packed_arr packed_arr_from_dynamic(const dynamic_arr* src) {
+  packed_arr self = __intern_packed_arr_new(src->element_size);
+  packed_arr_bulk_append(&self, dynamic_arr_get_start(src), src->num);
+
+  return self;
+} /* packed_arr_from_dynamic */
+
+dynamic_arr packed_arr_to_dynamic(const packed_arr* self) {
+  dynamic_arr arr = __intern_dynamic_generic_arr_new(self->element_size);
+  if (!self->num)
+    return arr;
+
+  dynamic_arr_resize_to(&arr, NULL, self->num);
+  packed_arr_bulk_peek(self, 0, dynamic_arr_get_start(&arr), self->num);
+
+  return arr;
+} /* packed_arr_to_dynamic */
+
+void packed_arr_append(packed_arr* self, const void* element) {
+  memcpy((uint8_t*)self->__tail__ + self->__tail_num__ * self->element_size, element, self->element_size);
+  self->num++;
+
+  if (++self->__tail_num__ == PACKED_ARR_BLOCK) {
+    packed_arr_encode(self, self->__tail__);
+    self->__tail_num__ = 0;
+  }
+
+  return;
+} /* packed_arr_append */
+
+void packed_arr_bulk_append(packed_arr* self, const void* elements, unsigned long num) {
+  const uint8_t* src = elements;
+  self->num += num;
+
+  /* The tail is filled up first, whole blocks after it are packed straight from the source */
+  if (self->__tail_num__) {
+    const unsigned long take = (num < PACKED_ARR_BLOCK - self->__tail_num__ ? num : PACKED_ARR_BLOCK - self->__tail_num__);
+    memcpy((uint8_t*)self->__tail__ + self->__tail_num__ * self->element_size, src, take * self->element_size);
+    self->__tail_num__ += take;
+    src += take * self->element_size;
+    num -= take;
+
+    if (self->__tail_num__ < PACKED_ARR_BLOCK)
+      return;
+    packed_arr_encode(self, self->__tail__);
+    self->__tail_num__ = 0;
+  }
+
+  dynamic_arr_reserve(&self->__blocks__, num / PACKED_ARR_BLOCK);
+  for (; num >= PACKED_ARR_BLOCK; num -= PACKED_ARR_BLOCK, src += PACKED_ARR_BLOCK * self->element_size)
+    packed_arr_encode(self, src);
+
+  memcpy(self->__tail__, src, num * self->element_size);
+  self->__tail_num__ = num;
+
+  return;
+} /* packed_arr_bulk_append */
+
+void packed_arr_peek(const packed_arr* self, unsigned long index, void* out) {
+  check_range(self, "peek", index, 1UL);
+
+  const unsigned long block = index / PACKED_ARR_BLOCK;
+  const unsigned int i = index % PACKED_ARR_BLOCK;
+  if (block == self->__blocks__.num) {
+    memcpy(out, (const uint8_t*)self->__tail__ + i * self->element_size, self->element_size);
+    return;
+  }
+
+  const packed_arr_block* header = (const packed_arr_block*)dynamic_arr_get_start(&self->__blocks__) + block;
+  const uint32_t* words = (const uint32_t*)dynamic_arr_get_start(&self->__words__) + header->offset;
+  uint64_t value = header->base;
+
+  switch (header->mode) {
+    case PACKED_FOR:
+      value += packed_arr_extract(words, header->bits, i);
+      break;
+    case PACKED_DELTA:
+      /* Every lane is a chain of differences from the first integer */
+      for (unsigned int j = i % 4; j <= i; j += 4) {
+        const uint32_t z = packed_arr_extract(words, header->bits, j);
+        value += (self->element_size == sizeof(uint32_t) ? (uint64_t)unzigzag32(z) : unzigzag64(z));
+      }
+      break;
+    case PACKED_RAW:
+      memcpy(&value, words + 2 * i, sizeof(value));
+      break;
+  }
+
+  if (self->element_size == sizeof(uint32_t)) {
+    const uint32_t narrow = (uint32_t)value;
+    memcpy(out, &narrow, sizeof(narrow));
+  } else {
+    memcpy(out, &value, sizeof(value));
+  }
+
+  return;
+} /* packed_arr_peek */
+
+void packed_arr_bulk_peek(const packed_arr* self, unsigned long index, void* out, unsigned long num) {
+  check_range(self, "bulk peek", index, num);
+
+  uint8_t* dst = out;
+  uint64_t scratch[PACKED_ARR_BLOCK];
+
+  while (num) {
+    const unsigned long block = index / PACKED_ARR_BLOCK;
+    const unsigned long i = index % PACKED_ARR_BLOCK;
+    const unsigned long take = (num < PACKED_ARR_BLOCK - i ? num : PACKED_ARR_BLOCK - i);
+
+    if (block == self->__blocks__.num) {
+      memcpy(dst, (const uint8_t*)self->__tail__ + i * self->element_size, take * self->element_size);
+    } else if (take == PACKED_ARR_BLOCK) {
+      packed_arr_decode(self, block, dst);
+    } else {
+      packed_arr_decode(self, block, scratch);
+      memcpy(dst, (const uint8_t*)scratch + i * self->element_size, take * self->element_size);
+    }
+
+    dst += take * self->element_size;
+    index += take;
+    num -= take;
+  }
+
+  return;
+} /* packed_arr_bulk_peek */
+
+packed_arr_stats packed_arr_stats_get(const packed_arr* self) {
+  packed_arr_stats stats = {
+    .blocks = self->__blocks__.num,
+    .bytes = self->__blocks__.num * sizeof(packed_arr_block) + self->__words__.num * sizeof(uint32_t)
+      + self->__tail_num__ * self->element_size,
+    .raw_bytes = self->num * self->element_size,
+  };
+
+  const packed_arr_block* headers = dynamic_arr_get_start(&self->__blocks__);
+  for (unsigned long b = 0; b < self->__blocks__.num; b++) {
+    stats.for_blocks += (headers[b].mode == PACKED_FOR);
+    stats.delta_blocks += (headers[b].mode == PACKED_DELTA);
+    stats.raw_blocks += (headers[b].mode == PACKED_RAW);
+  }
+
+  return stats;
+} /* packed_arr_stats_get */
+
+void packed_arr_cleanup(packed_arr* self) {
+  dynamic_arr_cleanup(&self->__blocks__);
+  dynamic_arr_cleanup(&self->__words__);
+  blib_free(self->__tail__);
+
+  *self = (packed_arr) {0};
+
+  return;
+} /* packed_arr_cleanup */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+unsigned int packed_arr_bits(uint64_t max) {
+  return (max ? 64 - __builtin_clzll(max) : 0);
+}
+
+/* Packs a block, as offsets or differences, whichever takes fewer bits */
+void packed_arr_encode(packed_arr* self, const void* elements) {
+  uint64_t values[PACKED_ARR_BLOCK];
+  uint32_t residuals[PACKED_ARR_BLOCK];
+  uint32_t packed[RAW_WORDS];
+  const bool wide = (self->element_size == sizeof(uint64_t));
+
+  if (wide) {
+    memcpy(values, elements, sizeof(values));
+  } else {
+    const uint32_t* narrow = elements;
+    for (int i = 0; i < PACKED_ARR_BLOCK; i++)
+      values[i] = narrow[i];
+  }
+
+  uint64_t min = values[0], max = values[0], deltas = 0;
+  for (int i = 0; i < PACKED_ARR_BLOCK; i++) {
+    min = (values[i] < min ? values[i] : min);
+    max = (values[i] > max ? values[i] : max);
+
+    const uint64_t prev = values[(i < 4 ? 0 : i - 4)];
+    deltas |= (wide ? zigzag64(values[i] - prev) : zigzag32((uint32_t)values[i] - (uint32_t)prev));
+  }
+
+  /* Offsets are preferred on a tie, they can be read without summing */
+  const unsigned int for_bits = packed_arr_bits(max - min);
+  const unsigned int delta_bits = packed_arr_bits(deltas);
+
+  packed_arr_block header = { .offset = self->__words__.num };
+  if (for_bits <= delta_bits && for_bits <= 32) {
+    header.mode = PACKED_FOR;
+    header.bits = for_bits;
+    header.base = min;
+    for (int i = 0; i < PACKED_ARR_BLOCK; i++)
+      residuals[i] = (uint32_t)(values[i] - min);
+  } else if (delta_bits <= 32) {
+    header.mode = PACKED_DELTA;
+    header.bits = delta_bits;
+    header.base = values[0];
+    for (int i = 0; i < PACKED_ARR_BLOCK; i++) {
+      const uint64_t prev = values[(i < 4 ? 0 : i - 4)];
+      residuals[i] = (uint32_t)(wide ? zigzag64(values[i] - prev) : zigzag32((uint32_t)values[i] - (uint32_t)prev));
+    }
+  } else {
+    header.mode = PACKED_RAW;
+    header.bits = 64;
+    dynamic_arr_bulk_append(&self->__words__, values, RAW_WORDS);
+    dynamic_arr_append(&self->__blocks__, &header);
+    return;
+  }
+
+  kernel_pack(packed, residuals, header.bits);
+  dynamic_arr_bulk_append(&self->__words__, packed, header.bits * 4UL);
+  dynamic_arr_append(&self->__blocks__, &header);
+}
+
+/* Unpacks a whole block into PACKED_ARR_BLOCK integers */
+void packed_arr_decode(const packed_arr* self, unsigned long block, void* out) {
+  const packed_arr_block* header = (const packed_arr_block*)dynamic_arr_get_start(&self->__blocks__) + block;
+  const uint32_t* words = (const uint32_t*)dynamic_arr_get_start(&self->__words__) + header->offset;
+
+  if (header->mode == PACKED_RAW) {
+    memcpy(out, words, RAW_WORDS * sizeof(uint32_t));
+    return;
+  }
+
+  /* Narrow integers are unpacked in place, the loops below vectorize */
+  if (self->element_size == sizeof(uint32_t)) {
+    uint32_t* values = out;
+    const uint32_t base = (uint32_t)header->base;
+    kernel_unpack(values, words, header->bits);
+
+    if (header->mode == PACKED_FOR) {
+      for (int i = 0; i < PACKED_ARR_BLOCK; i++)
+        values[i] += base;
+    } else {
+      for (int i = 0; i < 4; i++)
+        values[i] = base + unzigzag32(values[i]);
+      for (int i = 4; i < PACKED_ARR_BLOCK; i++)
+        values[i] = values[i - 4] + unzigzag32(values[i]);
+    }
+
+    return;
+  }
+
+  uint32_t residuals[PACKED_ARR_BLOCK];
+  uint64_t* values = out;
+  kernel_unpack(residuals, words, header->bits);
+
+  if (header->mode == PACKED_FOR) {
+    for (int i = 0; i < PACKED_ARR_BLOCK; i++)
+      values[i] = header->base + residuals[i];
+  } else {
+    for (int i = 0; i < 4; i++)
+      values[i] = header->base + unzigzag64(residuals[i]);
+    for (int i = 4; i < PACKED_ARR_BLOCK; i++)
+      values[i] = values[i - 4] + unzigzag64(residuals[i]);
+  }
+}
+
+/* Reads integer `i' of a block packed by `kernel_pack()' */
+uint32_t packed_arr_extract(const uint32_t* words, unsigned int bits, unsigned int i) {
+  if (!bits)
+    return 0;
+
+  const unsigned int bit = (i / 4) * bits;
+  const uint32_t* word = words + (bit / 32) * 4 + i % 4;
+
+  uint32_t value = *word >> (bit % 32);
+  if (bit % 32 + bits > 32)
+    value |= word[4] << (32 - bit % 32);
+
+  return (bits < 32 ? value & ((UINT32_C(1) << bits) - 1) : value);
+}
+/* ===================== */
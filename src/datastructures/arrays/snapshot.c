@@ -0,0 +1,360 @@
+#include <blib/datastructures/arrays/snapshot.h>
+#include <blib/memory/alloc.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define CACHE_LINE     64
+#define SPINS          64
+
+/* A thread that found every slot taken reads through the shared counter from then on */
+#define NO_SLOT        (-2)
+#define UNASSIGNED     (-1)
+
+typedef struct snapshot_arr_version {
+  dynamic_arr arr; /* First, readers get a pointer to it */
+  uint64_t retired; /* Epoch the version was replaced in */
+  struct snapshot_arr_version* next; /* Next older retired version */
+} snapshot_arr_version;
+
+typedef struct {
+  uint64_t epoch; /* Announced epoch, 0 if not reading */
+  unsigned long depth; /* Nested reads, only touched by the thread of the slot */
+} __attribute__((aligned(CACHE_LINE))) snapshot_arr_reader;
+
+/* One bit per slot, SNAPSHOT_ARR_MAX_READERS is the width of the map */
+static uint64_t snapshot_arr_slots = 0;
+static __thread int snapshot_arr_thread_slot = UNASSIGNED;
+static pthread_key_t snapshot_arr_key;
+static pthread_once_t snapshot_arr_key_once = PTHREAD_ONCE_INIT;
+static bool snapshot_arr_key_created = false;
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+void snapshot_arr_key_create(void);
+void snapshot_arr_slot_release(void* slot);
+int snapshot_arr_slot_acquire(void);
+snapshot_arr_reader* snapshot_arr_reader_get(snapshot_arr* self);
+
+snapshot_arr_version* snapshot_arr_version_new(dynamic_arr* arr);
+void snapshot_arr_lock(snapshot_arr* self);
+void snapshot_arr_unlock(snapshot_arr* self);
+void snapshot_arr_replace_version(snapshot_arr* self, dynamic_arr* arr);
+bool snapshot_arr_advance(snapshot_arr* self);
+void snapshot_arr_collect(snapshot_arr* self);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+snapshot_arr __intern_snapshot_arr_new(unsigned int element_size) {
+  dynamic_arr empty = __intern_dynamic_generic_arr_new(element_size);
+
+  return snapshot_arr_from_dynamic(&empty);
+} /* __intern_snapshot_arr_new */
+
+snapshot_arr snapshot_arr_from_dynamic(dynamic_arr* src) {
+  snapshot_arr self = {
+    .element_size = src->element_size,
+    .__epoch__ = 1,
+    .__published__ = 1,
+  };
+
+  if (blib_posix_memalign(&self.__readers__, CACHE_LINE, SNAPSHOT_ARR_MAX_READERS * sizeof(snapshot_arr_reader))) {
+    fprintf(stderr,
+        "Failed to allocate reader slots of snapshot array: %s\n"
+        "=== ABORT ===\n",
+        strerror(errno));
+
+    abort();
+  }
+  memset(self.__readers__, 0, SNAPSHOT_ARR_MAX_READERS * sizeof(snapshot_arr_reader));
+
+  self.__current__ = snapshot_arr_version_new(src);
+
+  return self;
+} /* snapshot_arr_from_dynamic */
+
+const dynamic_arr* snapshot_arr_read_begin(snapshot_arr* self) {
+  snapshot_arr_reader* reader = snapshot_arr_reader_get(self);
+
+  /*
+   * The announcement has to be visible before the version is loaded, writers check the
+   * announcements after replacing the version. A stale epoch only delays reclamation.
+   */
+  if (!reader) {
+    __atomic_add_fetch(&self->__overflow__, 1, __ATOMIC_SEQ_CST);
+  } else if (!reader->depth++) {
+    __atomic_exchange_n(&reader->epoch, __atomic_load_n(&self->__epoch__, __ATOMIC_RELAXED), __ATOMIC_SEQ_CST);
+  }
+
+  const snapshot_arr_version* version = __atomic_load_n(&self->__current__, __ATOMIC_SEQ_CST);
+
+  return &version->arr;
+} /* snapshot_arr_read_begin */
+
+void snapshot_arr_read_end(snapshot_arr* self) {
+  snapshot_arr_reader* reader = snapshot_arr_reader_get(self);
+
+  if (!reader)
+    __atomic_sub_fetch(&self->__overflow__, 1, __ATOMIC_RELEASE);
+  else if (!--reader->depth)
+    __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+
+  return;
+} /* snapshot_arr_read_end */
+
+dynamic_arr snapshot_arr_copy(snapshot_arr* self) {
+  const dynamic_arr* version = snapshot_arr_read_begin(self);
+  dynamic_arr copy = dynamic_arr_copy(version);
+  snapshot_arr_read_end(self);
+
+  return copy;
+} /* snapshot_arr_copy */
+
+void snapshot_arr_publish(snapshot_arr* self, dynamic_arr* version) {
+  if (version->element_size != self->element_size) {
+    fprintf(stderr,
+        "Attempt to publish version with element size %u in snapshot array with element size %u!\n"
+        "=== ABORT ===\n",
+        version->element_size, self->element_size);
+
+    abort();
+  }
+
+  snapshot_arr_lock(self);
+  snapshot_arr_replace_version(self, version);
+  snapshot_arr_unlock(self);
+
+  return;
+} /* snapshot_arr_publish */
+
+void snapshot_arr_update(snapshot_arr* self, void (*edit)(dynamic_arr* version, void* data), void* data) {
+  snapshot_arr_lock(self);
+
+  /* Only writers replace the version and they are locked out, so it can't be retired meanwhile */
+  const snapshot_arr_version* current = __atomic_load_n(&self->__current__, __ATOMIC_RELAXED);
+  dynamic_arr version = dynamic_arr_copy(&current->arr);
+  edit(&version, data);
+
+  if (version.element_size != self->element_size) {
+    fprintf(stderr,
+        "Update changed element size of snapshot array from %u to %u!\n"
+        "=== ABORT ===\n",
+        self->element_size, version.element_size);
+
+    abort();
+  }
+
+  snapshot_arr_replace_version(self, &version);
+  snapshot_arr_unlock(self);
+
+  return;
+} /* snapshot_arr_update */
+
+unsigned long snapshot_arr_reclaim(snapshot_arr* self) {
+  snapshot_arr_lock(self);
+
+  /* Versions retired in the current epoch are freed two epochs later */
+  for (int i = 0; i < 2 && self->__retired__ && snapshot_arr_advance(self); i++)
+    snapshot_arr_collect(self);
+  const unsigned long left = self->__retired_count__;
+
+  snapshot_arr_unlock(self);
+
+  return left;
+} /* snapshot_arr_reclaim */
+
+snapshot_arr_stats snapshot_arr_stats_get(const snapshot_arr* self) {
+  return (snapshot_arr_stats) {
+    .published = __atomic_load_n(&self->__published__, __ATOMIC_RELAXED),
+    .retired = __atomic_load_n(&self->__retired_count__, __ATOMIC_RELAXED),
+    .epoch = __atomic_load_n(&self->__epoch__, __ATOMIC_RELAXED),
+  };
+} /* snapshot_arr_stats_get */
+
+void snapshot_arr_cleanup(snapshot_arr* self) {
+  snapshot_arr_version* version = self->__retired__;
+  while (version) {
+    snapshot_arr_version* next = version->next;
+    dynamic_arr_cleanup(&version->arr);
+    blib_free(version);
+    version = next;
+  }
+
+  version = self->__current__;
+  if (version) {
+    dynamic_arr_cleanup(&version->arr);
+    blib_free(version);
+  }
+
+  blib_free(self->__readers__);
+
+  *self = (snapshot_arr) {0};
+
+  return;
+} /* snapshot_arr_cleanup */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+void snapshot_arr_key_create(void) {
+  snapshot_arr_key_created = !pthread_key_create(&snapshot_arr_key, snapshot_arr_slot_release);
+}
+
+void snapshot_arr_slot_release(void* slot) {
+  const int index = (int)((uintptr_t)slot - 1);
+  __atomic_and_fetch(&snapshot_arr_slots, ~(UINT64_C(1) << index), __ATOMIC_RELEASE);
+}
+
+int snapshot_arr_slot_acquire(void) {
+  pthread_once(&snapshot_arr_key_once, snapshot_arr_key_create);
+
+  /* Without the key a slot would never be released again */
+  if (!snapshot_arr_key_created) {
+    snapshot_arr_thread_slot = NO_SLOT;
+    return NO_SLOT;
+  }
+
+  uint64_t used = __atomic_load_n(&snapshot_arr_slots, __ATOMIC_RELAXED);
+  int slot;
+  do {
+    if (!~used) {
+      snapshot_arr_thread_slot = NO_SLOT;
+      return NO_SLOT;
+    }
+    slot = __builtin_ctzll(~used);
+  } while (!__atomic_compare_exchange_n(&snapshot_arr_slots, &used, used | (UINT64_C(1) << slot), true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+  if (pthread_setspecific(snapshot_arr_key, (void*)((uintptr_t)slot + 1))) {
+    snapshot_arr_slot_release((void*)((uintptr_t)slot + 1));
+    snapshot_arr_thread_slot = NO_SLOT;
+    return NO_SLOT;
+  }
+
+  snapshot_arr_thread_slot = slot;
+  return slot;
+}
+
+/* A slot belongs to one live thread, it is idle in every array once the thread stopped reading */
+snapshot_arr_reader* snapshot_arr_reader_get(snapshot_arr* self) {
+  int slot = snapshot_arr_thread_slot;
+  if (slot == NO_SLOT)
+    return NULL;
+  if (slot == UNASSIGNED) {
+    slot = snapshot_arr_slot_acquire();
+    if (slot == NO_SLOT)
+      return NULL;
+  }
+
+  return (snapshot_arr_reader*)self->__readers__ + slot;
+}
+
+snapshot_arr_version* snapshot_arr_version_new(dynamic_arr* arr) {
+  snapshot_arr_version* version = blib_malloc(sizeof(*version));
+  if (!version) {
+    fprintf(stderr,
+        "Failed to allocate version of snapshot array: %s\n"
+        "=== ABORT ===\n",
+        strerror(errno));
+
+    abort();
+  }
+
+  /* Copies handed out share the memory, published versions are never written to */
+  *version = (snapshot_arr_version) { .arr = *arr };
+  dynamic_arr_enable_cow(&version->arr);
+  *arr = (dynamic_arr) {0};
+
+  return version;
+}
+
+void snapshot_arr_lock(snapshot_arr* self) {
+  while (__atomic_test_and_set(&self->__lock__, __ATOMIC_ACQUIRE)) {
+    int spins = 0;
+    while (__atomic_load_n(&self->__lock__, __ATOMIC_RELAXED)) {
+      if (++spins == SPINS) {
+        sched_yield();
+        spins = 0;
+      }
+    }
+  }
+}
+
+void snapshot_arr_unlock(snapshot_arr* self) {
+  __atomic_clear(&self->__lock__, __ATOMIC_RELEASE);
+}
+
+/* Needs the lock */
+void snapshot_arr_replace_version(snapshot_arr* self, dynamic_arr* arr) {
+  snapshot_arr_version* version = snapshot_arr_version_new(arr);
+
+  /* Readers that load the old version after this announced an epoch the retirement sees */
+  snapshot_arr_version* old = __atomic_exchange_n(&self->__current__, version, __ATOMIC_SEQ_CST);
+  old->retired = __atomic_load_n(&self->__epoch__, __ATOMIC_SEQ_CST);
+  old->next = self->__retired__;
+  self->__retired__ = old;
+
+  __atomic_store_n(&self->__retired_count__, self->__retired_count__ + 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&self->__published__, self->__published__ + 1, __ATOMIC_RELAXED);
+
+  for (int i = 0; i < 2 && snapshot_arr_advance(self); i++)
+    snapshot_arr_collect(self);
+}
+
+/* Needs the lock, the epoch only advances once every reader announced the current one */
+bool snapshot_arr_advance(snapshot_arr* self) {
+  const uint64_t epoch = __atomic_load_n(&self->__epoch__, __ATOMIC_RELAXED);
+
+  if (__atomic_load_n(&self->__overflow__, __ATOMIC_SEQ_CST))
+    return false;
+
+  const snapshot_arr_reader* readers = self->__readers__;
+  for (int r = 0; r < SNAPSHOT_ARR_MAX_READERS; r++) {
+    const uint64_t announced = __atomic_load_n(&readers[r].epoch, __ATOMIC_SEQ_CST);
+    if (announced && announced != epoch)
+      return false;
+  }
+
+  __atomic_store_n(&self->__epoch__, epoch + 1, __ATOMIC_SEQ_CST);
+
+  return true;
+}
+
+/*
+ * Needs the lock. A reader announces at most the epoch a version was retired in, so versions
+ * retired two epochs ago can't be in use.
+ */
+void snapshot_arr_collect(snapshot_arr* self) {
+  const uint64_t epoch = __atomic_load_n(&self->__epoch__, __ATOMIC_RELAXED);
+
+  /* Newest first, everything from the first old enough version on is old enough */
+  snapshot_arr_version** link = (snapshot_arr_version**)&self->__retired__;
+  while (*link && (*link)->retired + 2 > epoch)
+    link = &(*link)->next;
+
+  snapshot_arr_version* version = *link;
+  *link = NULL;
+
+  unsigned long freed = 0;
+  while (version) {
+    snapshot_arr_version* next = version->next;
+    dynamic_arr_cleanup(&version->arr);
+    blib_free(version);
+    version = next;
+    freed++;
+  }
+
+  __atomic_store_n(&self->__retired_count__, self->__retired_count__ - freed, __ATOMIC_RELAXED);
+}
+/* ===================== */
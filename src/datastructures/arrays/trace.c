@@ -0,0 +1,186 @@
+#include <blib/datastructures/arrays/trace.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+/* "BLIBTRC" and the version of the format */
+#define TRACE_MAGIC   "BLIBTRC"
+#define TRACE_VERSION 1
+
+/* Longest varint of 64 bits */
+#define VARINT_MAX 10
+/* Op and six varints */
+#define RECORD_MAX (1 + 6 * VARINT_MAX)
+/* ================== */
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+unsigned long trace_put_varint(uint8_t* buffer, uint64_t value);
+bool trace_get_varint(FILE* file, uint64_t* value);
+/* ================================== */
+
+bool __intern_dynamic_arr_tracing;
+
+static FILE* trace_file;
+static unsigned long next_id;
+
+/* =============
+ * API Functions
+ * ============= */
+bool dynamic_arr_trace_start(const char* path) {
+  if (trace_file) {
+    errno = EBUSY;
+    return false;
+  }
+
+  FILE* file = fopen(path, "wb");
+  if (!file)
+    return false;
+
+  const uint8_t header[8] = { 'B', 'L', 'I', 'B', 'T', 'R', 'C', TRACE_VERSION };
+  if (fwrite(header, sizeof(header), 1, file) != 1) {
+    const int error = errno;
+    fclose(file);
+    errno = error;
+
+    return false;
+  }
+
+  trace_file = file;
+  __atomic_store_n(&__intern_dynamic_arr_tracing, true, __ATOMIC_RELEASE);
+
+  return true;
+} /* dynamic_arr_trace_start */
+
+void dynamic_arr_trace_stop(void) {
+  if (!trace_file)
+    return;
+
+  __atomic_store_n(&__intern_dynamic_arr_tracing, false, __ATOMIC_RELEASE);
+  fclose(trace_file);
+  trace_file = NULL;
+
+  return;
+} /* dynamic_arr_trace_stop */
+
+FILE* dynamic_arr_trace_open(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (!file)
+    return NULL;
+
+  uint8_t header[8];
+  if (fread(header, sizeof(header), 1, file) != 1
+      || memcmp(header, TRACE_MAGIC, sizeof(header) - 1) || header[7] != TRACE_VERSION) {
+    fclose(file);
+    errno = EINVAL;
+
+    return NULL;
+  }
+
+  return file;
+} /* dynamic_arr_trace_open */
+
+bool dynamic_arr_trace_read(FILE* file, dynamic_arr_trace_record* record) {
+  const int op = fgetc(file);
+  if (op == EOF || op >= DYNAMIC_ARR_TRACE_OPS)
+    return false;
+
+  uint64_t fields[6];
+  for (int i = 0; i < 6; i++)
+    if (!trace_get_varint(file, &fields[i]))
+      return false;
+
+  *record = (dynamic_arr_trace_record) {
+    .op = op,
+    .array = fields[0],
+    .element_size = fields[1],
+    .size = fields[2],
+    .index = fields[3],
+    .other = fields[4],
+    .count = fields[5],
+  };
+
+  return true;
+} /* dynamic_arr_trace_read */
+
+const char* dynamic_arr_trace_op_name(enum dynamic_arr_trace_op op) {
+  static const char* const names[DYNAMIC_ARR_TRACE_OPS] = {
+    "new", "copy", "enable_cow", "replace", "bulk_replace", "set", "flip", "bulk_flip",
+    "peek", "bulk_peek", "append", "bulk_append", "prepend", "bulk_prepend",
+    "insert_at", "bulk_insert_at", "precate", "quick_precate", "truncate",
+    "resize_to", "reserve", "trim", "remove_at", "bulk_remove_at", "quick_remove_at", "cleanup",
+  };
+
+  return ((unsigned int)op < DYNAMIC_ARR_TRACE_OPS ? names[op] : "unknown");
+} /* dynamic_arr_trace_op_name */
+
+unsigned long __intern_dynamic_arr_next_id(void) {
+  return __atomic_add_fetch(&next_id, 1, __ATOMIC_RELAXED);
+}
+
+void __intern_dynamic_arr_trace(const dynamic_arr* self, enum dynamic_arr_trace_op op, unsigned long index, unsigned long other, unsigned long count) {
+  uint8_t buffer[RECORD_MAX];
+  unsigned long len = 0;
+
+  buffer[len++] = op;
+  len += trace_put_varint(buffer + len, self->__id__);
+  len += trace_put_varint(buffer + len, self->element_size);
+  len += trace_put_varint(buffer + len, self->num);
+  len += trace_put_varint(buffer + len, index);
+  len += trace_put_varint(buffer + len, other);
+  len += trace_put_varint(buffer + len, count);
+
+  /* A single write per record, stdio locks the stream so threads don't interleave */
+  fwrite(buffer, len, 1, trace_file);
+
+  return;
+}
+
+void __intern_dynamic_arr_trace_num(const dynamic_arr* self, unsigned long num) {
+  /* Growing fills reserved capacity like a bulk append, shrinking drops the last elements */
+  if (num > self->num)
+    __intern_dynamic_arr_trace(self, DYNAMIC_ARR_TRACE_BULK_APPEND, 0, 0, num - self->num);
+  else if (num < self->num)
+    __intern_dynamic_arr_trace(self, DYNAMIC_ARR_TRACE_RESIZE_TO, 0, 0, num);
+
+  return;
+}
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+unsigned long trace_put_varint(uint8_t* buffer, uint64_t value) {
+  unsigned long len = 0;
+
+  while (value >= 0x80) {
+    buffer[len++] = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+  buffer[len++] = (uint8_t)value;
+
+  return len;
+}
+
+bool trace_get_varint(FILE* file, uint64_t* value) {
+  *value = 0;
+
+  for (int shift = 0; shift < 7 * VARINT_MAX; shift += 7) {
+    const int byte = fgetc(file);
+    if (byte == EOF)
+      return false;
+
+    *value |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+
+  return false;
+}
+/* ===================== */
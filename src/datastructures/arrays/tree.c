@@ -0,0 +1,645 @@
+#include <blib/datastructures/arrays/tree.h>
+#include <blib/memory/alloc.h>
+#include <blib/memory/pool.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define FANOUT      32
+#define LEAF_HEADER 32 /* Keeps the elements aligned to 16 bytes */
+
+#if DISABLE_RUNTIME_BOUNDS_CHECKS
+#define check_range(self, operation, index, number)
+#define check_position(self, operation, index)
+#else
+#define check_range(self, operation, index, number) \
+  do {                                              \
+    if (index > self->num || number > self->num - index) { \
+      fprintf(stderr,                               \
+          "Attempt to " operation " %lu element(s) at index %lu of tree array of element count %lu!\n" \
+          "=== ABORT ===\n",                        \
+          (unsigned long)(number), index, self->num); \
+      abort();                                      \
+    }                                               \
+  } while(0)
+
+/* Insertions and iterators can also start at the end */
+#define check_position(self, operation, index) \
+  do {                                         \
+    if (index > self->num) {                   \
+      fprintf(stderr,                          \
+          "Attempt to " operation " at index %lu of tree array of element count %lu!\n" \
+          "=== ABORT ===\n",                   \
+          index, self->num);                   \
+      abort();                                 \
+    }                                          \
+  } while(0)
+#endif
+
+#define leaf_data(leaf) ((uint8_t*)(leaf) + LEAF_HEADER)
+#define leaf_at(self, leaf, i) (leaf_data(leaf) + (unsigned long)(i) * (self)->element_size)
+
+typedef struct tree_arr_leaf {
+  struct tree_arr_leaf* next; /* Next leaf in order */
+  unsigned long count; /* Elements in the leaf */
+} tree_arr_leaf;
+
+typedef struct {
+  unsigned long num; /* Number of children */
+  unsigned long counts[FANOUT]; /* Elements under every child */
+  void* children[FANOUT];
+} tree_arr_node;
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+tree_arr_leaf* tree_arr_leaf_new(tree_arr* self);
+tree_arr_node* tree_arr_node_new(tree_arr* self);
+unsigned long tree_arr_node_sum(const tree_arr_node* node, unsigned long from, unsigned long to);
+
+tree_arr_leaf* tree_arr_find(const tree_arr* self, unsigned long* index);
+void tree_arr_transfer(const tree_arr* self, unsigned long index, uint8_t* buffer, unsigned long num, bool store);
+
+void tree_arr_insert_chunk(tree_arr* self, unsigned long index, const uint8_t* elements, unsigned long num);
+unsigned long tree_arr_insert_rec(tree_arr* self, void* node, unsigned int height, unsigned long index, const uint8_t* elements, unsigned long num, void** split);
+unsigned long tree_arr_remove_rec(tree_arr* self, void* node, unsigned int height, unsigned long index, unsigned long num);
+void tree_arr_rebalance(tree_arr* self, tree_arr_node* node, unsigned long child, unsigned int height);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+tree_arr __intern_tree_arr_new(unsigned int element_size) {
+  unsigned long leaf_cap = (element_size ? TREE_ARR_LEAF_BYTES / element_size : TREE_ARR_LEAF_BYTES);
+  if (leaf_cap < TREE_ARR_MIN_LEAF)
+    leaf_cap = TREE_ARR_MIN_LEAF;
+
+  /* Leaves of a multiple of 16 bytes are aligned to 16 bytes by the pool */
+  const unsigned long leaf_size = (LEAF_HEADER + leaf_cap * element_size + 15) & ~15UL;
+
+  return (tree_arr) {
+    .num = 0,
+    .element_size = element_size,
+    .__leaf_cap__ = leaf_cap,
+    .__leaves__ = pool_new_sized(leaf_size),
+    .__nodes__ = pool_new(tree_arr_node),
+  };
+}
+
+tree_arr tree_arr_from_dynamic(const dynamic_arr* src) {
+  tree_arr self = __intern_tree_arr_new(src->element_size);
+  if (!src->num)
+    return self;
+
+  const uint8_t* data = dynamic_arr_get_start(src);
+  unsigned long level_num = (src->num + self.__leaf_cap__ - 1) / self.__leaf_cap__;
+  void** level = blib_malloc(level_num * sizeof(void*));
+  unsigned long* counts = blib_malloc(level_num * sizeof(unsigned long));
+  if (!level || !counts) {
+    fprintf(stderr,
+        "Failed to allocate memory for %lu leaves of tree array: %s\n"
+        "=== ABORT ===\n",
+        level_num, strerror(errno));
+
+    abort();
+  }
+
+  /* Leaves and nodes are filled evenly, bottom-up */
+  tree_arr_leaf* prev = NULL;
+  for (unsigned long i = 0; i < level_num; i++) {
+    tree_arr_leaf* leaf = tree_arr_leaf_new(&self);
+    leaf->count = src->num / level_num + (i < src->num % level_num);
+    memcpy(leaf_data(leaf), data, leaf->count * self.element_size);
+    data += leaf->count * self.element_size;
+
+    if (prev)
+      prev->next = leaf;
+    else
+      self.__first__ = leaf;
+    prev = leaf;
+
+    level[i] = leaf;
+    counts[i] = leaf->count;
+  }
+
+  while (level_num > 1) {
+    const unsigned long parents = (level_num + FANOUT - 1) / FANOUT;
+    unsigned long child = 0;
+
+    /* Node `p' only reads children at `p' or after, so the level is rewritten in place */
+    for (unsigned long p = 0; p < parents; p++) {
+      tree_arr_node* node = tree_arr_node_new(&self);
+      node->num = level_num / parents + (p < level_num % parents);
+      memcpy(node->children, level + child, node->num * sizeof(void*));
+      memcpy(node->counts, counts + child, node->num * sizeof(unsigned long));
+      child += node->num;
+
+      level[p] = node;
+      counts[p] = tree_arr_node_sum(node, 0, node->num);
+    }
+
+    level_num = parents;
+    self.__height__++;
+  }
+
+  self.__root__ = level[0];
+  self.num = src->num;
+
+  blib_free(level);
+  blib_free(counts);
+
+  return self;
+} /* tree_arr_from_dynamic */
+
+dynamic_arr tree_arr_to_dynamic(const tree_arr* self) {
+  dynamic_arr arr = __intern_dynamic_generic_arr_new(self->element_size);
+  if (!self->num)
+    return arr;
+
+  dynamic_arr_reserve(&arr, self->num);
+  for (const tree_arr_leaf* leaf = self->__first__; leaf; leaf = leaf->next) {
+    if (leaf->count)
+      dynamic_arr_bulk_append(&arr, leaf_data(leaf), leaf->count);
+  }
+
+  return arr;
+} /* tree_arr_to_dynamic */
+
+void tree_arr_peek(const tree_arr* self, unsigned long index, void* out) {
+  check_range(self, "peek", index, 1);
+
+  const tree_arr_leaf* leaf = tree_arr_find(self, &index);
+  memcpy(out, leaf_at(self, leaf, index), self->element_size);
+
+  return;
+} /* tree_arr_peek */
+
+void tree_arr_bulk_peek(const tree_arr* self, unsigned long index, void* out, unsigned long num) {
+  check_range(self, "bulk-peek", index, num);
+
+  tree_arr_transfer(self, index, out, num, false);
+
+  return;
+} /* tree_arr_bulk_peek */
+
+void* tree_arr_get(const tree_arr* self, unsigned long index) {
+  check_range(self, "get", index, 1);
+
+  tree_arr_leaf* leaf = tree_arr_find(self, &index);
+
+  return leaf_at(self, leaf, index);
+} /* tree_arr_get */
+
+void tree_arr_replace(tree_arr* self, unsigned long index, const void* element) {
+  check_range(self, "replace", index, 1);
+
+  tree_arr_leaf* leaf = tree_arr_find(self, &index);
+  memcpy(leaf_at(self, leaf, index), element, self->element_size);
+
+  return;
+} /* tree_arr_replace */
+
+void tree_arr_bulk_replace(tree_arr* self, unsigned long index, const void* elements, unsigned long num) {
+  check_range(self, "bulk-replace", index, num);
+
+  tree_arr_transfer(self, index, (uint8_t*)elements, num, true);
+
+  return;
+} /* tree_arr_bulk_replace */
+
+void tree_arr_append(tree_arr* self, const void* element) {
+  tree_arr_insert_chunk(self, self->num, element, 1);
+
+  return;
+} /* tree_arr_append */
+
+void tree_arr_bulk_append(tree_arr* self, const void* elements, unsigned long num) {
+  tree_arr_bulk_insert_at(self, self->num, elements, num);
+
+  return;
+} /* tree_arr_bulk_append */
+
+void tree_arr_insert_at(tree_arr* self, unsigned long index, const void* element) {
+  check_position(self, "insert", index);
+
+  tree_arr_insert_chunk(self, index, element, 1);
+
+  return;
+} /* tree_arr_insert_at */
+
+void tree_arr_bulk_insert_at(tree_arr* self, unsigned long index, const void* elements, unsigned long num) {
+  check_position(self, "bulk-insert", index);
+
+  /* Half a leaf at a time, so a split leaf always has room for the chunk */
+  const unsigned long chunk = self->__leaf_cap__ / 2;
+  const uint8_t* p = elements;
+  while (num) {
+    const unsigned long n = (num < chunk ? num : chunk);
+    tree_arr_insert_chunk(self, index, p, n);
+
+    index += n;
+    p += n * self->element_size;
+    num -= n;
+  }
+
+  return;
+} /* tree_arr_bulk_insert_at */
+
+void tree_arr_remove_at(tree_arr* self, unsigned long index, void* out) {
+  tree_arr_bulk_remove_at(self, index, out, 1);
+
+  return;
+} /* tree_arr_remove_at */
+
+void tree_arr_bulk_remove_at(tree_arr* self, unsigned long index, void* out, unsigned long num) {
+  check_range(self, "bulk-remove", index, num);
+
+  if (out)
+    tree_arr_transfer(self, index, out, num, false);
+
+  /* Up to the end of a leaf at a time */
+  while (num) {
+    const unsigned long removed = tree_arr_remove_rec(self, self->__root__, self->__height__, index, num);
+    self->num -= removed;
+    num -= removed;
+
+    while (self->__height__ && ((tree_arr_node*)self->__root__)->num == 1) {
+      tree_arr_node* root = self->__root__;
+      self->__root__ = root->children[0];
+      self->__height__--;
+      pool_free(&self->__nodes__, root);
+    }
+  }
+
+  if (!self->num && self->__root__) {
+    pool_reset(&self->__leaves__);
+    pool_reset(&self->__nodes__);
+    self->__root__ = NULL;
+    self->__first__ = NULL;
+    self->__height__ = 0;
+  }
+
+  return;
+} /* tree_arr_bulk_remove_at */
+
+tree_arr_iter tree_arr_iter_new(const tree_arr* self, unsigned long index) {
+  check_position(self, "iterate", index);
+
+  tree_arr_iter iter = { NULL, 0, self->element_size };
+  if (index < self->num) {
+    iter.__leaf__ = tree_arr_find(self, &index);
+    iter.__offset__ = index;
+  }
+
+  return iter;
+} /* tree_arr_iter_new */
+
+void* tree_arr_iter_next(tree_arr_iter* iter) {
+  tree_arr_leaf* leaf = iter->__leaf__;
+  while (leaf && iter->__offset__ == leaf->count) {
+    leaf = leaf->next;
+    iter->__offset__ = 0;
+  }
+  iter->__leaf__ = leaf;
+  if (!leaf)
+    return NULL;
+
+  return leaf_at(iter, leaf, iter->__offset__++);
+} /* tree_arr_iter_next */
+
+void* tree_arr_iter_block(tree_arr_iter* iter, unsigned long* num) {
+  tree_arr_leaf* leaf = iter->__leaf__;
+  while (leaf && iter->__offset__ == leaf->count) {
+    leaf = leaf->next;
+    iter->__offset__ = 0;
+  }
+  if (!leaf) {
+    iter->__leaf__ = NULL;
+    *num = 0;
+    return NULL;
+  }
+
+  void* block = leaf_at(iter, leaf, iter->__offset__);
+  *num = leaf->count - iter->__offset__;
+
+  iter->__leaf__ = leaf->next;
+  iter->__offset__ = 0;
+
+  return block;
+} /* tree_arr_iter_block */
+
+void tree_arr_cleanup(tree_arr* self) {
+  /* Every node lives in the pools, they are freed slab by slab */
+  pool_cleanup(&self->__leaves__);
+  pool_cleanup(&self->__nodes__);
+
+  *self = (tree_arr) {0};
+
+  return;
+} /* tree_arr_cleanup */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+tree_arr_leaf* tree_arr_leaf_new(tree_arr* self) {
+  tree_arr_leaf* leaf = pool_alloc(&self->__leaves__);
+  if (!leaf) {
+    fprintf(stderr,
+        "Failed to allocate leaf of tree array: %s\n"
+        "=== ABORT ===\n",
+        strerror(errno));
+
+    abort();
+  }
+
+  leaf->next = NULL;
+  leaf->count = 0;
+
+  return leaf;
+}
+
+tree_arr_node* tree_arr_node_new(tree_arr* self) {
+  tree_arr_node* node = pool_alloc(&self->__nodes__);
+  if (!node) {
+    fprintf(stderr,
+        "Failed to allocate node of tree array: %s\n"
+        "=== ABORT ===\n",
+        strerror(errno));
+
+    abort();
+  }
+
+  node->num = 0;
+
+  return node;
+}
+
+unsigned long tree_arr_node_sum(const tree_arr_node* node, unsigned long from, unsigned long to) {
+  unsigned long sum = 0;
+  for (unsigned long c = from; c < to; c++)
+    sum += node->counts[c];
+
+  return sum;
+}
+
+/* Leaf of an existing element, `index' becomes its offset in the leaf */
+tree_arr_leaf* tree_arr_find(const tree_arr* self, unsigned long* index) {
+  void* node = self->__root__;
+  unsigned long i = *index;
+
+  for (unsigned int height = self->__height__; height; height--) {
+    const tree_arr_node* n = node;
+    unsigned long c = 0;
+    while (i >= n->counts[c])
+      i -= n->counts[c++];
+    node = n->children[c];
+  }
+
+  *index = i;
+  return node;
+}
+
+void tree_arr_transfer(const tree_arr* self, unsigned long index, uint8_t* buffer, unsigned long num, bool store) {
+  if (!num)
+    return;
+
+  tree_arr_leaf* leaf = tree_arr_find(self, &index);
+  while (num) {
+    unsigned long n = leaf->count - index;
+    if (n > num)
+      n = num;
+
+    if (store)
+      memcpy(leaf_at(self, leaf, index), buffer, n * self->element_size);
+    else
+      memcpy(buffer, leaf_at(self, leaf, index), n * self->element_size);
+
+    buffer += n * self->element_size;
+    num -= n;
+    leaf = leaf->next;
+    index = 0;
+  }
+}
+
+/* At most half a leaf */
+void tree_arr_insert_chunk(tree_arr* self, unsigned long index, const uint8_t* elements, unsigned long num) {
+  if (!self->__root__) {
+    self->__root__ = tree_arr_leaf_new(self);
+    self->__first__ = self->__root__;
+  }
+
+  void* split;
+  const unsigned long split_count = tree_arr_insert_rec(self, self->__root__, self->__height__, index, elements, num, &split);
+  self->num += num;
+
+  if (split) {
+    tree_arr_node* root = tree_arr_node_new(self);
+    root->num = 2;
+    root->children[0] = self->__root__;
+    root->children[1] = split;
+    root->counts[0] = self->num - split_count;
+    root->counts[1] = split_count;
+
+    self->__root__ = root;
+    self->__height__++;
+  }
+}
+
+/* Returns the number of elements under `*split', the new right sibling of `node' if it was split */
+unsigned long tree_arr_insert_rec(tree_arr* self, void* node, unsigned int height, unsigned long index, const uint8_t* elements, unsigned long num, void** split) {
+  *split = NULL;
+
+  if (!height) {
+    tree_arr_leaf* leaf = node;
+    tree_arr_leaf* target = leaf;
+
+    if (leaf->count + num > self->__leaf_cap__) {
+      /* Appending keeps the leaf full, so growing at the end doesn't leave half empty leaves */
+      const unsigned long keep = (index == leaf->count ? leaf->count : leaf->count / 2);
+
+      tree_arr_leaf* right = tree_arr_leaf_new(self);
+      memcpy(leaf_data(right), leaf_at(self, leaf, keep), (leaf->count - keep) * self->element_size);
+      right->count = leaf->count - keep;
+      leaf->count = keep;
+
+      right->next = leaf->next;
+      leaf->next = right;
+      *split = right;
+
+      if (index > keep || keep + num > self->__leaf_cap__) {
+        target = right;
+        index -= keep;
+      }
+    }
+
+    memmove(leaf_at(self, target, index + num), leaf_at(self, target, index), (target->count - index) * self->element_size);
+    memcpy(leaf_at(self, target, index), elements, num * self->element_size);
+    target->count += num;
+
+    return (*split ? ((tree_arr_leaf*)*split)->count : 0);
+  }
+
+  tree_arr_node* n = node;
+  unsigned long c = 0;
+  while (c + 1 < n->num && index > n->counts[c])
+    index -= n->counts[c++];
+
+  void* child_split;
+  const unsigned long child_split_count = tree_arr_insert_rec(self, n->children[c], height - 1, index, elements, num, &child_split);
+  n->counts[c] += num - child_split_count;
+  if (!child_split)
+    return 0;
+
+  tree_arr_node* target = n;
+  tree_arr_node* right = NULL;
+  c++;
+
+  if (n->num == FANOUT) {
+    const unsigned long keep = (c == n->num ? n->num : n->num / 2);
+
+    right = tree_arr_node_new(self);
+    right->num = n->num - keep;
+    memcpy(right->children, n->children + keep, right->num * sizeof(void*));
+    memcpy(right->counts, n->counts + keep, right->num * sizeof(unsigned long));
+    n->num = keep;
+
+    if (c > keep || keep == FANOUT) {
+      target = right;
+      c -= keep;
+    }
+  }
+
+  memmove(target->children + c + 1, target->children + c, (target->num - c) * sizeof(void*));
+  memmove(target->counts + c + 1, target->counts + c, (target->num - c) * sizeof(unsigned long));
+  target->children[c] = child_split;
+  target->counts[c] = child_split_count;
+  target->num++;
+
+  if (!right)
+    return 0;
+
+  *split = right;
+  return tree_arr_node_sum(right, 0, right->num);
+}
+
+/* Removes up to the end of the leaf of `index', returns the number of removed elements */
+unsigned long tree_arr_remove_rec(tree_arr* self, void* node, unsigned int height, unsigned long index, unsigned long num) {
+  if (!height) {
+    tree_arr_leaf* leaf = node;
+    const unsigned long removed = (num < leaf->count - index ? num : leaf->count - index);
+
+    memmove(leaf_at(self, leaf, index), leaf_at(self, leaf, index + removed), (leaf->count - index - removed) * self->element_size);
+    leaf->count -= removed;
+
+    return removed;
+  }
+
+  tree_arr_node* n = node;
+  unsigned long c = 0;
+  while (index >= n->counts[c])
+    index -= n->counts[c++];
+
+  const unsigned long removed = tree_arr_remove_rec(self, n->children[c], height - 1, index, num);
+  n->counts[c] -= removed;
+  tree_arr_rebalance(self, n, c, height - 1);
+
+  return removed;
+}
+
+/* Merges a child below a quarter full into a sibling, or evens them out if both don't fit into one */
+void tree_arr_rebalance(tree_arr* self, tree_arr_node* node, unsigned long child, unsigned int height) {
+  if (node->num < 2)
+    return;
+
+  const unsigned long cap = (height ? FANOUT : self->__leaf_cap__);
+  const unsigned long fill = (height ? ((tree_arr_node*)node->children[child])->num : ((tree_arr_leaf*)node->children[child])->count);
+  if (fill >= cap / 4)
+    return;
+
+  const unsigned long l = (child + 1 < node->num ? child : child - 1);
+  const unsigned long r = l + 1;
+
+  if (!height) {
+    tree_arr_leaf* a = node->children[l];
+    tree_arr_leaf* b = node->children[r];
+
+    if (a->count + b->count <= cap) {
+      memcpy(leaf_at(self, a, a->count), leaf_data(b), b->count * self->element_size);
+      a->count += b->count;
+      a->next = b->next;
+      pool_free(&self->__leaves__, b);
+    } else {
+      const unsigned long want = (a->count + b->count) / 2;
+      if (a->count > want) {
+        const unsigned long move = a->count - want;
+        memmove(leaf_at(self, b, move), leaf_data(b), b->count * self->element_size);
+        memcpy(leaf_data(b), leaf_at(self, a, want), move * self->element_size);
+        a->count -= move;
+        b->count += move;
+      } else {
+        const unsigned long move = want - a->count;
+        memcpy(leaf_at(self, a, a->count), leaf_data(b), move * self->element_size);
+        memmove(leaf_data(b), leaf_at(self, b, move), (b->count - move) * self->element_size);
+        a->count += move;
+        b->count -= move;
+      }
+
+      node->counts[l] = a->count;
+      node->counts[r] = b->count;
+      return;
+    }
+  } else {
+    tree_arr_node* a = node->children[l];
+    tree_arr_node* b = node->children[r];
+
+    if (a->num + b->num <= cap) {
+      memcpy(a->children + a->num, b->children, b->num * sizeof(void*));
+      memcpy(a->counts + a->num, b->counts, b->num * sizeof(unsigned long));
+      a->num += b->num;
+      pool_free(&self->__nodes__, b);
+    } else {
+      const unsigned long want = (a->num + b->num) / 2;
+      unsigned long moved;
+      if (a->num > want) {
+        const unsigned long move = a->num - want;
+        moved = tree_arr_node_sum(a, want, a->num);
+        memmove(b->children + move, b->children, b->num * sizeof(void*));
+        memmove(b->counts + move, b->counts, b->num * sizeof(unsigned long));
+        memcpy(b->children, a->children + want, move * sizeof(void*));
+        memcpy(b->counts, a->counts + want, move * sizeof(unsigned long));
+        a->num -= move;
+        b->num += move;
+
+        node->counts[l] -= moved;
+        node->counts[r] += moved;
+      } else {
+        const unsigned long move = want - a->num;
+        moved = tree_arr_node_sum(b, 0, move);
+        memcpy(a->children + a->num, b->children, move * sizeof(void*));
+        memcpy(a->counts + a->num, b->counts, move * sizeof(unsigned long));
+        memmove(b->children, b->children + move, (b->num - move) * sizeof(void*));
+        memmove(b->counts, b->counts + move, (b->num - move) * sizeof(unsigned long));
+        a->num += move;
+        b->num -= move;
+
+        node->counts[l] += moved;
+        node->counts[r] -= moved;
+      }
+      return;
+    }
+  }
+
+  /* `r' was merged into `l' */
+  node->counts[l] += node->counts[r];
+  memmove(node->children + r, node->children + r + 1, (node->num - r - 1) * sizeof(void*));
+  memmove(node->counts + r, node->counts + r + 1, (node->num - r - 1) * sizeof(unsigned long));
+  node->num--;
+}
+/* ===================== */
@@ -0,0 +1,272 @@
+#include <blib/datastructures/flat/map.h>
+#include <blib/datastructures/arrays/trace.h>
+#include <blib/memory/alloc.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#if DISABLE_RUNTIME_BOUNDS_CHECKS
+#define check_index(self, operation, i)
+#else
+#define check_index(self, operation, i) \
+  do {                                  \
+    if (i >= self->__keys__.num) {      \
+      fprintf(stderr,                   \
+          "Attempt to " operation " entry %lu from flat map of entry count %lu!\n" \
+          "=== ABORT ===\n",            \
+          i, self->__keys__.num);       \
+      abort();                          \
+    }                                   \
+  } while(0)
+#endif
+
+#define key_at(self, i) ((uint8_t*)dynamic_arr_get_start(&self->__keys__) + (i) * self->__keys__.element_size)
+#define value_at(self, i) ((uint8_t*)dynamic_arr_get_start(&self->__values__) + (i) * self->__values__.element_size)
+
+/* Records are padded so the keys inside of them stay aligned */
+#define record_size(ks, vs) ((ks + vs + 7) & ~7U)
+/* ================== */
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+uint8_t* flat_map_pack(const flat_map* self, const void* keys, const void* values, unsigned long num, unsigned long* unique);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+flat_map __intern_flat_map_new(unsigned int key_size, unsigned int value_size, flat_cmp cmp) {
+  return (flat_map) {
+    .__keys__ = __intern_dynamic_generic_arr_new(key_size),
+    .__values__ = __intern_dynamic_generic_arr_new(value_size),
+    .cmp = cmp,
+  };
+} /* __intern_flat_map_new */
+
+flat_map flat_map_from_arrs(dynamic_arr* keys, dynamic_arr* values, flat_cmp cmp) {
+  if (keys->num != values->num) {
+    fprintf(stderr,
+        "Attempt to create flat map from %lu key(s) and %lu value(s)!\n"
+        "=== ABORT ===\n",
+        keys->num, values->num);
+
+    abort();
+  }
+
+  flat_map map = {
+    .__keys__ = *keys,
+    .__values__ = *values,
+    .cmp = cmp,
+  };
+
+  *keys = (dynamic_arr) {0};
+  *values = (dynamic_arr) {0};
+
+  dynamic_arr_unshare(&map.__keys__);
+  dynamic_arr_unshare(&map.__values__);
+
+  const unsigned long num = map.__keys__.num;
+  if (num < 2)
+    return map;
+
+  const unsigned int ks = map.__keys__.element_size;
+  const unsigned int vs = map.__values__.element_size;
+
+  unsigned long unique;
+  uint8_t* records = flat_map_pack(&map, key_at((&map), 0), value_at((&map), 0), num, &unique);
+
+  for (unsigned long i = 0; i < unique; i++) {
+    memcpy(key_at((&map), i), records + i * record_size(ks, vs), ks);
+    memcpy(value_at((&map), i), records + i * record_size(ks, vs) + ks, vs);
+  }
+  blib_free(records);
+
+  if (unique != num) {
+    dynamic_arr_resize_to(&map.__keys__, NULL, unique);
+    dynamic_arr_resize_to(&map.__values__, NULL, unique);
+  }
+
+  return map;
+} /* flat_map_from_arrs */
+
+unsigned long flat_map_len(const flat_map* self) {
+  return self->__keys__.num;
+} /* flat_map_len */
+
+void flat_map_peek(const flat_map* self, unsigned long index, void* key, void* value) {
+  check_index(self, "read", index);
+
+  if (key)
+    memcpy(key, key_at(self, index), self->__keys__.element_size);
+  if (value)
+    memcpy(value, value_at(self, index), self->__values__.element_size);
+
+  return;
+} /* flat_map_peek */
+
+bool flat_map_find(const flat_map* self, const void* key, unsigned long* index) {
+  const unsigned long i = __intern_flat_lower_bound(
+      dynamic_arr_get_start(&self->__keys__), self->__keys__.num,
+      self->__keys__.element_size, self->cmp, key);
+
+  if (i == self->__keys__.num || self->cmp(key_at(self, i), key))
+    return false;
+
+  if (index)
+    *index = i;
+
+  return true;
+} /* flat_map_find */
+
+bool flat_map_get(const flat_map* self, const void* key, void* value) {
+  unsigned long i;
+  if (!flat_map_find(self, key, &i))
+    return false;
+
+  if (value)
+    memcpy(value, value_at(self, i), self->__values__.element_size);
+
+  return true;
+} /* flat_map_get */
+
+bool flat_map_insert(flat_map* self, const void* key, const void* value) {
+  const unsigned long i = __intern_flat_lower_bound(
+      dynamic_arr_get_start(&self->__keys__), self->__keys__.num,
+      self->__keys__.element_size, self->cmp, key);
+
+  if (i == self->__keys__.num) {
+    dynamic_arr_append(&self->__keys__, key);
+    dynamic_arr_append(&self->__values__, value);
+
+    return true;
+  }
+
+  if (!self->cmp(key_at(self, i), key)) {
+    dynamic_arr_replace(&self->__values__, i, value);
+
+    return false;
+  }
+
+  dynamic_arr_insert_at(&self->__keys__, i, key);
+  dynamic_arr_insert_at(&self->__values__, i, value);
+
+  return true;
+} /* flat_map_insert */
+
+void flat_map_bulk_insert(flat_map* self, const void* keys, const void* values, unsigned long num) {
+  if (!num)
+    return;
+
+  const unsigned int ks = self->__keys__.element_size;
+  const unsigned int vs = self->__values__.element_size;
+  const unsigned long n = self->__keys__.num;
+
+  unsigned long m;
+  uint8_t* records = flat_map_pack(self, keys, values, num, &m);
+
+  dynamic_arr new_keys = __intern_dynamic_generic_arr_new(ks);
+  dynamic_arr new_values = __intern_dynamic_generic_arr_new(vs);
+  dynamic_arr_reserve(&new_keys, n + m);
+  dynamic_arr_reserve(&new_values, n + m);
+
+  uint8_t* dk = dynamic_arr_get_start(&new_keys);
+  uint8_t* dv = dynamic_arr_get_start(&new_values);
+
+  unsigned long i = 0, j = 0, k = 0;
+  while (i < n || j < m) {
+    const uint8_t* record = records + j * record_size(ks, vs);
+    const int c = (i == n ? 1 : (j == m ? -1 : self->cmp(key_at(self, i), record)));
+
+    if (c < 0) {
+      memcpy(dk + k * ks, key_at(self, i), ks);
+      memcpy(dv + k * vs, value_at(self, i), vs);
+      i++;
+    } else {
+      memcpy(dk + k * ks, record, ks);
+      memcpy(dv + k * vs, record + ks, vs);
+      i += !c;
+      j++;
+    }
+    k++;
+  }
+  blib_free(records);
+
+  __intern_dynamic_arr_set_num(&new_keys, k);
+  __intern_dynamic_arr_set_num(&new_values, k);
+
+  dynamic_arr_cleanup(&self->__keys__);
+  dynamic_arr_cleanup(&self->__values__);
+  self->__keys__ = new_keys;
+  self->__values__ = new_values;
+
+  return;
+} /* flat_map_bulk_insert */
+
+bool flat_map_remove(flat_map* self, const void* key, void* value) {
+  unsigned long i;
+  if (!flat_map_find(self, key, &i))
+    return false;
+
+  dynamic_arr_remove_at(&self->__keys__, i, NULL);
+  dynamic_arr_remove_at(&self->__values__, i, value);
+
+  return true;
+} /* flat_map_remove */
+
+void flat_map_cleanup(flat_map* self) {
+  dynamic_arr_cleanup(&self->__keys__);
+  dynamic_arr_cleanup(&self->__values__);
+
+  *self = (flat_map) {0};
+
+  return;
+} /* flat_map_cleanup */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+uint8_t* flat_map_pack(const flat_map* self, const void* keys, const void* values, unsigned long num, unsigned long* unique) {
+  const unsigned int ks = self->__keys__.element_size;
+  const unsigned int vs = self->__values__.element_size;
+  const unsigned int rs = record_size(ks, vs);
+
+  /* Keys lead their records, so the key comparison works on records as well */
+  uint8_t* records = blib_malloc(num * rs);
+  if (!records) {
+    fprintf(stderr,
+        "Failed to allocate %lu entries for flat map: %s\n"
+        "=== ABORT ===\n",
+        num, strerror(errno));
+
+    abort();
+  }
+
+  for (unsigned long i = 0; i < num; i++) {
+    memcpy(records + i * rs, (const uint8_t*)keys + i * ks, ks);
+    memcpy(records + i * rs + ks, (const uint8_t*)values + i * vs, vs);
+  }
+
+  __intern_flat_sort(records, num, rs, self->cmp);
+
+  /* The sort is stable, so the last of equal keys wins */
+  unsigned long u = 1;
+  for (unsigned long i = 1; i < num; i++) {
+    if (self->cmp(records + (u - 1) * rs, records + i * rs))
+      u++;
+
+    if (u - 1 != i)
+      memcpy(records + (u - 1) * rs, records + i * rs, rs);
+  }
+
+  *unique = u;
+
+  return records;
+}
+/* ===================== */
@@ -0,0 +1,337 @@
+#include <blib/datastructures/flat/set.h>
+#include <blib/datastructures/arrays/trace.h>
+#include <blib/memory/alloc.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#if DISABLE_RUNTIME_BOUNDS_CHECKS
+#define check_index(self, operation, i)
+#else
+#define check_index(self, operation, i) \
+  do {                                  \
+    if (i >= self->__storage__.num) {   \
+      fprintf(stderr,                   \
+          "Attempt to " operation " element %lu from flat set of element count %lu!\n" \
+          "=== ABORT ===\n",            \
+          i, self->__storage__.num);    \
+      abort();                          \
+    }                                   \
+  } while(0)
+#endif
+
+#define set_base(self) ((uint8_t*)dynamic_arr_get_start(&self->__storage__))
+#define set_at(self, base, i) (base + (i) * self->__storage__.element_size)
+
+/* Runs sorted by insertion sort before merging */
+#define SORT_RUN 16
+/* ================== */
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+enum flat_set_merge_mode {
+  FLAT_SET_UNION,
+  FLAT_SET_INTERSECTION,
+  FLAT_SET_DIFFERENCE,
+};
+
+flat_set flat_set_merge(const flat_set* a, const flat_set* b, enum flat_set_merge_mode mode);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+flat_set __intern_flat_set_new(unsigned int element_size, flat_cmp cmp) {
+  return (flat_set) {
+    .__storage__ = __intern_dynamic_generic_arr_new(element_size),
+    .cmp = cmp,
+  };
+} /* __intern_flat_set_new */
+
+void __intern_flat_sort(void* base, unsigned long num, unsigned int size, flat_cmp cmp) {
+  if (num < 2)
+    return;
+
+  uint8_t* buffer = blib_malloc(num * size);
+  if (!buffer) {
+    fprintf(stderr,
+        "Failed to allocate sorting buffer of size %lu: %s\n"
+        "=== ABORT ===\n",
+        num * size, strerror(errno));
+
+    abort();
+  }
+
+  uint8_t* src = base;
+  uint8_t* dst = buffer;
+
+  /* Insertion sort small runs, the buffer holds the element being inserted */
+  for (unsigned long lo = 0; lo < num; lo += SORT_RUN) {
+    const unsigned long hi = (num - lo > SORT_RUN ? lo + SORT_RUN : num);
+
+    for (unsigned long i = lo + 1; i < hi; i++) {
+      unsigned long j = i;
+      if (cmp(src + (j - 1) * size, src + j * size) <= 0)
+        continue;
+
+      memcpy(buffer, src + i * size, size);
+      while (j > lo && cmp(src + (j - 1) * size, buffer) > 0) {
+        memcpy(src + j * size, src + (j - 1) * size, size);
+        j--;
+      }
+      memcpy(src + j * size, buffer, size);
+    }
+  }
+
+  /* Stable bottom-up merges, ping-ponging between the array and the buffer */
+  for (unsigned long width = SORT_RUN; width < num; width <<= 1) {
+    for (unsigned long lo = 0; lo < num; lo += width << 1) {
+      const unsigned long mid = (num - lo > width ? lo + width : num);
+      const unsigned long hi = (num - mid > width ? mid + width : num);
+
+      unsigned long i = lo, j = mid, k = lo;
+      while (i < mid && j < hi) {
+        if (cmp(src + j * size, src + i * size) < 0)
+          memcpy(dst + k++ * size, src + j++ * size, size);
+        else
+          memcpy(dst + k++ * size, src + i++ * size, size);
+      }
+
+      memcpy(dst + k * size, src + i * size, (mid - i) * size);
+      k += mid - i;
+      memcpy(dst + k * size, src + j * size, (hi - j) * size);
+    }
+
+    uint8_t* tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+
+  if (src != base)
+    memcpy(base, src, num * size);
+
+  blib_free(buffer);
+
+  return;
+} /* __intern_flat_sort */
+
+unsigned long __intern_flat_lower_bound(const void* base, unsigned long num, unsigned int size, flat_cmp cmp, const void* key) {
+  if (!num)
+    return 0;
+
+  /* Halving without an early exit, the select compiles to a conditional move */
+  const uint8_t* first = base;
+  while (num > 1) {
+    const unsigned long half = num >> 1;
+    first = (cmp(first + half * size, key) < 0 ? first + half * size : first);
+    num -= half;
+  }
+
+  return (unsigned long)(first - (const uint8_t*)base) / size + (cmp(first, key) < 0);
+} /* __intern_flat_lower_bound */
+
+flat_set flat_set_from_arr(dynamic_arr* arr, flat_cmp cmp) {
+  flat_set set = {
+    .__storage__ = *arr,
+    .cmp = cmp,
+  };
+
+  *arr = (dynamic_arr) {0};
+
+  dynamic_arr_unshare(&set.__storage__);
+
+  const unsigned int size = set.__storage__.element_size;
+  const unsigned long num = set.__storage__.num;
+  uint8_t* base = set_base((&set));
+  if (num < 2)
+    return set;
+
+  __intern_flat_sort(base, num, size, cmp);
+
+  unsigned long unique = 1;
+  for (unsigned long i = 1; i < num; i++) {
+    if (!cmp(base + (unique - 1) * size, base + i * size))
+      continue;
+
+    if (unique != i)
+      memcpy(base + unique * size, base + i * size, size);
+    unique++;
+  }
+
+  if (unique != num)
+    dynamic_arr_resize_to(&set.__storage__, NULL, unique);
+
+  return set;
+} /* flat_set_from_arr */
+
+unsigned long flat_set_len(const flat_set* self) {
+  return self->__storage__.num;
+} /* flat_set_len */
+
+const void* flat_set_get_start(const flat_set* self) {
+  return dynamic_arr_get_start(&self->__storage__);
+} /* flat_set_get_start */
+
+void flat_set_peek(const flat_set* self, unsigned long index, void* out) {
+  check_index(self, "read", index);
+
+  dynamic_arr_peek(&self->__storage__, index, out);
+
+  return;
+} /* flat_set_peek */
+
+unsigned long flat_set_lower_bound(const flat_set* self, const void* key) {
+  return __intern_flat_lower_bound(
+      dynamic_arr_get_start(&self->__storage__), self->__storage__.num,
+      self->__storage__.element_size, self->cmp, key);
+} /* flat_set_lower_bound */
+
+bool flat_set_find(const flat_set* self, const void* key, unsigned long* index) {
+  const unsigned long i = flat_set_lower_bound(self, key);
+  if (i == self->__storage__.num || self->cmp(set_at(self, set_base(self), i), key))
+    return false;
+
+  if (index)
+    *index = i;
+
+  return true;
+} /* flat_set_find */
+
+bool flat_set_insert(flat_set* self, const void* element) {
+  const unsigned long i = flat_set_lower_bound(self, element);
+
+  if (i == self->__storage__.num) {
+    dynamic_arr_append(&self->__storage__, element);
+
+    return true;
+  }
+
+  if (!self->cmp(set_at(self, set_base(self), i), element))
+    return false;
+
+  dynamic_arr_insert_at(&self->__storage__, i, element);
+
+  return true;
+} /* flat_set_insert */
+
+void flat_set_bulk_insert(flat_set* self, const void* elements, unsigned long num) {
+  if (!num)
+    return;
+
+  dynamic_arr batch_arr = __intern_dynamic_generic_arr_new(self->__storage__.element_size);
+  dynamic_arr_bulk_append(&batch_arr, elements, num);
+
+  flat_set batch = flat_set_from_arr(&batch_arr, self->cmp);
+  flat_set merged = flat_set_merge(self, &batch, FLAT_SET_UNION);
+
+  flat_set_cleanup(&batch);
+  dynamic_arr_cleanup(&self->__storage__);
+  self->__storage__ = merged.__storage__;
+
+  return;
+} /* flat_set_bulk_insert */
+
+bool flat_set_remove(flat_set* self, const void* key) {
+  unsigned long i;
+  if (!flat_set_find(self, key, &i))
+    return false;
+
+  dynamic_arr_remove_at(&self->__storage__, i, NULL);
+
+  return true;
+} /* flat_set_remove */
+
+flat_set flat_set_union(const flat_set* a, const flat_set* b) {
+  return flat_set_merge(a, b, FLAT_SET_UNION);
+} /* flat_set_union */
+
+flat_set flat_set_intersection(const flat_set* a, const flat_set* b) {
+  return flat_set_merge(a, b, FLAT_SET_INTERSECTION);
+} /* flat_set_intersection */
+
+flat_set flat_set_difference(const flat_set* a, const flat_set* b) {
+  return flat_set_merge(a, b, FLAT_SET_DIFFERENCE);
+} /* flat_set_difference */
+
+void flat_set_cleanup(flat_set* self) {
+  dynamic_arr_cleanup(&self->__storage__);
+
+  *self = (flat_set) {0};
+
+  return;
+} /* flat_set_cleanup */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+flat_set flat_set_merge(const flat_set* a, const flat_set* b, enum flat_set_merge_mode mode) {
+  if (a->__storage__.element_size != b->__storage__.element_size) {
+    fprintf(stderr,
+        "Attempt to merge flat sets of element sizes %u and %u!\n"
+        "=== ABORT ===\n",
+        a->__storage__.element_size, b->__storage__.element_size);
+
+    abort();
+  }
+
+  const unsigned int size = a->__storage__.element_size;
+  const unsigned long an = a->__storage__.num;
+  const unsigned long bn = b->__storage__.num;
+  const uint8_t* pa = set_base(a);
+  const uint8_t* pb = set_base(b);
+
+  flat_set out = __intern_flat_set_new(size, a->cmp);
+  switch (mode) {
+    case FLAT_SET_UNION:
+      dynamic_arr_reserve(&out.__storage__, an + bn);
+      break;
+    case FLAT_SET_INTERSECTION:
+      dynamic_arr_reserve(&out.__storage__, (an < bn ? an : bn));
+      break;
+    case FLAT_SET_DIFFERENCE:
+      dynamic_arr_reserve(&out.__storage__, an);
+      break;
+  }
+  uint8_t* dst = set_base((&out));
+
+  unsigned long i = 0, j = 0, k = 0;
+  while (i < an && j < bn) {
+    const int c = a->cmp(pa + i * size, pb + j * size);
+
+    if (c < 0) {
+      if (mode != FLAT_SET_INTERSECTION)
+        memcpy(dst + k++ * size, pa + i * size, size);
+      i++;
+    } else if (c > 0) {
+      if (mode == FLAT_SET_UNION)
+        memcpy(dst + k++ * size, pb + j * size, size);
+      j++;
+    } else {
+      if (mode != FLAT_SET_DIFFERENCE)
+        memcpy(dst + k++ * size, pa + i * size, size);
+      i++;
+      j++;
+    }
+  }
+
+  if (mode != FLAT_SET_INTERSECTION) {
+    memcpy(dst + k * size, pa + i * size, (an - i) * size);
+    k += an - i;
+  }
+  if (mode == FLAT_SET_UNION) {
+    memcpy(dst + k * size, pb + j * size, (bn - j) * size);
+    k += bn - j;
+  }
+
+  __intern_dynamic_arr_set_num(&out.__storage__, k);
+
+  return out;
+}
+/* ===================== */
@@ -0,0 +1,272 @@
+#include <blib/datastructures/queues/priority.h>
+#include <blib/memory/alloc.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#if DISABLE_RUNTIME_BOUNDS_CHECKS
+#define check_nonempty(self, operation)
+#else
+#define check_nonempty(self, operation)           \
+  do {                                            \
+    if (!self->__storage__.num) {                 \
+      fputs(                                      \
+          "Attempt to " operation " an empty priority queue!\n" \
+          "=== ABORT ===\n", stderr);             \
+      abort();                                    \
+    }                                             \
+  } while (0)
+#endif
+
+#if DISABLE_RUNTIME_BOUNDS_CHECKS
+#define check_index(self, operation, i)
+#else
+#define check_index(self, operation, i) \
+  do {                                  \
+    if (i >= self->__storage__.num) {   \
+      fprintf(stderr,                   \
+          "Attempt to " operation " element %lu from priority queue of element count %lu!\n" \
+          "=== ABORT ===\n",            \
+          i, self->__storage__.num);    \
+      abort();                          \
+    }                                   \
+  } while(0)
+#endif
+
+#define heap_base(self) ((uint8_t*)dynamic_arr_get_start(&self->__storage__))
+#define heap_at(self, base, i) (base + (i) * self->__storage__.element_size)
+/* ================== */
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+void priority_queue_sift_up(priority_queue* self, unsigned long index, const void* element);
+void priority_queue_sift_down(priority_queue* self, unsigned long index, const void* element);
+void priority_queue_place(priority_queue* self, unsigned long index, const void* element);
+void priority_queue_heapify(priority_queue* self);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+priority_queue __intern_priority_queue_new(unsigned int element_size, unsigned int arity, priority_queue_cmp cmp) {
+  dynamic_arr storage = __intern_dynamic_generic_arr_new(element_size);
+
+  return priority_queue_from_arr(&storage, arity, cmp);
+} /* __intern_priority_queue_new */
+
+priority_queue priority_queue_from_arr(dynamic_arr* arr, unsigned int arity, priority_queue_cmp cmp) {
+  if (arity < 2) {
+    fprintf(stderr,
+        "Attempt to create priority queue of arity %u!\n"
+        "=== ABORT ===\n",
+        arity);
+
+    abort();
+  }
+
+  priority_queue pq = {
+    .__storage__ = *arr,
+    .arity = arity,
+    .cmp = cmp,
+  };
+
+  pq.__scratch__ = blib_malloc(arr->element_size);
+  if (!pq.__scratch__) {
+    fprintf(stderr,
+        "Failed to allocate scratch memory for priority queue of element size %u: %s\n"
+        "=== ABORT ===\n",
+        arr->element_size, strerror(errno));
+
+    abort();
+  }
+
+  *arr = (dynamic_arr) {0};
+
+  /* The heap is written through `dynamic_arr_get_start()' */
+  dynamic_arr_unshare(&pq.__storage__);
+  priority_queue_heapify(&pq);
+
+  return pq;
+} /* priority_queue_from_arr */
+
+void priority_queue_set_hook(priority_queue* self, priority_queue_hook hook, void* ctx) {
+  self->__hook__ = hook;
+  self->__hook_ctx__ = ctx;
+
+  return;
+} /* priority_queue_set_hook */
+
+unsigned long priority_queue_len(const priority_queue* self) {
+  return self->__storage__.num;
+} /* priority_queue_len */
+
+void priority_queue_push(priority_queue* self, const void* element) {
+  dynamic_arr_append(&self->__storage__, element);
+  priority_queue_sift_up(self, self->__storage__.num - 1, element);
+
+  return;
+} /* priority_queue_push */
+
+void priority_queue_bulk_push(priority_queue* self, const void* elements, unsigned long num) {
+  if (!num)
+    return;
+
+  /* Rebuilding is O(n + k), pushing one by one O(k * log(n + k)) */
+  if (num < self->__storage__.num) {
+    const uint8_t* e = elements;
+    for (unsigned long i = 0; i < num; i++)
+      priority_queue_push(self, e + i * self->__storage__.element_size);
+
+    return;
+  }
+
+  dynamic_arr_bulk_append(&self->__storage__, elements, num);
+
+  /* Heapifying only reports the elements it moves, the others stay where they were appended */
+  if (self->__hook__) {
+    uint8_t* base = heap_base(self);
+    for (unsigned long i = self->__storage__.num - num; i < self->__storage__.num; i++)
+      self->__hook__(heap_at(self, base, i), i, self->__hook_ctx__);
+  }
+  priority_queue_heapify(self);
+
+  return;
+} /* priority_queue_bulk_push */
+
+void priority_queue_peek(const priority_queue* self, void* out) {
+  check_nonempty(self, "peek");
+
+  memcpy(out, dynamic_arr_get_start(&self->__storage__), self->__storage__.element_size);
+
+  return;
+} /* priority_queue_peek */
+
+void priority_queue_pop(priority_queue* self, void* out) {
+  priority_queue_remove_at(self, 0, out);
+
+  return;
+} /* priority_queue_pop */
+
+void priority_queue_update(priority_queue* self, unsigned long index, const void* element) {
+  check_index(self, "update", index);
+
+  memmove(self->__scratch__, element, self->__storage__.element_size);
+  priority_queue_place(self, index, self->__scratch__);
+
+  return;
+} /* priority_queue_update */
+
+void priority_queue_remove_at(priority_queue* self, unsigned long index, void* out) {
+  check_nonempty(self, "remove from");
+  check_index(self, "remove", index);
+
+  if (out)
+    memcpy(out, heap_at(self, heap_base(self), index), self->__storage__.element_size);
+
+  dynamic_arr_truncate(&self->__storage__, self->__scratch__);
+  if (index < self->__storage__.num)
+    priority_queue_place(self, index, self->__scratch__);
+
+  return;
+} /* priority_queue_remove_at */
+
+void priority_queue_cleanup(priority_queue* self) {
+  dynamic_arr_cleanup(&self->__storage__);
+  blib_free(self->__scratch__);
+
+  *self = (priority_queue) {0};
+
+  return;
+} /* priority_queue_cleanup */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+void priority_queue_sift_up(priority_queue* self, unsigned long index, const void* element) {
+  uint8_t* base = heap_base(self);
+  const unsigned int size = self->__storage__.element_size;
+
+  while (index) {
+    const unsigned long parent = (index - 1) / self->arity;
+    if (self->cmp(element, heap_at(self, base, parent)) >= 0)
+      break;
+
+    memcpy(heap_at(self, base, index), heap_at(self, base, parent), size);
+    if (self->__hook__)
+      self->__hook__(heap_at(self, base, index), index, self->__hook_ctx__);
+
+    index = parent;
+  }
+
+  memcpy(heap_at(self, base, index), element, size);
+  if (self->__hook__)
+    self->__hook__(heap_at(self, base, index), index, self->__hook_ctx__);
+
+  return;
+}
+
+void priority_queue_sift_down(priority_queue* self, unsigned long index, const void* element) {
+  uint8_t* base = heap_base(self);
+  const unsigned int size = self->__storage__.element_size;
+  const unsigned long num = self->__storage__.num;
+
+  for (;;) {
+    const unsigned long first = index * self->arity + 1;
+    if (first >= num)
+      break;
+
+    const unsigned long last = (num - first > self->arity ? first + self->arity : num);
+    unsigned long best = first;
+    for (unsigned long c = first + 1; c < last; c++)
+      if (self->cmp(heap_at(self, base, c), heap_at(self, base, best)) < 0)
+        best = c;
+
+    if (self->cmp(heap_at(self, base, best), element) >= 0)
+      break;
+
+    memcpy(heap_at(self, base, index), heap_at(self, base, best), size);
+    if (self->__hook__)
+      self->__hook__(heap_at(self, base, index), index, self->__hook_ctx__);
+
+    index = best;
+  }
+
+  memcpy(heap_at(self, base, index), element, size);
+  if (self->__hook__)
+    self->__hook__(heap_at(self, base, index), index, self->__hook_ctx__);
+
+  return;
+}
+
+void priority_queue_place(priority_queue* self, unsigned long index, const void* element) {
+  uint8_t* base = heap_base(self);
+
+  if (index && self->cmp(element, heap_at(self, base, (index - 1) / self->arity)) < 0)
+    priority_queue_sift_up(self, index, element);
+  else
+    priority_queue_sift_down(self, index, element);
+
+  return;
+}
+
+void priority_queue_heapify(priority_queue* self) {
+  const unsigned long num = self->__storage__.num;
+  if (num < 2)
+    return;
+
+  uint8_t* base = heap_base(self);
+  for (unsigned long i = (num - 2) / self->arity + 1; i--;) {
+    memcpy(self->__scratch__, heap_at(self, base, i), self->__storage__.element_size);
+    priority_queue_sift_down(self, i, self->__scratch__);
+  }
+
+  return;
+}
+/* ===================== */
@@ -0,0 +1,274 @@
+#include <blib/datastructures/strings/builder.h>
+#include <blib/datastructures/arrays/trace.h>
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define builder_end(self) ((char*)dynamic_arr_get_start(&self->__storage__) + self->__storage__.num)
+
+/* Bounds of the fixed point path of `string_builder_append_double()' (scaled value needs a fraction bit) */
+#define FAST_DOUBLE_MAX_PRECISION 9
+#define FAST_DOUBLE_LIMIT 4503599627370496.0 /* 2^52 */
+/* ================== */
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+unsigned int string_builder_digits(unsigned long long value);
+void string_builder_write_uint(char* end, unsigned long long value);
+/* ================================== */
+
+static const char digit_pairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static const unsigned long long pow10_table[FAST_DOUBLE_MAX_PRECISION + 1] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL,
+  100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+};
+
+/* =============
+ * API Functions
+ * ============= */
+string_builder string_builder_new(void) {
+  return (string_builder) {
+    .__storage__ = dynamic_arr_new(char),
+  };
+} /* string_builder_new */
+
+unsigned long string_builder_len(const string_builder* self) {
+  return self->__storage__.num;
+} /* string_builder_len */
+
+void string_builder_reserve(string_builder* self, unsigned long num) {
+  dynamic_arr_reserve(&self->__storage__, num);
+
+  return;
+} /* string_builder_reserve */
+
+void string_builder_clear(string_builder* self) {
+  __intern_dynamic_arr_set_num(&self->__storage__, 0);
+
+  return;
+} /* string_builder_clear */
+
+void string_builder_append_bytes(string_builder* self, const void* bytes, unsigned long num) {
+  dynamic_arr_reserve(&self->__storage__, num);
+
+  memcpy(builder_end(self), bytes, num);
+  __intern_dynamic_arr_set_num(&self->__storage__, self->__storage__.num + num);
+
+  return;
+} /* string_builder_append_bytes */
+
+void string_builder_append_str(string_builder* self, const char* str) {
+  string_builder_append_bytes(self, str, strlen(str));
+
+  return;
+} /* string_builder_append_str */
+
+void string_builder_append_char(string_builder* self, char c) {
+  dynamic_arr_reserve(&self->__storage__, 1);
+
+  *builder_end(self) = c;
+  __intern_dynamic_arr_set_num(&self->__storage__, self->__storage__.num + 1);
+
+  return;
+} /* string_builder_append_char */
+
+void string_builder_append_uint(string_builder* self, unsigned long long value) {
+  const unsigned int digits = string_builder_digits(value);
+  dynamic_arr_reserve(&self->__storage__, digits);
+
+  string_builder_write_uint(builder_end(self) + digits, value);
+  __intern_dynamic_arr_set_num(&self->__storage__, self->__storage__.num + digits);
+
+  return;
+} /* string_builder_append_uint */
+
+void string_builder_append_int(string_builder* self, long long value) {
+  if (value >= 0) {
+    string_builder_append_uint(self, (unsigned long long)value);
+
+    return;
+  }
+
+  const unsigned long long magnitude = -(unsigned long long)value;
+  const unsigned int digits = string_builder_digits(magnitude);
+  dynamic_arr_reserve(&self->__storage__, digits + 1);
+
+  char* end = builder_end(self);
+  *end = '-';
+  string_builder_write_uint(end + 1 + digits, magnitude);
+  __intern_dynamic_arr_set_num(&self->__storage__, self->__storage__.num + digits + 1);
+
+  return;
+} /* string_builder_append_int */
+
+void string_builder_append_double(string_builder* self, double value, unsigned int precision) {
+  if (isnan(value)) {
+    string_builder_append_bytes(self, "nan", 3);
+
+    return;
+  }
+
+  const double magnitude = (value < 0 ? -value : value);
+  if (precision > FAST_DOUBLE_MAX_PRECISION
+      || magnitude * (double)pow10_table[precision] >= FAST_DOUBLE_LIMIT) {
+    /* Out of range for the fixed point path, let printf format straight into the spare capacity */
+    string_builder_appendf(self, "%.*f", (int)precision, value);
+
+    return;
+  }
+
+  /* The product is rounded, `residual' is what it is off from the exact one, so the
+   * exact product is rounded like printf does: to the nearest, halfway cases to even */
+  const unsigned long long scale = pow10_table[precision];
+  const double product = magnitude * (double)scale;
+  const double residual = fma(magnitude, (double)scale, -product);
+  const double whole = floor(product);
+  const double above_half = (product - whole) - 0.5;
+
+  unsigned long long scaled = (unsigned long long)whole;
+  if (above_half > -residual || (above_half == -residual && (scaled & 1)))
+    scaled++;
+
+  const unsigned long long integral = scaled / scale;
+  const unsigned long long fraction = scaled % scale;
+
+  const unsigned int negative = (signbit(value) != 0);
+  const unsigned int digits = string_builder_digits(integral);
+  const unsigned long len = negative + digits + (precision ? precision + 1 : 0);
+  dynamic_arr_reserve(&self->__storage__, len);
+
+  char* end = builder_end(self);
+  if (negative)
+    *end = '-';
+  string_builder_write_uint(end + negative + digits, integral);
+
+  if (precision) {
+    char* frac = end + negative + digits;
+    *frac = '.';
+    memset(frac + 1, '0', precision);
+
+    if (fraction)
+      string_builder_write_uint(frac + 1 + precision, fraction);
+  }
+
+  __intern_dynamic_arr_set_num(&self->__storage__, self->__storage__.num + len);
+
+  return;
+} /* string_builder_append_double */
+
+void string_builder_appendf(string_builder* self, const char* fmt, ...) {
+  va_list argp;
+  va_list argp_copy;
+
+  va_start(argp, fmt);
+  va_copy(argp_copy, argp);
+
+  const int len = vsnprintf(NULL, 0, fmt, argp);
+  va_end(argp);
+
+  if (len < 0) {
+    fprintf(stderr,
+        "Failed to format string \"%s\" for string builder!\n"
+        "=== ABORT ===\n",
+        fmt);
+
+    abort();
+  }
+
+  /* One additional byte for the null terminator written by vsnprintf */
+  dynamic_arr_reserve(&self->__storage__, len + 1);
+
+  vsnprintf(builder_end(self), len + 1, fmt, argp_copy);
+  va_end(argp_copy);
+
+  __intern_dynamic_arr_set_num(&self->__storage__, self->__storage__.num + len);
+
+  return;
+} /* string_builder_appendf */
+
+const char* string_builder_cstr(string_builder* self) {
+  dynamic_arr_reserve(&self->__storage__, 1);
+  *builder_end(self) = '\0';
+
+  return dynamic_arr_get_start(&self->__storage__);
+} /* string_builder_cstr */
+
+char* string_builder_release(string_builder* self, unsigned long* len) {
+  string_builder_cstr(self);
+
+  if (len)
+    *len = self->__storage__.num;
+
+  char* str = (char*)self->__storage__.__malloc_start__;
+  self->__storage__ = dynamic_arr_new(char);
+
+  return str;
+} /* string_builder_release */
+
+void string_builder_cleanup(string_builder* self) {
+  dynamic_arr_cleanup(&self->__storage__);
+
+  *self = (string_builder) {0};
+
+  return;
+} /* string_builder_cleanup */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+unsigned int string_builder_digits(unsigned long long value) {
+  unsigned int digits = 1;
+
+  for (;;) {
+    if (value < 10)
+      return digits;
+    if (value < 100)
+      return digits + 1;
+    if (value < 1000)
+      return digits + 2;
+    if (value < 10000)
+      return digits + 3;
+
+    value /= 10000;
+    digits += 4;
+  }
+}
+
+void string_builder_write_uint(char* end, unsigned long long value) {
+  while (value >= 100) {
+    const unsigned int pair = (value % 100) * 2;
+    value /= 100;
+
+    *--end = digit_pairs[pair + 1];
+    *--end = digit_pairs[pair];
+  }
+
+  if (value >= 10) {
+    *--end = digit_pairs[value * 2 + 1];
+    *--end = digit_pairs[value * 2];
+  } else {
+    *--end = '0' + value;
+  }
+
+  return;
+}
+/* ===================== */
@@ -0,0 +1,819 @@
+#define _POSIX_C_SOURCE 200112L
+#include <blib/logging/logger.h>
+#include <blib/memory/alloc.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define DEFAULT_RING_SIZE (64UL * 1024)
+/* A record with a message of LOGGER_MAX_MESSAGE has to fit half of the ring */
+#define MIN_RING_SIZE     (16UL * 1024)
+
+/* Longest "<name>: <prefix> " of a line */
+#define MAX_HEADER 256
+#define MAX_LINE   (MAX_HEADER + LOGGER_MAX_MESSAGE)
+/* Buffer of the writer thread, written with one `write()' */
+#define OUT_SIZE   (64UL * 1024)
+
+/* Arguments of a record formatted by the writer */
+#define MAX_ARGS 16
+/* Longest conversion specification, like "%-08.3lld" */
+#define MAX_SPEC 24
+
+/* Writer thread sleeps at most this long between draining the rings */
+#define WAKEUP_NS (5 * 1000 * 1000L)
+
+#define align_record(size) (((size) + 7) & ~7UL)
+/* ================== */
+
+typedef struct {
+  uint32_t size; /* Bytes of the record, 0 skips to the start of the ring */
+  uint16_t len; /* Length of the message, or number of arguments of a deferred record */
+  uint8_t level;
+  uint8_t deferred; /* Arguments follow the header, formatted by the writer */
+  int32_t fd;
+  uint32_t __pad__;
+  const char* prefix;
+  const char* fmt;
+} logger_record;
+
+typedef union {
+  long long i;
+  unsigned long long u;
+  double d;
+  const void* p;
+  unsigned long offset; /* Of a copied string, after the arguments */
+} logger_arg;
+
+enum logger_arg_type {
+  ARG_NONE, /* "%%" */
+  ARG_SIGNED,
+  ARG_UNSIGNED,
+  ARG_DOUBLE,
+  ARG_CHAR,
+  ARG_STRING,
+  ARG_POINTER,
+  ARG_INVALID, /* Only formatted eagerly */
+};
+
+enum logger_length { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_Z, LEN_J, LEN_T };
+
+typedef struct {
+  const char* start; /* After the '%' */
+  unsigned long flags_len; /* Flags, width and precision */
+  long precision; /* -1 without a precision */
+  enum logger_length length;
+  char conversion;
+  enum logger_arg_type type;
+} logger_spec;
+
+typedef struct logger_ring {
+  unsigned long head; /* Written by the thread */
+  char __pad_head__[64 - sizeof(unsigned long)];
+  unsigned long tail; /* Written by the writer thread */
+  char __pad_tail__[64 - sizeof(unsigned long)];
+
+  unsigned long mask;
+  struct logger_ring* next;
+  int closed; /* Thread exited, freed by the writer once drained */
+  char* data;
+} logger_ring;
+
+typedef struct {
+  char data[OUT_SIZE];
+  unsigned long len;
+  int fd;
+} logger_out;
+
+enum logger_level __intern_logger_level = LOGGER_DEBUG;
+
+static const char* const logger_prefixes[LOGGER_LEVELS] = { "[DEBUG]", "[INFO]", "[WARN]", "[ERR ]" };
+
+static const char* logger_name = NULL;
+
+static bool logger_active = false;
+static bool logger_stopping = false;
+static enum logger_policy logger_policy_used = LOGGER_DROP;
+static unsigned long logger_ring_size = DEFAULT_RING_SIZE;
+static unsigned long logger_dropped_num = 0;
+/* Dropped records the writer reported, taken at the start so none are missed before it runs */
+static unsigned long logger_dropped_reported = 0;
+
+static logger_ring* logger_rings = NULL;
+static __thread logger_ring* logger_thread_ring = NULL;
+static pthread_key_t logger_key;
+static bool logger_key_created = false;
+
+static pthread_t logger_thread;
+static pthread_mutex_t logger_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t logger_wakeup = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t logger_flushed = PTHREAD_COND_INITIALIZER;
+static unsigned long logger_flush_requested = 0;
+static unsigned long logger_flush_done = 0;
+/* Threads of LOGGER_BLOCK wait for the writer to drain the rings once more */
+static pthread_cond_t logger_space = PTHREAD_COND_INITIALIZER;
+static bool logger_space_wanted = false;
+static unsigned long logger_drains = 0;
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+const char* logger_parse_spec(const char* p, logger_spec* spec);
+unsigned long logger_header(char* out, const char* prefix);
+FILE* logger_default_file(enum logger_level level);
+
+logger_ring* logger_ring_get(void);
+void logger_ring_close(void* ring);
+char* logger_ring_reserve(logger_ring* ring, unsigned long size);
+void logger_ring_wait(void);
+bool logger_write_deferred(logger_ring* ring, enum logger_level level, int fd, const char* prefix, const char* fmt, va_list argp);
+void logger_write_eager(logger_ring* ring, enum logger_level level, int fd, const char* prefix, const char* fmt, va_list argp);
+void logger_commit(logger_ring* ring, unsigned long size, enum logger_level level);
+
+void* logger_writer(void* data);
+void logger_drain(logger_out* out);
+void logger_format(logger_out* out, const logger_record* record);
+unsigned long logger_format_deferred(char* out, unsigned long cap, const logger_record* record);
+void logger_out_flush(logger_out* out);
+void logger_write_fd(int fd, const char* data, unsigned long len);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+void __intern_logger_write(enum logger_level level, FILE* file, const char* prefix, const char* fmt, ...) {
+  if (!file)
+    file = logger_default_file(level);
+  va_list argp;
+
+  va_start(argp, fmt);
+
+  logger_ring* ring = (__atomic_load_n(&logger_active, __ATOMIC_ACQUIRE) ? logger_ring_get() : NULL);
+  if (!ring) {
+    /* Not started: the whole line is written at once, in order with other stdio output */
+    char line[MAX_LINE + 1];
+    unsigned long len = logger_header(line, (prefix ? prefix : logger_prefixes[level]));
+    const int written = vsnprintf(line + len, LOGGER_MAX_MESSAGE, fmt, argp);
+    if (written > 0)
+      len += (written < LOGGER_MAX_MESSAGE ? (unsigned long)written : LOGGER_MAX_MESSAGE - 1);
+    line[len++] = '\n';
+
+    fwrite(line, 1, len, file);
+  } else {
+    va_list copy;
+    va_copy(copy, argp);
+    if (!logger_write_deferred(ring, level, fileno(file), prefix, fmt, copy))
+      logger_write_eager(ring, level, fileno(file), prefix, fmt, argp);
+    va_end(copy);
+  }
+
+  va_end(argp);
+
+  return;
+}
+
+bool logger_start(enum logger_policy policy, unsigned long ring_size) {
+  static bool registered = false;
+
+  if (__atomic_load_n(&logger_active, __ATOMIC_ACQUIRE)) {
+    errno = EBUSY;
+    return false;
+  }
+
+  if (!ring_size)
+    ring_size = DEFAULT_RING_SIZE;
+  unsigned long size = MIN_RING_SIZE;
+  while (size < ring_size)
+    size <<= 1;
+
+  if (!logger_key_created) {
+    const int error = pthread_key_create(&logger_key, logger_ring_close);
+    if (error) {
+      errno = error;
+      return false;
+    }
+    logger_key_created = true;
+  }
+
+  logger_policy_used = policy;
+  logger_ring_size = size;
+  logger_stopping = false;
+  logger_dropped_reported = __atomic_load_n(&logger_dropped_num, __ATOMIC_RELAXED);
+
+  const int error = pthread_create(&logger_thread, NULL, logger_writer, NULL);
+  if (error) {
+    errno = error;
+    return false;
+  }
+
+  if (!registered) {
+    atexit(logger_stop);
+    registered = true;
+  }
+
+  /* stdio output before the start comes first */
+  fflush(NULL);
+  __atomic_store_n(&logger_active, true, __ATOMIC_RELEASE);
+
+  return true;
+} /* logger_start */
+
+void logger_flush(void) {
+  if (!__atomic_load_n(&logger_active, __ATOMIC_ACQUIRE)) {
+    fflush(NULL);
+    return;
+  }
+
+  pthread_mutex_lock(&logger_mutex);
+
+  const unsigned long ticket = ++logger_flush_requested;
+  pthread_cond_signal(&logger_wakeup);
+  while (logger_flush_done < ticket)
+    pthread_cond_wait(&logger_flushed, &logger_mutex);
+
+  pthread_mutex_unlock(&logger_mutex);
+
+  return;
+} /* logger_flush */
+
+void logger_stop(void) {
+  if (!__atomic_load_n(&logger_active, __ATOMIC_ACQUIRE))
+    return;
+
+  __atomic_store_n(&logger_active, false, __ATOMIC_RELEASE);
+
+  pthread_mutex_lock(&logger_mutex);
+  logger_stopping = true;
+  pthread_cond_signal(&logger_wakeup);
+  pthread_mutex_unlock(&logger_mutex);
+
+  /* The writer drains every ring once more before it exits */
+  pthread_join(logger_thread, NULL);
+
+  return;
+} /* logger_stop */
+
+void logger_set_level(enum logger_level level) {
+  __atomic_store_n(&__intern_logger_level, level, __ATOMIC_RELAXED);
+
+  return;
+} /* logger_set_level */
+
+void logger_set_name(const char* name) {
+  __atomic_store_n(&logger_name, name, __ATOMIC_RELAXED);
+
+  return;
+} /* logger_set_name */
+
+unsigned long logger_dropped(void) {
+  return __atomic_load_n(&logger_dropped_num, __ATOMIC_RELAXED);
+} /* logger_dropped */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+const char* logger_parse_spec(const char* p, logger_spec* spec) {
+  spec->start = p;
+  spec->precision = -1;
+  spec->length = LEN_NONE;
+  spec->type = ARG_INVALID;
+
+  while (*p && strchr("-+ #0", *p))
+    p++;
+  while (*p >= '0' && *p <= '9')
+    p++;
+  if (*p == '.') {
+    p++;
+    spec->precision = 0;
+    while (*p >= '0' && *p <= '9')
+      spec->precision = (spec->precision > 100000 ? spec->precision : spec->precision * 10 + (*p++ - '0'));
+  }
+  spec->flags_len = p - spec->start;
+
+  switch (*p) {
+    case 'h':
+      spec->length = (p[1] == 'h' ? LEN_HH : LEN_H);
+      p += (p[1] == 'h' ? 2 : 1);
+      break;
+    case 'l':
+      spec->length = (p[1] == 'l' ? LEN_LL : LEN_L);
+      p += (p[1] == 'l' ? 2 : 1);
+      break;
+    case 'z': spec->length = LEN_Z; p++; break;
+    case 'j': spec->length = LEN_J; p++; break;
+    case 't': spec->length = LEN_T; p++; break;
+  }
+
+  spec->conversion = *p;
+  if (!*p)
+    return p;
+
+  /* Wide characters and strings, `*' widths, `L' and `n' are only formatted eagerly */
+  switch (*p) {
+    case '%':
+      spec->type = (p == spec->start ? ARG_NONE : ARG_INVALID);
+      break;
+    case 'd': case 'i':
+      spec->type = ARG_SIGNED;
+      break;
+    case 'u': case 'o': case 'x': case 'X':
+      spec->type = ARG_UNSIGNED;
+      break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+      spec->type = (spec->length == LEN_NONE || spec->length == LEN_L ? ARG_DOUBLE : ARG_INVALID);
+      break;
+    case 'c':
+      spec->type = (spec->length == LEN_NONE ? ARG_CHAR : ARG_INVALID);
+      break;
+    case 's':
+      spec->type = (spec->length == LEN_NONE ? ARG_STRING : ARG_INVALID);
+      break;
+    case 'p':
+      spec->type = (spec->length == LEN_NONE ? ARG_POINTER : ARG_INVALID);
+      break;
+  }
+
+  if (spec->flags_len + 4 > MAX_SPEC)
+    spec->type = ARG_INVALID;
+
+  return p + 1;
+}
+
+unsigned long logger_header(char* out, const char* prefix) {
+  const char* name = __atomic_load_n(&logger_name, __ATOMIC_RELAXED);
+
+  const int len = (name ? snprintf(out, MAX_HEADER, "%s: %s ", name, prefix) : snprintf(out, MAX_HEADER, "%s ", prefix));
+  if (len < 0)
+    return 0;
+
+  return (len < MAX_HEADER ? (unsigned long)len : MAX_HEADER - 1);
+}
+
+FILE* logger_default_file(enum logger_level level) {
+  return (level >= LOGGER_WARN ? stderr : stdout);
+}
+
+logger_ring* logger_ring_get(void) {
+  logger_ring* ring = logger_thread_ring;
+  if (ring)
+    return ring;
+
+  const unsigned long size = logger_ring_size;
+  ring = blib_malloc(sizeof(*ring) + size);
+  if (!ring)
+    return NULL;
+
+  memset(ring, 0, sizeof(*ring));
+  ring->mask = size - 1;
+  ring->data = (char*)(ring + 1);
+
+  /* Only the writer unlinks rings, and never the first one */
+  ring->next = __atomic_load_n(&logger_rings, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&logger_rings, &ring->next, ring, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    ;
+
+  logger_thread_ring = ring;
+  pthread_setspecific(logger_key, ring);
+
+  return ring;
+}
+
+void logger_ring_close(void* ring) {
+  logger_thread_ring = NULL;
+  __atomic_store_n(&((logger_ring*)ring)->closed, 1, __ATOMIC_RELEASE);
+
+  return;
+}
+
+char* logger_ring_reserve(logger_ring* ring, unsigned long size) {
+  const unsigned long capacity = ring->mask + 1;
+  unsigned long head = ring->head;
+
+  for (;;) {
+    const unsigned long tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    const unsigned long offset = head & ring->mask;
+    const unsigned long contiguous = capacity - offset;
+    /* A record never wraps around, the rest of the ring is skipped */
+    const unsigned long needed = (contiguous < size ? contiguous + size : size);
+
+    if (capacity - (head - tail) >= needed) {
+      if (contiguous < size) {
+        /* Published like a commit, the writer must see the marker before the new head */
+        ((logger_record*)(ring->data + offset))->size = 0;
+        __atomic_store_n(&ring->head, head + contiguous, __ATOMIC_RELEASE);
+        return ring->data;
+      }
+
+      return ring->data + offset;
+    }
+
+    if (logger_policy_used == LOGGER_DROP) {
+      __atomic_fetch_add(&logger_dropped_num, 1, __ATOMIC_RELAXED);
+      return NULL;
+    }
+
+    logger_ring_wait();
+  }
+}
+
+void logger_ring_wait(void) {
+  pthread_mutex_lock(&logger_mutex);
+
+  /* The writer advances the tails before it counts the drain, under the mutex */
+  const unsigned long drains = logger_drains;
+  logger_space_wanted = true;
+  pthread_cond_signal(&logger_wakeup);
+  while (logger_drains == drains)
+    pthread_cond_wait(&logger_space, &logger_mutex);
+
+  pthread_mutex_unlock(&logger_mutex);
+
+  return;
+}
+
+void logger_commit(logger_ring* ring, unsigned long size, enum logger_level level) {
+  const unsigned long head = ring->head + size;
+  __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+  /* The writer polls, it's only woken up early for errors and filling rings */
+  if (level == LOGGER_ERR || head - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED) > (ring->mask + 1) / 2)
+    pthread_cond_signal(&logger_wakeup);
+
+  return;
+}
+
+bool logger_write_deferred(logger_ring* ring, enum logger_level level, int fd, const char* prefix, const char* fmt, va_list argp) {
+  logger_arg args[MAX_ARGS];
+  const char* strings[MAX_ARGS];
+  unsigned long lengths[MAX_ARGS];
+  unsigned long num = 0;
+  unsigned long string_bytes = 0;
+
+  for (const char* p = fmt; *p;) {
+    if (*p++ != '%')
+      continue;
+
+    logger_spec spec;
+    p = logger_parse_spec(p, &spec);
+    if (spec.type == ARG_NONE)
+      continue;
+    if (spec.type == ARG_INVALID || num == MAX_ARGS)
+      return false;
+
+    logger_arg* arg = &args[num];
+    switch (spec.type) {
+      case ARG_SIGNED:
+        switch (spec.length) {
+          case LEN_HH: arg->i = (signed char)va_arg(argp, int); break;
+          case LEN_H:  arg->i = (short)va_arg(argp, int); break;
+          case LEN_L:  arg->i = va_arg(argp, long); break;
+          case LEN_LL: arg->i = va_arg(argp, long long); break;
+          case LEN_Z:  arg->i = (long long)va_arg(argp, size_t); break;
+          case LEN_J:  arg->i = va_arg(argp, intmax_t); break;
+          case LEN_T:  arg->i = va_arg(argp, ptrdiff_t); break;
+          default:     arg->i = va_arg(argp, int); break;
+        }
+        break;
+      case ARG_UNSIGNED:
+        switch (spec.length) {
+          case LEN_HH: arg->u = (unsigned char)va_arg(argp, unsigned int); break;
+          case LEN_H:  arg->u = (unsigned short)va_arg(argp, unsigned int); break;
+          case LEN_L:  arg->u = va_arg(argp, unsigned long); break;
+          case LEN_LL: arg->u = va_arg(argp, unsigned long long); break;
+          case LEN_Z:  arg->u = va_arg(argp, size_t); break;
+          case LEN_J:  arg->u = va_arg(argp, uintmax_t); break;
+          case LEN_T:  arg->u = (unsigned long long)va_arg(argp, ptrdiff_t); break;
+          default:     arg->u = va_arg(argp, unsigned int); break;
+        }
+        break;
+      case ARG_DOUBLE:
+        arg->d = va_arg(argp, double);
+        break;
+      case ARG_CHAR:
+        arg->i = va_arg(argp, int);
+        break;
+      case ARG_POINTER:
+        arg->p = va_arg(argp, void*);
+        break;
+      case ARG_STRING: {
+        const char* string = va_arg(argp, const char*);
+        if (!string)
+          string = "(null)";
+
+        /* Only the characters that are printed are copied */
+        unsigned long len = 0;
+        if (spec.precision >= 0) {
+          const char* end = memchr(string, 0, spec.precision);
+          len = (end ? (unsigned long)(end - string) : (unsigned long)spec.precision);
+        } else {
+          len = strlen(string);
+        }
+
+        if (len > LOGGER_MAX_MESSAGE)
+          return false;
+        strings[num] = string;
+        lengths[num] = len;
+        arg->offset = string_bytes;
+        string_bytes += len + 1;
+        break;
+      }
+      default:
+        return false;
+    }
+
+    if (spec.type != ARG_STRING)
+      strings[num] = NULL;
+    num++;
+  }
+
+  const unsigned long size = align_record(sizeof(logger_record) + num * sizeof(logger_arg) + string_bytes);
+  if (size > (ring->mask + 1) / 2)
+    return false;
+
+  char* data = logger_ring_reserve(ring, size);
+  if (!data)
+    return true;
+
+  logger_record* record = (logger_record*)data;
+  record->size = size;
+  record->len = num;
+  record->level = level;
+  record->deferred = 1;
+  record->fd = fd;
+  record->prefix = prefix;
+  record->fmt = fmt;
+
+  memcpy(record + 1, args, num * sizeof(logger_arg));
+  char* copies = (char*)(record + 1) + num * sizeof(logger_arg);
+  for (unsigned long a = 0; a < num; a++) {
+    if (!strings[a])
+      continue;
+
+    memcpy(copies + args[a].offset, strings[a], lengths[a]);
+    copies[args[a].offset + lengths[a]] = 0;
+  }
+
+  logger_commit(ring, size, level);
+
+  return true;
+}
+
+void logger_write_eager(logger_ring* ring, enum logger_level level, int fd, const char* prefix, const char* fmt, va_list argp) {
+  char message[LOGGER_MAX_MESSAGE];
+  const int written = vsnprintf(message, sizeof(message), fmt, argp);
+  const unsigned long len = (written < 0 ? 0 : (written < LOGGER_MAX_MESSAGE ? (unsigned long)written : LOGGER_MAX_MESSAGE - 1));
+
+  const unsigned long size = align_record(sizeof(logger_record) + len);
+  char* data = logger_ring_reserve(ring, size);
+  if (!data)
+    return;
+
+  logger_record* record = (logger_record*)data;
+  record->size = size;
+  record->len = len;
+  record->level = level;
+  record->deferred = 0;
+  record->fd = fd;
+  record->prefix = prefix;
+  record->fmt = NULL;
+  memcpy(record + 1, message, len);
+
+  logger_commit(ring, size, level);
+
+  return;
+}
+
+void* logger_writer(void* data) {
+  (void)data;
+  logger_out* out = blib_malloc(sizeof(*out));
+  if (!out) {
+    fprintf(stderr, "Couldn't allocate the buffer of the logger!\n=== ABORT ===\n");
+    abort();
+  }
+  out->len = 0;
+  out->fd = -1;
+
+  unsigned long reported = logger_dropped_reported;
+
+  pthread_mutex_lock(&logger_mutex);
+  for (;;) {
+    const bool stopping = logger_stopping;
+    const unsigned long requested = logger_flush_requested;
+    pthread_mutex_unlock(&logger_mutex);
+
+    logger_drain(out);
+
+    const unsigned long dropped = __atomic_load_n(&logger_dropped_num, __ATOMIC_RELAXED);
+    if (dropped != reported) {
+      logger_out_flush(out);
+      char line[MAX_LINE];
+      unsigned long len = logger_header(line, logger_prefixes[LOGGER_WARN]);
+      len += snprintf(line + len, LOGGER_MAX_MESSAGE, "logger dropped %lu records\n", dropped - reported);
+      logger_write_fd(fileno(stderr), line, len);
+      reported = dropped;
+    }
+    logger_out_flush(out);
+
+    pthread_mutex_lock(&logger_mutex);
+    logger_drains++;
+    if (logger_space_wanted) {
+      logger_space_wanted = false;
+      pthread_cond_broadcast(&logger_space);
+    }
+    if (logger_flush_done != requested) {
+      logger_flush_done = requested;
+      pthread_cond_broadcast(&logger_flushed);
+    }
+    if (stopping)
+      break;
+
+    if (!logger_stopping && logger_flush_requested == requested) {
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += WAKEUP_NS;
+      if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+      }
+      pthread_cond_timedwait(&logger_wakeup, &logger_mutex, &deadline);
+    }
+  }
+  pthread_mutex_unlock(&logger_mutex);
+
+  blib_free(out);
+
+  return NULL;
+}
+
+void logger_drain(logger_out* out) {
+  logger_ring* prev = NULL;
+  logger_ring* ring = __atomic_load_n(&logger_rings, __ATOMIC_ACQUIRE);
+
+  while (ring) {
+    /* Everything before closing was committed */
+    const int closed = __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE);
+    const unsigned long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    unsigned long tail = ring->tail;
+
+    while (tail != head) {
+      const logger_record* record = (const logger_record*)(ring->data + (tail & ring->mask));
+      if (!record->size) {
+        tail += ring->mask + 1 - (tail & ring->mask);
+        continue;
+      }
+
+      logger_format(out, record);
+      tail += record->size;
+      __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+
+    logger_ring* next = ring->next;
+    if (closed && prev) {
+      prev->next = next;
+      blib_free(ring);
+    } else {
+      prev = ring;
+    }
+    ring = next;
+  }
+
+  return;
+}
+
+void logger_format(logger_out* out, const logger_record* record) {
+  if (out->fd != record->fd || out->len + MAX_LINE + 1 > OUT_SIZE) {
+    logger_out_flush(out);
+    out->fd = record->fd;
+  }
+
+  char* line = out->data + out->len;
+  unsigned long len = logger_header(line, (record->prefix ? record->prefix : logger_prefixes[record->level]));
+
+  if (record->deferred) {
+    len += logger_format_deferred(line + len, LOGGER_MAX_MESSAGE, record);
+  } else {
+    memcpy(line + len, record + 1, record->len);
+    len += record->len;
+  }
+  line[len++] = '\n';
+
+  out->len += len;
+
+  return;
+}
+
+unsigned long logger_format_deferred(char* out, unsigned long cap, const logger_record* record) {
+  const logger_arg* args = (const logger_arg*)(record + 1);
+  const char* strings = (const char*)(args + record->len);
+  unsigned long len = 0;
+  unsigned long num = 0;
+
+  /* Keeps one character for the terminator of `snprintf()' */
+  for (const char* p = record->fmt; *p && len + 1 < cap;) {
+    if (*p != '%') {
+      out[len++] = *p++;
+      continue;
+    }
+
+    logger_spec spec;
+    p = logger_parse_spec(p + 1, &spec);
+    if (spec.type == ARG_NONE) {
+      out[len++] = '%';
+      continue;
+    }
+
+    /* Plain integers and strings are the most common, they skip `snprintf()' */
+    if (!spec.flags_len && (spec.type == ARG_SIGNED || spec.type == ARG_STRING || (spec.type == ARG_UNSIGNED && spec.conversion == 'u'))) {
+      const logger_arg* arg = &args[num++];
+      if (spec.type == ARG_STRING) {
+        const char* string = strings + arg->offset;
+        while (*string && len + 1 < cap)
+          out[len++] = *string++;
+        continue;
+      }
+
+      char digits[24];
+      unsigned long d = sizeof(digits);
+      unsigned long long value = (spec.type == ARG_SIGNED && arg->i < 0 ? -(unsigned long long)arg->i : arg->u);
+      do {
+        digits[--d] = '0' + value % 10;
+        value /= 10;
+      } while (value);
+      if (spec.type == ARG_SIGNED && arg->i < 0)
+        digits[--d] = '-';
+
+      while (d < sizeof(digits) && len + 1 < cap)
+        out[len++] = digits[d++];
+      continue;
+    }
+
+    /* Integers are stored as long long, the length is replaced */
+    char format[MAX_SPEC];
+    unsigned long f = 0;
+    format[f++] = '%';
+    memcpy(format + f, spec.start, spec.flags_len);
+    f += spec.flags_len;
+    if (spec.type == ARG_SIGNED || spec.type == ARG_UNSIGNED) {
+      format[f++] = 'l';
+      format[f++] = 'l';
+    }
+    format[f++] = spec.conversion;
+    format[f] = 0;
+
+    const logger_arg* arg = &args[num++];
+    int written = 0;
+    switch (spec.type) {
+      case ARG_SIGNED:   written = snprintf(out + len, cap - len, format, arg->i); break;
+      case ARG_UNSIGNED: written = snprintf(out + len, cap - len, format, arg->u); break;
+      case ARG_DOUBLE:   written = snprintf(out + len, cap - len, format, arg->d); break;
+      case ARG_CHAR:     written = snprintf(out + len, cap - len, format, (int)arg->i); break;
+      case ARG_POINTER:  written = snprintf(out + len, cap - len, format, arg->p); break;
+      case ARG_STRING:   written = snprintf(out + len, cap - len, format, strings + arg->offset); break;
+      default: break;
+    }
+
+    if (written > 0)
+      len += ((unsigned long)written < cap - len ? (unsigned long)written : cap - len - 1);
+  }
+
+  return len;
+}
+
+void logger_out_flush(logger_out* out) {
+  if (out->len)
+    logger_write_fd(out->fd, out->data, out->len);
+  out->len = 0;
+
+  return;
+}
+
+void logger_write_fd(int fd, const char* data, unsigned long len) {
+  while (len) {
+    const ssize_t written = write(fd, data, len);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      /* Nothing left to report the error to */
+      return;
+    }
+
+    data += written;
+    len -= written;
+  }
+
+  return;
+}
+/* ===================== */
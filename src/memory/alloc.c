@@ -0,0 +1,123 @@
+#define _POSIX_C_SOURCE 200112L
+#include <blib/memory/alloc.h>
+
+#include <stdlib.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+/* Without usable sizes live and peak bytes stay 0, `sized' tells them apart from nothing allocated */
+#ifdef __GLIBC__
+#define HAVE_USABLE_SIZE 1
+#define usable_size(ptr) ((int64_t)malloc_usable_size(ptr))
+#else
+#define HAVE_USABLE_SIZE 0
+#define usable_size(ptr) ((int64_t)0)
+#endif
+
+#define count(field, value) __atomic_add_fetch(&stats.field, value, __ATOMIC_RELAXED)
+/* ================== */
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+void blib_alloc_count_live(int64_t change);
+/* ================================== */
+
+static bool tracking;
+static blib_alloc_stats stats;
+
+/* =============
+ * API Functions
+ * ============= */
+void* blib_malloc(size_t size) {
+  void* ptr = malloc(size);
+  if (!ptr || !__atomic_load_n(&tracking, __ATOMIC_RELAXED))
+    return ptr;
+
+  count(mallocs, 1);
+  count(bytes, size);
+  blib_alloc_count_live(usable_size(ptr));
+
+  return ptr;
+} /* blib_malloc */
+
+void* blib_realloc(void* ptr, size_t size) {
+  if (!__atomic_load_n(&tracking, __ATOMIC_RELAXED))
+    return realloc(ptr, size);
+
+  const int64_t old = (ptr ? usable_size(ptr) : 0);
+  void* new = realloc(ptr, size);
+  if (!new)
+    return new;
+
+  count(reallocs, 1);
+  count(bytes, size);
+  blib_alloc_count_live(usable_size(new) - old);
+
+  return new;
+} /* blib_realloc */
+
+int blib_posix_memalign(void** ptr, size_t alignment, size_t size) {
+  const int error = posix_memalign(ptr, alignment, size);
+  if (error || !__atomic_load_n(&tracking, __ATOMIC_RELAXED))
+    return error;
+
+  count(mallocs, 1);
+  count(bytes, size);
+  blib_alloc_count_live(usable_size(*ptr));
+
+  return 0;
+} /* blib_posix_memalign */
+
+void blib_free(void* ptr) {
+  if (ptr && __atomic_load_n(&tracking, __ATOMIC_RELAXED)) {
+    count(frees, 1);
+    blib_alloc_count_live(-usable_size(ptr));
+  }
+
+  free(ptr);
+
+  return;
+} /* blib_free */
+
+bool blib_alloc_track(bool enable) {
+  return __atomic_exchange_n(&tracking, enable, __ATOMIC_RELAXED);
+} /* blib_alloc_track */
+
+blib_alloc_stats blib_alloc_stats_get(void) {
+  return (blib_alloc_stats) {
+    .mallocs = __atomic_load_n(&stats.mallocs, __ATOMIC_RELAXED),
+    .reallocs = __atomic_load_n(&stats.reallocs, __ATOMIC_RELAXED),
+    .frees = __atomic_load_n(&stats.frees, __ATOMIC_RELAXED),
+    .bytes = __atomic_load_n(&stats.bytes, __ATOMIC_RELAXED),
+    .live = __atomic_load_n(&stats.live, __ATOMIC_RELAXED),
+    .peak = __atomic_load_n(&stats.peak, __ATOMIC_RELAXED),
+    .sized = HAVE_USABLE_SIZE,
+  };
+} /* blib_alloc_stats_get */
+
+void blib_alloc_reset_peak(void) {
+  __atomic_store_n(&stats.peak, __atomic_load_n(&stats.live, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+
+  return;
+} /* blib_alloc_reset_peak */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+void blib_alloc_count_live(int64_t change) {
+  const int64_t live = count(live, change);
+
+  int64_t peak = __atomic_load_n(&stats.peak, __ATOMIC_RELAXED);
+  while (live > peak && !__atomic_compare_exchange_n(&stats.peak, &peak, live, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    ;
+
+  return;
+}
+/* ===================== */
@@ -0,0 +1,484 @@
+#include <blib/memory/kernels.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNEL_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+/*
+ * Fill and swap only differ in the width of the vectors, they are written once with
+ * vectors of GCC's vector extension (unaligned, so any pointer can be cast).
+ */
+#define KERNEL_MEMORY_VARIANTS(isa, target_name, vec)                                     \
+  __attribute__((target(target_name)))                                                    \
+  void kernel_fill_##isa(void* dst, const void* pattern, unsigned long size, unsigned long num) {\
+    /* Patterns that don't divide a vector are doubled with `memcpy()' */                 \
+    if (size < 2 || sizeof(vec) % size || size * num < 2 * sizeof(vec)) {                 \
+      kernel_fill_scalar(dst, pattern, size, num);                                        \
+      return;                                                                             \
+    }                                                                                     \
+                                                                                          \
+    /* Two vectors of the pattern, a vector at offset `o' starts at phase `o % size' */   \
+    uint8_t buffer[2 * sizeof(vec)];                                                      \
+    for (unsigned long i = 0; i < sizeof(buffer); i += size) {                            \
+      /* Copies of constant size are inlined */                                           \
+      switch (size) {                                                                     \
+        case 2:  memcpy(buffer + i, pattern, 2);  break;                                  \
+        case 4:  memcpy(buffer + i, pattern, 4);  break;                                  \
+        case 8:  memcpy(buffer + i, pattern, 8);  break;                                  \
+        case 16: memcpy(buffer + i, pattern, 16); break;                                  \
+        default: memcpy(buffer + i, pattern, size); break;                                \
+      }                                                                                   \
+    }                                                                                     \
+                                                                                          \
+    uint8_t* d = dst;                                                                     \
+    uint8_t* end = d + size * num;                                                        \
+    const unsigned long head = (sizeof(vec) - ((uintptr_t)d & (sizeof(vec) - 1))) & (sizeof(vec) - 1);\
+                                                                                          \
+    /* Unaligned first and last vectors, aligned ones in between */                       \
+    *(vec*)d = *(const vec*)buffer;                                                       \
+    *(vec*)(end - sizeof(vec)) = *(const vec*)(buffer + (size * num - sizeof(vec)) % size);\
+                                                                                          \
+    const vec v = *(const vec*)(buffer + head % size);                                    \
+    for (d += head; end - d >= (long)(4 * sizeof(vec)); d += 4 * sizeof(vec)) {           \
+      ((vec*)d)[0] = v; ((vec*)d)[1] = v; ((vec*)d)[2] = v; ((vec*)d)[3] = v;             \
+    }                                                                                     \
+    for (; end - d >= (long)sizeof(vec); d += sizeof(vec))                                \
+      *(vec*)d = v;                                                                       \
+  }                                                                                       \
+                                                                                          \
+  __attribute__((target(target_name)))                                                    \
+  void kernel_swap_##isa(void* a, void* b, unsigned long len) {                           \
+    uint8_t* x = a;                                                                       \
+    uint8_t* y = b;                                                                       \
+    for (; len >= 4 * sizeof(vec); len -= 4 * sizeof(vec), x += 4 * sizeof(vec), y += 4 * sizeof(vec)) { \
+      const vec x0 = ((vec*)x)[0], x1 = ((vec*)x)[1], x2 = ((vec*)x)[2], x3 = ((vec*)x)[3]; \
+      const vec y0 = ((vec*)y)[0], y1 = ((vec*)y)[1], y2 = ((vec*)y)[2], y3 = ((vec*)y)[3]; \
+      ((vec*)x)[0] = y0; ((vec*)x)[1] = y1; ((vec*)x)[2] = y2; ((vec*)x)[3] = y3;         \
+      ((vec*)y)[0] = x0; ((vec*)y)[1] = x1; ((vec*)y)[2] = x2; ((vec*)y)[3] = x3;         \
+    }                                                                                     \
+    for (; len >= sizeof(vec); len -= sizeof(vec), x += sizeof(vec), y += sizeof(vec)) {  \
+      const vec t = *(vec*)x;                                                             \
+      *(vec*)x = *(vec*)y;                                                                \
+      *(vec*)y = t;                                                                       \
+    }                                                                                     \
+    kernel_swap_scalar(x, y, len);                                                        \
+  }
+
+/*
+ * Unpacking is written once with 16 byte vectors, the wider variants get the VEX encoded
+ * version of it since the lanes of a block are four wide. Every width gets its own fully
+ * unrolled copy, so all shifts are immediates.
+ */
+#define KERNEL_UNPACK_VARIANT(isa, target_name)                                           \
+  __attribute__((target(target_name), always_inline))                                     \
+  static inline void kernel_unpack_bits_##isa(uint32_t* out, const __m128i* in, const unsigned int bits) {\
+    const __m128i mask = _mm_set1_epi32((int)(bits < 32 ? (1U << bits) - 1 : ~0U));      \
+                                                                                          \
+    _Pragma("GCC unroll 32")                                                              \
+    for (unsigned int pos = 0; pos < KERNEL_UNPACK_BLOCK / 4; pos++) {                    \
+      const unsigned int bit = pos * bits;                                                \
+      __m128i v = _mm_srli_epi32(_mm_loadu_si128(in + bit / 32), bit % 32);               \
+      if (bit % 32 + bits > 32)                                                           \
+        v = _mm_or_si128(v, _mm_slli_epi32(_mm_loadu_si128(in + bit / 32 + 1), 32 - bit % 32));\
+      _mm_storeu_si128((__m128i*)out + pos, _mm_and_si128(v, mask));                      \
+    }                                                                                     \
+  }                                                                                       \
+                                                                                          \
+  __attribute__((target(target_name)))                                                    \
+  void kernel_unpack_##isa(uint32_t* out, const void* in, unsigned int bits) {            \
+    switch (bits) {                                                                       \
+      case 0: memset(out, 0, KERNEL_UNPACK_BLOCK * sizeof(uint32_t)); break;              \
+      KERNEL_UNPACK_CASES(isa, 1, 2, 3, 4, 5, 6, 7, 8)                                    \
+      KERNEL_UNPACK_CASES(isa, 9, 10, 11, 12, 13, 14, 15, 16)                             \
+      KERNEL_UNPACK_CASES(isa, 17, 18, 19, 20, 21, 22, 23, 24)                            \
+      KERNEL_UNPACK_CASES(isa, 25, 26, 27, 28, 29, 30, 31, 32)                            \
+      default: kernel_unpack_scalar(out, in, bits); break;                                \
+    }                                                                                     \
+  }
+
+#define KERNEL_UNPACK_CASES(isa, a, b, c, d, e, f, g, h)                                  \
+  case a: kernel_unpack_bits_##isa(out, in, a); break;                                    \
+  case b: kernel_unpack_bits_##isa(out, in, b); break;                                    \
+  case c: kernel_unpack_bits_##isa(out, in, c); break;                                    \
+  case d: kernel_unpack_bits_##isa(out, in, d); break;                                    \
+  case e: kernel_unpack_bits_##isa(out, in, e); break;                                    \
+  case f: kernel_unpack_bits_##isa(out, in, f); break;                                    \
+  case g: kernel_unpack_bits_##isa(out, in, g); break;                                    \
+  case h: kernel_unpack_bits_##isa(out, in, h); break;
+/* ================== */
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+void kernel_init(void) __attribute__((constructor));
+unsigned long long kernel_xgetbv(void);
+
+void kernel_move_scalar(void* dst, const void* src, unsigned long len);
+void kernel_fill_scalar(void* dst, const void* pattern, unsigned long size, unsigned long num);
+void kernel_swap_scalar(void* a, void* b, unsigned long len);
+const char* kernel_find_scalar(const char* p, const char* end, char a, char b);
+unsigned long kernel_count_scalar(const char* p, const char* end, char a, char b);
+void kernel_unpack_scalar(uint32_t* out, const void* in, unsigned int bits);
+
+#if KERNEL_X86
+typedef uint8_t kernel_v16 __attribute__((vector_size(16), aligned(1), may_alias));
+typedef uint8_t kernel_v32 __attribute__((vector_size(32), aligned(1), may_alias));
+typedef uint8_t kernel_v64 __attribute__((vector_size(64), aligned(1), may_alias));
+
+void kernel_fill_sse2(void* dst, const void* pattern, unsigned long size, unsigned long num);
+void kernel_swap_sse2(void* a, void* b, unsigned long len);
+void kernel_fill_avx2(void* dst, const void* pattern, unsigned long size, unsigned long num);
+void kernel_swap_avx2(void* a, void* b, unsigned long len);
+void kernel_fill_avx512(void* dst, const void* pattern, unsigned long size, unsigned long num);
+void kernel_swap_avx512(void* a, void* b, unsigned long len);
+const char* kernel_find_sse2(const char* p, const char* end, char a, char b);
+unsigned long kernel_count_sse2(const char* p, const char* end, char a, char b);
+const char* kernel_find_avx2(const char* p, const char* end, char a, char b);
+unsigned long kernel_count_avx2(const char* p, const char* end, char a, char b);
+const char* kernel_find_avx512(const char* p, const char* end, char a, char b);
+unsigned long kernel_count_avx512(const char* p, const char* end, char a, char b);
+void kernel_unpack_sse2(uint32_t* out, const void* in, unsigned int bits);
+void kernel_unpack_avx2(uint32_t* out, const void* in, unsigned int bits);
+void kernel_unpack_avx512(uint32_t* out, const void* in, unsigned int bits);
+
+#endif
+/* ================================== */
+
+/* `memmove()' of the C library is dispatched already, vector loops were slower for every length */
+static const kernel_table kernel_variants[KERNEL_ISAS] = {
+  [KERNEL_ISA_SCALAR] = { kernel_move_scalar, kernel_fill_scalar, kernel_swap_scalar, kernel_find_scalar, kernel_count_scalar, kernel_unpack_scalar },
+#if KERNEL_X86
+  [KERNEL_ISA_SSE2]   = { kernel_move_scalar, kernel_fill_sse2,   kernel_swap_sse2,   kernel_find_sse2,   kernel_count_sse2,   kernel_unpack_sse2   },
+  [KERNEL_ISA_AVX2]   = { kernel_move_scalar, kernel_fill_avx2,   kernel_swap_avx2,   kernel_find_avx2,   kernel_count_avx2,   kernel_unpack_avx2   },
+  [KERNEL_ISA_AVX512] = { kernel_move_scalar, kernel_fill_avx512, kernel_swap_avx512, kernel_find_avx512, kernel_count_avx512, kernel_unpack_avx512 },
+#endif
+};
+
+static const char* const kernel_isa_names[KERNEL_ISAS] = { "scalar", "sse2", "avx2", "avx512" };
+
+kernel_table __intern_kernels = { kernel_move_scalar, kernel_fill_scalar, kernel_swap_scalar, kernel_find_scalar, kernel_count_scalar, kernel_unpack_scalar };
+static enum kernel_isa kernel_selected = KERNEL_ISA_SCALAR;
+
+/* =============
+ * API Functions
+ * ============= */
+enum kernel_isa kernel_isa_supported(void) {
+#if KERNEL_X86
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(edx & bit_SSE2))
+    return KERNEL_ISA_SCALAR;
+
+  /* The operating system has to save the vector registers too */
+  if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+    return KERNEL_ISA_SSE2;
+  const unsigned long long xcr0 = kernel_xgetbv();
+  if ((xcr0 & 0x6) != 0x6 || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) || !(ebx & bit_AVX2))
+    return KERNEL_ISA_SSE2;
+
+  /* Opmask and both halves of the ZMM registers */
+  if ((ebx & bit_AVX512F) && (ebx & bit_AVX512BW) && (xcr0 & 0xe0) == 0xe0)
+    return KERNEL_ISA_AVX512;
+
+  return KERNEL_ISA_AVX2;
+#else
+  return KERNEL_ISA_SCALAR;
+#endif
+} /* kernel_isa_supported */
+
+enum kernel_isa kernel_isa_selected(void) {
+  return kernel_selected;
+} /* kernel_isa_selected */
+
+bool kernel_isa_select(enum kernel_isa isa) {
+  if ((unsigned int)isa >= KERNEL_ISAS || isa > kernel_isa_supported()) {
+    errno = ENOTSUP;
+    return false;
+  }
+
+  __intern_kernels = kernel_variants[isa];
+  kernel_selected = isa;
+
+  return true;
+} /* kernel_isa_select */
+
+const char* kernel_isa_str(enum kernel_isa isa) {
+  return ((unsigned int)isa < KERNEL_ISAS ? kernel_isa_names[isa] : "unknown");
+} /* kernel_isa_str */
+
+void kernel_pack(uint32_t* out, const uint32_t* in, unsigned int bits) {
+  memset(out, 0, bits * 4 * sizeof(uint32_t));
+
+  for (unsigned int i = 0; i < KERNEL_UNPACK_BLOCK; i++) {
+    const unsigned int bit = (i / 4) * bits;
+    uint32_t* word = out + (bit / 32) * 4 + i % 4;
+
+    *word |= in[i] << (bit % 32);
+    if (bit % 32 + bits > 32)
+      word[4] |= in[i] >> (32 - bit % 32);
+  }
+
+  return;
+} /* kernel_pack */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+void kernel_init(void) {
+  const char* forced = getenv(KERNEL_ISA_ENV);
+  if (!forced || !*forced) {
+    kernel_isa_select(kernel_isa_supported());
+    return;
+  }
+
+  for (unsigned int isa = 0; isa < KERNEL_ISAS; isa++) {
+    if (strcmp(forced, kernel_isa_names[isa]))
+      continue;
+
+    /* Silently running another variant would make benchmarks lie */
+    if (!kernel_isa_select(isa)) {
+      fprintf(stderr, KERNEL_ISA_ENV "=%s isn't supported by this CPU (up to %s)!\n=== ABORT ===\n",
+          forced, kernel_isa_names[kernel_isa_supported()]);
+      abort();
+    }
+
+    return;
+  }
+
+  fprintf(stderr, "Unknown " KERNEL_ISA_ENV "=%s, expected scalar, sse2, avx2 or avx512!\n=== ABORT ===\n", forced);
+  abort();
+}
+
+unsigned long long kernel_xgetbv(void) {
+#if KERNEL_X86
+  unsigned int lo, hi;
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+
+  return ((unsigned long long)hi << 32) | lo;
+#else
+  return 0;
+#endif
+}
+
+void kernel_move_scalar(void* dst, const void* src, unsigned long len) {
+  memmove(dst, src, len);
+
+  return;
+}
+
+void kernel_fill_scalar(void* dst, const void* pattern, unsigned long size, unsigned long num) {
+  if (!size || !num)
+    return;
+  if (size == 1) {
+    memset(dst, *(const uint8_t*)pattern, num);
+    return;
+  }
+
+  /* Copies of what is filled already, doubling every time */
+  uint8_t* d = dst;
+  const unsigned long len = size * num;
+  memcpy(d, pattern, size);
+  for (unsigned long filled = size; filled < len; filled <<= 1)
+    memcpy(d + filled, d, (filled < len - filled ? filled : len - filled));
+
+  return;
+}
+
+void kernel_swap_scalar(void* a, void* b, unsigned long len) {
+  uint8_t* x = a;
+  uint8_t* y = b;
+
+  for (; len >= 8; len -= 8, x += 8, y += 8) {
+    uint64_t t, u;
+    memcpy(&t, x, 8);
+    memcpy(&u, y, 8);
+    memcpy(x, &u, 8);
+    memcpy(y, &t, 8);
+  }
+
+  for (; len; len--, x++, y++) {
+    const uint8_t t = *x;
+    *x = *y;
+    *y = t;
+  }
+
+  return;
+}
+
+const char* kernel_find_scalar(const char* p, const char* end, char a, char b) {
+  for (; p < end; p++)
+    if (*p == a || *p == b)
+      return p;
+
+  return end;
+}
+
+unsigned long kernel_count_scalar(const char* p, const char* end, char a, char b) {
+  unsigned long count = 0;
+
+  for (; p < end; p++)
+    count += (*p == a || *p == b);
+
+  return count;
+}
+
+void kernel_unpack_scalar(uint32_t* out, const void* in, unsigned int bits) {
+  const uint32_t* words = in;
+  const uint32_t mask = (bits < 32 ? (UINT32_C(1) << bits) - 1 : ~UINT32_C(0));
+
+  if (!bits) {
+    memset(out, 0, KERNEL_UNPACK_BLOCK * sizeof(uint32_t));
+    return;
+  }
+
+  for (unsigned int i = 0; i < KERNEL_UNPACK_BLOCK; i++) {
+    const unsigned int bit = (i / 4) * bits;
+    const uint32_t* word = words + (bit / 32) * 4 + i % 4;
+
+    uint32_t value = *word >> (bit % 32);
+    if (bit % 32 + bits > 32)
+      value |= word[4] << (32 - bit % 32);
+    out[i] = value & mask;
+  }
+
+  return;
+}
+
+#if KERNEL_X86
+KERNEL_MEMORY_VARIANTS(sse2, "sse2", kernel_v16)
+KERNEL_MEMORY_VARIANTS(avx2, "avx2", kernel_v32)
+KERNEL_MEMORY_VARIANTS(avx512, "avx512f,avx512bw", kernel_v64)
+KERNEL_UNPACK_VARIANT(sse2, "sse2")
+KERNEL_UNPACK_VARIANT(avx2, "avx2")
+KERNEL_UNPACK_VARIANT(avx512, "avx512f,avx512bw")
+
+__attribute__((target("sse2")))
+const char* kernel_find_sse2(const char* p, const char* end, char a, char b) {
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+
+  for (; end - p >= 16; p += 16) {
+    const __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+    const unsigned int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+    if (mask)
+      return p + __builtin_ctz(mask);
+  }
+
+  return kernel_find_scalar(p, end, a, b);
+}
+
+/* Without `popcnt', matches are summed as bytes and widened every 255 chunks */
+__attribute__((target("sse2")))
+unsigned long kernel_count_sse2(const char* p, const char* end, char a, char b) {
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+  __m128i total = _mm_setzero_si128();
+
+  while (end - p >= 16) {
+    __m128i counts = _mm_setzero_si128();
+    for (int i = 0; i < 255 && end - p >= 16; i++, p += 16) {
+      const __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+      counts = _mm_sub_epi8(counts, _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+    }
+    total = _mm_add_epi64(total, _mm_sad_epu8(counts, _mm_setzero_si128()));
+  }
+
+  uint64_t sums[2];
+  _mm_storeu_si128((__m128i*)sums, total);
+
+  return sums[0] + sums[1] + kernel_count_scalar(p, end, a, b);
+}
+
+__attribute__((target("avx2")))
+const char* kernel_find_avx2(const char* p, const char* end, char a, char b) {
+  const __m256i va = _mm256_set1_epi8(a);
+  const __m256i vb = _mm256_set1_epi8(b);
+
+  for (; end - p >= 32; p += 32) {
+    const __m256i chunk = _mm256_loadu_si256((const __m256i*)p);
+    const unsigned int mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb)));
+    if (mask)
+      return p + __builtin_ctz(mask);
+  }
+
+  /* Inline tail, calling the legacy SSE variant with dirty upper halves stalls */
+  for (; p < end; p++)
+    if (*p == a || *p == b)
+      return p;
+
+  return end;
+}
+
+__attribute__((target("avx2")))
+unsigned long kernel_count_avx2(const char* p, const char* end, char a, char b) {
+  const __m256i va = _mm256_set1_epi8(a);
+  const __m256i vb = _mm256_set1_epi8(b);
+  unsigned long count = 0;
+
+  for (; end - p >= 32; p += 32) {
+    const __m256i chunk = _mm256_loadu_si256((const __m256i*)p);
+    count += __builtin_popcount(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb))));
+  }
+
+  for (; p < end; p++)
+    count += (*p == a || *p == b);
+
+  return count;
+}
+
+/* The tail is read with a masked load, which can't fault on the bytes past `end' */
+__attribute__((target("avx512f,avx512bw")))
+const char* kernel_find_avx512(const char* p, const char* end, char a, char b) {
+  const __m512i va = _mm512_set1_epi8(a);
+  const __m512i vb = _mm512_set1_epi8(b);
+
+  for (; end - p >= 64; p += 64) {
+    const __m512i chunk = _mm512_loadu_si512((const void*)p);
+    const unsigned long long mask = _mm512_cmpeq_epi8_mask(chunk, va) | _mm512_cmpeq_epi8_mask(chunk, vb);
+    if (mask)
+      return p + __builtin_ctzll(mask);
+  }
+
+  if (p < end) {
+    const __mmask64 valid = (1ULL << (end - p)) - 1;
+    const __m512i chunk = _mm512_maskz_loadu_epi8(valid, p);
+    const unsigned long long mask = (_mm512_cmpeq_epi8_mask(chunk, va) | _mm512_cmpeq_epi8_mask(chunk, vb)) & valid;
+    if (mask)
+      return p + __builtin_ctzll(mask);
+  }
+
+  return end;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+unsigned long kernel_count_avx512(const char* p, const char* end, char a, char b) {
+  const __m512i va = _mm512_set1_epi8(a);
+  const __m512i vb = _mm512_set1_epi8(b);
+  unsigned long count = 0;
+
+  for (; end - p >= 64; p += 64) {
+    const __m512i chunk = _mm512_loadu_si512((const void*)p);
+    count += __builtin_popcountll(_mm512_cmpeq_epi8_mask(chunk, va) | _mm512_cmpeq_epi8_mask(chunk, vb));
+  }
+
+  if (p < end) {
+    const __mmask64 valid = (1ULL << (end - p)) - 1;
+    const __m512i chunk = _mm512_maskz_loadu_epi8(valid, p);
+    count += __builtin_popcountll((_mm512_cmpeq_epi8_mask(chunk, va) | _mm512_cmpeq_epi8_mask(chunk, vb)) & valid);
+  }
+
+  return count;
+}
+#endif
+/* ===================== */
@@ -0,0 +1,384 @@
+#include <blib/memory/alloc.h>
+#include <blib/memory/pool.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define SLAB_ALIGN     64
+#define SLAB_HEADER    16 /* Keeps the objects aligned to 16 bytes */
+#define MIN_PER_SLAB   16
+#define FALLBACK_PAGE  4096
+#define SPINS          64
+
+/* A thread that found every slot taken uses the depot from then on */
+#define NO_SLOT        (-2)
+#define UNASSIGNED     (-1)
+
+typedef struct pool_slab {
+  struct pool_slab* next;
+} pool_slab;
+
+/* One bit per slot, POOL_MAX_THREADS is the width of the map */
+static uint64_t pool_slots = 0;
+static __thread int pool_thread_slot = UNASSIGNED;
+static pthread_key_t pool_key;
+static pthread_once_t pool_key_once = PTHREAD_ONCE_INIT;
+static bool pool_key_created = false;
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+void pool_key_create(void);
+void pool_slot_release(void* slot);
+int pool_slot_acquire(void);
+pool_magazine* pool_magazine_get(pool* self);
+
+void pool_lock(pool* self);
+void pool_unlock(pool* self);
+bool pool_slab_next(pool* self);
+unsigned long pool_depot_take(pool* self, void** objects, unsigned long num);
+void pool_depot_give(pool* self, void* const* objects, unsigned long num);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+pool __intern_pool_new(unsigned int element_size) {
+  const unsigned int align = (element_size && !(element_size % 16) ? 16 : sizeof(void*));
+  unsigned int stride = (element_size > sizeof(void*) ? element_size : sizeof(void*));
+  stride = (stride + align - 1) & ~(align - 1);
+
+  const long page = sysconf(_SC_PAGESIZE);
+  const unsigned long page_size = (page > 0 ? (unsigned long)page : FALLBACK_PAGE);
+  unsigned long slab_size = page_size;
+  while ((slab_size - SLAB_HEADER) / stride < MIN_PER_SLAB)
+    slab_size += page_size;
+
+  return (pool) {
+    .element_size = element_size,
+    .__stride__ = stride,
+    .__slab_size__ = slab_size,
+    .__per_slab__ = (slab_size - SLAB_HEADER) / stride,
+  };
+}
+
+void* pool_alloc(pool* self) {
+  pool_magazine* magazine = pool_magazine_get(self);
+  if (!magazine) {
+    void* object = NULL;
+    if (pool_depot_take(self, &object, 1))
+      __atomic_add_fetch(&self->__shared_allocs__, 1, __ATOMIC_RELAXED);
+    return object;
+  }
+
+  if (!magazine->count) {
+    magazine->count = pool_depot_take(self, magazine->objects, POOL_MAGAZINE / 2);
+    if (!magazine->count)
+      return NULL;
+  }
+
+  magazine->allocs++;
+  return magazine->objects[--magazine->count];
+} /* pool_alloc */
+
+void pool_free(pool* self, void* object) {
+  if (!object)
+    return;
+
+  pool_magazine* magazine = pool_magazine_get(self);
+  if (!magazine) {
+    pool_depot_give(self, &object, 1);
+    __atomic_add_fetch(&self->__shared_frees__, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  /* Half stays cached, so alternating calls don't hit the depot every time */
+  if (magazine->count == POOL_MAGAZINE) {
+    pool_depot_give(self, magazine->objects + POOL_MAGAZINE / 2, POOL_MAGAZINE / 2);
+    magazine->count = POOL_MAGAZINE / 2;
+  }
+
+  magazine->objects[magazine->count++] = object;
+  magazine->frees++;
+
+  return;
+} /* pool_free */
+
+unsigned long pool_alloc_bulk(pool* self, void** objects, unsigned long num) {
+  pool_magazine* magazine = pool_magazine_get(self);
+  unsigned long taken = 0;
+
+  if (magazine) {
+    while (taken < num && magazine->count)
+      objects[taken++] = magazine->objects[--magazine->count];
+  }
+  if (taken < num)
+    taken += pool_depot_take(self, objects + taken, num - taken);
+
+  if (magazine)
+    magazine->allocs += taken;
+  else
+    __atomic_add_fetch(&self->__shared_allocs__, taken, __ATOMIC_RELAXED);
+
+  return taken;
+} /* pool_alloc_bulk */
+
+void pool_free_bulk(pool* self, void* const* objects, unsigned long num) {
+  pool_magazine* magazine = pool_magazine_get(self);
+  unsigned long given = 0;
+
+  if (magazine) {
+    while (given < num && magazine->count < POOL_MAGAZINE) {
+      if (objects[given])
+        magazine->objects[magazine->count++] = objects[given];
+      given++;
+    }
+  }
+
+  /* NULL objects can't be linked into the free list */
+  void* const* rest = objects + given;
+  unsigned long left = num - given;
+  while (left) {
+    unsigned long run = 0;
+    while (run < left && rest[run])
+      run++;
+    if (run)
+      pool_depot_give(self, rest, run);
+    while (run < left && !rest[run])
+      run++;
+    rest += run;
+    left -= run;
+  }
+
+  unsigned long freed = 0;
+  for (unsigned long i = 0; i < num; i++)
+    freed += (objects[i] != NULL);
+
+  if (magazine)
+    magazine->frees += freed;
+  else
+    __atomic_add_fetch(&self->__shared_frees__, freed, __ATOMIC_RELAXED);
+
+  return;
+} /* pool_free_bulk */
+
+void pool_reset(pool* self) {
+  for (int m = 0; m < POOL_MAX_THREADS; m++) {
+    if (self->__magazines__[m])
+      *self->__magazines__[m] = (pool_magazine) {0};
+  }
+
+  self->__free__ = NULL;
+  self->__cursor__ = self->__slabs__;
+  self->__carved__ = 0;
+  self->__shared_allocs__ = 0;
+  self->__shared_frees__ = 0;
+
+  return;
+} /* pool_reset */
+
+pool_stats pool_stats_get(pool* self) {
+  pool_stats stats = {0};
+
+  pool_lock(self);
+  stats.slabs = self->__slab_count__;
+  stats.live = self->__shared_allocs__ - self->__shared_frees__;
+  pool_unlock(self);
+
+  stats.bytes = stats.slabs * self->__slab_size__;
+  stats.capacity = stats.slabs * self->__per_slab__;
+
+  for (int m = 0; m < POOL_MAX_THREADS; m++) {
+    const pool_magazine* magazine = self->__magazines__[m];
+    if (!magazine)
+      continue;
+
+    /* Wraps on threads freeing objects of other threads, the sum doesn't */
+    stats.live += magazine->allocs - magazine->frees;
+    stats.cached += magazine->count;
+  }
+
+  return stats;
+} /* pool_stats_get */
+
+void pool_cleanup(pool* self) {
+  pool_slab* slab = self->__slabs__;
+  while (slab) {
+    pool_slab* next = slab->next;
+    blib_free(slab);
+    slab = next;
+  }
+
+  for (int m = 0; m < POOL_MAX_THREADS; m++)
+    blib_free(self->__magazines__[m]);
+
+  *self = (pool) {0};
+
+  return;
+} /* pool_cleanup */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+void pool_key_create(void) {
+  pool_key_created = !pthread_key_create(&pool_key, pool_slot_release);
+}
+
+void pool_slot_release(void* slot) {
+  const int index = (int)((uintptr_t)slot - 1);
+  __atomic_and_fetch(&pool_slots, ~(UINT64_C(1) << index), __ATOMIC_RELEASE);
+}
+
+int pool_slot_acquire(void) {
+  pthread_once(&pool_key_once, pool_key_create);
+
+  /* Without the key a slot would never be released again */
+  if (!pool_key_created) {
+    pool_thread_slot = NO_SLOT;
+    return NO_SLOT;
+  }
+
+  uint64_t used = __atomic_load_n(&pool_slots, __ATOMIC_RELAXED);
+  int slot;
+  do {
+    if (!~used) {
+      pool_thread_slot = NO_SLOT;
+      return NO_SLOT;
+    }
+    slot = __builtin_ctzll(~used);
+  } while (!__atomic_compare_exchange_n(&pool_slots, &used, used | (UINT64_C(1) << slot), true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+  if (pthread_setspecific(pool_key, (void*)((uintptr_t)slot + 1))) {
+    pool_slot_release((void*)((uintptr_t)slot + 1));
+    pool_thread_slot = NO_SLOT;
+    return NO_SLOT;
+  }
+
+  pool_thread_slot = slot;
+  return slot;
+}
+
+/*
+ * A slot belongs to one live thread, the magazines of a thread that exited are taken over
+ * with their objects by the next thread getting its slot.
+ */
+pool_magazine* pool_magazine_get(pool* self) {
+  int slot = pool_thread_slot;
+  if (slot == NO_SLOT)
+    return NULL;
+  if (slot == UNASSIGNED) {
+    slot = pool_slot_acquire();
+    if (slot == NO_SLOT)
+      return NULL;
+  }
+
+  pool_magazine* magazine = self->__magazines__[slot];
+  if (!magazine) {
+    magazine = blib_malloc(sizeof(*magazine));
+    if (!magazine)
+      return NULL;
+
+    *magazine = (pool_magazine) {0};
+    self->__magazines__[slot] = magazine;
+  }
+
+  return magazine;
+}
+
+void pool_lock(pool* self) {
+  while (__atomic_test_and_set(&self->__lock__, __ATOMIC_ACQUIRE)) {
+    int spins = 0;
+    while (__atomic_load_n(&self->__lock__, __ATOMIC_RELAXED)) {
+      if (++spins == SPINS) {
+        sched_yield();
+        spins = 0;
+      }
+    }
+  }
+}
+
+void pool_unlock(pool* self) {
+  __atomic_clear(&self->__lock__, __ATOMIC_RELEASE);
+}
+
+/* Needs the lock */
+bool pool_slab_next(pool* self) {
+  pool_slab* cursor = self->__cursor__;
+  pool_slab* next = (cursor ? cursor->next : self->__slabs__);
+
+  /* Slabs kept by `pool_reset()' are reused before new ones are allocated */
+  if (!next) {
+    void* memory;
+    if (blib_posix_memalign(&memory, SLAB_ALIGN, self->__slab_size__)) {
+      errno = ENOMEM;
+      return false;
+    }
+
+    next = memory;
+    next->next = NULL;
+    if (cursor)
+      cursor->next = next;
+    else
+      self->__slabs__ = next;
+    self->__slab_count__++;
+  }
+
+  self->__cursor__ = next;
+  self->__carved__ = 0;
+
+  return true;
+}
+
+unsigned long pool_depot_take(pool* self, void** objects, unsigned long num) {
+  unsigned long taken = 0;
+
+  pool_lock(self);
+
+  while (taken < num && self->__free__) {
+    objects[taken++] = self->__free__;
+    self->__free__ = *(void**)self->__free__;
+  }
+
+  while (taken < num) {
+    if ((!self->__cursor__ || self->__carved__ == self->__per_slab__) && !pool_slab_next(self))
+      break;
+
+    char* object = (char*)self->__cursor__ + SLAB_HEADER + self->__carved__ * self->__stride__;
+    unsigned long carve = self->__per_slab__ - self->__carved__;
+    if (carve > num - taken)
+      carve = num - taken;
+
+    for (unsigned long i = 0; i < carve; i++, object += self->__stride__)
+      objects[taken++] = object;
+    self->__carved__ += carve;
+  }
+
+  pool_unlock(self);
+
+  return taken;
+}
+
+void pool_depot_give(pool* self, void* const* objects, unsigned long num) {
+  if (!num)
+    return;
+
+  /* Linked before taking the lock, only the ends are spliced under it */
+  for (unsigned long i = 0; i + 1 < num; i++)
+    *(void**)objects[i] = objects[i + 1];
+
+  pool_lock(self);
+  *(void**)objects[num - 1] = self->__free__;
+  self->__free__ = objects[0];
+  pool_unlock(self);
+}
+/* ===================== */
@@ -0,0 +1,332 @@
+#include <blib/parsing/arguments/args.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define args_abort(...)                 \
+  do {                                  \
+    fprintf(stderr, __VA_ARGS__);       \
+    fputs("=== ABORT ===\n", stderr);   \
+    abort();                            \
+  } while (0)
+
+/* Seeds tried for every bucket of the perfect hash */
+#define DISPLACEMENTS 256
+/* Golden ratio, spreads the seeds over the hash */
+#define SEED_STEP 0x9e3779b9u
+/* ================== */
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+uint32_t args_hash(const char* name, unsigned long* len);
+uint32_t args_mix(uint32_t h);
+bool args_build_table(args_parser* self, const uint32_t* hashes);
+const args_option* args_find_long(const args_parser* self, const char* name, unsigned long* len);
+bool args_store(const args_option* option, const char* value);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+args_parser args_parser_new(const args_option* options, unsigned int num) {
+  if (num > ARGS_MAX_OPTIONS)
+    args_abort("Attempt to create argument parser of %u options, at most %u are supported!\n",
+        num, ARGS_MAX_OPTIONS);
+
+  args_parser self = {
+    .options = options,
+    .num = num,
+  };
+
+  uint32_t hashes[ARGS_MAX_OPTIONS];
+  unsigned int longs = 0;
+
+  for (unsigned int i = 0; i < num; i++) {
+    const args_option* option = &options[i];
+
+    if (!option->value || (option->type == ARGS_ENUM && !option->choices))
+      args_abort("Option %u of argument parser has no value to store to or no choices!\n", i);
+    if (!option->short_name && !option->long_name)
+      args_abort("Option %u of argument parser has neither a short nor a long name!\n", i);
+
+    if (option->short_name) {
+      const unsigned char c = option->short_name;
+      if (c >= 128 || c <= ' ' || c == '-')
+        args_abort("Option %u of argument parser has invalid short name 0x%02x!\n", i, c);
+      if (self.__short__[c])
+        args_abort("Duplicate option -%c of argument parser!\n", c);
+
+      self.__short__[c] = i + 1;
+    }
+
+    if (option->long_name) {
+      unsigned long len;
+      hashes[i] = args_hash(option->long_name, &len);
+      if (!len || option->long_name[len])
+        args_abort("Option %u of argument parser has invalid long name \"%s\"!\n", i, option->long_name);
+
+      for (unsigned int j = 0; j < i; j++)
+        if (options[j].long_name && !strcmp(options[j].long_name, option->long_name))
+          args_abort("Duplicate option --%s of argument parser!\n", option->long_name);
+
+      longs++;
+    }
+  }
+
+  unsigned int size = 2;
+  while (size < 2 * longs)
+    size <<= 1;
+  self.__mask__ = size - 1;
+
+  /* Four keys per bucket first, more buckets if a bucket finds no seed */
+  for (unsigned int buckets = (size >= 8 ? size / 4 : 1); buckets <= size && buckets <= ARGS_MAX_OPTIONS; buckets <<= 1) {
+    self.__buckets__ = buckets - 1;
+    if (args_build_table(&self, hashes))
+      return self;
+  }
+
+  args_abort("Failed to build perfect hash of %u long options!\n", longs);
+} /* args_parser_new */
+
+args_result args_parse(const args_parser* self, int ac, const char** av) {
+  args_result result = { 0 };
+
+  for (int i = 1; i < ac; i++) {
+    const char* arg = av[i];
+    const args_option* option = NULL;
+    const char* value = NULL;
+
+    result.index = i;
+
+    /* Positional, including "-" on its own */
+    if (arg[0] != '-' || !arg[1]) {
+      av[++result.positionals] = arg;
+      continue;
+    }
+
+    if (arg[1] == '-') {
+      if (!arg[2]) {
+        while (++i < ac)
+          av[++result.positionals] = av[i];
+        break;
+      }
+
+      unsigned long len;
+      option = args_find_long(self, arg + 2, &len);
+      if (!option) {
+        result.error = ARGS_UNKNOWN;
+        return result;
+      }
+
+      if (arg[2 + len] == '=') {
+        value = arg + 2 + len + 1;
+        if (option->type == ARGS_FLAG) {
+          result.error = ARGS_UNEXPECTED_VALUE;
+          result.option = option;
+          return result;
+        }
+      } else if (option->type == ARGS_FLAG) {
+        *(bool*)option->value = true;
+        continue;
+      }
+    } else {
+      /* Cluster of flags, the first option taking a value takes the rest of it */
+      for (const char* c = arg + 1; *c; c++) {
+        const unsigned char name = *c;
+        const unsigned int index = (name < 128 ? self->__short__[name] : 0);
+        if (!index) {
+          result.error = ARGS_UNKNOWN;
+          return result;
+        }
+
+        option = &self->options[index - 1];
+        if (option->type != ARGS_FLAG) {
+          value = (c[1] ? c + 1 : NULL);
+          break;
+        }
+
+        *(bool*)option->value = true;
+      }
+
+      if (option->type == ARGS_FLAG)
+        continue;
+    }
+
+    if (!value) {
+      if (i + 1 >= ac) {
+        result.error = ARGS_MISSING_VALUE;
+        result.option = option;
+        return result;
+      }
+      value = av[++i];
+    }
+
+    if (!args_store(option, value)) {
+      result.error = ARGS_INVALID_VALUE;
+      result.option = option;
+      return result;
+    }
+  }
+
+  return result;
+} /* args_parse */
+
+const char* args_error_str(enum args_error error) {
+  static const char* const errors[ARGS_ERRORS] = {
+    "success", "unknown option", "missing value", "invalid value", "option takes no value",
+  };
+
+  return ((unsigned int)error < ARGS_ERRORS ? errors[error] : "unknown error");
+} /* args_error_str */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+/* FNV-1a of a long name up to '=' or the end, `len' is set to its length */
+uint32_t args_hash(const char* name, unsigned long* len) {
+  uint32_t h = 0x811c9dc5u;
+  unsigned long i = 0;
+
+  for (; name[i] && name[i] != '='; i++) {
+    h ^= (unsigned char)name[i];
+    h *= 0x01000193u;
+  }
+  *len = i;
+
+  return h;
+}
+
+/* Finalizer of MurmurHash3 */
+uint32_t args_mix(uint32_t h) {
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+
+  return h;
+}
+
+/*
+ * Hash and displace: the long names are split into buckets, the largest buckets first
+ * look for a seed that moves all of their names to free slots.
+ */
+bool args_build_table(args_parser* self, const uint32_t* hashes) {
+  unsigned char counts[ARGS_MAX_TABLE] = { 0 };
+  unsigned char buckets[ARGS_MAX_OPTIONS];
+  unsigned int largest = 0;
+
+  memset(self->__table__, 0, sizeof(self->__table__));
+  memset(self->__displace__, 0, sizeof(self->__displace__));
+
+  for (unsigned int i = 0; i < self->num; i++) {
+    if (!self->options[i].long_name)
+      continue;
+
+    buckets[i] = args_mix(hashes[i]) & self->__buckets__;
+    if (++counts[buckets[i]] > largest)
+      largest = counts[buckets[i]];
+  }
+
+  for (unsigned int count = largest; count; count--) {
+    for (unsigned int bucket = 0; bucket <= self->__buckets__; bucket++) {
+      if (counts[bucket] != count)
+        continue;
+
+      unsigned char members[ARGS_MAX_OPTIONS];
+      unsigned int num = 0;
+      for (unsigned int i = 0; i < self->num; i++)
+        if (self->options[i].long_name && buckets[i] == bucket)
+          members[num++] = i;
+
+      bool placed = false;
+      for (unsigned int seed = 0; seed < DISPLACEMENTS && !placed; seed++) {
+        unsigned int m = 0;
+        for (; m < num; m++) {
+          const unsigned int slot = args_mix(hashes[members[m]] + seed * SEED_STEP) & self->__mask__;
+          if (self->__table__[slot])
+            break;
+          self->__table__[slot] = members[m] + 1;
+        }
+
+        placed = (m == num);
+        if (!placed) {
+          /* Roll back the names of this bucket already placed with this seed */
+          while (m--)
+            self->__table__[args_mix(hashes[members[m]] + seed * SEED_STEP) & self->__mask__] = 0;
+        } else {
+          self->__displace__[bucket] = seed;
+        }
+      }
+
+      if (!placed)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+const args_option* args_find_long(const args_parser* self, const char* name, unsigned long* len) {
+  const uint32_t h = args_hash(name, len);
+  const unsigned int seed = self->__displace__[args_mix(h) & self->__buckets__];
+  const unsigned int index = self->__table__[args_mix(h + seed * SEED_STEP) & self->__mask__];
+  if (!index)
+    return NULL;
+
+  const args_option* option = &self->options[index - 1];
+  if (strncmp(option->long_name, name, *len) || option->long_name[*len])
+    return NULL;
+
+  return option;
+}
+
+bool args_store(const args_option* option, const char* value) {
+  char* end;
+
+  switch (option->type) {
+    case ARGS_FLAG:
+      *(bool*)option->value = true;
+      return true;
+    case ARGS_INT: {
+      errno = 0;
+      const long number = strtol(value, &end, 0);
+      if (end == value || *end || errno == ERANGE)
+        return false;
+
+      *(long*)option->value = number;
+      return true;
+    }
+    case ARGS_FLOAT: {
+      errno = 0;
+      const double number = strtod(value, &end);
+      if (end == value || *end || errno == ERANGE)
+        return false;
+
+      *(double*)option->value = number;
+      return true;
+    }
+    case ARGS_STRING:
+      *(const char**)option->value = value;
+      return true;
+    case ARGS_ENUM:
+      for (unsigned int c = 0; option->choices[c]; c++) {
+        if (!strcmp(option->choices[c], value)) {
+          *(unsigned int*)option->value = c;
+          return true;
+        }
+      }
+      return false;
+  }
+
+  return false;
+}
+/* ===================== */
@@ -0,0 +1,458 @@
+#define _POSIX_C_SOURCE 200809L /* newlocale, uselocale */
+#include <blib/parsing/text/numbers.h>
+#include <blib/datastructures/arrays/trace.h>
+#include <blib/memory/alloc.h>
+#include <blib/memory/kernels.h>
+
+#include <errno.h>
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define is_digit(c) ((unsigned char)((c) - '0') < 10)
+/* Blanks around a field, unless they separate the fields */
+#define is_blank(c, delimiter) (((c) == ' ' || (c) == '\t' || (c) == '\r') && (c) != (delimiter))
+
+/* Significant digits that fit an unsigned 64 bit integer */
+#define MAX_DIGITS 19
+/* Largest integer a double represents exactly */
+#define MAX_EXACT (1ULL << 53)
+/* Largest exactly representable power of ten */
+#define MAX_EXACT_POW10 22
+/* Numbers of the `strtod()' path up to this length are copied to the stack */
+#define SLOW_BUFFER 128
+
+#define check_element_size(arr, type, name)                                  \
+  do {                                                                       \
+    if ((arr)->element_size != sizeof(type)) {                               \
+      fprintf(stderr,                                                        \
+          "Attempt to parse " name " into dynamic array of element size %u!\n" \
+          "=== ABORT ===\n",                                                 \
+          (arr)->element_size);                                              \
+      abort();                                                               \
+    }                                                                        \
+  } while (0)
+/* ================== */
+
+enum number_kind {
+  NUMBER_I32,
+  NUMBER_I64,
+  NUMBER_F64,
+};
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+const char* number_skip_blanks(const char* p, const char* end, char delimiter);
+const char* number_scan_int(const char* p, const char* end, int64_t* value, enum number_error* error);
+const char* number_scan_float(const char* p, const char* end, double* value, enum number_error* error);
+double number_slow_float(const char* start, const char* end, enum number_error* error);
+locale_t number_c_locale(void);
+unsigned long number_parse_arr(const text_span* text, char delimiter, dynamic_arr* values, dynamic_arr* errors, enum number_kind kind);
+/* ================================== */
+
+static const double pow10_table[MAX_EXACT_POW10 + 1] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/* The "C" locale of the slow path, created once and kept until exit */
+static locale_t number_locale = (locale_t)0;
+
+/* =============
+ * API Functions
+ * ============= */
+enum number_error number_parse_i64(const char* start, unsigned long len, int64_t* value) {
+  const char* end = start + len;
+  const char* p = number_skip_blanks(start, end, 0);
+  if (p == end)
+    return NUMBER_EMPTY;
+
+  int64_t number;
+  enum number_error error;
+  p = number_skip_blanks(number_scan_int(p, end, &number, &error), end, 0);
+  if (p != end)
+    return NUMBER_INVALID;
+  if (error)
+    return error;
+
+  *value = number;
+
+  return NUMBER_OK;
+} /* number_parse_i64 */
+
+enum number_error number_parse_i32(const char* start, unsigned long len, int32_t* value) {
+  int64_t number;
+  const enum number_error error = number_parse_i64(start, len, &number);
+  if (error)
+    return error;
+  if (number < INT32_MIN || number > INT32_MAX)
+    return NUMBER_RANGE;
+
+  *value = number;
+
+  return NUMBER_OK;
+} /* number_parse_i32 */
+
+enum number_error number_parse_f64(const char* start, unsigned long len, double* value) {
+  const char* end = start + len;
+  const char* p = number_skip_blanks(start, end, 0);
+  if (p == end)
+    return NUMBER_EMPTY;
+
+  double number;
+  enum number_error error;
+  p = number_skip_blanks(number_scan_float(p, end, &number, &error), end, 0);
+  if (p != end)
+    return NUMBER_INVALID;
+  if (error)
+    return error;
+
+  *value = number;
+
+  return NUMBER_OK;
+} /* number_parse_f64 */
+
+unsigned long number_parse_i64_arr(const text_span* text, char delimiter, dynamic_arr* values, dynamic_arr* errors) {
+  check_element_size(values, int64_t, "int64_t");
+
+  return number_parse_arr(text, delimiter, values, errors, NUMBER_I64);
+} /* number_parse_i64_arr */
+
+unsigned long number_parse_i32_arr(const text_span* text, char delimiter, dynamic_arr* values, dynamic_arr* errors) {
+  check_element_size(values, int32_t, "int32_t");
+
+  return number_parse_arr(text, delimiter, values, errors, NUMBER_I32);
+} /* number_parse_i32_arr */
+
+unsigned long number_parse_f64_arr(const text_span* text, char delimiter, dynamic_arr* values, dynamic_arr* errors) {
+  check_element_size(values, double, "double");
+
+  return number_parse_arr(text, delimiter, values, errors, NUMBER_F64);
+} /* number_parse_f64_arr */
+
+const char* number_error_str(enum number_error error) {
+  static const char* const errors[NUMBER_ERRORS] = {
+    "success", "empty field", "not a number", "number out of range",
+  };
+
+  return ((unsigned int)error < NUMBER_ERRORS ? errors[error] : "unknown error");
+} /* number_error_str */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+const char* number_skip_blanks(const char* p, const char* end, char delimiter) {
+  while (p < end && is_blank(*p, delimiter))
+    p++;
+
+  return p;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+/* Eight ASCII digits in the bytes of `chunk' */
+static bool number_eight_digits(uint64_t chunk) {
+  return !(((chunk & 0xf0f0f0f0f0f0f0f0ULL) ^ 0x3030303030303030ULL)
+      | (((chunk + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) ^ 0x3030303030303030ULL));
+}
+
+/* Value of eight ASCII digits, first digit in the lowest byte */
+static uint32_t number_convert_eight(uint64_t chunk) {
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & 0x000000ff000000ffULL) * (100 + (1000000ULL << 32)))
+      + (((chunk >> 16) & 0x000000ff000000ffULL) * (1 + (10000ULL << 32)))) >> 32;
+
+  return (uint32_t)chunk;
+}
+#endif
+
+/* Sign and digits at `p', returns the end of the digits */
+const char* number_scan_int(const char* p, const char* end, int64_t* value, enum number_error* error) {
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+    negative = (*p++ == '-');
+
+  const char* digits = p;
+  uint64_t number = 0;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  /* Two chunks can't overflow, the rest is checked digit by digit */
+  for (int chunks = 0; chunks < 2 && end - p >= 8; chunks++) {
+    uint64_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+    if (!number_eight_digits(chunk))
+      break;
+
+    number = number * 100000000 + number_convert_eight(chunk);
+    p += 8;
+  }
+#endif
+
+  bool overflow = false;
+  for (; p < end && is_digit(*p); p++)
+    overflow |= __builtin_mul_overflow(number, 10, &number) | __builtin_add_overflow(number, (uint64_t)(*p - '0'), &number);
+
+  if (p == digits) {
+    *error = NUMBER_INVALID;
+    return p;
+  }
+
+  overflow |= (number > (uint64_t)INT64_MAX + negative);
+  *error = (overflow ? NUMBER_RANGE : NUMBER_OK);
+  *value = (negative ? (int64_t)(0 - number) : (int64_t)number);
+
+  return p;
+}
+
+/* Number at `p', returns its end */
+const char* number_scan_float(const char* p, const char* end, double* value, enum number_error* error) {
+  const char* start = p;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+    negative = (*p++ == '-');
+
+  /* inf, infinity and nan */
+  if (p < end && ((*p | 0x20) == 'i' || (*p | 0x20) == 'n')) {
+    static const char* const words[] = { "infinity", "inf", "nan" };
+    for (int w = 0; w < 3; w++) {
+      const unsigned long len = strlen(words[w]);
+      if ((unsigned long)(end - p) < len)
+        continue;
+
+      unsigned long i = 0;
+      while (i < len && (p[i] | 0x20) == words[w][i])
+        i++;
+      if (i == len) {
+        *value = (w < 2 ? (negative ? -INFINITY : INFINITY) : NAN);
+        *error = NUMBER_OK;
+        return p + len;
+      }
+    }
+
+    *error = NUMBER_INVALID;
+    return p;
+  }
+
+  uint64_t mantissa = 0;
+  int digits = 0;
+  long exponent = 0;
+  bool any = false;
+  bool truncated = false;
+
+  for (; p < end && is_digit(*p); p++) {
+    const unsigned int digit = *p - '0';
+    any = true;
+    if (digits < MAX_DIGITS) {
+      mantissa = mantissa * 10 + digit;
+      digits += (mantissa != 0);
+    } else {
+      exponent++;
+      truncated |= (digit != 0);
+    }
+  }
+
+  if (p < end && *p == '.') {
+    for (p++; p < end && is_digit(*p); p++) {
+      const unsigned int digit = *p - '0';
+      any = true;
+      if (digits < MAX_DIGITS) {
+        mantissa = mantissa * 10 + digit;
+        digits += (mantissa != 0);
+        exponent--;
+      } else {
+        truncated |= (digit != 0);
+      }
+    }
+  }
+
+  if (!any) {
+    *error = NUMBER_INVALID;
+    return p;
+  }
+
+  if (p < end && (*p | 0x20) == 'e') {
+    const char* e = p + 1;
+    bool negative_exponent = false;
+    if (e < end && (*e == '-' || *e == '+'))
+      negative_exponent = (*e++ == '-');
+
+    if (e < end && is_digit(*e)) {
+      long exp = 0;
+      for (; e < end && is_digit(*e); e++)
+        if (exp < 100000)
+          exp = exp * 10 + (*e - '0');
+
+      exponent += (negative_exponent ? -exp : exp);
+      p = e;
+    }
+  }
+
+  *error = NUMBER_OK;
+
+  if (!mantissa) {
+    *value = (negative ? -0.0 : 0.0);
+    return p;
+  }
+
+  /* Clinger's fast path: both operands are exact, so is the correctly rounded result */
+  if (!truncated && mantissa <= MAX_EXACT) {
+    double number = (double)mantissa;
+
+    if (exponent > MAX_EXACT_POW10 && exponent <= MAX_EXACT_POW10 + 15) {
+      /* Move the excess of the exponent into the mantissa while it stays exact */
+      uint64_t shifted = mantissa;
+      long e = exponent;
+      while (e > MAX_EXACT_POW10 && shifted <= MAX_EXACT / 10) {
+        shifted *= 10;
+        e--;
+      }
+      if (e == MAX_EXACT_POW10) {
+        number = (double)shifted;
+        exponent = e;
+      }
+    }
+
+    if (exponent >= -MAX_EXACT_POW10 && exponent <= MAX_EXACT_POW10) {
+      number = (exponent < 0 ? number / pow10_table[-exponent] : number * pow10_table[exponent]);
+      *value = (negative ? -number : number);
+      return p;
+    }
+  }
+
+  *value = number_slow_float(start, p, error);
+
+  return p;
+}
+
+/* `strtod()' of [start, end) in the "C" locale, whatever the locale of the program and its threads */
+double number_slow_float(const char* start, const char* end, enum number_error* error) {
+  const unsigned long len = end - start;
+  char stack[SLOW_BUFFER];
+  char* buffer = (len < SLOW_BUFFER ? stack : blib_malloc(len + 1));
+  if (!buffer) {
+    fprintf(stderr,
+        "Failed to allocate number buffer of size %lu: %s\n"
+        "=== ABORT ===\n",
+        len + 1, strerror(errno));
+
+    abort();
+  }
+
+  memcpy(buffer, start, len);
+  buffer[len] = '\0';
+
+  /* Only the calling thread switches locales */
+  const locale_t previous = uselocale(number_c_locale());
+  const double number = strtod(buffer, NULL);
+  uselocale(previous);
+  if (isinf(number))
+    *error = NUMBER_RANGE;
+
+  if (buffer != stack)
+    blib_free(buffer);
+
+  return number;
+}
+
+locale_t number_c_locale(void) {
+  locale_t locale = __atomic_load_n(&number_locale, __ATOMIC_ACQUIRE);
+  if (locale)
+    return locale;
+
+  locale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+  if (!locale) {
+    fprintf(stderr,
+        "Failed to create the \"C\" locale for parsing numbers: %s\n"
+        "=== ABORT ===\n",
+        strerror(errno));
+
+    abort();
+  }
+
+  /* Threads racing to create it keep the first one */
+  locale_t expected = (locale_t)0;
+  if (!__atomic_compare_exchange_n(&number_locale, &expected, locale, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    freelocale(locale);
+    locale = expected;
+  }
+
+  return locale;
+}
+
+unsigned long number_parse_arr(const text_span* text, char delimiter, dynamic_arr* values, dynamic_arr* errors, enum number_kind kind) {
+  const char* p = text->start;
+  const char* end = text->start + text->len;
+  if (p == end)
+    return 0;
+
+  /* Every separator starts at most one more field */
+  dynamic_arr_reserve(values, kernel_count(p, end, delimiter, '\n') + 1);
+
+  uint8_t* out = (uint8_t*)dynamic_arr_get_start(values) + values->num * values->element_size;
+  unsigned long num = 0;
+
+  for (;;) {
+    const char* field = p;
+    enum number_error error = NUMBER_OK;
+    int64_t integer = 0;
+    double real = 0;
+
+    const char* q = number_skip_blanks(p, end, delimiter);
+    if (q == end || *q == delimiter || *q == '\n') {
+      error = NUMBER_EMPTY;
+    } else {
+      if (kind == NUMBER_F64)
+        q = number_scan_float(q, end, &real, &error);
+      else
+        q = number_scan_int(q, end, &integer, &error);
+
+      q = number_skip_blanks(q, end, delimiter);
+      if (q < end && *q != delimiter && *q != '\n')
+        error = NUMBER_INVALID;
+      else if (!error && kind == NUMBER_I32 && (integer < INT32_MIN || integer > INT32_MAX))
+        error = NUMBER_RANGE;
+    }
+
+    if (error) {
+      integer = 0;
+      real = 0;
+      if (errors) {
+        const number_field_error rejected = { num, field - text->start, error };
+        dynamic_arr_append(errors, &rejected);
+      }
+
+      while (q < end && *q != delimiter && *q != '\n')
+        q++;
+    }
+
+    switch (kind) {
+      case NUMBER_I32:
+        ((int32_t*)out)[num] = (int32_t)integer;
+        break;
+      case NUMBER_I64:
+        ((int64_t*)out)[num] = integer;
+        break;
+      case NUMBER_F64:
+        ((double*)out)[num] = real;
+        break;
+    }
+    num++;
+
+    /* A final newline ends the last field, a final delimiter starts an empty one */
+    if (q >= end || (q + 1 == end && *q == '\n'))
+      break;
+    p = q + 1;
+  }
+
+  __intern_dynamic_arr_set_num(values, values->num + num);
+
+  return num;
+}
+/* ===================== */
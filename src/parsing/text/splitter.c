@@ -0,0 +1,229 @@
+#define _POSIX_C_SOURCE 200112L
+#include <blib/parsing/text/splitter.h>
+#include <blib/memory/kernels.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define find_char(p, end, c) kernel_find(p, end, c, c)
+
+/* Fields collected on the stack before they are appended at once */
+#define FIELD_BATCH 32
+/* ================== */
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+const char* splitter_line_end(const char* p, const char* end, char quote, bool inside);
+/* ================================== */
+
+/* =============
+ * API Functions
+ * ============= */
+text_splitter text_splitter_new(const char* data, unsigned long len, char delimiter, char quote) {
+  return (text_splitter) {
+    .__pos__ = data,
+    .__end__ = data + len,
+    .delimiter = delimiter,
+    .quote = quote,
+    .__map__ = NULL,
+    .__map_len__ = 0,
+  };
+} /* text_splitter_new */
+
+bool text_splitter_map(text_splitter* self, const char* path, char delimiter, char quote) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st)) {
+    const int error = errno;
+    close(fd);
+    errno = error;
+
+    return false;
+  }
+
+  /* Empty files can't be mapped */
+  if (!st.st_size) {
+    close(fd);
+    *self = text_splitter_new("", 0, delimiter, quote);
+
+    return true;
+  }
+
+  void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int error = errno;
+  close(fd);
+  if (map == MAP_FAILED) {
+    errno = error;
+    return false;
+  }
+
+  posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+
+  *self = text_splitter_new(map, st.st_size, delimiter, quote);
+  self->__map__ = map;
+  self->__map_len__ = st.st_size;
+
+  return true;
+} /* text_splitter_map */
+
+bool text_splitter_next_line(text_splitter* self, text_span* line) {
+  if (self->__pos__ >= self->__end__)
+    return false;
+
+  const char* start = self->__pos__;
+  const char* end = splitter_line_end(start, self->__end__, self->quote, false);
+
+  self->__pos__ = (end < self->__end__ ? end + 1 : end);
+
+  if (end > start && end[-1] == '\r')
+    end--;
+  *line = (text_span) { start, end - start, false };
+
+  return true;
+} /* text_splitter_next_line */
+
+unsigned long text_splitter_split(const text_splitter* self, const text_span* line, dynamic_arr* fields) {
+  const char* p = line->start;
+  const char* end = line->start + line->len;
+  const char quote = self->quote;
+  unsigned long num = 0;
+
+  text_span batch[FIELD_BATCH];
+  unsigned int batched = 0;
+
+  for (;;) {
+    text_span field;
+
+    if (quote && p < end && *p == quote) {
+      const char* q = p + 1;
+      for (;;) {
+        q = find_char(q, end, quote);
+        /* Doubled quotes are part of the field */
+        if (q + 1 < end && q[1] == quote) {
+          q += 2;
+          continue;
+        }
+        break;
+      }
+
+      field = (text_span) { p + 1, q - (p + 1), true };
+      p = (q < end ? find_char(q + 1, end, self->delimiter) : end);
+    } else {
+      const char* q = find_char(p, end, self->delimiter);
+
+      field = (text_span) { p, q - p, false };
+      p = q;
+    }
+
+    batch[batched++] = field;
+    if (batched == FIELD_BATCH) {
+      dynamic_arr_bulk_append(fields, batch, batched);
+      batched = 0;
+    }
+    num++;
+
+    if (p >= end)
+      break;
+    p++;
+  }
+
+  if (batched)
+    dynamic_arr_bulk_append(fields, batch, batched);
+
+  return num;
+} /* text_splitter_split */
+
+unsigned long text_splitter_chunks(const text_splitter* self, text_splitter* chunks, unsigned long num) {
+  const char* start = self->__pos__;
+  const char* end = self->__end__;
+  const unsigned long total = end - start;
+  unsigned long made = 0;
+
+  for (unsigned long k = 1; k <= num && start < end; k++) {
+    const char* boundary = end;
+
+    if (k < num) {
+      const char* target = self->__pos__ + total / num * k;
+      if (target < start)
+        target = start;
+
+      /* `start' is outside of quotes, an odd number of quotes up to `target' is inside */
+      const bool inside = (self->quote && (kernel_count(start, target, self->quote, self->quote) & 1));
+      boundary = splitter_line_end(target, end, self->quote, inside);
+      if (boundary < end)
+        boundary++;
+    }
+
+    chunks[made] = *self;
+    chunks[made].__pos__ = start;
+    chunks[made].__end__ = boundary;
+    chunks[made].__map__ = NULL;
+    chunks[made].__map_len__ = 0;
+    made++;
+
+    start = boundary;
+  }
+
+  return made;
+} /* text_splitter_chunks */
+
+unsigned long text_span_unescape(const text_span* span, char quote, char* out) {
+  unsigned long len = 0;
+
+  for (unsigned long i = 0; i < span->len; i++) {
+    out[len++] = span->start[i];
+    if (span->quoted && span->start[i] == quote && i + 1 < span->len && span->start[i + 1] == quote)
+      i++;
+  }
+
+  return len;
+} /* text_span_unescape */
+
+void text_splitter_cleanup(text_splitter* self) {
+  if (self->__map__)
+    munmap(self->__map__, self->__map_len__);
+
+  self->__map__ = NULL;
+  self->__map_len__ = 0;
+  self->__pos__ = self->__end__;
+
+  return;
+} /* text_splitter_cleanup */
+/* ============= */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+/* Newline ending the line at `p', skipping quoted parts, `inside' if `p' is inside quotes */
+const char* splitter_line_end(const char* p, const char* end, char quote, bool inside) {
+  if (!quote)
+    return find_char(p, end, '\n');
+
+  for (;;) {
+    if (inside) {
+      p = find_char(p, end, quote);
+      if (p >= end)
+        return end;
+      p++;
+      inside = false;
+    }
+
+    p = kernel_find(p, end, '\n', quote);
+    if (p >= end || *p == '\n')
+      return p;
+
+    p++;
+    inside = true;
+  }
+}
+/* ===================== */
@@ -1,25 +1,258 @@
+#define _GNU_SOURCE /* sched_setaffinity */
 #include <blib/testing/time/time_tests.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+/* ==================
+ * Convenience Macros
+ * ================== */
+#define CLOCK_SOURCES (TIME_CLOCK_TSC + 1)
+
+/* Back-to-back readings taken to find the overhead of a clock */
+#define OVERHEAD_ROUNDS 1024
+/* Time spent comparing the TSC against CLOCK_MONOTONIC_RAW */
+#define TSC_CALIBRATION_NS 10000000ULL
+
+/* Scales the MAD to the standard deviation of normally distributed samples */
+#define MAD_SCALE 1.4826
+/* Samples further than this many scaled MADs from the median are outliers */
+#define MAD_OUTLIER_LIMIT 3.0
+
+/* Default duration batched samples are grown to */
+#define BATCH_TARGET_NS 1000000ULL
+/* Bounds of the growth of the iteration count per calibration round */
+#define BATCH_GROWTH_MIN 2.0
+#define BATCH_GROWTH_MAX 10.0
+
+/* Longest caption kept from a baseline */
+#define BASELINE_CAPTION_MAX 256
+
+#ifndef BLIB_CFLAGS
+#define BLIB_CFLAGS "unknown"
+#endif
+#if defined(__GNUC__) && !defined(__clang__)
+#define BLIB_COMPILER "gcc " __VERSION__
+#elif defined(__VERSION__)
+#define BLIB_COMPILER __VERSION__
+#else
+#define BLIB_COMPILER "unknown"
+#endif
+/* ================== */
+
+/* Open perf events of a thread, read as a group */
+typedef struct {
+  int leader;
+  int fds[TIME_COUNTERS];
+  enum time_counter order[TIME_COUNTERS]; /* Counter of every opened event, in group order */
+  unsigned int num;
+} time_counter_group;
+
+/* ==================================
+ * Convenience Function Declaractions
+ * ================================== */
+uint64_t time_clock_read_start(enum time_clock_source source);
+uint64_t time_clock_read_end(enum time_clock_source source);
+uint64_t time_clock_to_ns(enum time_clock_source source, uint64_t ticks);
+void time_clock_calibrate(enum time_clock_source source);
+int time_stats_cmp(const void* a, const void* b);
+double time_stats_percentile(const double* sorted, unsigned long num, double p);
+double time_stats_t_value(unsigned long num);
+time_test time_testrun_sample(const time_testrun_template* template, unsigned int index, unsigned long iterations);
+unsigned long time_testrun_calibrate(const time_testrun_template* template);
+time_testrun_results time_testrun_results_new(const time_testrun_template* template, unsigned long num, unsigned long iterations);
+void time_testrun_prepare(const time_testrun_template* template, time_testrun_results* results, unsigned long begin, unsigned long end);
+void time_testrun_range(const time_testrun_template* template, time_testrun_results* results, unsigned long begin, unsigned long end);
+void time_testrun_finish(time_testrun_results* results);
+void time_testrun_threaded(const time_testrun_template* template, time_testrun_results* results, unsigned int threads);
+void* time_testrun_worker(void* arg);
+int time_counters_open(time_counter_group* group, time_counters* counters);
+void time_counters_start(const time_counter_group* group);
+void time_counters_stop(const time_counter_group* group, time_counters* counters);
+void time_counters_close(time_counter_group* group);
+void time_counters_finish(time_counters* counters, uint64_t ops);
+bool time_memory_begin(time_memory* memory, blib_alloc_stats* before);
+void time_memory_end(time_memory* memory, const blib_alloc_stats* before, bool tracked);
+int64_t time_memory_rss(void);
+void time_scheduling_begin(time_scheduling* scheduling, const scheduler* scheduler);
+void time_scheduling_end(time_scheduling* scheduling, const scheduler* scheduler);
+void time_export_json_string(FILE* file, const char* str);
+void time_export_csv_string(FILE* file, const char* str);
+bool time_csv_field(const char** line, char* field, unsigned long size);
+dynamic_arr time_baseline_load(const char* path);
+double time_complexity_f(enum time_complexity complexity, unsigned long n);
+void time_complexity_fit(time_complexity_results* complexity);
+/* ================================== */
+
+/* A thread of a threaded testrun */
+typedef struct {
+  const time_testrun_template* template;
+  time_testrun_results* results;
+  unsigned long begin;
+  unsigned long end;
+
+  unsigned int index;
+  int cpu; /* -1 if not pinned */
+  pthread_barrier_t* barrier;
+
+  uint64_t wall_start;
+  uint64_t wall_end;
+} time_worker;
+
+/* A testrun loaded from a baseline */
+typedef struct {
+  char caption[BASELINE_CAPTION_MAX];
+  unsigned long size;
+  unsigned long runs;
+  double mean;
+  double stddev;
+} time_baseline;
+
+#ifdef __linux__
+/* perf events of the counters */
+static const struct {
+  uint32_t type;
+  uint64_t config;
+} counter_events[TIME_COUNTERS] = {
+  [TIME_COUNTER_CYCLES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  [TIME_COUNTER_INSTRUCTIONS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  [TIME_COUNTER_L1D_MISSES] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+    | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+  [TIME_COUNTER_LLC_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+  [TIME_COUNTER_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+  [TIME_COUNTER_PAGE_FAULTS] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+};
+#endif
+
+/* Columns written by `time_testrun_export_csv()' */
+static const char* const csv_columns[] = {
+  "caption", "size", "runs", "iterations", "warmup", "clock", "clock_overhead_ns",
+  "success", "failure", "skipped", "total_ns",
+  "min", "max", "mean", "stddev", "median", "p90", "p99", "p999",
+  "mad", "ci_low", "ci_high", "outliers",
+  "ops_per_sec", "bytes_per_iteration", "bytes_per_sec",
+  "ipc", "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "page_faults",
+  "mallocs", "reallocs", "frees", "bytes_allocated", "peak_bytes", "rss_delta",
+};
+
+static enum time_clock_source clock_selected = TIME_CLOCK_MONOTONIC_RAW;
+static bool clock_calibrated[CLOCK_SOURCES];
+static uint64_t clock_overhead[CLOCK_SOURCES];
+static double tsc_ns_per_tick;
+static __thread unsigned int worker_index;
+
+/* Two-sided 95% quantiles of Student's t-distribution for 1 to 30 degrees of freedom */
+static const double t_table_95[30] = {
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+void time_clock_select(enum time_clock_source source) {
+  if (!time_clock_available(source))
+    source = TIME_CLOCK_MONOTONIC_RAW;
+
+  if (!clock_calibrated[source])
+    time_clock_calibrate(source);
+
+  clock_selected = source;
+
+  return;
+} /* time_clock_select */
+
+enum time_clock_source time_clock_selected(void) {
+  return clock_selected;
+} /* time_clock_selected */
+
+bool time_clock_available(enum time_clock_source source) {
+  switch (source) {
+    case TIME_CLOCK_MONOTONIC_RAW:
+    case TIME_CLOCK_THREAD_CPU:
+    case TIME_CLOCK_PROCESS_CPU:
+      return true;
+
+    case TIME_CLOCK_TSC:
+#if HAVE_TSC
+    {
+      unsigned int eax, ebx, ecx, edx;
+      if (!__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) || !(edx & (1U << 27)))
+        return false; /* no rdtscp */
+      if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1U << 8)))
+        return false; /* TSC isn't invariant, so not usable as a clock */
+
+      return true;
+    }
+#else
+      return false;
+#endif
+  }
+
+  return false;
+} /* time_clock_available */
+
+const char* time_clock_name(enum time_clock_source source) {
+  switch (source) {
+    case TIME_CLOCK_MONOTONIC_RAW:
+      return "CLOCK_MONOTONIC_RAW";
+    case TIME_CLOCK_THREAD_CPU:
+      return "CLOCK_THREAD_CPUTIME_ID";
+    case TIME_CLOCK_PROCESS_CPU:
+      return "clock()";
+    case TIME_CLOCK_TSC:
+      return "TSC";
+  }
+
+  return "unknown";
+} /* time_clock_name */
+
+uint64_t time_clock_overhead(enum time_clock_source source) {
+  if (!clock_calibrated[source])
+    time_clock_calibrate(source);
+
+  return clock_overhead[source];
+} /* time_clock_overhead */
 
 time_test time_test_start(const char* caption) {
   time_test test = (time_test) {
     .caption = caption,
     .start = 0,
     .end = 0,
-    .taken = 0
+    .taken = 0,
+    .ops = 0,
   };
 
-  test.start = clock();
+  test.start = time_clock_read_start(clock_selected);
 
   return test;
 } /* time_test_start */
 
 void time_test_end(time_test *test) {
-  const clock_t t = clock();
+  const uint64_t t = time_clock_read_end(clock_selected);
   test->end = t;
-  test->taken = test->end - test->start;
+
+  const uint64_t taken = time_clock_to_ns(clock_selected, test->end - test->start);
+  test->taken = (taken > clock_overhead[clock_selected] ? taken - clock_overhead[clock_selected] : 0);
 
   return;
 } /* time_test_end */
@@ -30,9 +263,10 @@ time_testrun_template time_testrun_new(const char* caption, unsigned long testnu
     .num = testnumber,
     .testdata = data,
     .testfunc = testfunc,
+    .clock = TIME_CLOCK_MONOTONIC_RAW,
   };
 
-  if (features & 1) 
+  if (features & 1)
     template.enable_test_check = true;
   if ((features >> 1) & 1)
     template.enable_time_tracking = true;
@@ -41,38 +275,1144 @@ time_testrun_template time_testrun_new(const char* caption, unsigned long testnu
   return template;
 } /* time_testrun_new */
 
+time_testrun_template time_testrun_new_batched(const char* caption, unsigned long samples, enum TIMETEST_STATE (*batchfunc)(unsigned long iterations, void* data), void* data, unsigned int features) {
+  time_testrun_template template = time_testrun_new(caption, samples, NULL, data, features);
+  template.batchfunc = batchfunc;
+  template.target_ns = BATCH_TARGET_NS;
+
+  return template;
+} /* time_testrun_new_batched */
+
+void time_testrun_set_target(time_testrun_template* template, uint64_t target_ns) {
+  template->target_ns = target_ns;
+
+  return;
+} /* time_testrun_set_target */
+
+void time_testrun_set_bytes(time_testrun_template* template, unsigned long bytes) {
+  template->bytes_per_iteration = bytes;
+
+  return;
+} /* time_testrun_set_bytes */
+
+void time_testrun_set_threads(time_testrun_template* template, unsigned int threads, bool pin) {
+  template->threads = threads;
+  template->pin = pin;
+
+  return;
+} /* time_testrun_set_threads */
+
+void time_testrun_set_counters(time_testrun_template* template, bool enable) {
+  template->counters = enable;
+
+  return;
+} /* time_testrun_set_counters */
+
+void time_testrun_set_memory(time_testrun_template* template, bool enable) {
+  template->memory = enable;
+
+  return;
+} /* time_testrun_set_memory */
+
+void time_testrun_set_scheduler(time_testrun_template* template, const scheduler* scheduler) {
+  template->scheduler = scheduler;
+
+  return;
+} /* time_testrun_set_scheduler */
+
+unsigned int time_testrun_thread(void) {
+  return worker_index;
+} /* time_testrun_thread */
+
+void time_testrun_set_clock(time_testrun_template* template, enum time_clock_source source) {
+  template->clock = source;
+
+  return;
+} /* time_testrun_set_clock */
+
+void time_testrun_set_warmup(time_testrun_template* template, unsigned long warmup) {
+  template->warmup = warmup;
+
+  return;
+} /* time_testrun_set_warmup */
+
+const char* time_counter_name(enum time_counter counter) {
+  switch (counter) {
+    case TIME_COUNTER_CYCLES:
+      return "cycles";
+    case TIME_COUNTER_INSTRUCTIONS:
+      return "instructions";
+    case TIME_COUNTER_L1D_MISSES:
+      return "l1d_misses";
+    case TIME_COUNTER_LLC_MISSES:
+      return "llc_misses";
+    case TIME_COUNTER_BRANCH_MISSES:
+      return "branch_misses";
+    case TIME_COUNTER_PAGE_FAULTS:
+      return "page_faults";
+  }
+
+  return "unknown";
+} /* time_counter_name */
+
+time_stats time_stats_compute(const double* samples, unsigned long num) {
+  time_stats stats = {0};
+  if (!num)
+    return stats;
+
+  double* sorted = malloc(num * sizeof(double));
+  if (!sorted) {
+    fprintf(stderr,
+        "Failed to allocate memory for statistics over %lu samples: %s\n"
+        "=== ABORT ===\n",
+        num, strerror(errno));
+
+    abort();
+  }
+  memcpy(sorted, samples, num * sizeof(double));
+  qsort(sorted, num, sizeof(double), time_stats_cmp);
+
+  double sum = 0;
+  for (unsigned long i = 0; i < num; i++)
+    sum += sorted[i];
+  stats.mean = sum / num;
+  stats.min = sorted[0];
+  stats.max = sorted[num - 1];
+
+  double squares = 0;
+  for (unsigned long i = 0; i < num; i++)
+    squares += (sorted[i] - stats.mean) * (sorted[i] - stats.mean);
+  stats.stddev = (num > 1 ? sqrt(squares / (num - 1)) : 0);
+
+  stats.median = time_stats_percentile(sorted, num, 0.5);
+  stats.p90 = time_stats_percentile(sorted, num, 0.9);
+  stats.p99 = time_stats_percentile(sorted, num, 0.99);
+  stats.p999 = time_stats_percentile(sorted, num, 0.999);
+
+  /* Reuse the buffer for the absolute deviations from the median */
+  for (unsigned long i = 0; i < num; i++)
+    sorted[i] = fabs(sorted[i] - stats.median);
+  qsort(sorted, num, sizeof(double), time_stats_cmp);
+  stats.mad = time_stats_percentile(sorted, num, 0.5);
+
+  const double limit = MAD_OUTLIER_LIMIT * MAD_SCALE * stats.mad;
+  for (unsigned long i = 0; i < num; i++)
+    if (fabs(samples[i] - stats.median) > limit)
+      stats.outliers++;
+
+  const double margin = time_stats_t_value(num) * stats.stddev / sqrt(num);
+  stats.ci_low = stats.mean - margin;
+  stats.ci_high = stats.mean + margin;
+
+  free(sorted);
+
+  return stats;
+} /* time_stats_compute */
+
 time_testrun_results time_testrun_run(const time_testrun_template* template) {
-  time_testrun_results results = {
+  const enum time_clock_source previous_clock = time_clock_selected();
+  time_clock_select(template->clock);
+
+  const unsigned long iterations = (template->batchfunc && template->num ? time_testrun_calibrate(template) : 1);
+  time_testrun_results results = time_testrun_results_new(template, template->num, iterations);
+
+  if (template->threads) {
+    time_testrun_threaded(template, &results, template->threads);
+  } else {
+    blib_alloc_stats before;
+    bool tracked = false;
+
+    time_testrun_prepare(template, &results, 0, template->num);
+    if (template->scheduler)
+      time_scheduling_begin(&results.scheduling, template->scheduler);
+    if (template->memory)
+      tracked = time_memory_begin(&results.memory, &before);
+    time_testrun_range(template, &results, 0, template->num);
+    if (template->memory)
+      time_memory_end(&results.memory, &before, tracked);
+    if (template->scheduler)
+      time_scheduling_end(&results.scheduling, template->scheduler);
+
+    time_testrun_finish(&results);
+  }
+
+  time_clock_select(previous_clock);
+
+  return results;
+} /* time_testrun_run */
+
+dynamic_arr time_testrun_sweep(const time_testrun_template* template, unsigned int max_threads) {
+  dynamic_arr sweep = dynamic_arr_new(time_testrun_results);
+  dynamic_arr_reserve(&sweep, max_threads);
+
+  time_testrun_template run = *template;
+  for (unsigned int threads = 1; threads <= max_threads; threads++) {
+    run.threads = threads;
+
+    const time_testrun_results results = time_testrun_run(&run);
+    dynamic_arr_append(&sweep, &results);
+  }
+
+  return sweep;
+} /* time_testrun_sweep */
+
+void time_testrun_print_scaling(const time_testrun_results* results, unsigned long num) {
+  if (!num)
+    return;
+
+  const double base = results[0].ops_per_sec;
+
+  printf(
+      "%s:\n"
+      "\tSCALING (%s):\n"
+      "\t\tTHREADS\tOPS/S\t\tSPEEDUP\tEFFICIENCY\tMEDIAN\t\tP99\n",
+      (results[0].caption ? results[0].caption : ""),
+      (results[0].pinned ? "pinned" : "not pinned"));
+
+  for (unsigned long i = 0; i < num; i++) {
+    const double speedup = (base > 0 ? results[i].ops_per_sec / base : 0);
+
+    printf("\t\t%u\t%.3e\t%.2fx\t%.0f%%\t\t%.2f ns\t%.2f ns\n",
+        results[i].threads,
+        results[i].ops_per_sec,
+        speedup,
+        100 * speedup / results[i].threads,
+        results[i].stats.median,
+        results[i].stats.p99);
+  }
+
+  return;
+} /* time_testrun_print_scaling */
+
+const char* time_complexity_name(enum time_complexity complexity) {
+  switch (complexity) {
+    case TIME_O_1:
+      return "O(1)";
+    case TIME_O_LOG_N:
+      return "O(log n)";
+    case TIME_O_N:
+      return "O(n)";
+    case TIME_O_N_LOG_N:
+      return "O(n log n)";
+    case TIME_O_N_SQUARED:
+      return "O(n^2)";
+  }
+
+  return "unknown";
+} /* time_complexity_name */
+
+dynamic_arr time_testrun_sizes(unsigned long from, unsigned long to, double factor) {
+  if (!from || factor <= 1) {
+    fprintf(stderr,
+        "Attempt to create range of sizes from %lu with factor %.2f!\n"
+        "=== ABORT ===\n",
+        from, factor);
+
+    abort();
+  }
+
+  dynamic_arr sizes = dynamic_arr_new(unsigned long);
+
+  /* Rounded up, so small factors still make progress */
+  for (double size = from; size <= to; size = ceil(size * factor)) {
+    const unsigned long n = (unsigned long)size;
+    dynamic_arr_append(&sizes, &n);
+  }
+
+  return sizes;
+} /* time_testrun_sizes */
+
+time_complexity_results time_testrun_complexity(const time_testrun_template* template, const unsigned long* sizes, unsigned long num, void (*setup)(unsigned long size, void* data)) {
+  time_complexity_results complexity = {
+    .results = dynamic_arr_new(time_testrun_results),
+  };
+  dynamic_arr_reserve(&complexity.results, num);
+
+  for (unsigned long i = 0; i < num; i++) {
+    if (setup)
+      setup(sizes[i], template->testdata);
+
+    time_testrun_results results = time_testrun_run(template);
+    results.size = sizes[i];
+    dynamic_arr_append(&complexity.results, &results);
+  }
+
+  time_complexity_fit(&complexity);
+
+  return complexity;
+} /* time_testrun_complexity */
+
+void time_testrun_print_complexity(const time_complexity_results* complexity) {
+  const time_testrun_results* results = dynamic_arr_get_start(&complexity->results);
+  const unsigned long num = complexity->results.num;
+  if (!num)
+    return;
+
+  printf(
+      "%s:\n"
+      "\tCOMPLEXITY (%s, %.4g ns * f(n)):\n"
+      "\t\tSIZE\t\tMEDIAN\t\tP99\t\tFIT\n",
+      (results[0].caption ? results[0].caption : ""),
+      time_complexity_name(complexity->best), complexity->coefficient);
+
+  for (unsigned long i = 0; i < num; i++)
+    printf("\t\t%lu\t\t%.2f ns\t%.2f ns\t%.2f ns\n",
+        results[i].size,
+        results[i].stats.median,
+        results[i].stats.p99,
+        complexity->coefficient * time_complexity_f(complexity->best, results[i].size));
+
+  printf("\tFITS (relative error):\n");
+  for (int c = 0; c < TIME_COMPLEXITIES; c++)
+    printf("\t\t%-10s\t%.4g ns * f(n)\t%.1f%%%s\n",
+        time_complexity_name(c), complexity->coefficients[c], complexity->rms[c] * 100,
+        ((enum time_complexity)c == complexity->best ? "\t<- best" : ""));
+
+  return;
+} /* time_testrun_print_complexity */
+
+void time_complexity_cleanup(time_complexity_results* complexity) {
+  time_testrun_results* results = dynamic_arr_get_start(&complexity->results);
+  for (unsigned long i = 0; i < complexity->results.num; i++)
+    time_testrun_cleanup(&results[i]);
+  dynamic_arr_cleanup(&complexity->results);
+
+  *complexity = (time_complexity_results) {0};
+
+  return;
+} /* time_complexity_cleanup */
+
+void time_testrun_print(const time_testrun_results* results) {
+  if (!results->enable_time_tracking)
+    goto test_check;
+
+  printf(
+      "%s:\n"
+      "\tTIME (%s, %" PRIu64 " ns overhead subtracted, %lu iteration(s) per run):\n"
+      "\t\tMIN:\t%.2f\tns\n"
+      "\t\tMAX:\t%.2f\tns\n"
+      "\t\tAVG:\t%.2f\tns\n"
+      "\t\tTOTAL:\t%" PRIu64 "\tns in %lu runs\n"
+      "\t\tMEDIAN:\t%.2f\tns\n"
+      "\t\tP90:\t%.2f\tns\n"
+      "\t\tP99:\t%.2f\tns\n"
+      "\t\tP99.9:\t%.2f\tns\n"
+      "\t\tSTDDEV:\t%.2f\tns\n"
+      "\t\tCI95:\t[%.2f, %.2f]\tns\n"
+      "\t\tMAD:\t%.2f\tns (%lu outlier(s))\n",
+      (results->caption ? results->caption : ""),
+      time_clock_name(results->clock),
+      results->clock_overhead,
+      results->iterations,
+      results->stats.min,
+      results->stats.max,
+      results->stats.mean,
+      results->total,
+      results->num,
+      results->stats.median,
+      results->stats.p90,
+      results->stats.p99,
+      results->stats.p999,
+      results->stats.stddev,
+      results->stats.ci_low, results->stats.ci_high,
+      results->stats.mad, results->stats.outliers);
+
+  if (results->per_thread.num)
+    printf("\tTHREADS (%u, %s):\n", results->threads, (results->pinned ? "pinned" : "not pinned"));
+  for (unsigned long t = 0; t < results->per_thread.num; t++) {
+    const time_testrun_results* thread = (const time_testrun_results*)dynamic_arr_get_start(&results->per_thread) + t;
+
+    printf("\t\t#%lu:\tMEDIAN %.2f ns\tP99 %.2f ns\t%.3e ops/s\n",
+        t, thread->stats.median, thread->stats.p99, thread->ops_per_sec);
+  }
+
+  if (results->counters.enabled && results->counters.error) {
+    printf("\tCOUNTERS:\tunavailable (%s%s)\n", strerror(results->counters.error),
+        (results->counters.error == EACCES || results->counters.error == EPERM
+         ? ", see /proc/sys/kernel/perf_event_paranoid" : ""));
+  } else if (results->counters.enabled) {
+    printf("\tCOUNTERS (per iteration):\n");
+    if (results->counters.ipc > 0)
+      printf("\t\tIPC:\t%.2f\n", results->counters.ipc);
+
+    for (int c = 0; c < TIME_COUNTERS; c++) {
+      if (results->counters.available[c])
+        printf("\t\t%s:\t%.2f\n", time_counter_name(c), results->counters.per_op[c]);
+      else
+        printf("\t\t%s:\tunsupported\n", time_counter_name(c));
+    }
+  }
+
+  if (results->memory.enabled) {
+    char peak[32] = "n/a";
+    if (results->memory.allocs.sized)
+      snprintf(peak, sizeof(peak), "%" PRId64, results->memory.peak);
+
+    printf(
+        "\tMEMORY:\n"
+        "\t\tALLOCS:\t%" PRIu64 " malloc(s), %" PRIu64 " realloc(s), %" PRIu64 " free(s)\n"
+        "\t\tBYTES:\t%" PRIu64 " allocated, %s peak\n"
+        "\t\tRSS:\t%+" PRId64 " bytes\n",
+        results->memory.allocs.mallocs, results->memory.allocs.reallocs, results->memory.allocs.frees,
+        results->memory.allocs.bytes, peak,
+        results->memory.rss_delta);
+  }
+
+  if (results->scheduling.enabled) {
+    const scheduler_stats* total = &results->scheduling.total;
+    const scheduler_stats* workers = dynamic_arr_get_start(&results->scheduling.per_worker);
+
+    printf(
+        "\tSCHEDULER (%u worker(s)):\n"
+        "\t\tTOTAL:\t%" PRIu64 " task(s), %" PRIu64 " steal(s), %" PRIu64 " failed steal(s), "
+        "%" PRIu64 " sleep(s), %.3f ms idle\n",
+        results->scheduling.workers,
+        total->tasks, total->steals, total->failed_steals, total->sleeps, total->idle_ns / 1e6);
+    for (unsigned long w = 0; w < results->scheduling.per_worker.num; w++)
+      printf("\t\t#%lu:\t%" PRIu64 " task(s), %" PRIu64 " steal(s), %" PRIu64 " failed steal(s), %.3f ms idle\n",
+          w, workers[w].tasks, workers[w].steals, workers[w].failed_steals, workers[w].idle_ns / 1e6);
+  }
+
+  if (results->bytes_per_sec > 0)
+    printf("\tTHROUGHPUT:\t%.3e ops/s, %.2f MiB/s\n", results->ops_per_sec, results->bytes_per_sec / (1024.0 * 1024.0));
+  else if (results->ops_per_sec > 0)
+    printf("\tTHROUGHPUT:\t%.3e ops/s\n", results->ops_per_sec);
+
+test_check:
+  if (!results->enable_test_check)
+    return;
+
+  printf(
+      "\tCHECK:\n"
+      "\t\tSUCCESS: %lu\n"
+      "\t\tFAILURE: %lu\n"
+      "\t\tSKIPPED: %lu\n",
+      results->success,
+      results->failure,
+      results->skipped);
+
+  return;
+} /* time_testrun_print */
+
+void time_testrun_cleanup(time_testrun_results* results) {
+  time_testrun_results* threads = dynamic_arr_get_start(&results->per_thread);
+  for (unsigned long t = 0; t < results->per_thread.num; t++)
+    time_testrun_cleanup(&threads[t]);
+
+  dynamic_arr_cleanup(&results->per_thread);
+  dynamic_arr_cleanup(&results->samples);
+  if (results->scheduling.enabled)
+    dynamic_arr_cleanup(&results->scheduling.per_worker);
+
+  return;
+} /* time_testrun_cleanup */
+
+time_env time_env_get(void) {
+  static char cpu[256];
+
+  if (!*cpu) {
+    strcpy(cpu, "unknown");
+
+    FILE* cpuinfo = fopen("/proc/cpuinfo", "r");
+    char line[512];
+    while (cpuinfo && fgets(line, sizeof(line), cpuinfo)) {
+      if (strncmp(line, "model name", 10))
+        continue;
+
+      const char* value = strchr(line, ':');
+      if (!value)
+        break;
+      value += 1 + (value[1] == ' ');
+
+      strncpy(cpu, value, sizeof(cpu) - 1);
+      cpu[strcspn(cpu, "\n")] = '\0';
+      break;
+    }
+    if (cpuinfo)
+      fclose(cpuinfo);
+  }
+
+  return (time_env) {
+    .cpu = cpu,
+    .compiler = BLIB_COMPILER,
+    .cflags = BLIB_CFLAGS,
+  };
+} /* time_env_get */
+
+void time_testrun_export_json(FILE* file, const time_testrun_results* results, unsigned long num) {
+  const time_env env = time_env_get();
+
+  fprintf(file, "{\n  \"environment\": {\n    \"cpu\": ");
+  time_export_json_string(file, env.cpu);
+  fprintf(file, ",\n    \"compiler\": ");
+  time_export_json_string(file, env.compiler);
+  fprintf(file, ",\n    \"cflags\": ");
+  time_export_json_string(file, env.cflags);
+  fprintf(file, "\n  },\n  \"results\": [");
+
+  for (unsigned long i = 0; i < num; i++) {
+    const time_testrun_results* r = &results[i];
+
+    fprintf(file, "%s\n    {\n      \"caption\": ", (i ? "," : ""));
+    time_export_json_string(file, (r->caption ? r->caption : ""));
+    fprintf(file,
+        ",\n"
+        "      \"config\": {\"size\": %lu, \"runs\": %lu, \"iterations\": %lu, \"warmup\": %lu, "
+        "\"clock\": \"%s\", \"clock_overhead_ns\": %" PRIu64 ", \"bytes_per_iteration\": %lu},\n"
+        "      \"check\": {\"success\": %lu, \"failure\": %lu, \"skipped\": %lu},\n"
+        "      \"total_ns\": %" PRIu64 ",\n"
+        "      \"stats\": {\"min\": %.4f, \"max\": %.4f, \"mean\": %.4f, \"stddev\": %.4f, "
+        "\"median\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"p999\": %.4f, "
+        "\"mad\": %.4f, \"ci_low\": %.4f, \"ci_high\": %.4f, \"outliers\": %lu},\n"
+        "      \"ops_per_sec\": %.4f,\n"
+        "      \"bytes_per_sec\": %.4f,\n"
+        "      \"memory\": ",
+        r->size, r->num, r->iterations, r->warmup,
+        time_clock_name(r->clock), r->clock_overhead, r->bytes_per_iteration,
+        r->success, r->failure, r->skipped,
+        r->total,
+        r->stats.min, r->stats.max, r->stats.mean, r->stats.stddev,
+        r->stats.median, r->stats.p90, r->stats.p99, r->stats.p999,
+        r->stats.mad, r->stats.ci_low, r->stats.ci_high, r->stats.outliers,
+        r->ops_per_sec,
+        r->bytes_per_sec);
+
+    if (r->memory.enabled) {
+      fprintf(file,
+          "{\"mallocs\": %" PRIu64 ", \"reallocs\": %" PRIu64 ", \"frees\": %" PRIu64 ", "
+          "\"bytes_allocated\": %" PRIu64 ", \"peak_bytes\": ",
+          r->memory.allocs.mallocs, r->memory.allocs.reallocs, r->memory.allocs.frees, r->memory.allocs.bytes);
+      if (r->memory.allocs.sized)
+        fprintf(file, "%" PRId64, r->memory.peak);
+      else
+        fprintf(file, "null");
+      fprintf(file, ", \"rss_delta\": %" PRId64 "}", r->memory.rss_delta);
+    } else
+      fprintf(file, "null");
+
+    fprintf(file, ",\n      \"scheduler\": ");
+    if (r->scheduling.enabled)
+      fprintf(file,
+          "{\"workers\": %u, \"tasks\": %" PRIu64 ", \"spawns\": %" PRIu64 ", \"steals\": %" PRIu64 ", "
+          "\"failed_steals\": %" PRIu64 ", \"sleeps\": %" PRIu64 ", \"idle_ns\": %" PRIu64 "}",
+          r->scheduling.workers, r->scheduling.total.tasks, r->scheduling.total.spawns, r->scheduling.total.steals,
+          r->scheduling.total.failed_steals, r->scheduling.total.sleeps, r->scheduling.total.idle_ns);
+    else
+      fprintf(file, "null");
+
+    fprintf(file, ",\n      \"counters\": ");
+    if (!r->counters.enabled || r->counters.error) {
+      fprintf(file, "null\n    }");
+      continue;
+    }
+
+    if (r->counters.ipc > 0)
+      fprintf(file, "{\"ipc\": %.4f", r->counters.ipc);
+    else
+      fprintf(file, "{\"ipc\": null");
+    for (int c = 0; c < TIME_COUNTERS; c++) {
+      if (r->counters.available[c])
+        fprintf(file, ", \"%s\": %.4f", time_counter_name(c), r->counters.per_op[c]);
+      else
+        fprintf(file, ", \"%s\": null", time_counter_name(c));
+    }
+    fprintf(file, "}\n    }");
+  }
+
+  fprintf(file, "\n  ]\n}\n");
+
+  return;
+} /* time_testrun_export_json */
+
+void time_testrun_export_csv(FILE* file, const time_testrun_results* results, unsigned long num) {
+  const time_env env = time_env_get();
+
+  fprintf(file, "# cpu: %s\n# compiler: %s\n# cflags: %s\n", env.cpu, env.compiler, env.cflags);
+
+  for (unsigned long c = 0; c < sizeof(csv_columns) / sizeof(*csv_columns); c++)
+    fprintf(file, "%s%s", (c ? "," : ""), csv_columns[c]);
+  fputc('\n', file);
+
+  for (unsigned long i = 0; i < num; i++) {
+    const time_testrun_results* r = &results[i];
+
+    time_export_csv_string(file, (r->caption ? r->caption : ""));
+    fprintf(file,
+        ",%lu,%lu,%lu,%lu,%s,%" PRIu64 ",%lu,%lu,%lu,%" PRIu64
+        ",%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%lu,%.4f,%lu,%.4f",
+        r->size, r->num, r->iterations, r->warmup, time_clock_name(r->clock), r->clock_overhead,
+        r->success, r->failure, r->skipped, r->total,
+        r->stats.min, r->stats.max, r->stats.mean, r->stats.stddev,
+        r->stats.median, r->stats.p90, r->stats.p99, r->stats.p999,
+        r->stats.mad, r->stats.ci_low, r->stats.ci_high, r->stats.outliers,
+        r->ops_per_sec, r->bytes_per_iteration, r->bytes_per_sec);
+
+    /* Counters stay empty if they weren't captured */
+    const bool counted = r->counters.enabled && !r->counters.error;
+    if (counted && r->counters.ipc > 0)
+      fprintf(file, ",%.4f", r->counters.ipc);
+    else
+      fputc(',', file);
+    for (int c = 0; c < TIME_COUNTERS; c++) {
+      if (counted && r->counters.available[c])
+        fprintf(file, ",%.4f", r->counters.per_op[c]);
+      else
+        fputc(',', file);
+    }
+
+    /* The peak stays empty if the allocator doesn't report sizes */
+    if (r->memory.enabled && r->memory.allocs.sized)
+      fprintf(file, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRId64 ",%" PRId64,
+          r->memory.allocs.mallocs, r->memory.allocs.reallocs, r->memory.allocs.frees,
+          r->memory.allocs.bytes, r->memory.peak, r->memory.rss_delta);
+    else if (r->memory.enabled)
+      fprintf(file, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",,%" PRId64,
+          r->memory.allocs.mallocs, r->memory.allocs.reallocs, r->memory.allocs.frees,
+          r->memory.allocs.bytes, r->memory.rss_delta);
+    else
+      fputs(",,,,,,", file);
+    fputc('\n', file);
+  }
+
+  return;
+} /* time_testrun_export_csv */
+
+long time_testrun_compare(const char* baseline, const time_testrun_results* results, unsigned long num, double threshold) {
+  dynamic_arr entries = time_baseline_load(baseline);
+  if (!entries.element_size)
+    return -1;
+
+  const time_baseline* base = dynamic_arr_get_start(&entries);
+  long regressions = 0;
+
+  printf("COMPARE (baseline %s, %.1f%% threshold):\n", baseline, threshold * 100);
+
+  for (unsigned long i = 0; i < num; i++) {
+    const time_testrun_results* r = &results[i];
+    const char* caption = (r->caption ? r->caption : "");
+    char size[32] = "";
+    if (r->size)
+      snprintf(size, sizeof(size), " (n = %lu)", r->size);
+
+    const time_baseline* b = NULL;
+    for (unsigned long j = 0; j < entries.num && !b; j++)
+      if (!strncmp(base[j].caption, caption, BASELINE_CAPTION_MAX - 1) && base[j].size == r->size)
+        b = &base[j];
+
+    if (!b) {
+      printf("\t%s%s:\tnot in baseline\n", caption, size);
+      continue;
+    }
+
+    /* Welch's t-test, the runs don't share a variance */
+    const double va = (b->runs ? b->stddev * b->stddev / b->runs : 0);
+    const double vb = (r->num ? r->stats.stddev * r->stats.stddev / r->num : 0);
+    const double diff = r->stats.mean - b->mean;
+    bool significant = (diff != 0);
+    if (va + vb > 0) {
+      const double df_denom = (b->runs > 1 ? va * va / (b->runs - 1) : 0) + (r->num > 1 ? vb * vb / (r->num - 1) : 0);
+      const double df = (df_denom > 0 ? (va + vb) * (va + vb) / df_denom : 1);
+
+      significant = fabs(diff) / sqrt(va + vb) > time_stats_t_value((unsigned long)df + 1);
+    }
+
+    const double change = (b->mean > 0 ? diff / b->mean : 0);
+    const char* verdict = "unchanged";
+    if (significant && change > threshold) {
+      verdict = "REGRESSION";
+      regressions++;
+    } else if (significant && change < -threshold) {
+      verdict = "improved";
+    }
+
+    printf("\t%s%s:\t%.2f -> %.2f ns (%+.1f%%)\t%s\n", caption, size, b->mean, r->stats.mean, change * 100, verdict);
+  }
+
+  dynamic_arr_cleanup(&entries);
+
+  return regressions;
+} /* time_testrun_compare */
+
+/* =====================
+ * Convenience Functions
+ * ===================== */
+double time_complexity_f(enum time_complexity complexity, unsigned long n) {
+  const double x = (double)n;
+
+  switch (complexity) {
+    case TIME_O_1:
+      return 1;
+    case TIME_O_LOG_N:
+      return log2(x > 1 ? x : 2);
+    case TIME_O_N:
+      return x;
+    case TIME_O_N_LOG_N:
+      return x * log2(x > 1 ? x : 2);
+    case TIME_O_N_SQUARED:
+      return x * x;
+  }
+
+  return 1;
+}
+
+void time_complexity_fit(time_complexity_results* complexity) {
+  const time_testrun_results* results = dynamic_arr_get_start(&complexity->results);
+  const unsigned long num = complexity->results.num;
+  if (!num)
+    return;
+
+  double mean = 0;
+  for (unsigned long i = 0; i < num; i++)
+    mean += results[i].stats.median / num;
+
+  /*
+   * Weighted least squares of y = c * f(n) with weights 1 / s^2, so every size counts
+   * by its relative error instead of the largest sizes deciding the fit alone:
+   * c = sum(f * y / s^2) / sum(f^2 / s^2)
+   * The scale s is y kept off 0, the medians themselves are fitted unchanged.
+   */
+  for (int c = 0; c < TIME_COMPLEXITIES; c++) {
+    double fy = 0, ff = 0;
+    for (unsigned long i = 0; i < num; i++) {
+      const double y = results[i].stats.median;
+      const double s = fmax(y, mean * 1e-3);
+      const double f = time_complexity_f(c, results[i].size);
+      fy += f * y / (s * s);
+      ff += f * f / (s * s);
+    }
+    complexity->coefficients[c] = (ff > 0 ? fy / ff : 0);
+
+    double residuals = 0;
+    for (unsigned long i = 0; i < num; i++) {
+      const double y = results[i].stats.median;
+      const double r = (y - complexity->coefficients[c] * time_complexity_f(c, results[i].size)) / fmax(y, mean * 1e-3);
+      residuals += r * r;
+    }
+    complexity->rms[c] = sqrt(residuals / num);
+
+    if (complexity->rms[c] < complexity->rms[complexity->best])
+      complexity->best = c;
+  }
+  complexity->coefficient = complexity->coefficients[complexity->best];
+
+  return;
+}
+
+uint64_t time_clock_read_start(enum time_clock_source source) {
+  struct timespec ts;
+
+  switch (source) {
+    case TIME_CLOCK_TSC:
+#if HAVE_TSC
+    {
+      /* lfence keeps earlier instructions from drifting into the measurement */
+      uint32_t lo, hi;
+      __asm__ __volatile__("lfence\n\trdtsc" : "=a"(lo), "=d"(hi) : : "memory");
+
+      return ((uint64_t)hi << 32) | lo;
+    }
+#endif
+    case TIME_CLOCK_MONOTONIC_RAW:
+      clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+      return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+    case TIME_CLOCK_THREAD_CPU:
+      clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+      return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+    case TIME_CLOCK_PROCESS_CPU:
+      return clock();
+  }
+
+  return 0;
+}
+
+uint64_t time_clock_read_end(enum time_clock_source source) {
+#if HAVE_TSC
+  if (source == TIME_CLOCK_TSC) {
+    /* rdtscp waits for the measured instructions, lfence keeps later ones out */
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi) : : "ecx", "memory");
+
+    return ((uint64_t)hi << 32) | lo;
+  }
+#endif
+
+  return time_clock_read_start(source);
+}
+
+uint64_t time_clock_to_ns(enum time_clock_source source, uint64_t ticks) {
+  switch (source) {
+    case TIME_CLOCK_MONOTONIC_RAW:
+    case TIME_CLOCK_THREAD_CPU:
+      return ticks;
+
+    case TIME_CLOCK_PROCESS_CPU:
+      return ticks * (1000000000ULL / CLOCKS_PER_SEC);
+
+    case TIME_CLOCK_TSC:
+      return (uint64_t)(ticks * tsc_ns_per_tick + 0.5);
+  }
+
+  return ticks;
+}
+
+void time_clock_calibrate(enum time_clock_source source) {
+  if (source == TIME_CLOCK_TSC) {
+    const uint64_t ns_start = time_clock_read_start(TIME_CLOCK_MONOTONIC_RAW);
+    const uint64_t tsc_start = time_clock_read_start(TIME_CLOCK_TSC);
+
+    uint64_t ns_end;
+    do {
+      ns_end = time_clock_read_start(TIME_CLOCK_MONOTONIC_RAW);
+    } while (ns_end - ns_start < TSC_CALIBRATION_NS);
+    const uint64_t tsc_end = time_clock_read_end(TIME_CLOCK_TSC);
+
+    tsc_ns_per_tick = (double)(ns_end - ns_start) / (double)(tsc_end - tsc_start);
+  }
+
+  uint64_t overhead = UINT64_MAX;
+  for (unsigned int i = 0; i < OVERHEAD_ROUNDS; i++) {
+    const uint64_t start = time_clock_read_start(source);
+    const uint64_t end = time_clock_read_end(source);
+
+    const uint64_t taken = time_clock_to_ns(source, end - start);
+    if (taken < overhead)
+      overhead = taken;
+  }
+
+  clock_overhead[source] = overhead;
+  clock_calibrated[source] = true;
+
+  return;
+}
+
+int time_stats_cmp(const void* a, const void* b) {
+  const double x = *(const double*)a;
+  const double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+double time_stats_percentile(const double* sorted, unsigned long num, double p) {
+  const double pos = p * (num - 1);
+  const unsigned long lo = (unsigned long)pos;
+  if (lo + 1 >= num)
+    return sorted[num - 1];
+
+  return sorted[lo] + (pos - lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+time_test time_testrun_sample(const time_testrun_template* template, unsigned int index, unsigned long iterations) {
+  if (!template->batchfunc)
+    return template->testfunc(index, template->testdata);
+
+  time_test test = time_test_start(template->caption);
+  const enum TIMETEST_STATE state = template->batchfunc(iterations, template->testdata);
+  time_test_end(&test);
+
+  test.state = state;
+
+  return test;
+}
+
+unsigned long time_testrun_calibrate(const time_testrun_template* template) {
+  const uint64_t target = (template->target_ns ? template->target_ns : BATCH_TARGET_NS);
+  unsigned long iterations = 1;
+
+  for (;;) {
+    const time_test test = time_testrun_sample(template, 0, iterations);
+    if (test.taken >= target)
+      return iterations;
+
+    /* Aim a bit past the target, so timer noise doesn't cause an extra round */
+    double growth = (test.taken ? 1.4 * target / test.taken : BATCH_GROWTH_MAX);
+    if (growth < BATCH_GROWTH_MIN)
+      growth = BATCH_GROWTH_MIN;
+    if (growth > BATCH_GROWTH_MAX)
+      growth = BATCH_GROWTH_MAX;
+
+    if (iterations > ULONG_MAX / BATCH_GROWTH_MAX)
+      return iterations;
+    iterations = (unsigned long)(iterations * growth);
+  }
+}
+
+/* Returns whether allocations were tracked before, `time_memory_end()' restores it */
+bool time_memory_begin(time_memory* memory, blib_alloc_stats* before) {
+  const bool tracked = blib_alloc_track(true);
+  blib_alloc_reset_peak();
+
+  *before = blib_alloc_stats_get();
+  memory->rss_delta = time_memory_rss();
+
+  return tracked;
+}
+
+void time_memory_end(time_memory* memory, const blib_alloc_stats* before, bool tracked) {
+  memory->rss_delta = time_memory_rss() - memory->rss_delta;
+
+  const blib_alloc_stats after = blib_alloc_stats_get();
+  blib_alloc_track(tracked);
+
+  memory->allocs = (blib_alloc_stats) {
+    .mallocs = after.mallocs - before->mallocs,
+    .reallocs = after.reallocs - before->reallocs,
+    .frees = after.frees - before->frees,
+    .bytes = after.bytes - before->bytes,
+    .live = after.live - before->live,
+    .peak = after.peak,
+    .sized = after.sized,
+  };
+  memory->peak = after.peak - before->live;
+
+  return;
+}
+
+/* Counters are cumulative, the snapshot taken here is subtracted at the end */
+void time_scheduling_begin(time_scheduling* scheduling, const scheduler* scheduler) {
+  scheduling->enabled = true;
+  scheduling->workers = scheduler->workers;
+  scheduling->per_worker = dynamic_arr_new(scheduler_stats);
+  dynamic_arr_reserve(&scheduling->per_worker, scheduler->workers);
+
+  for (unsigned int w = 0; w < scheduler->workers; w++) {
+    const scheduler_stats stats = scheduler_stats_get(scheduler, w);
+    dynamic_arr_append(&scheduling->per_worker, &stats);
+  }
+
+  return;
+}
+
+void time_scheduling_end(time_scheduling* scheduling, const scheduler* scheduler) {
+  scheduler_stats* workers = dynamic_arr_get_start(&scheduling->per_worker);
+  scheduling->total = (scheduler_stats) {0};
+
+  for (unsigned int w = 0; w < scheduling->workers; w++) {
+    const scheduler_stats after = scheduler_stats_get(scheduler, w);
+    workers[w] = (scheduler_stats) {
+      .tasks = after.tasks - workers[w].tasks,
+      .spawns = after.spawns - workers[w].spawns,
+      .steals = after.steals - workers[w].steals,
+      .failed_steals = after.failed_steals - workers[w].failed_steals,
+      .sleeps = after.sleeps - workers[w].sleeps,
+      .idle_ns = after.idle_ns - workers[w].idle_ns,
+    };
+
+    scheduling->total.tasks += workers[w].tasks;
+    scheduling->total.spawns += workers[w].spawns;
+    scheduling->total.steals += workers[w].steals;
+    scheduling->total.failed_steals += workers[w].failed_steals;
+    scheduling->total.sleeps += workers[w].sleeps;
+    scheduling->total.idle_ns += workers[w].idle_ns;
+  }
+
+  return;
+}
+
+int64_t time_memory_rss(void) {
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (!statm)
+    return 0;
+
+  long pages = 0;
+  if (fscanf(statm, "%*s %ld", &pages) != 1)
+    pages = 0;
+  fclose(statm);
+
+  return (int64_t)pages * sysconf(_SC_PAGESIZE);
+}
+
+void time_export_json_string(FILE* file, const char* str) {
+  fputc('"', file);
+
+  for (; *str; str++) {
+    const unsigned char c = *str;
+    if (c == '"' || c == '\\')
+      fprintf(file, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(file, "\\u%04x", c);
+    else
+      fputc(c, file);
+  }
+
+  fputc('"', file);
+
+  return;
+}
+
+void time_export_csv_string(FILE* file, const char* str) {
+  fputc('"', file);
+
+  for (; *str; str++) {
+    if (*str == '"')
+      fputc('"', file);
+    fputc(*str, file);
+  }
+
+  fputc('"', file);
+
+  return;
+}
+
+bool time_csv_field(const char** line, char* field, unsigned long size) {
+  const char* p = *line;
+  unsigned long len = 0;
+
+  if (*p == '\0' || *p == '\n')
+    return false;
+
+  if (*p == '"') {
+    for (p++; *p; p++) {
+      if (*p == '"' && p[1] != '"')
+        break;
+      p += (*p == '"');
+
+      if (len + 1 < size)
+        field[len++] = *p;
+    }
+    p += (*p == '"');
+  } else {
+    for (; *p && *p != ',' && *p != '\n'; p++)
+      if (len + 1 < size)
+        field[len++] = *p;
+  }
+
+  field[len] = '\0';
+  *line = p + (*p == ',');
+
+  return true;
+}
+
+dynamic_arr time_baseline_load(const char* path) {
+  FILE* file = fopen(path, "r");
+  if (!file)
+    return (dynamic_arr) {0};
+
+  dynamic_arr entries = dynamic_arr_new(time_baseline);
+  long caption_col = -1, size_col = -1, runs_col = -1, mean_col = -1, stddev_col = -1;
+  bool header = true;
+
+  char* line = NULL;
+  size_t line_size = 0;
+  char field[BASELINE_CAPTION_MAX];
+  while (getline(&line, &line_size, file) != -1) {
+    if (*line == '#' || *line == '\n')
+      continue;
+
+    const char* p = line;
+    time_baseline entry = {0};
+    for (long col = 0; time_csv_field(&p, field, sizeof(field)); col++) {
+      if (header) {
+        caption_col = (!strcmp(field, "caption") ? col : caption_col);
+        size_col = (!strcmp(field, "size") ? col : size_col);
+        runs_col = (!strcmp(field, "runs") ? col : runs_col);
+        mean_col = (!strcmp(field, "mean") ? col : mean_col);
+        stddev_col = (!strcmp(field, "stddev") ? col : stddev_col);
+      } else if (col == caption_col) {
+        strcpy(entry.caption, field);
+      } else if (col == size_col) {
+        entry.size = strtoul(field, NULL, 10);
+      } else if (col == runs_col) {
+        entry.runs = strtoul(field, NULL, 10);
+      } else if (col == mean_col) {
+        entry.mean = strtod(field, NULL);
+      } else if (col == stddev_col) {
+        entry.stddev = strtod(field, NULL);
+      }
+    }
+
+    if (!header)
+      dynamic_arr_append(&entries, &entry);
+    header = false;
+  }
+
+  free(line);
+  fclose(file);
+
+  if (caption_col < 0 || mean_col < 0) {
+    dynamic_arr_cleanup(&entries);
+    errno = EINVAL;
+
+    return (dynamic_arr) {0};
+  }
+
+  return entries;
+}
+
+time_testrun_results time_testrun_results_new(const time_testrun_template* template, unsigned long num, unsigned long iterations) {
+  return (time_testrun_results) {
     .caption = template->caption,
-    .num = template->num,
+    .num = num,
 
     .enable_test_check = template->enable_test_check,
     .enable_time_tracking = template->enable_time_tracking,
 
     .max = 0,
-    .min = INT_MAX,
+    .min = UINT64_MAX,
     .avg = 0,
     .total = 0,
+
+    .clock = time_clock_selected(),
+    .clock_overhead = time_clock_overhead(time_clock_selected()),
+
+    .samples = dynamic_arr_new(double),
+    .iterations = iterations,
+
+    .warmup = template->warmup,
+    .bytes_per_iteration = template->bytes_per_iteration,
+
+    .threads = 1,
+
+    .counters = { .enabled = template->counters },
+    .memory = { .enabled = template->memory },
   };
+}
+
+void time_testrun_prepare(const time_testrun_template* template, time_testrun_results* results, unsigned long begin, unsigned long end) {
+  for (unsigned long t = 0; begin < end && t < template->warmup; t++)
+    time_testrun_sample(template, begin + t % (end - begin), results->iterations);
+
+  /* Recording the samples mustn't allocate during the tests */
+  if (template->enable_time_tracking)
+    dynamic_arr_reserve(&results->samples, end - begin);
+
+  return;
+}
+
+void time_testrun_range(const time_testrun_template* template, time_testrun_results* results, unsigned long begin, unsigned long end) {
+  /* Counters belong to the calling thread, so every range opens its own */
+  time_counter_group group;
+  const bool counting = template->counters && !time_counters_open(&group, &results->counters);
 
-  for (unsigned int t = 0; t < template->num; t++) {
-    time_test test = template->testfunc(t, template->testdata);
+  for (unsigned int t = begin; t < end; t++) {
+    if (counting)
+      time_counters_start(&group);
+    time_test test = time_testrun_sample(template, t, results->iterations);
+    if (counting)
+      time_counters_stop(&group, &results->counters);
+
+    const unsigned long ops = (test.ops ? test.ops : 1) * results->iterations;
+    results->ops += ops;
     if (!template->enable_time_tracking)
       goto test_check;
 
-    if (test.taken > results.max)
-      results.max = test.taken;
-    if (test.taken < results.min)
-      results.min = test.taken;
+    if (test.taken > results->max)
+      results->max = test.taken;
+    if (test.taken < results->min)
+      results->min = test.taken;
+
+    results->total += test.taken;
 
-    results.total += test.taken;
+    const double sample = (double)test.taken / ops;
+    dynamic_arr_append(&results->samples, &sample);
 test_check:
     if (!template->enable_test_check)
       continue;
 
     switch(test.state) {
       case TEST_UNKNOWN:
-        fprintf(stderr, 
+        fprintf(stderr,
             "Test #%u returned invalid state of TEST_UNKNOWN!\n"
             "=== ABORT ===\n",
             t);
@@ -81,59 +1421,293 @@ test_check:
         break;
 
       case TEST_SUCCESS:
-        results.success++;
+        results->success++;
         break;
 
       case TEST_FAILURE:
-        results.failure++;
+        results->failure++;
         fprintf(stderr, "%s: #%u: Test failed!\n", template->caption, t);
         break;
 
       case TEST_SKIPPED:
-        results.skipped++;
+        results->skipped++;
         break;
     }
   }
 
-  results.avg = (float)results.total / (template->num ? template->num : 1);
+  if (counting)
+    time_counters_close(&group);
 
-  return results;
-} /* time_testrun_run */
+  return;
+}
 
-void time_testrun_print(const time_testrun_results* results) {
-  if (!results->enable_time_tracking)
-    goto test_check;
+void time_testrun_finish(time_testrun_results* results) {
+  if (!results->samples.num)
+    results->min = 0;
+  results->avg = (double)results->total / (results->samples.num ? results->samples.num : 1);
+  results->stats = time_stats_compute(dynamic_arr_get_start(&results->samples), results->samples.num);
 
-  clock_t div = CLOCKS_PER_SEC / 1000000;
-  if (!div)
-    div = 1;
+  if (results->stats.mean > 0) {
+    results->ops_per_sec = 1e9 / results->stats.mean;
+    results->bytes_per_sec = results->ops_per_sec * results->bytes_per_iteration;
+  }
 
-  printf(
-      "%s:\n"
-      "\tTIME:\n"
-      "\t\tMIN:\t%lu\tmicros\n"
-      "\t\tMAX:\t%lu\tmicros\n"
-      "\t\tAVG:\t%.2f\tmicros\n"
-      "\t\tTOTAL:\t%lu\tmicros in %lu runs\n",
-      (results->caption ? results->caption : ""),
-      results->min / div,
-      results->max / div,
-      results->avg / div,
-      results->total / div,
-      results->num);
+  if (results->counters.enabled && !results->counters.error)
+    time_counters_finish(&results->counters, results->ops);
 
-test_check:
-  if (!results->enable_test_check)
+  return;
+}
+
+void time_testrun_threaded(const time_testrun_template* template, time_testrun_results* results, unsigned int threads) {
+  /* Threads are pinned to the CPUs the process may run on, in order */
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  const bool pin = template->pin && !sched_getaffinity(0, sizeof(allowed), &allowed);
+  const int cpus = (pin ? CPU_COUNT(&allowed) : 0);
+
+  time_worker* workers = calloc(threads, sizeof(time_worker));
+  pthread_t* handles = calloc(threads, sizeof(pthread_t));
+  if (!workers || !handles) {
+    fprintf(stderr,
+        "Failed to allocate %u threads for testrun: %s\n"
+        "=== ABORT ===\n",
+        threads, strerror(errno));
+
+    abort();
+  }
+
+  results->threads = threads;
+  results->pinned = pin;
+  results->per_thread = dynamic_arr_new(time_testrun_results);
+  dynamic_arr_resize_to(&results->per_thread, NULL, threads);
+
+  time_testrun_results* per_thread = dynamic_arr_get_start(&results->per_thread);
+
+  /* The calling thread joins the barrier to start tracking memory once the threads are ready */
+  pthread_barrier_t barrier;
+  pthread_barrier_init(&barrier, NULL, threads + 1);
+
+  for (unsigned int t = 0; t < threads; t++) {
+    const unsigned long begin = results->num * t / threads;
+    const unsigned long end = results->num * (t + 1) / threads;
+    per_thread[t] = time_testrun_results_new(template, end - begin, results->iterations);
+
+    workers[t] = (time_worker) {
+      .template = template,
+      .results = &per_thread[t],
+      .begin = begin,
+      .end = end,
+      .index = t,
+      .cpu = -1,
+      .barrier = &barrier,
+    };
+
+    for (int cpu = 0, nth = t % (cpus ? cpus : 1); pin && cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed) && !nth--) {
+        workers[t].cpu = cpu;
+        break;
+      }
+    }
+
+    const int error = pthread_create(&handles[t], NULL, time_testrun_worker, &workers[t]);
+    if (error) {
+      fprintf(stderr,
+          "Failed to start thread #%u of testrun: %s\n"
+          "=== ABORT ===\n",
+          t, strerror(error));
+
+      abort();
+    }
+  }
+
+  blib_alloc_stats before;
+  bool tracked = false;
+  pthread_barrier_wait(&barrier);
+  if (template->scheduler)
+    time_scheduling_begin(&results->scheduling, template->scheduler);
+  if (template->memory)
+    tracked = time_memory_begin(&results->memory, &before);
+  pthread_barrier_wait(&barrier);
+
+  for (unsigned int t = 0; t < threads; t++)
+    pthread_join(handles[t], NULL);
+  if (template->memory)
+    time_memory_end(&results->memory, &before, tracked);
+  if (template->scheduler)
+    time_scheduling_end(&results->scheduling, template->scheduler);
+
+  uint64_t wall_start = UINT64_MAX, wall_end = 0;
+  for (unsigned int t = 0; t < threads; t++) {
+    if (workers[t].wall_start < wall_start)
+      wall_start = workers[t].wall_start;
+    if (workers[t].wall_end > wall_end)
+      wall_end = workers[t].wall_end;
+
+    time_testrun_results* thread = &per_thread[t];
+    time_testrun_finish(thread);
+
+    results->success += thread->success;
+    results->failure += thread->failure;
+    results->skipped += thread->skipped;
+    results->total += thread->total;
+    results->ops += thread->ops;
+    if (thread->samples.num && thread->min < results->min)
+      results->min = thread->min;
+    if (thread->max > results->max)
+      results->max = thread->max;
+
+    if (thread->counters.error)
+      results->counters.error = thread->counters.error;
+    for (int c = 0; !thread->counters.error && c < TIME_COUNTERS; c++) {
+      results->counters.available[c] |= thread->counters.available[c];
+      results->counters.total[c] += thread->counters.total[c];
+    }
+
+    if (thread->samples.num)
+      dynamic_arr_bulk_append(&results->samples, dynamic_arr_get_start(&thread->samples), thread->samples.num);
+  }
+
+  pthread_barrier_destroy(&barrier);
+  free(handles);
+  free(workers);
+
+  time_testrun_finish(results);
+
+  /* Combined throughput, as the threads didn't necessarily overlap the whole time */
+  if (results->samples.num && wall_end > wall_start) {
+    results->ops_per_sec = (double)results->ops * 1e9 / (wall_end - wall_start);
+    results->bytes_per_sec = results->ops_per_sec * results->bytes_per_iteration;
+  }
+
+  return;
+}
+
+void* time_testrun_worker(void* arg) {
+  time_worker* worker = arg;
+
+  if (worker->cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(worker->cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+  }
+
+  worker_index = worker->index;
+
+  /* Warm up on the pinned CPU, but release the measurement together */
+  time_testrun_prepare(worker->template, worker->results, worker->begin, worker->end);
+
+  pthread_barrier_wait(worker->barrier);
+  pthread_barrier_wait(worker->barrier);
+
+  worker->wall_start = time_clock_read_start(TIME_CLOCK_MONOTONIC_RAW);
+  time_testrun_range(worker->template, worker->results, worker->begin, worker->end);
+  worker->wall_end = time_clock_read_start(TIME_CLOCK_MONOTONIC_RAW);
+
+  return NULL;
+}
+
+int time_counters_open(time_counter_group* group, time_counters* counters) {
+  group->leader = -1;
+  group->num = 0;
+
+#ifdef __linux__
+  int error = 0;
+  for (int c = 0; c < TIME_COUNTERS; c++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = counter_events[c].type;
+    attr.config = counter_events[c].config;
+    attr.disabled = (group->leader < 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    /* Unsupported counters are left out, the first one opened leads the group */
+    const int fd = syscall(SYS_perf_event_open, &attr, 0, -1, group->leader, PERF_FLAG_FD_CLOEXEC);
+    if (fd < 0) {
+      error = (error ? error : errno);
+      continue;
+    }
+
+    if (group->leader < 0)
+      group->leader = fd;
+    group->fds[group->num] = fd;
+    group->order[group->num++] = c;
+    counters->available[c] = true;
+  }
+
+  counters->error = (group->num ? 0 : error);
+#else
+  (void)group;
+  counters->error = ENOSYS;
+#endif
+
+  return counters->error;
+}
+
+void time_counters_start(const time_counter_group* group) {
+#ifdef __linux__
+  ioctl(group->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+  (void)group;
+#endif
+
+  return;
+}
+
+void time_counters_stop(const time_counter_group* group, time_counters* counters) {
+#ifdef __linux__
+  ioctl(group->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  /* nr, time enabled, time running, then the values in group order */
+  uint64_t values[3 + TIME_COUNTERS];
+  if (read(group->leader, values, sizeof(values)) < (ssize_t)(3 * sizeof(uint64_t)))
     return;
 
-  printf(
-      "\tCHECK:\n"
-      "\t\tSUCCESS: %lu\n"
-      "\t\tFAILURE: %lu\n"
-      "\t\tSKIPPED: %lu\n",
-      results->success,
-      results->failure,
-      results->skipped);
+  /* Scale up counts of events the kernel had to multiplex */
+  const double scale = (values[2] && values[2] < values[1] ? (double)values[1] / values[2] : 1.0);
+  for (uint64_t i = 0; i < values[0] && i < group->num; i++)
+    counters->total[group->order[i]] += (uint64_t)(values[3 + i] * scale);
+#else
+  (void)group;
+  (void)counters;
+#endif
 
   return;
-} /* time_testrun_print */
+}
+
+void time_counters_close(time_counter_group* group) {
+#ifdef __linux__
+  for (unsigned int i = 0; i < group->num; i++)
+    close(group->fds[i]);
+#endif
+
+  group->leader = -1;
+  group->num = 0;
+
+  return;
+}
+
+void time_counters_finish(time_counters* counters, uint64_t ops) {
+  for (int c = 0; ops && c < TIME_COUNTERS; c++)
+    counters->per_op[c] = (double)counters->total[c] / ops;
+
+  if (counters->available[TIME_COUNTER_CYCLES] && counters->available[TIME_COUNTER_INSTRUCTIONS]
+      && counters->total[TIME_COUNTER_CYCLES])
+    counters->ipc = (double)counters->total[TIME_COUNTER_INSTRUCTIONS] / counters->total[TIME_COUNTER_CYCLES];
+
+  return;
+}
+
+double time_stats_t_value(unsigned long num) {
+  if (num < 2)
+    return 0;
+  if (num - 1 <= sizeof(t_table_95) / sizeof(*t_table_95))
+    return t_table_95[num - 2];
+
+  return 1.96;
+}
+/* ===================== */
@@ -0,0 +1,278 @@
+#define _GNU_SOURCE
+#include <blib/parsing/arguments/args.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_TESTS 256UL
+#define DEFAULT_ARGS  10000UL
+
+/* Options of every type, flags have short names to be clustered */
+#define FLAGS   16
+#define INTS    8
+#define FLOATS  8
+#define STRINGS 8
+#define ENUMS   8
+#define OPTIONS (FLAGS + INTS + FLOATS + STRINGS + ENUMS)
+
+typedef struct {
+  bool flags[FLAGS];
+  long ints[INTS];
+  double floats[FLOATS];
+  const char* strings[STRINGS];
+  unsigned int enums[ENUMS];
+} bench_values;
+
+typedef struct {
+  int ac;
+  const char** args; /* The generated command line */
+  const char** av; /* Copy parsed in place by every test */
+
+  args_option options[OPTIONS];
+  args_parser parser;
+
+  /* The same options for getopt_long(), long-only options return 256 + their index */
+  struct option long_options[OPTIONS + 1];
+  char short_options[2 * OPTIONS + 1];
+  int short_index[128];
+
+  bench_values values;
+} bench_state;
+
+static const char* const choices[] = { "none", "fast", "balanced", "thorough", NULL };
+
+static char names[OPTIONS][16];
+
+static uint64_t next_rand(uint64_t* rng) {
+  *rng ^= *rng << 13;
+  *rng ^= *rng >> 7;
+  *rng ^= *rng << 17;
+
+  return *rng;
+}
+
+static void bench_options(bench_state* state) {
+  bench_values* v = &state->values;
+  char* shorts = state->short_options;
+
+  for (int i = 0; i < OPTIONS; i++) {
+    args_option* option = &state->options[i];
+    *option = (args_option) { 0 };
+
+    if (i < FLAGS) {
+      snprintf(names[i], sizeof(names[i]), "flag-%d", i);
+      *option = (args_option) { 'a' + i, names[i], ARGS_FLAG, &v->flags[i], NULL };
+    } else if (i < FLAGS + INTS) {
+      snprintf(names[i], sizeof(names[i]), "count-%d", i - FLAGS);
+      *option = (args_option) { 'A' + (i - FLAGS), names[i], ARGS_INT, &v->ints[i - FLAGS], NULL };
+    } else if (i < FLAGS + INTS + FLOATS) {
+      snprintf(names[i], sizeof(names[i]), "ratio-%d", i - FLAGS - INTS);
+      *option = (args_option) { 0, names[i], ARGS_FLOAT, &v->floats[i - FLAGS - INTS], NULL };
+    } else if (i < FLAGS + INTS + FLOATS + STRINGS) {
+      const int s = i - FLAGS - INTS - FLOATS;
+      snprintf(names[i], sizeof(names[i]), "output-path-%d", s);
+      *option = (args_option) { '0' + s, names[i], ARGS_STRING, &v->strings[s], NULL };
+    } else {
+      const int e = i - FLAGS - INTS - FLOATS - STRINGS;
+      snprintf(names[i], sizeof(names[i]), "mode-%d", e);
+      *option = (args_option) { 0, names[i], ARGS_ENUM, &v->enums[e], choices };
+    }
+
+    state->long_options[i] = (struct option) {
+      names[i], (option->type == ARGS_FLAG ? no_argument : required_argument), NULL,
+      (option->short_name ? option->short_name : 256 + i),
+    };
+    if (option->short_name) {
+      *shorts++ = option->short_name;
+      if (option->type != ARGS_FLAG)
+        *shorts++ = ':';
+      state->short_index[(int)option->short_name] = i;
+    }
+  }
+  *shorts = '\0';
+
+  state->parser = args_parser_new(state->options, OPTIONS);
+}
+
+static const char* bench_value(const args_option* option, uint64_t* rng, char* buffer) {
+  switch (option->type) {
+    case ARGS_INT:
+      sprintf(buffer, "%ld", (long)(next_rand(rng) % 100000));
+      return buffer;
+    case ARGS_FLOAT:
+      sprintf(buffer, "%.4f", (next_rand(rng) % 100000) / 1000.0);
+      return buffer;
+    case ARGS_ENUM:
+      return choices[next_rand(rng) % 4];
+    default:
+      sprintf(buffer, "/tmp/out-%lu.dat", (unsigned long)(next_rand(rng) % 1000));
+      return buffer;
+  }
+}
+
+/* Clusters of flags, `--name=value', `--name value', `-xvalue', `-x value' and positionals */
+static void bench_generate(bench_state* state, unsigned long num) {
+  uint64_t rng = 0x9e3779b97f4a7c15ULL;
+  state->args = calloc(num + 2, sizeof(*state->args));
+  state->av = calloc(num + 2, sizeof(*state->av));
+
+  int ac = 0;
+  state->args[ac++] = "bench";
+  while ((unsigned long)ac < num) {
+    char buffer[64];
+    const args_option* option = &state->options[FLAGS + next_rand(&rng) % (OPTIONS - FLAGS)];
+
+    switch (next_rand(&rng) % 5) {
+      case 0: {
+        const int cluster = 1 + next_rand(&rng) % 4;
+        buffer[0] = '-';
+        for (int c = 0; c < cluster; c++)
+          buffer[1 + c] = 'a' + next_rand(&rng) % FLAGS;
+        buffer[1 + cluster] = '\0';
+        state->args[ac++] = strdup(buffer);
+        break;
+      }
+      case 1: {
+        char value[32];
+        snprintf(buffer, sizeof(buffer), "--%s=%s", option->long_name, bench_value(option, &rng, value));
+        state->args[ac++] = strdup(buffer);
+        break;
+      }
+      case 2:
+        if ((unsigned long)ac + 2 > num)
+          continue;
+        snprintf(buffer, sizeof(buffer), "--%s", option->long_name);
+        state->args[ac++] = strdup(buffer);
+        state->args[ac++] = strdup(bench_value(option, &rng, buffer));
+        break;
+      case 3:
+        if (!option->short_name || (unsigned long)ac + 2 > num)
+          continue;
+        snprintf(buffer, sizeof(buffer), "-%c", option->short_name);
+        state->args[ac++] = strdup(buffer);
+        state->args[ac++] = strdup(bench_value(option, &rng, buffer));
+        break;
+      default:
+        snprintf(buffer, sizeof(buffer), "input-%d.txt", ac);
+        state->args[ac++] = strdup(buffer);
+        break;
+    }
+  }
+
+  state->ac = ac;
+}
+
+/* Conversions of `args_parse()' for the values getopt_long() returns */
+static void bench_store(const args_option* option, const char* value) {
+  switch (option->type) {
+    case ARGS_FLAG:
+      *(bool*)option->value = true;
+      break;
+    case ARGS_INT:
+      *(long*)option->value = strtol(value, NULL, 0);
+      break;
+    case ARGS_FLOAT:
+      *(double*)option->value = strtod(value, NULL);
+      break;
+    case ARGS_STRING:
+      *(const char**)option->value = value;
+      break;
+    case ARGS_ENUM:
+      for (unsigned int c = 0; option->choices[c]; c++)
+        if (!strcmp(option->choices[c], value))
+          *(unsigned int*)option->value = c;
+      break;
+  }
+}
+
+static time_test bench_args(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  memcpy(state->av, state->args, state->ac * sizeof(*state->av));
+
+  time_test test = time_test_start("args_parse");
+  const args_result result = args_parse(&state->parser, state->ac, state->av);
+  time_clobber_memory();
+  time_test_end(&test);
+
+  test.ops = state->ac - 1;
+  test.state = (result.error == ARGS_OK ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_getopt(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  memcpy(state->av, state->args, state->ac * sizeof(*state->av));
+
+  bool failed = false;
+
+  time_test test = time_test_start("getopt_long");
+  optind = 0; /* Reinitialize getopt */
+  opterr = 0;
+
+  int c;
+  while ((c = getopt_long(state->ac, (char* const*)state->av, state->short_options, state->long_options, NULL)) != -1) {
+    if (c == '?') {
+      failed = true;
+      break;
+    }
+
+    const int option = (c >= 256 ? c - 256 : state->short_index[c]);
+    bench_store(&state->options[option], optarg);
+  }
+  time_clobber_memory();
+  time_test_end(&test);
+
+  test.ops = state->ac - 1;
+  test.state = (failed ? TEST_FAILURE : TEST_SUCCESS);
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long num = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_ARGS);
+
+  static bench_state state;
+  bench_options(&state);
+  bench_generate(&state, num);
+
+  /* Parsing an argument is short, time the whole command line and report per argument */
+  time_test (*const funcs[])(unsigned int, void*) = { bench_args, bench_getopt };
+  const char* const captions[] = { "args_parse", "getopt_long" };
+  time_testrun_results results[2];
+
+  for (int r = 0; r < 2; r++) {
+    char caption[64];
+    snprintf(caption, sizeof(caption), "%s (%d arguments)", captions[r], state.ac - 1);
+
+    time_testrun_template run = time_testrun_new(caption, tests, funcs[r], &state, TESTRUN_ENABLE_ALL);
+    time_testrun_set_warmup(&run, 4);
+    time_testrun_set_memory(&run, true);
+
+    results[r] = time_testrun_run(&run);
+    time_testrun_print(&results[r]);
+  }
+
+  const int status = bench_report(results, 2);
+
+  for (int r = 0; r < 2; r++)
+    time_testrun_cleanup(&results[r]);
+  for (int a = 1; a < state.ac; a++)
+    free((void*)state.args[a]);
+  free(state.args);
+  free(state.av);
+
+  return status;
+}
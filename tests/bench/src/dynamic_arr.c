@@ -0,0 +1,478 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "report.h"
+
+#define DEFAULT_TESTS   16UL
+#define DEFAULT_MAX_NUM 100000000UL
+
+/* Largest array measured, in bytes */
+#define MEMORY_BUDGET (512UL << 20)
+/* Operations per test for operations independent of the array size */
+#define MAX_OPS 1024UL
+/* Elements moved per test by operations linear in the array size */
+#define LINEAR_WORK (1UL << 20)
+/* Sizes of the complexity sweep */
+#define COMPLEXITY_MIN     1024UL
+#define COMPLEXITY_MAX     (1UL << 20)
+#define COMPLEXITY_FACTOR  4.0
+#define COMPLEXITY_ELEMENT 8
+/* Largest element measured */
+#define MAX_ELEMENT 256
+
+/* How an operation changes the size of the array, undone after every test */
+enum op_effect {
+  KEEPS,
+  GROWS,
+  SHRINKS,
+};
+
+/* A plain array grown with realloc(), the baseline */
+typedef struct {
+  uint8_t* data;
+  unsigned long num;
+  unsigned long cap;
+  unsigned long size;
+} raw_arr;
+
+typedef struct {
+  dynamic_arr arr;
+  raw_arr raw;
+
+  unsigned long num; /* Size of the array before every test */
+  unsigned long ops; /* Operations per test */
+  unsigned int size; /* Size of the elements */
+  uint64_t rng;
+
+  uint8_t* scratch; /* Room for `ops' elements */
+} bench_state;
+
+typedef struct {
+  const char* name;
+  enum op_effect effect;
+  bool linear; /* Cost grows with the size of the array */
+  bool single; /* Measured once per test */
+  bool baseline;
+  void (*prepare)(bench_state* state); /* Untimed, before every test */
+  void (*run)(bench_state* state);
+} bench_op;
+
+typedef struct {
+  bench_state* state;
+  const bench_op* op;
+} bench_ctx;
+
+static uint64_t next_rand(uint64_t* rng) {
+  *rng ^= *rng << 13;
+  *rng ^= *rng >> 7;
+  *rng ^= *rng << 17;
+
+  return *rng;
+}
+
+/* ===== Baseline ===== */
+static void raw_reserve(raw_arr* self, unsigned long num) {
+  if (num <= self->cap)
+    return;
+
+  while (self->cap < num)
+    self->cap = (self->cap ? self->cap << 1 : 1);
+
+  self->data = realloc(self->data, self->cap * self->size);
+  if (!self->data) {
+    err("failed to grow baseline array to %lu elements", self->cap);
+    exit(1);
+  }
+}
+
+static void raw_insert(raw_arr* self, unsigned long index, const void* element) {
+  raw_reserve(self, self->num + 1);
+  memmove(self->data + (index + 1) * self->size, self->data + index * self->size, (self->num - index) * self->size);
+  memcpy(self->data + index * self->size, element, self->size);
+  self->num++;
+}
+
+static void raw_remove(raw_arr* self, unsigned long index, void* out) {
+  memcpy(out, self->data + index * self->size, self->size);
+  memmove(self->data + index * self->size, self->data + (index + 1) * self->size, (self->num - index - 1) * self->size);
+  self->num--;
+}
+
+static void op_raw_append(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    raw_insert(&s->raw, s->raw.num, s->scratch);
+}
+
+static void op_raw_prepend(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    raw_insert(&s->raw, 0, s->scratch);
+}
+
+static void op_raw_insert_at(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    raw_insert(&s->raw, s->raw.num >> 1, s->scratch);
+}
+
+static void op_raw_remove_at(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    raw_remove(&s->raw, s->raw.num >> 1, s->scratch);
+}
+
+static void op_raw_truncate(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    raw_remove(&s->raw, s->raw.num - 1, s->scratch);
+}
+
+static void op_raw_peek(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    memcpy(s->scratch, s->raw.data + next_rand(&s->rng) % s->raw.num * s->size, s->size);
+  time_clobber_memory();
+}
+
+/* ===== dynamic_arr ===== */
+static void op_append(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_append(&s->arr, s->scratch);
+}
+
+static void op_bulk_append(bench_state* s) {
+  dynamic_arr_bulk_append(&s->arr, s->scratch, s->ops);
+}
+
+static void op_prepend(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_prepend(&s->arr, s->scratch);
+}
+
+static void op_bulk_prepend(bench_state* s) {
+  dynamic_arr_bulk_prepend(&s->arr, s->scratch, s->ops);
+}
+
+static void op_insert_at(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_insert_at(&s->arr, s->arr.num >> 1, s->scratch);
+}
+
+static void op_bulk_insert_at(bench_state* s) {
+  dynamic_arr_bulk_insert_at(&s->arr, s->arr.num >> 1, s->scratch, s->ops);
+}
+
+static void op_truncate(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_truncate(&s->arr, s->scratch);
+}
+
+static void op_precate(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_precate(&s->arr, s->scratch);
+}
+
+static void op_quick_precate(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_quick_precate(&s->arr, s->scratch);
+}
+
+static void op_remove_at(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_remove_at(&s->arr, s->arr.num >> 1, s->scratch);
+}
+
+static void op_quick_remove_at(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_quick_remove_at(&s->arr, s->arr.num >> 1, s->scratch);
+}
+
+static void op_bulk_remove_at(bench_state* s) {
+  dynamic_arr_bulk_remove_at(&s->arr, (s->arr.num - s->ops) >> 1, s->scratch, s->ops);
+}
+
+static void op_peek(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_peek(&s->arr, next_rand(&s->rng) % s->arr.num, s->scratch);
+  time_clobber_memory();
+}
+
+static void op_bulk_peek(bench_state* s) {
+  dynamic_arr_bulk_peek(&s->arr, (s->arr.num - s->ops) >> 1, s->scratch, s->ops);
+  time_clobber_memory();
+}
+
+static void op_replace(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_replace(&s->arr, next_rand(&s->rng) % s->arr.num, s->scratch);
+}
+
+static void op_bulk_replace(bench_state* s) {
+  dynamic_arr_bulk_replace(&s->arr, (s->arr.num - s->ops) >> 1, s->scratch, s->ops);
+}
+
+static void op_set(bench_state* s) {
+  dynamic_arr_set(&s->arr, (s->arr.num - s->ops) >> 1, s->scratch, s->ops);
+}
+
+static void op_flip(bench_state* s) {
+  for (unsigned long i = 0; i < s->ops; i++)
+    dynamic_arr_flip(&s->arr, next_rand(&s->rng) % s->arr.num, next_rand(&s->rng) % s->arr.num);
+}
+
+static void op_bulk_flip(bench_state* s) {
+  dynamic_arr_bulk_flip(&s->arr, 0, s->arr.num - s->ops, s->ops);
+}
+
+static void op_copy(bench_state* s) {
+  dynamic_arr copy = dynamic_arr_copy(&s->arr);
+  time_do_not_optimize(dynamic_arr_get_start(&copy));
+  dynamic_arr_cleanup(&copy);
+}
+
+static void prepare_trim(bench_state* s) {
+  dynamic_arr_reserve(&s->arr, s->arr.num);
+}
+
+static void op_trim(bench_state* s) {
+  dynamic_arr_trim(&s->arr);
+}
+
+static const bench_op ops[] = {
+  { "append", GROWS, false, false, false, NULL, op_append },
+  { "bulk_append", GROWS, false, false, false, NULL, op_bulk_append },
+  { "prepend", GROWS, true, false, false, NULL, op_prepend },
+  { "bulk_prepend", GROWS, false, false, false, NULL, op_bulk_prepend },
+  { "insert_at", GROWS, true, false, false, NULL, op_insert_at },
+  { "bulk_insert_at", GROWS, false, false, false, NULL, op_bulk_insert_at },
+  { "truncate", SHRINKS, false, false, false, NULL, op_truncate },
+  { "precate", SHRINKS, true, false, false, NULL, op_precate },
+  { "quick_precate", SHRINKS, false, false, false, NULL, op_quick_precate },
+  { "remove_at", SHRINKS, true, false, false, NULL, op_remove_at },
+  { "quick_remove_at", SHRINKS, true, false, false, NULL, op_quick_remove_at },
+  { "bulk_remove_at", SHRINKS, false, false, false, NULL, op_bulk_remove_at },
+  { "peek", KEEPS, false, false, false, NULL, op_peek },
+  { "bulk_peek", KEEPS, false, false, false, NULL, op_bulk_peek },
+  { "replace", KEEPS, false, false, false, NULL, op_replace },
+  { "bulk_replace", KEEPS, false, false, false, NULL, op_bulk_replace },
+  { "set", KEEPS, false, false, false, NULL, op_set },
+  { "flip", KEEPS, false, false, false, NULL, op_flip },
+  { "bulk_flip", KEEPS, false, false, false, NULL, op_bulk_flip },
+  { "copy", KEEPS, true, true, false, NULL, op_copy },
+  { "trim", KEEPS, true, true, false, prepare_trim, op_trim },
+
+  { "append", GROWS, false, false, true, NULL, op_raw_append },
+  { "prepend", GROWS, true, false, true, NULL, op_raw_prepend },
+  { "insert_at", GROWS, true, false, true, NULL, op_raw_insert_at },
+  { "truncate", SHRINKS, false, false, true, NULL, op_raw_truncate },
+  { "remove_at", SHRINKS, true, false, true, NULL, op_raw_remove_at },
+  { "peek", KEEPS, false, false, true, NULL, op_raw_peek },
+};
+
+/* Bring the array back to its size before the test */
+static void restore(bench_state* s, const bench_op* op) {
+  if (op->baseline) {
+    s->raw.num = s->num;
+    return;
+  }
+
+  /* Dropped from the end, so the capacity stays and the next test doesn't start with a reallocation */
+  if (op->effect == GROWS)
+    dynamic_arr_bulk_remove_at(&s->arr, s->num, NULL, s->arr.num - s->num);
+  while (op->effect == SHRINKS && s->arr.num < s->num)
+    dynamic_arr_bulk_append(&s->arr, s->scratch, s->num - s->arr.num < s->ops ? s->num - s->arr.num : s->ops);
+}
+
+static time_test bench_run(unsigned int index, void* data) {
+  (void)index;
+  const bench_ctx* ctx = data;
+  bench_state* s = ctx->state;
+
+  if (ctx->op->prepare)
+    ctx->op->prepare(s);
+
+  time_test test = time_test_start(ctx->op->name);
+  ctx->op->run(s);
+  time_test_end(&test);
+
+  test.ops = (ctx->op->single ? 1 : s->ops);
+  test.state = (ctx->op->baseline || s->arr.num == s->num
+      + (ctx->op->effect == GROWS ? test.ops : 0) - (ctx->op->effect == SHRINKS ? test.ops : 0)
+      ? TEST_SUCCESS : TEST_FAILURE);
+
+  restore(s, ctx->op);
+
+  return test;
+}
+
+/* Linear operations get fewer repetitions on larger arrays, without growing it by much; removals can't outnumber the elements */
+static unsigned long bench_ops(const bench_op* op, unsigned long num) {
+  unsigned long ops = MAX_OPS;
+  if (op->linear) {
+    ops = LINEAR_WORK / num;
+    ops = (ops > num / 8 ? num / 8 : ops);
+  }
+  if (op->effect != GROWS && ops > num / 2)
+    ops = num / 2;
+
+  return (ops < 1 ? 1 : (ops > MAX_OPS ? MAX_OPS : ops));
+}
+
+static void fill(bench_state* s) {
+  s->ops = MAX_OPS;
+  memset(s->scratch, 0xa5, MAX_OPS * s->size);
+
+  s->arr = __intern_dynamic_generic_arr_new(s->size);
+  dynamic_arr_reserve(&s->arr, s->num);
+  for (unsigned long i = 0; i < s->num; i += s->ops)
+    dynamic_arr_bulk_append(&s->arr, s->scratch, (s->num - i < s->ops ? s->num - i : s->ops));
+
+  s->raw = (raw_arr) { .size = s->size };
+  raw_reserve(&s->raw, s->num);
+  memset(s->raw.data, 0xa5, s->num * s->size);
+  s->raw.num = s->num;
+}
+
+/* Rebuilds the arrays at a new size for the complexity sweep */
+static void bench_setup(unsigned long size, void* data) {
+  bench_ctx* ctx = data;
+  bench_state* s = ctx->state;
+
+  dynamic_arr_cleanup(&s->arr);
+  free(s->raw.data);
+
+  s->num = size;
+  fill(s);
+  s->ops = bench_ops(ctx->op, size);
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long max_num = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_MAX_NUM);
+  const char* filter = (ac > 3 ? av[3] : NULL);
+  if (!tests || max_num < 10) {
+    err("usage: %s [tests] [largest array, at least 10] [operation filter]", av[0]);
+    return 1;
+  }
+
+  const unsigned int sizes[] = { 1, 8, 64, MAX_ELEMENT };
+
+  dynamic_arr results = dynamic_arr_new(time_testrun_results);
+  dynamic_arr captions = dynamic_arr_new(char*);
+
+  printf("%-40s %8s %10s %8s %12s %12s %12s %8s\n",
+      "OPERATION", "ELEMENT", "ARRAY", "OPS", "MEDIAN ns", "P99 ns", "OPS/S", "ALLOCS");
+
+  for (unsigned long num = 10; num <= max_num; num *= 10) {
+    for (unsigned long e = 0; e < sizeof(sizes) / sizeof(*sizes); e++) {
+      if (num * sizes[e] > MEMORY_BUDGET)
+        continue;
+
+      bench_state state = {
+        .num = num,
+        .size = sizes[e],
+        .rng = 0x9e3779b97f4a7c15ULL,
+        .ops = MAX_OPS,
+      };
+      state.scratch = malloc(MAX_OPS * MAX_ELEMENT);
+      if (!state.scratch) {
+        err("failed to allocate scratch buffer");
+        return 1;
+      }
+      fill(&state);
+
+      for (unsigned long o = 0; o < sizeof(ops) / sizeof(*ops); o++) {
+        const bench_op* op = &ops[o];
+        if (filter && !strstr(op->name, filter))
+          continue;
+
+        state.ops = bench_ops(op, num);
+
+        char* caption = malloc(96);
+        snprintf(caption, 96, "%s%s (%u B x %lu)", (op->baseline ? "realloc array: " : ""), op->name, state.size, num);
+        dynamic_arr_append(&captions, &caption);
+
+        bench_ctx ctx = { .state = &state, .op = op };
+        time_testrun_template run = time_testrun_new(caption, tests, bench_run, &ctx, TESTRUN_ENABLE_ALL);
+        time_testrun_set_clock(&run, TIME_CLOCK_TSC);
+        time_testrun_set_warmup(&run, 2);
+        time_testrun_set_bytes(&run, state.size);
+        time_testrun_set_memory(&run, !op->baseline);
+
+        const time_testrun_results r = time_testrun_run(&run);
+        dynamic_arr_append(&results, &r);
+
+        char allocs[24] = "-";
+        if (r.memory.enabled)
+          snprintf(allocs, sizeof(allocs), "%" PRIu64, r.memory.allocs.mallocs + r.memory.allocs.reallocs);
+
+        printf("%s%-*s %8u %10lu %8lu %12.2f %12.2f %12.3e %8s%s\n",
+            (op->baseline ? "realloc array: " : ""), (op->baseline ? 25 : 40), op->name,
+            state.size, num, (op->single ? 1 : state.ops),
+            r.stats.median, r.stats.p99, r.ops_per_sec, allocs,
+            (r.failure ? " FAILED" : ""));
+        fflush(stdout);
+      }
+
+      dynamic_arr_cleanup(&state.arr);
+      free(state.raw.data);
+      free(state.scratch);
+    }
+  }
+
+  /* How the cost of every operation grows with the size of the array */
+  dynamic_arr sweep = time_testrun_sizes(COMPLEXITY_MIN, (max_num < COMPLEXITY_MAX ? max_num : COMPLEXITY_MAX), COMPLEXITY_FACTOR);
+  for (unsigned long o = 0; sweep.num > 1 && o < sizeof(ops) / sizeof(*ops); o++) {
+    const bench_op* op = &ops[o];
+    if (filter && !strstr(op->name, filter))
+      continue;
+
+    bench_state state = {
+      .size = COMPLEXITY_ELEMENT,
+      .rng = 0x9e3779b97f4a7c15ULL,
+    };
+    state.scratch = malloc(MAX_OPS * MAX_ELEMENT);
+    if (!state.scratch) {
+      err("failed to allocate scratch buffer");
+      return 1;
+    }
+
+    char* caption = malloc(96);
+    snprintf(caption, 96, "%s%s (%u B)", (op->baseline ? "realloc array: " : ""), op->name, state.size);
+    dynamic_arr_append(&captions, &caption);
+
+    bench_ctx ctx = { .state = &state, .op = op };
+    time_testrun_template run = time_testrun_new(caption, tests, bench_run, &ctx, TESTRUN_ENABLE_ALL);
+    time_testrun_set_clock(&run, TIME_CLOCK_TSC);
+    time_testrun_set_warmup(&run, 2);
+
+    time_complexity_results complexity = time_testrun_complexity(&run, dynamic_arr_get_start(&sweep), sweep.num, bench_setup);
+    time_testrun_print_complexity(&complexity);
+
+    /* The results of every size are reported with the rest */
+    dynamic_arr_bulk_append(&results, dynamic_arr_get_start(&complexity.results), complexity.results.num);
+    dynamic_arr_cleanup(&complexity.results);
+
+    dynamic_arr_cleanup(&state.arr);
+    free(state.raw.data);
+    free(state.scratch);
+  }
+  dynamic_arr_cleanup(&sweep);
+
+  time_testrun_results* all = dynamic_arr_get_start(&results);
+  const int status = bench_report(all, results.num);
+
+  for (unsigned long r = 0; r < results.num; r++)
+    time_testrun_cleanup(&all[r]);
+  char** strings = dynamic_arr_get_start(&captions);
+  for (unsigned long c = 0; c < captions.num; c++)
+    free(strings[c]);
+  dynamic_arr_cleanup(&results);
+  dynamic_arr_cleanup(&captions);
+
+  return status;
+}
@@ -0,0 +1,196 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/flat/set.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_TESTS 256UL
+#define SIZES         4
+#define RUNS          2
+#define MAX_THREADS   64
+
+/* Open addressing hash set with linear probing, the alternative to a flat set */
+typedef struct {
+  uint64_t* slots;
+  unsigned long mask;
+} hash_set;
+
+/* State of every thread, on its own cache line */
+typedef struct {
+  uint64_t rng;
+  volatile unsigned long found;
+  char pad[48];
+} bench_thread;
+
+typedef struct {
+  unsigned long num;
+  const uint64_t* keys; /* Inserted keys, half of the lookups hit */
+  flat_set set;
+  hash_set hash;
+  bench_thread threads[MAX_THREADS];
+} bench_state;
+
+static uint64_t next_rand(uint64_t* rng) {
+  *rng ^= *rng << 13;
+  *rng ^= *rng >> 7;
+  *rng ^= *rng << 17;
+
+  return *rng;
+}
+
+static int cmp_u64(const void* a, const void* b) {
+  const uint64_t x = *(const uint64_t*)a;
+  const uint64_t y = *(const uint64_t*)b;
+
+  return (x > y) - (x < y);
+}
+
+static uint64_t hash_u64(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+
+  return x;
+}
+
+static void hash_set_insert(hash_set* self, uint64_t key) {
+  unsigned long i = hash_u64(key) & self->mask;
+  while (self->slots[i] && self->slots[i] != key)
+    i = (i + 1) & self->mask;
+
+  self->slots[i] = key;
+}
+
+static int hash_set_contains(const hash_set* self, uint64_t key) {
+  unsigned long i = hash_u64(key) & self->mask;
+  while (self->slots[i]) {
+    if (self->slots[i] == key)
+      return 1;
+    i = (i + 1) & self->mask;
+  }
+
+  return 0;
+}
+
+static uint64_t next_key(bench_state* state, bench_thread* thread) {
+  const uint64_t r = next_rand(&thread->rng);
+
+  return (r & 1 ? state->keys[(r >> 1) % state->num] : (r | 1));
+}
+
+static enum TIMETEST_STATE bench_flat(unsigned long iterations, void* data) {
+  bench_state* state = data;
+  bench_thread* thread = &state->threads[time_testrun_thread()];
+  unsigned long found = 0;
+
+  for (unsigned long i = 0; i < iterations; i++) {
+    const uint64_t key = next_key(state, thread);
+    found += flat_set_find(&state->set, &key, NULL);
+  }
+
+  thread->found += found;
+
+  return TEST_SUCCESS;
+}
+
+static enum TIMETEST_STATE bench_hash(unsigned long iterations, void* data) {
+  bench_state* state = data;
+  bench_thread* thread = &state->threads[time_testrun_thread()];
+  unsigned long found = 0;
+
+  for (unsigned long i = 0; i < iterations; i++)
+    found += hash_set_contains(&state->hash, next_key(state, thread));
+
+  thread->found += found;
+
+  return TEST_SUCCESS;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long sweep = (ac > 2 ? strtoul(av[2], NULL, 0) : 0);
+  if (sweep > MAX_THREADS) {
+    err("usage: %s [tests] [threads to sweep, up to %d]", av[0], MAX_THREADS);
+    return 1;
+  }
+
+  const unsigned long sizes[SIZES] = { 64, 4096, 262144, 4194304 };
+  char captions[SIZES][RUNS][64];
+  time_testrun_results results[SIZES][RUNS];
+
+  for (unsigned long s = 0; s < SIZES; s++) {
+    static bench_state state;
+    state = (bench_state) { .num = sizes[s] };
+    for (unsigned long t = 0; t < MAX_THREADS; t++)
+      state.threads[t].rng = 0x9e3779b97f4a7c15ULL * (t + 1);
+
+    /* Even keys only, odd lookups always miss */
+    dynamic_arr keys = dynamic_arr_new(uint64_t);
+    for (unsigned long i = 0; i < state.num; i++) {
+      const uint64_t key = (next_rand(&state.threads[0].rng) | 2) & ~1ULL;
+      dynamic_arr_append(&keys, &key);
+    }
+    state.keys = dynamic_arr_get_start(&keys);
+
+    dynamic_arr set_keys = dynamic_arr_copy(&keys);
+    state.set = flat_set_from_arr(&set_keys, cmp_u64);
+
+    state.hash.mask = 1;
+    while (state.hash.mask < state.num * 2)
+      state.hash.mask <<= 1;
+    state.hash.slots = calloc(state.hash.mask, sizeof(uint64_t));
+    if (!state.hash.slots) {
+      err("failed to allocate hash set of %lu slots", state.hash.mask);
+      return 1;
+    }
+    state.hash.mask--;
+    for (unsigned long i = 0; i < state.num; i++)
+      hash_set_insert(&state.hash, state.keys[i]);
+
+    snprintf(captions[s][0], sizeof(captions[s][0]), "flat_set_find (%lu keys)", state.num);
+    snprintf(captions[s][1], sizeof(captions[s][1]), "hash set lookup (%lu keys)", state.num);
+
+    const time_testrun_template runs[RUNS] = {
+      time_testrun_new_batched(captions[s][0], tests, bench_flat, &state, TESTRUN_ENABLE_ALL),
+      time_testrun_new_batched(captions[s][1], tests, bench_hash, &state, TESTRUN_ENABLE_ALL),
+    };
+
+    for (unsigned long r = 0; r < RUNS; r++) {
+      results[s][r] = time_testrun_run(&runs[r]);
+      time_testrun_print(&results[s][r]);
+    }
+
+    /* Lookups are read-only, so they should scale until memory bandwidth runs out */
+    for (unsigned long r = 0; sweep && r < RUNS; r++) {
+      time_testrun_template run = runs[r];
+      time_testrun_set_threads(&run, 1, true);
+
+      dynamic_arr scaling = time_testrun_sweep(&run, sweep);
+      time_testrun_results* scaled = dynamic_arr_get_start(&scaling);
+      time_testrun_print_scaling(scaled, scaling.num);
+
+      for (unsigned long t = 0; t < scaling.num; t++)
+        time_testrun_cleanup(&scaled[t]);
+      dynamic_arr_cleanup(&scaling);
+    }
+
+    free(state.hash.slots);
+    flat_set_cleanup(&state.set);
+    dynamic_arr_cleanup(&keys);
+  }
+
+  const int status = bench_report(&results[0][0], SIZES * RUNS);
+
+  for (unsigned long s = 0; s < SIZES; s++)
+    for (unsigned long r = 0; r < RUNS; r++)
+      time_testrun_cleanup(&results[s][r]);
+
+  return status;
+}
@@ -0,0 +1,125 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/memory/kernels.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_TESTS 64UL
+#define DEFAULT_BYTES (64UL * 1024)
+#define KERNELS       4
+
+typedef struct {
+  unsigned long bytes;
+  char* a;
+  char* b;
+  unsigned long found;
+} bench_state;
+
+static time_test bench_fill(unsigned int index, void* data) {
+  bench_state* state = data;
+  const uint32_t pattern = index;
+
+  time_test test = time_test_start("kernel_fill");
+  kernel_fill(state->a, &pattern, sizeof(pattern), state->bytes / sizeof(pattern));
+  time_test_end(&test);
+
+  test.state = (!memcmp(state->a + state->bytes - sizeof(pattern), &pattern, sizeof(pattern)) ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_swap(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+
+  time_test test = time_test_start("kernel_swap");
+  kernel_swap(state->a, state->b, state->bytes);
+  time_test_end(&test);
+
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+static time_test bench_find(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+
+  /* The text only has letters, so the whole of it is scanned */
+  time_test test = time_test_start("kernel_find");
+  const char* found = kernel_find(state->b, state->b + state->bytes, '\n', ',');
+  time_test_end(&test);
+
+  test.state = (found == state->b + state->bytes ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_count(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+
+  time_test test = time_test_start("kernel_count");
+  const unsigned long count = kernel_count(state->b, state->b + state->bytes, 'a', 'e');
+  time_test_end(&test);
+
+  test.state = (count == state->found ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long bytes = (ac > 2 ? strtoul(av[2], NULL, 0) & ~3UL : DEFAULT_BYTES);
+
+  bench_state state = { bytes, malloc(bytes), malloc(bytes), 0 };
+  for (unsigned long i = 0; i < bytes; i++) {
+    state.a[i] = 'a' + i % 26;
+    state.b[i] = 'a' + (i * 7) % 26;
+    state.found += (state.b[i] == 'a' || state.b[i] == 'e');
+  }
+
+  const enum kernel_isa supported = kernel_isa_supported();
+  const enum kernel_isa selected = kernel_isa_selected();
+  info("kernels up to %s, %s selected", kernel_isa_str(supported), kernel_isa_str(selected));
+
+  time_test (*const funcs[KERNELS])(unsigned int, void*) = { bench_fill, bench_swap, bench_find, bench_count };
+  const char* const names[KERNELS] = { "kernel_fill", "kernel_swap", "kernel_find", "kernel_count" };
+  char captions[KERNEL_ISAS][KERNELS][64];
+  time_testrun_results results[KERNEL_ISAS * KERNELS];
+  unsigned long num = 0;
+
+  /* Every kernel on every supported variant */
+  for (unsigned int isa = 0; isa <= supported; isa++) {
+    kernel_isa_select(isa);
+
+    for (int k = 0; k < KERNELS; k++) {
+      snprintf(captions[isa][k], sizeof(captions[isa][k]), "%s (%s)", names[k], kernel_isa_str(isa));
+
+      time_testrun_template run = time_testrun_new(captions[isa][k], tests, funcs[k], &state, TESTRUN_ENABLE_ALL);
+      time_testrun_set_warmup(&run, 4);
+      time_testrun_set_bytes(&run, bytes);
+
+      results[num] = time_testrun_run(&run);
+      time_testrun_print(&results[num++]);
+    }
+  }
+  kernel_isa_select(selected);
+
+  const int status = bench_report(results, num);
+
+  for (unsigned long r = 0; r < num; r++)
+    time_testrun_cleanup(&results[r]);
+  free(state.a);
+  free(state.b);
+
+  return status;
+}
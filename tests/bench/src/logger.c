@@ -0,0 +1,147 @@
+#define _GNU_SOURCE
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/logging/logger.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_TESTS    32UL
+#define DEFAULT_MESSAGES 10000UL
+#define MAX_THREADS      8
+
+typedef struct {
+  FILE* sink; /* /dev/null */
+  unsigned long messages;
+} bench_state;
+
+/* How util.h logged before: three stdio calls on a shared FILE per message */
+static void bench_stdio_log(FILE* file, const char* prefix, const char* fmt, ...) {
+  va_list argp;
+
+  va_start(argp, fmt);
+
+  fprintf(file, "%s: %s ", "logger", prefix);
+  vfprintf(file, fmt, argp);
+  fputs("\n", file);
+
+  va_end(argp);
+}
+
+static time_test bench_stdio(unsigned int index, void* data) {
+  bench_state* state = data;
+  const unsigned int thread = time_testrun_thread();
+
+  time_test test = time_test_start("stdio");
+  for (unsigned long m = 0; m < state->messages; m++)
+    bench_stdio_log(state->sink, "[INFO]", "thread %u test %u message %lu of %s: %.3f", thread, index, m, "bench", m * 0.25);
+  time_test_end(&test);
+
+  test.ops = state->messages;
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+static time_test bench_logger(unsigned int index, void* data) {
+  bench_state* state = data;
+  const unsigned int thread = time_testrun_thread();
+
+  time_test test = time_test_start("logger");
+  for (unsigned long m = 0; m < state->messages; m++)
+    logger_log_to(LOGGER_INFO, state->sink, "[INFO]", "thread %u test %u message %lu of %s: %.3f", thread, index, m, "bench", m * 0.25);
+  time_test_end(&test);
+
+  test.ops = state->messages;
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+/* Filtered at runtime, only the level check is left */
+static time_test bench_filtered(unsigned int index, void* data) {
+  bench_state* state = data;
+
+  time_test test = time_test_start("filtered");
+  for (unsigned long m = 0; m < state->messages; m++)
+    logger_log_to(LOGGER_DEBUG, state->sink, "[DEBUG]", "test %u message %lu", index, m);
+  time_test_end(&test);
+
+  test.ops = state->messages;
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long messages = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_MESSAGES);
+
+  bench_state state = { fopen("/dev/null", "w"), messages };
+  if (!state.sink) {
+    err("failed to open /dev/null: %s", strerror(errno));
+    return 1;
+  }
+
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  const unsigned int max_threads = (cpus > MAX_THREADS ? MAX_THREADS : (cpus > 0 ? cpus : 1));
+
+  enum { RUN_STDIO, RUN_SYNC, RUN_DROP, RUN_BLOCK, RUN_FILTERED, RUNS };
+  const char* const captions[RUNS] = { "stdio (3 calls)", "logger (not started)", "logger (drop)", "logger (block)", "logger (filtered)" };
+  time_test (*const funcs[RUNS])(unsigned int, void*) = { bench_stdio, bench_logger, bench_logger, bench_logger, bench_filtered };
+  time_testrun_results results[RUNS];
+
+  for (int r = 0; r < RUNS; r++) {
+    if (r == RUN_DROP || r == RUN_BLOCK) {
+      if (!logger_start((r == RUN_DROP ? LOGGER_DROP : LOGGER_BLOCK), 0)) {
+        err("failed to start the logger: %s", strerror(errno));
+        return 1;
+      }
+    }
+    if (r == RUN_FILTERED)
+      logger_set_level(LOGGER_INFO);
+
+    time_testrun_template run = time_testrun_new(captions[r], tests, funcs[r], &state, TESTRUN_ENABLE_ALL);
+    time_testrun_set_warmup(&run, 2);
+
+    results[r] = time_testrun_run(&run);
+
+    /* Contention on the FILE lock against per-thread rings */
+    if (max_threads > 1 && r != RUN_FILTERED) {
+      time_testrun_set_threads(&run, 1, false);
+
+      dynamic_arr scaling = time_testrun_sweep(&run, max_threads);
+      time_testrun_results* scaled = dynamic_arr_get_start(&scaling);
+      time_testrun_print_scaling(scaled, scaling.num);
+
+      for (unsigned long t = 0; t < scaling.num; t++)
+        time_testrun_cleanup(&scaled[t]);
+      dynamic_arr_cleanup(&scaling);
+    }
+
+    if (r == RUN_DROP || r == RUN_BLOCK)
+      logger_stop();
+    time_testrun_print(&results[r]);
+  }
+  logger_set_level(LOGGER_DEBUG);
+
+  if (logger_dropped())
+    info("%lu records were dropped", logger_dropped());
+
+  const int status = bench_report(results, RUNS);
+
+  for (int r = 0; r < RUNS; r++)
+    time_testrun_cleanup(&results[r]);
+  fclose(state.sink);
+
+  return status;
+}
@@ -0,0 +1,186 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/parsing/text/numbers.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_TESTS  32UL
+#define DEFAULT_FIELDS 1000000UL
+#define ROW            10
+
+typedef struct {
+  text_span integers; /* Rows of ROW comma separated integers */
+  text_span reals; /* Rows of ROW comma separated decimals like "-1234.567" */
+  unsigned long fields;
+
+  dynamic_arr i64;
+  dynamic_arr f64;
+} bench_state;
+
+static uint64_t next_rand(uint64_t* rng) {
+  *rng ^= *rng << 13;
+  *rng ^= *rng >> 7;
+  *rng ^= *rng << 17;
+
+  return *rng;
+}
+
+static text_span bench_generate(unsigned long fields, bool reals) {
+  uint64_t rng = 0x9e3779b97f4a7c15ULL;
+  char* text = malloc(fields * 24 + 1);
+  unsigned long len = 0;
+
+  for (unsigned long f = 0; f < fields; f++) {
+    const uint64_t r = next_rand(&rng);
+    const char sep = ((f + 1) % ROW ? ',' : '\n');
+
+    /* Mostly short numbers with the occasional large one, like real columns */
+    if (reals)
+      len += sprintf(text + len, "%s%lu.%03lu%c", (r & 1 ? "-" : ""), (unsigned long)(r >> 8) % (r & 0x10 ? 10000000 : 10000), (unsigned long)(r >> 40) % 1000, sep);
+    else
+      len += sprintf(text + len, "%ld%c", (long)((r >> 8) % (r & 0x10 ? 10000000000ULL : 100000)) * (r & 1 ? -1 : 1), sep);
+  }
+
+  return (text_span) { text, len, false };
+}
+
+static time_test bench_strtol(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  state->i64.num = 0;
+
+  const char* p = state->integers.start;
+  const char* end = p + state->integers.len;
+
+  time_test test = time_test_start("strtol");
+  while (p < end) {
+    char* next;
+    const int64_t value = strtol(p, &next, 10);
+    dynamic_arr_append(&state->i64, &value);
+    p = next + 1;
+  }
+  time_test_end(&test);
+
+  test.ops = state->fields;
+  test.state = (state->i64.num == state->fields ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_i64(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  state->i64.num = 0;
+
+  time_test test = time_test_start("number_parse_i64_arr");
+  const unsigned long num = number_parse_i64_arr(&state->integers, ',', &state->i64, NULL);
+  time_test_end(&test);
+
+  test.ops = state->fields;
+  test.state = (num == state->fields ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_strtod(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  state->f64.num = 0;
+
+  const char* p = state->reals.start;
+  const char* end = p + state->reals.len;
+
+  time_test test = time_test_start("strtod");
+  while (p < end) {
+    char* next;
+    const double value = strtod(p, &next);
+    dynamic_arr_append(&state->f64, &value);
+    p = next + 1;
+  }
+  time_test_end(&test);
+
+  test.ops = state->fields;
+  test.state = (state->f64.num == state->fields ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_f64(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  state->f64.num = 0;
+
+  time_test test = time_test_start("number_parse_f64_arr");
+  const unsigned long num = number_parse_f64_arr(&state->reals, ',', &state->f64, NULL);
+  time_test_end(&test);
+
+  test.ops = state->fields;
+  test.state = (num == state->fields ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long fields = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_FIELDS);
+
+  static bench_state state;
+  state.fields = fields;
+  state.integers = bench_generate(fields, false);
+  state.reals = bench_generate(fields, true);
+  state.i64 = dynamic_arr_new(int64_t);
+  state.f64 = dynamic_arr_new(double);
+
+  /* Both ways have to agree on every value */
+  bench_strtol(0, &state);
+  dynamic_arr expected = dynamic_arr_copy(&state.i64);
+  bench_i64(0, &state);
+  if (memcmp(dynamic_arr_get_start(&expected), dynamic_arr_get_start(&state.i64), fields * sizeof(int64_t))) {
+    err("number_parse_i64_arr() disagrees with strtol()");
+    return 1;
+  }
+  dynamic_arr_cleanup(&expected);
+
+  bench_strtod(0, &state);
+  expected = dynamic_arr_copy(&state.f64);
+  bench_f64(0, &state);
+  if (memcmp(dynamic_arr_get_start(&expected), dynamic_arr_get_start(&state.f64), fields * sizeof(double))) {
+    err("number_parse_f64_arr() disagrees with strtod()");
+    return 1;
+  }
+  dynamic_arr_cleanup(&expected);
+
+  time_test (*const funcs[])(unsigned int, void*) = { bench_strtol, bench_i64, bench_strtod, bench_f64 };
+  const char* const captions[] = { "strtol + append", "number_parse_i64_arr", "strtod + append", "number_parse_f64_arr" };
+  const text_span* texts[] = { &state.integers, &state.integers, &state.reals, &state.reals };
+  time_testrun_results results[4];
+
+  for (int r = 0; r < 4; r++) {
+    time_testrun_template run = time_testrun_new(captions[r], tests, funcs[r], &state, TESTRUN_ENABLE_ALL);
+    time_testrun_set_warmup(&run, 2);
+    /* Bytes of text per field */
+    time_testrun_set_bytes(&run, texts[r]->len / fields);
+
+    results[r] = time_testrun_run(&run);
+    time_testrun_print(&results[r]);
+  }
+
+  const int status = bench_report(results, 4);
+
+  for (int r = 0; r < 4; r++)
+    time_testrun_cleanup(&results[r]);
+  dynamic_arr_cleanup(&state.i64);
+  dynamic_arr_cleanup(&state.f64);
+  free((void*)state.integers.start);
+  free((void*)state.reals.start);
+
+  return status;
+}
@@ -0,0 +1,186 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/arrays/packed.h>
+#include <blib/memory/kernels.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_TESTS    64UL
+#define DEFAULT_ELEMENTS (64UL * 1024)
+#define LOOKUPS          1024
+#define DATASETS         4
+#define RUNS             (DATASETS * (KERNEL_ISAS + 2))
+
+typedef struct {
+  const char* name;
+  unsigned int element_size;
+  dynamic_arr raw; /* The integers unpacked, what decoding is compared against */
+  packed_arr packed;
+  void* out;
+} bench_dataset;
+
+typedef struct {
+  bench_dataset* dataset;
+  unsigned long elements;
+} bench_state;
+
+static uint64_t bench_random(uint64_t* seed) {
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 7;
+  *seed ^= *seed << 17;
+  return *seed;
+}
+
+/* Sorted ids with small gaps, jittered 32-bit timestamps, random integers and 64-bit timestamps in nanoseconds */
+static void bench_generate(bench_dataset* datasets, unsigned long elements) {
+  uint64_t seed = 0x2545f4914f6cdd1dULL;
+  uint64_t id = 1000, stamp = 1700000000, ns = 1700000000000000000ULL;
+
+  datasets[0] = (bench_dataset) { .name = "sorted ids", .element_size = sizeof(uint32_t), .raw = dynamic_arr_new(uint32_t) };
+  datasets[1] = (bench_dataset) { .name = "timestamps", .element_size = sizeof(uint32_t), .raw = dynamic_arr_new(uint32_t) };
+  datasets[2] = (bench_dataset) { .name = "random", .element_size = sizeof(uint32_t), .raw = dynamic_arr_new(uint32_t) };
+  datasets[3] = (bench_dataset) { .name = "timestamps (ns)", .element_size = sizeof(uint64_t), .raw = dynamic_arr_new(uint64_t) };
+
+  for (unsigned long i = 0; i < elements; i++) {
+    id += 1 + bench_random(&seed) % 8;
+    stamp += (i % 16 == 0) - 2 + bench_random(&seed) % 5;
+    ns += 1000000 + bench_random(&seed) % 4096;
+
+    const uint32_t values[3] = { id, stamp, bench_random(&seed) };
+    for (int d = 0; d < 3; d++)
+      dynamic_arr_append(&datasets[d].raw, &values[d]);
+    dynamic_arr_append(&datasets[3].raw, &ns);
+  }
+
+  for (int d = 0; d < DATASETS; d++) {
+    datasets[d].packed = packed_arr_from_dynamic(&datasets[d].raw);
+    datasets[d].out = malloc(elements * datasets[d].element_size);
+  }
+}
+
+static time_test bench_memcpy(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  bench_dataset* dataset = state->dataset;
+
+  time_test test = time_test_start("memcpy");
+  memcpy(dataset->out, dynamic_arr_get_start(&dataset->raw), state->elements * dataset->element_size);
+  time_test_end(&test);
+
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+static time_test bench_decode(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  bench_dataset* dataset = state->dataset;
+
+  time_test test = time_test_start("packed_arr_bulk_peek");
+  packed_arr_bulk_peek(&dataset->packed, 0, dataset->out, state->elements);
+  time_test_end(&test);
+
+  const bool valid = !memcmp(dataset->out, dynamic_arr_get_start(&dataset->raw), state->elements * dataset->element_size);
+  test.state = (valid ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_peek(unsigned int index, void* data) {
+  bench_state* state = data;
+  bench_dataset* dataset = state->dataset;
+  uint64_t seed = 0x9e3779b97f4a7c15ULL * (index + 1);
+  bool valid = true;
+
+  time_test test = time_test_start("packed_arr_peek");
+  for (int l = 0; l < LOOKUPS; l++) {
+    const unsigned long i = bench_random(&seed) % state->elements;
+    uint64_t value = 0, expected = 0;
+
+    packed_arr_peek(&dataset->packed, i, &value);
+    dynamic_arr_peek(&dataset->raw, i, &expected);
+
+    valid &= (value == expected);
+  }
+  time_test_end(&test);
+
+  test.ops = LOOKUPS;
+  test.state = (valid ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long elements = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_ELEMENTS);
+
+  bench_dataset datasets[DATASETS];
+  bench_generate(datasets, (elements ? elements : 1));
+  bench_state state = { .elements = (elements ? elements : 1) };
+
+  const enum kernel_isa supported = kernel_isa_supported();
+  const enum kernel_isa selected = kernel_isa_selected();
+  info("kernels up to %s, %s selected", kernel_isa_str(supported), kernel_isa_str(selected));
+
+  char captions[RUNS][96];
+  time_testrun_results results[RUNS];
+  unsigned long num = 0;
+
+  for (int d = 0; d < DATASETS; d++) {
+    const unsigned long bytes = state.elements * datasets[d].element_size;
+    const packed_arr_stats stats = packed_arr_stats_get(&datasets[d].packed);
+    state.dataset = &datasets[d];
+
+    info("%s: %lu -> %lu byte(s), ratio %.2f, %lu block(s): %lu frame of reference, %lu delta, %lu raw",
+        datasets[d].name, stats.raw_bytes, stats.bytes, (double)stats.raw_bytes / stats.bytes,
+        stats.blocks, stats.for_blocks, stats.delta_blocks, stats.raw_blocks);
+
+    /* Copying the unpacked integers is the bound decoding is measured against */
+    for (unsigned int isa = 0; isa <= supported + 1; isa++) {
+      const bool baseline = (isa > supported);
+      if (baseline)
+        snprintf(captions[num], sizeof(captions[num]), "memcpy (%s)", datasets[d].name);
+      else
+        snprintf(captions[num], sizeof(captions[num]), "packed_arr_bulk_peek (%s, %s)", datasets[d].name, kernel_isa_str(isa));
+
+      kernel_isa_select(baseline ? selected : isa);
+      time_testrun_template run = time_testrun_new(captions[num], tests, (baseline ? bench_memcpy : bench_decode), &state, TESTRUN_ENABLE_ALL);
+      time_testrun_set_warmup(&run, 4);
+      time_testrun_set_bytes(&run, bytes);
+
+      results[num] = time_testrun_run(&run);
+      time_testrun_print(&results[num]);
+      info("%s: %.2f GB/s", captions[num], results[num].bytes_per_sec / 1e9);
+      num++;
+    }
+
+    snprintf(captions[num], sizeof(captions[num]), "packed_arr_peek (%s)", datasets[d].name);
+    time_testrun_template run = time_testrun_new(captions[num], tests, bench_peek, &state, TESTRUN_ENABLE_ALL);
+    time_testrun_set_warmup(&run, 4);
+
+    results[num] = time_testrun_run(&run);
+    time_testrun_print(&results[num++]);
+  }
+  kernel_isa_select(selected);
+
+  const int status = bench_report(results, num);
+
+  for (unsigned long r = 0; r < num; r++)
+    time_testrun_cleanup(&results[r]);
+  for (int d = 0; d < DATASETS; d++) {
+    packed_arr_cleanup(&datasets[d].packed);
+    dynamic_arr_cleanup(&datasets[d].raw);
+    free(datasets[d].out);
+  }
+
+  return status;
+}
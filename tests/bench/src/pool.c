@@ -0,0 +1,140 @@
+#define _GNU_SOURCE
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/memory/pool.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_TESTS   64UL
+#define DEFAULT_OBJECTS 4096UL
+#define OBJECT_SIZE     64
+#define MAX_THREADS     8
+
+typedef struct {
+  char bytes[OBJECT_SIZE];
+} record;
+
+typedef struct {
+  pool records;
+  unsigned long objects;
+  void** held[MAX_THREADS]; /* Objects of every thread */
+} bench_state;
+
+/*
+ * Churn: allocate every object, free every other one, allocate them again and free all,
+ * in the order a container growing and shrinking would.
+ */
+#define BENCH_CHURN(name, caption, alloc, release)                            \
+  static time_test name(unsigned int index, void* data) {                     \
+    (void)index;                                                              \
+    bench_state* state = data;                                                \
+    void** held = state->held[time_testrun_thread()];                         \
+    bool valid = true;                                                        \
+                                                                              \
+    time_test test = time_test_start(caption);                                \
+    for (unsigned long i = 0; i < state->objects; i++) {                      \
+      held[i] = alloc;                                                        \
+      *(unsigned long*)held[i] = i;                                           \
+    }                                                                         \
+    for (unsigned long i = 0; i < state->objects; i += 2)                     \
+      release(held[i]);                                                       \
+    for (unsigned long i = 0; i < state->objects; i += 2) {                   \
+      held[i] = alloc;                                                        \
+      *(unsigned long*)held[i] = i;                                           \
+    }                                                                         \
+    for (unsigned long i = 0; i < state->objects; i++) {                      \
+      valid &= (*(unsigned long*)held[i] == i);                               \
+      release(held[i]);                                                       \
+    }                                                                         \
+    time_test_end(&test);                                                     \
+                                                                              \
+    test.ops = state->objects + state->objects / 2;                           \
+    test.state = (valid ? TEST_SUCCESS : TEST_FAILURE);                       \
+                                                                              \
+    return test;                                                              \
+  }
+
+#define POOL_RELEASE(object) pool_free(&state->records, object)
+
+BENCH_CHURN(bench_malloc, "malloc", malloc(sizeof(record)), free)
+BENCH_CHURN(bench_pool, "pool", pool_alloc(&state->records), POOL_RELEASE)
+
+static time_test bench_pool_bulk(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  void** held = state->held[time_testrun_thread()];
+  const unsigned long half = state->objects / 2;
+  bool valid = true;
+
+  time_test test = time_test_start("pool (bulk)");
+  valid &= (pool_alloc_bulk(&state->records, held, state->objects) == state->objects);
+  pool_free_bulk(&state->records, held, half);
+  valid &= (pool_alloc_bulk(&state->records, held, half) == half);
+  pool_free_bulk(&state->records, held, state->objects);
+  time_test_end(&test);
+
+  test.ops = state->objects + half;
+  test.state = (valid ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long objects = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_OBJECTS);
+
+  bench_state state = { pool_new(record), objects, {0} };
+  for (int t = 0; t < MAX_THREADS; t++)
+    state.held[t] = malloc(objects * sizeof(void*));
+
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  const unsigned int max_threads = (cpus > MAX_THREADS ? MAX_THREADS : (cpus > 0 ? cpus : 1));
+
+  enum { RUN_MALLOC, RUN_POOL, RUN_BULK, RUNS };
+  const char* const captions[RUNS] = { "malloc/free", "pool_alloc/pool_free", "pool_alloc_bulk/pool_free_bulk" };
+  time_test (*const funcs[RUNS])(unsigned int, void*) = { bench_malloc, bench_pool, bench_pool_bulk };
+  time_testrun_results results[RUNS];
+
+  for (int r = 0; r < RUNS; r++) {
+    time_testrun_template run = time_testrun_new(captions[r], tests, funcs[r], &state, TESTRUN_ENABLE_ALL);
+    time_testrun_set_warmup(&run, 4);
+
+    results[r] = time_testrun_run(&run);
+
+    /* Churn on every thread at once, the arena locks of malloc against the magazines */
+    if (max_threads > 1) {
+      time_testrun_set_threads(&run, 1, false);
+
+      dynamic_arr scaling = time_testrun_sweep(&run, max_threads);
+      time_testrun_results* scaled = dynamic_arr_get_start(&scaling);
+      time_testrun_print_scaling(scaled, scaling.num);
+
+      for (unsigned long t = 0; t < scaling.num; t++)
+        time_testrun_cleanup(&scaled[t]);
+      dynamic_arr_cleanup(&scaling);
+    }
+
+    time_testrun_print(&results[r]);
+  }
+
+  const pool_stats stats = pool_stats_get(&state.records);
+  info("pool: %lu slabs, %lu bytes, %lu of %lu objects live, %lu cached", stats.slabs, stats.bytes, stats.live, stats.capacity, stats.cached);
+
+  const int status = bench_report(results, RUNS);
+
+  for (int r = 0; r < RUNS; r++)
+    time_testrun_cleanup(&results[r]);
+  for (int t = 0; t < MAX_THREADS; t++)
+    free(state.held[t]);
+  pool_cleanup(&state.records);
+
+  return status;
+}
@@ -0,0 +1,146 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/queues/priority.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define DEFAULT_PENDING 1000000UL
+#define DEFAULT_TESTS   128UL
+#define BATCH           16
+
+/*
+ * Models a timer wheel: `pending' timers are armed, every operation
+ * expires the earliest timer and re-arms it at a later deadline.
+ */
+typedef struct {
+  uint64_t now;
+  uint64_t rng;
+  priority_queue pq;
+  dynamic_arr sorted; /* Sorted descending, earliest deadline at the end */
+} bench_state;
+
+static uint64_t next_rand(uint64_t* rng) {
+  *rng ^= *rng << 13;
+  *rng ^= *rng >> 7;
+  *rng ^= *rng << 17;
+
+  return *rng;
+}
+
+static int cmp_deadline(const void* a, const void* b) {
+  const uint64_t x = *(const uint64_t*)a;
+  const uint64_t y = *(const uint64_t*)b;
+
+  return (x > y) - (x < y);
+}
+
+static int cmp_deadline_desc(const void* a, const void* b) {
+  return cmp_deadline(b, a);
+}
+
+static time_test bench_pq(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+
+  time_test test = time_test_start("priority_queue");
+  for (unsigned int i = 0; i < BATCH; i++) {
+    uint64_t deadline;
+    priority_queue_pop(&state->pq, &deadline);
+
+    deadline += 1 + (next_rand(&state->rng) & 0xffff);
+    priority_queue_push(&state->pq, &deadline);
+  }
+  time_test_end(&test);
+
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+static time_test bench_sorted(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  const uint64_t* base = NULL;
+
+  time_test test = time_test_start("sorted insert");
+  for (unsigned int i = 0; i < BATCH; i++) {
+    uint64_t deadline;
+    dynamic_arr_truncate(&state->sorted, &deadline);
+
+    deadline += 1 + (next_rand(&state->rng) & 0xffff);
+
+    /* find the first element smaller than the new deadline */
+    base = dynamic_arr_get_start(&state->sorted);
+    unsigned long lo = 0, hi = state->sorted.num;
+    while (lo < hi) {
+      const unsigned long mid = lo + ((hi - lo) >> 1);
+      if (base[mid] >= deadline)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if (lo == state->sorted.num)
+      dynamic_arr_append(&state->sorted, &deadline);
+    else
+      dynamic_arr_insert_at(&state->sorted, lo, &deadline);
+  }
+  time_test_end(&test);
+
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long pending = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_PENDING);
+  const unsigned long tests = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_TESTS);
+  if (!pending || !tests) {
+    err("usage: %s [pending timers] [tests]", av[0]);
+    return 1;
+  }
+
+  bench_state state = { .rng = 0x9e3779b97f4a7c15ULL };
+
+  dynamic_arr deadlines = dynamic_arr_new(uint64_t);
+  for (unsigned long i = 0; i < pending; i++) {
+    const uint64_t deadline = next_rand(&state.rng) & 0xffffff;
+    dynamic_arr_append(&deadlines, &deadline);
+  }
+  state.sorted = dynamic_arr_copy(&deadlines);
+  qsort(dynamic_arr_get_start(&state.sorted), pending, sizeof(uint64_t), cmp_deadline_desc);
+
+  info("heapifying %lu pending timers", pending);
+  state.pq = priority_queue_from_arr(&deadlines, 4, cmp_deadline);
+
+  time_testrun_template runs[] = {
+    time_testrun_new("priority_queue (4-ary): expire + re-arm x16", tests, bench_pq, &state, TESTRUN_ENABLE_ALL),
+    time_testrun_new("sorted dynamic_arr_insert_at: expire + re-arm x16", tests, bench_sorted, &state, TESTRUN_ENABLE_ALL),
+  };
+
+  time_testrun_results results[sizeof(runs) / sizeof(*runs)];
+  for (unsigned long r = 0; r < sizeof(runs) / sizeof(*runs); r++) {
+    /* cache misses of the memmove in insert_at versus the sift of the heap */
+    time_testrun_set_counters(&runs[r], true);
+    /* both keep the same number of timers, neither should allocate */
+    time_testrun_set_memory(&runs[r], true);
+
+    results[r] = time_testrun_run(&runs[r]);
+    time_testrun_print(&results[r]);
+  }
+
+  const int status = bench_report(results, sizeof(results) / sizeof(*results));
+
+  for (unsigned long r = 0; r < sizeof(results) / sizeof(*results); r++)
+    time_testrun_cleanup(&results[r]);
+  priority_queue_cleanup(&state.pq);
+  dynamic_arr_cleanup(&state.sorted);
+
+  return status;
+}
@@ -0,0 +1,299 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/arrays/trace.h>
+#include <blib/datastructures/flat/map.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_TESTS 16UL
+
+/* An array that was alive before the trace started */
+typedef struct {
+  unsigned long slot;
+  unsigned int element_size;
+  unsigned long size;
+} replay_initial;
+
+/*
+ * The trace with the ids of the arrays replaced by dense slots,
+ * `arrays' holds the arrays of every slot while replaying.
+ */
+typedef struct {
+  dynamic_arr records;
+  dynamic_arr initial;
+
+  unsigned long slots;
+  dynamic_arr* arrays;
+  bool* alive;
+
+  uint8_t* scratch;
+  unsigned long counts[DYNAMIC_ARR_TRACE_OPS];
+} replay_state;
+
+static int cmp_id(const void* a, const void* b) {
+  const unsigned long x = *(const unsigned long*)a;
+  const unsigned long y = *(const unsigned long*)b;
+
+  return (x > y) - (x < y);
+}
+
+static unsigned long slot_of(flat_map* slots, unsigned long id, unsigned long* num, bool* created) {
+  unsigned long slot;
+  *created = !flat_map_get(slots, &id, &slot);
+  if (*created) {
+    slot = (*num)++;
+    flat_map_insert(slots, &id, &slot);
+  }
+
+  return slot;
+}
+
+static bool replay_load(replay_state* state, const char* path) {
+  FILE* file = dynamic_arr_trace_open(path);
+  if (!file)
+    return false;
+
+  state->records = dynamic_arr_new(dynamic_arr_trace_record);
+  state->initial = dynamic_arr_new(replay_initial);
+
+  flat_map slots = flat_map_new(unsigned long, unsigned long, cmp_id);
+  unsigned long scratch = 1;
+
+  dynamic_arr_trace_record record;
+  while (dynamic_arr_trace_read(file, &record)) {
+    bool created;
+    record.array = slot_of(&slots, record.array, &state->slots, &created);
+    if (created && record.op != DYNAMIC_ARR_TRACE_NEW) {
+      const replay_initial initial = { record.array, record.element_size, record.size };
+      dynamic_arr_append(&state->initial, &initial);
+    }
+    if (record.op == DYNAMIC_ARR_TRACE_COPY)
+      record.other = slot_of(&slots, record.other, &state->slots, &created);
+
+    const unsigned long bytes = (record.count ? record.count : 1) * record.element_size;
+    scratch = (bytes > scratch ? bytes : scratch);
+
+    state->counts[record.op]++;
+    dynamic_arr_append(&state->records, &record);
+  }
+
+  fclose(file);
+  flat_map_cleanup(&slots);
+
+  state->arrays = calloc(state->slots + 1, sizeof(dynamic_arr));
+  state->alive = calloc(state->slots + 1, sizeof(bool));
+  state->scratch = calloc(scratch, 1);
+
+  return state->arrays && state->alive && state->scratch;
+}
+
+static void replay_reset(replay_state* state) {
+  for (unsigned long s = 0; s < state->slots; s++) {
+    if (state->alive[s])
+      dynamic_arr_cleanup(&state->arrays[s]);
+    state->alive[s] = false;
+  }
+
+  const replay_initial* initial = dynamic_arr_get_start(&state->initial);
+  for (unsigned long i = 0; i < state->initial.num; i++) {
+    dynamic_arr* arr = &state->arrays[initial[i].slot];
+
+    *arr = __intern_dynamic_generic_arr_new(initial[i].element_size);
+    if (initial[i].size)
+      dynamic_arr_resize_to(arr, NULL, initial[i].size);
+    state->alive[initial[i].slot] = true;
+  }
+}
+
+static void replay_record(replay_state* state, const dynamic_arr_trace_record* r) {
+  dynamic_arr* arr = &state->arrays[r->array];
+  uint8_t* scratch = state->scratch;
+
+  if (r->op == DYNAMIC_ARR_TRACE_NEW) {
+    if (state->alive[r->array])
+      dynamic_arr_cleanup(arr);
+
+    *arr = __intern_dynamic_generic_arr_new_aligned(r->element_size, r->index, false);
+    state->alive[r->array] = true;
+
+    return;
+  }
+
+  /* Arrays moved out of or cleaned up without being recorded */
+  if (!state->alive[r->array])
+    return;
+
+  /* Elements written through `dynamic_arr_get_start()' by the program aren't recorded, the size is */
+  if (r->op != DYNAMIC_ARR_TRACE_CLEANUP && arr->num != r->size)
+    dynamic_arr_resize_to(arr, NULL, r->size);
+
+  switch (r->op) {
+    case DYNAMIC_ARR_TRACE_NEW:
+      break;
+    case DYNAMIC_ARR_TRACE_COPY:
+      if (state->alive[r->other])
+        dynamic_arr_cleanup(&state->arrays[r->other]);
+      state->arrays[r->other] = dynamic_arr_copy(arr);
+      state->alive[r->other] = true;
+      break;
+    case DYNAMIC_ARR_TRACE_ENABLE_COW:
+      dynamic_arr_enable_cow(arr);
+      break;
+    case DYNAMIC_ARR_TRACE_REPLACE:
+      dynamic_arr_replace(arr, r->index, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_BULK_REPLACE:
+      dynamic_arr_bulk_replace(arr, r->index, scratch, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_SET:
+      dynamic_arr_set(arr, r->index, scratch, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_FLIP:
+      dynamic_arr_flip(arr, r->index, r->other);
+      break;
+    case DYNAMIC_ARR_TRACE_BULK_FLIP:
+      dynamic_arr_bulk_flip(arr, r->index, r->other, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_PEEK:
+      dynamic_arr_peek(arr, r->index, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_BULK_PEEK:
+      dynamic_arr_bulk_peek(arr, r->index, scratch, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_APPEND:
+      dynamic_arr_append(arr, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_BULK_APPEND:
+      dynamic_arr_bulk_append(arr, scratch, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_PREPEND:
+      dynamic_arr_prepend(arr, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_BULK_PREPEND:
+      dynamic_arr_bulk_prepend(arr, scratch, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_INSERT_AT:
+      dynamic_arr_insert_at(arr, r->index, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_BULK_INSERT_AT:
+      dynamic_arr_bulk_insert_at(arr, r->index, scratch, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_PRECATE:
+      dynamic_arr_precate(arr, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_QUICK_PRECATE:
+      dynamic_arr_quick_precate(arr, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_TRUNCATE:
+      dynamic_arr_truncate(arr, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_RESIZE_TO:
+      dynamic_arr_resize_to(arr, NULL, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_RESERVE:
+      dynamic_arr_reserve(arr, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_TRIM:
+      dynamic_arr_trim(arr);
+      break;
+    case DYNAMIC_ARR_TRACE_REMOVE_AT:
+      dynamic_arr_remove_at(arr, r->index, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_BULK_REMOVE_AT:
+      dynamic_arr_bulk_remove_at(arr, r->index, scratch, r->count);
+      break;
+    case DYNAMIC_ARR_TRACE_QUICK_REMOVE_AT:
+      dynamic_arr_quick_remove_at(arr, r->index, scratch);
+      break;
+    case DYNAMIC_ARR_TRACE_CLEANUP:
+      dynamic_arr_cleanup(arr);
+      state->alive[r->array] = false;
+      break;
+  }
+}
+
+static time_test replay_run(unsigned int index, void* data) {
+  (void)index;
+  replay_state* state = data;
+  const dynamic_arr_trace_record* records = dynamic_arr_get_start(&state->records);
+
+  replay_reset(state);
+
+  time_test test = time_test_start("replay");
+  for (unsigned long r = 0; r < state->records.num; r++)
+    replay_record(state, &records[r]);
+  time_test_end(&test);
+
+  test.ops = state->records.num;
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+static void replay_dump(const replay_state* state) {
+  const dynamic_arr_trace_record* records = dynamic_arr_get_start(&state->records);
+
+  printf("OP\t\tARRAY\tELEMENT\tSIZE\tINDEX\tOTHER\tCOUNT\n");
+  for (unsigned long r = 0; r < state->records.num; r++)
+    printf("%-15s\t%lu\t%u\t%lu\t%lu\t%lu\t%lu\n",
+        dynamic_arr_trace_op_name(records[r].op), records[r].array, records[r].element_size,
+        records[r].size, records[r].index, records[r].other, records[r].count);
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const bool dump = (ac > 1 && !strcmp(av[1], "--dump"));
+  if (ac < 2 + dump) {
+    err("usage: %s [--dump] <trace> [tests]", av[0]);
+    return 1;
+  }
+  const char* path = av[1 + dump];
+  const unsigned long tests = (ac > 2 + dump ? strtoul(av[2 + dump], NULL, 0) : DEFAULT_TESTS);
+
+  static replay_state state;
+  if (!replay_load(&state, path)) {
+    err("failed to load trace %s: %s", path, strerror(errno));
+    return 1;
+  }
+
+  if (dump) {
+    replay_dump(&state);
+    return 0;
+  }
+
+  info("%lu operation(s) on %lu array(s), %lu alive before the trace started",
+      state.records.num, state.slots, state.initial.num);
+  for (int op = 0; op < DYNAMIC_ARR_TRACE_OPS; op++)
+    if (state.counts[op])
+      printf("\t%-15s\t%lu\n", dynamic_arr_trace_op_name(op), state.counts[op]);
+
+  time_testrun_template run = time_testrun_new(path, tests, replay_run, &state, TESTRUN_ENABLE_ALL);
+  time_testrun_set_warmup(&run, 1);
+  /* Reallocations are what differs between growth policies */
+  time_testrun_set_memory(&run, true);
+
+  time_testrun_results results = time_testrun_run(&run);
+  time_testrun_print(&results);
+
+  const int status = bench_report(&results, 1);
+
+  time_testrun_cleanup(&results);
+  for (unsigned long s = 0; s < state.slots; s++)
+    if (state.alive[s])
+      dynamic_arr_cleanup(&state.arrays[s]);
+  free(state.arrays);
+  free(state.alive);
+  free(state.scratch);
+  dynamic_arr_cleanup(&state.records);
+  dynamic_arr_cleanup(&state.initial);
+
+  return status;
+}
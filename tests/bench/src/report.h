@@ -0,0 +1,62 @@
+#ifndef __BENCH_REPORT_H__
+#define __BENCH_REPORT_H__
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_THRESHOLD 0.05
+
+/**
+ * @brief Export and compare the results of a benchmark, as requested by the environment
+ * @param results Results of the testruns
+ * @param num Number of results
+ *
+ * BENCH_JSON and BENCH_CSV name files to export the results to, BENCH_BASELINE
+ * names a CSV file to compare against with a relative BENCH_THRESHOLD (0.05 by default).
+ * Returns the exit status of the benchmark, non-zero on regressions.
+ */
+static int bench_report(const time_testrun_results* results, unsigned long num) {
+  const char* exports[] = { getenv("BENCH_JSON"), getenv("BENCH_CSV") };
+  for (int e = 0; e < 2; e++) {
+    if (!exports[e])
+      continue;
+
+    FILE* file = fopen(exports[e], "w");
+    if (!file) {
+      err("failed to open %s: %s", exports[e], strerror(errno));
+      return 1;
+    }
+
+    if (e)
+      time_testrun_export_csv(file, results, num);
+    else
+      time_testrun_export_json(file, results, num);
+    fclose(file);
+
+    info("wrote %s", exports[e]);
+  }
+
+  const char* baseline = getenv("BENCH_BASELINE");
+  if (!baseline)
+    return 0;
+
+  const char* threshold = getenv("BENCH_THRESHOLD");
+  const long regressions = time_testrun_compare(baseline, results, num,
+      (threshold ? strtod(threshold, NULL) : BENCH_DEFAULT_THRESHOLD));
+  if (regressions < 0) {
+    err("failed to load baseline %s: %s", baseline, strerror(errno));
+    return 1;
+  }
+  if (regressions) {
+    err("%ld regression(s) against %s", regressions, baseline);
+    return 1;
+  }
+
+  return 0;
+}
+
+#endif // !__BENCH_REPORT_H__
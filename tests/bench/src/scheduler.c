@@ -0,0 +1,208 @@
+#include <blib/concurrency/scheduler.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_TESTS    16UL
+#define DEFAULT_ELEMENTS 4000000UL
+#define FIXED_GRAIN      4096UL
+#define FIB_N            27
+#define FIB_RESULT       196418L
+#define FIB_CUTOFF       12
+#define MAX_WORKERS      8
+
+typedef struct {
+  scheduler sched;
+  uint32_t* values;
+  unsigned long elements;
+  uint64_t expected;
+} bench_state;
+
+typedef struct {
+  bench_state* state;
+  uint64_t sums[MAX_WORKERS + 1]; /* One per worker, the last for the calling thread */
+} bench_sum;
+
+typedef struct {
+  bench_state* state;
+  long n;
+  long result;
+} bench_fib;
+
+static long bench_fib_serial(long n) {
+  return (n < 2 ? n : bench_fib_serial(n - 1) + bench_fib_serial(n - 2));
+}
+
+static void bench_fib_task(void* data) {
+  bench_fib* fib = data;
+
+  if (fib->n < FIB_CUTOFF) {
+    fib->result = bench_fib_serial(fib->n);
+    return;
+  }
+
+  bench_fib left = { fib->state, fib->n - 1, 0 };
+  bench_fib right = { fib->state, fib->n - 2, 0 };
+  scheduler_group group = scheduler_group_new();
+
+  scheduler_spawn(&fib->state->sched, &group, bench_fib_task, &left);
+  bench_fib_task(&right);
+  scheduler_wait(&fib->state->sched, &group);
+
+  fib->result = left.result + right.result;
+}
+
+static void bench_sum_range(unsigned long begin, unsigned long end, void* data) {
+  bench_sum* sum = data;
+  const int worker = scheduler_worker(&sum->state->sched);
+  uint64_t partial = 0;
+
+  for (unsigned long i = begin; i < end; i++)
+    partial += sum->state->values[i];
+
+  /* Workers only add to their own slot, the calling thread to the last one */
+  sum->sums[(worker < 0 ? MAX_WORKERS : worker)] += partial;
+}
+
+static time_test bench_serial_sum(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  uint64_t sum = 0;
+
+  time_test test = time_test_start("serial sum");
+  for (unsigned long i = 0; i < state->elements; i++)
+    sum += state->values[i];
+  time_test_end(&test);
+
+  test.ops = state->elements;
+  test.state = (sum == state->expected ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_parallel_sum(bench_state* state, unsigned long grain) {
+  bench_sum sum = { state, {0} };
+  uint64_t total = 0;
+
+  time_test test = time_test_start("scheduler_for sum");
+  scheduler_for(&state->sched, 0, state->elements, grain, bench_sum_range, &sum);
+  for (int w = 0; w <= MAX_WORKERS; w++)
+    total += sum.sums[w];
+  time_test_end(&test);
+
+  test.ops = state->elements;
+  test.state = (total == state->expected ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_adaptive_sum(unsigned int index, void* data) {
+  (void)index;
+  return bench_parallel_sum(data, 0);
+}
+
+static time_test bench_fixed_sum(unsigned int index, void* data) {
+  (void)index;
+  return bench_parallel_sum(data, FIXED_GRAIN);
+}
+
+static time_test bench_serial_fib(unsigned int index, void* data) {
+  (void)index;
+  (void)data;
+
+  time_test test = time_test_start("serial fib");
+  const long result = bench_fib_serial(FIB_N);
+  time_test_end(&test);
+
+  test.state = (result == FIB_RESULT ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_spawn_fib(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  bench_fib fib = { state, FIB_N, 0 };
+  scheduler_group group = scheduler_group_new();
+
+  time_test test = time_test_start("spawn/wait fib");
+  scheduler_spawn(&state->sched, &group, bench_fib_task, &fib);
+  scheduler_wait(&state->sched, &group);
+  time_test_end(&test);
+
+  test.state = (fib.result == FIB_RESULT ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long elements = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_ELEMENTS);
+
+  bench_state state = { {0}, malloc(elements * sizeof(uint32_t)), elements, 0 };
+  if (!state.values) {
+    err("Failed to allocate %lu elements", elements);
+    return 1;
+  }
+  for (unsigned long i = 0; i < elements; i++) {
+    state.values[i] = (uint32_t)(i * 2654435761UL) >> 8;
+    state.expected += state.values[i];
+  }
+
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  const unsigned int max_workers = (cpus > MAX_WORKERS ? MAX_WORKERS : (cpus > 0 ? cpus : 1));
+
+  enum { RUN_SERIAL, RUN_ADAPTIVE, RUN_FIXED, RUN_SERIAL_FIB, RUN_FIB, RUNS };
+  const char* const names[RUNS] = { "serial sum", "scheduler_for sum, adaptive grain", "scheduler_for sum, fixed grain", "serial fib", "spawn/wait fib" };
+  time_test (*const funcs[RUNS])(unsigned int, void*) = { bench_serial_sum, bench_adaptive_sum, bench_fixed_sum, bench_serial_fib, bench_spawn_fib };
+  const bool scheduled[RUNS] = { false, true, true, false, true };
+  char captions[MAX_WORKERS][RUNS][64];
+  time_testrun_results results[MAX_WORKERS * RUNS];
+  unsigned long num = 0;
+
+  /* Every worker count up to the CPUs, the serial runs only once */
+  for (unsigned int workers = 1; workers <= max_workers; workers++) {
+    if (!scheduler_start(&state.sched, workers, false)) {
+      err("Failed to start %u worker(s): %s", workers, strerror(errno));
+      break;
+    }
+
+    for (int r = 0; r < RUNS; r++) {
+      if (!scheduled[r] && workers > 1)
+        continue;
+
+      if (scheduled[r])
+        snprintf(captions[workers - 1][r], sizeof(captions[workers - 1][r]), "%s (%u worker(s))", names[r], workers);
+      else
+        snprintf(captions[workers - 1][r], sizeof(captions[workers - 1][r]), "%s", names[r]);
+
+      time_testrun_template run = time_testrun_new(captions[workers - 1][r], tests, funcs[r], &state, TESTRUN_ENABLE_ALL);
+      time_testrun_set_warmup(&run, 2);
+      if (scheduled[r])
+        time_testrun_set_scheduler(&run, &state.sched);
+
+      results[num] = time_testrun_run(&run);
+      time_testrun_print(&results[num++]);
+    }
+
+    scheduler_stop(&state.sched);
+  }
+
+  const int status = bench_report(results, num);
+
+  for (unsigned long r = 0; r < num; r++)
+    time_testrun_cleanup(&results[r]);
+  free(state.values);
+
+  return status;
+}
@@ -0,0 +1,187 @@
+#define _GNU_SOURCE
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/arrays/snapshot.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_TESTS    64UL
+#define DEFAULT_ELEMENTS 4096UL
+#define LOOKUPS          1024
+#define WRITE_EVERY_NS   1000000L
+#define MAX_THREADS      8
+
+typedef struct {
+  pthread_rwlock_t lock;
+  dynamic_arr locked; /* The table behind a rwlock, how readers used to read it */
+  snapshot_arr published;
+  unsigned long elements;
+
+  bool stop;
+  unsigned long writes;
+} bench_state;
+
+typedef struct {
+  unsigned long index;
+  uint64_t value;
+} bench_write;
+
+static uint64_t bench_random(uint64_t* seed) {
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 7;
+  *seed ^= *seed << 17;
+  return *seed;
+}
+
+/* Every element keeps its index modulo the size, whatever the writer stored */
+static void bench_edit(dynamic_arr* version, void* data) {
+  const bench_write* write = data;
+  dynamic_arr_replace(version, write->index, &write->value);
+}
+
+/* Rewrites an element of both tables every millisecond while the readers run */
+static void* bench_writer(void* data) {
+  bench_state* state = data;
+  uint64_t seed = 0x2545f4914f6cdd1dULL;
+  const struct timespec pause = { 0, WRITE_EVERY_NS };
+
+  while (!__atomic_load_n(&state->stop, __ATOMIC_RELAXED)) {
+    const unsigned long index = bench_random(&seed) % state->elements;
+    const bench_write write = { index, index + state->elements * (bench_random(&seed) % 1024) };
+
+    pthread_rwlock_wrlock(&state->lock);
+    dynamic_arr_replace(&state->locked, write.index, &write.value);
+    pthread_rwlock_unlock(&state->lock);
+
+    snapshot_arr_update(&state->published, bench_edit, (void*)&write);
+
+    __atomic_store_n(&state->writes, state->writes + 1, __ATOMIC_RELAXED);
+    nanosleep(&pause, NULL);
+  }
+
+  return NULL;
+}
+
+static time_test bench_rwlock(unsigned int index, void* data) {
+  bench_state* state = data;
+  uint64_t seed = 0x9e3779b97f4a7c15ULL * (index + 1);
+  bool valid = true;
+
+  time_test test = time_test_start("rwlock + dynamic_arr_peek");
+  for (int l = 0; l < LOOKUPS; l++) {
+    const unsigned long i = bench_random(&seed) % state->elements;
+    uint64_t value;
+
+    pthread_rwlock_rdlock(&state->lock);
+    dynamic_arr_peek(&state->locked, i, &value);
+    pthread_rwlock_unlock(&state->lock);
+
+    valid &= (value % state->elements == i);
+  }
+  time_test_end(&test);
+
+  test.ops = LOOKUPS;
+  test.state = (valid ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_snapshot(unsigned int index, void* data) {
+  bench_state* state = data;
+  uint64_t seed = 0x9e3779b97f4a7c15ULL * (index + 1);
+  bool valid = true;
+
+  time_test test = time_test_start("snapshot_arr_read_begin + dynamic_arr_peek");
+  for (int l = 0; l < LOOKUPS; l++) {
+    const unsigned long i = bench_random(&seed) % state->elements;
+    uint64_t value;
+
+    const dynamic_arr* version = snapshot_arr_read_begin(&state->published);
+    dynamic_arr_peek(version, i, &value);
+    snapshot_arr_read_end(&state->published);
+
+    valid &= (value % state->elements == i);
+  }
+  time_test_end(&test);
+
+  test.ops = LOOKUPS;
+  test.state = (valid ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long elements = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_ELEMENTS);
+
+  bench_state state = { .locked = dynamic_arr_new(uint64_t), .elements = (elements ? elements : 1) };
+  pthread_rwlock_init(&state.lock, NULL);
+  for (uint64_t i = 0; i < state.elements; i++)
+    dynamic_arr_append(&state.locked, &i);
+
+  dynamic_arr first = dynamic_arr_copy(&state.locked);
+  state.published = snapshot_arr_from_dynamic(&first);
+
+  pthread_t writer;
+  if (pthread_create(&writer, NULL, bench_writer, &state)) {
+    err("Failed to start the writer");
+    return 1;
+  }
+
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  const unsigned int max_threads = (cpus > MAX_THREADS ? MAX_THREADS : (cpus > 0 ? cpus : 1));
+
+  enum { RUN_RWLOCK, RUN_SNAPSHOT, RUNS };
+  const char* const captions[RUNS] = { "rwlock + dynamic_arr_peek", "snapshot_arr_read_begin + dynamic_arr_peek" };
+  time_test (*const funcs[RUNS])(unsigned int, void*) = { bench_rwlock, bench_snapshot };
+  time_testrun_results results[RUNS];
+
+  for (int r = 0; r < RUNS; r++) {
+    time_testrun_template run = time_testrun_new(captions[r], tests, funcs[r], &state, TESTRUN_ENABLE_ALL);
+    time_testrun_set_warmup(&run, 4);
+
+    results[r] = time_testrun_run(&run);
+
+    /* Readers on every thread at once, the lock's cache line against a load and a private slot */
+    if (max_threads > 1) {
+      time_testrun_set_threads(&run, 1, false);
+
+      dynamic_arr scaling = time_testrun_sweep(&run, max_threads);
+      time_testrun_results* scaled = dynamic_arr_get_start(&scaling);
+      time_testrun_print_scaling(scaled, scaling.num);
+
+      for (unsigned long t = 0; t < scaling.num; t++)
+        time_testrun_cleanup(&scaled[t]);
+      dynamic_arr_cleanup(&scaling);
+    }
+
+    time_testrun_print(&results[r]);
+  }
+
+  __atomic_store_n(&state.stop, true, __ATOMIC_RELAXED);
+  pthread_join(writer, NULL);
+
+  const snapshot_arr_stats stats = snapshot_arr_stats_get(&state.published);
+  info("writer: %lu update(s), %lu version(s) published, %lu waiting to be freed, %lu after reclaiming",
+      state.writes, stats.published, stats.retired, snapshot_arr_reclaim(&state.published));
+
+  const int status = bench_report(results, RUNS);
+
+  for (int r = 0; r < RUNS; r++)
+    time_testrun_cleanup(&results[r]);
+  snapshot_arr_cleanup(&state.published);
+  dynamic_arr_cleanup(&state.locked);
+  pthread_rwlock_destroy(&state.lock);
+
+  return status;
+}
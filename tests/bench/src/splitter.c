@@ -0,0 +1,223 @@
+#define _GNU_SOURCE
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/parsing/text/splitter.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_TESTS 16UL
+#define DEFAULT_MIB   64UL
+#define MAX_THREADS   8
+#define LINE_MAX_LEN  4096
+
+typedef struct {
+  text_splitter chunk;
+  dynamic_arr fields;
+  unsigned long count;
+} bench_worker;
+
+typedef struct {
+  const char* path;
+  unsigned long bytes;
+  FILE* file;
+  text_splitter splitter;
+  unsigned long threads;
+  bench_worker workers[MAX_THREADS];
+} bench_state;
+
+static uint64_t next_rand(uint64_t* rng) {
+  *rng ^= *rng << 13;
+  *rng ^= *rng >> 7;
+  *rng ^= *rng << 17;
+
+  return *rng;
+}
+
+/* Rows of 8 to 16 fields: numbers, words and every tenth field quoted with a delimiter in it */
+static unsigned long bench_generate(const char* path, unsigned long bytes) {
+  FILE* file = fopen(path, "w");
+  if (!file)
+    return 0;
+
+  uint64_t rng = 0x9e3779b97f4a7c15ULL;
+  unsigned long written = 0;
+  while (written < bytes) {
+    const int fields = 8 + next_rand(&rng) % 9;
+    for (int f = 0; f < fields; f++) {
+      const uint64_t r = next_rand(&rng);
+      if (f)
+        written += fprintf(file, ",");
+
+      if (r % 10 == 0)
+        written += fprintf(file, "\"city %lu, region %lu\"", (unsigned long)(r >> 8) % 1000, (unsigned long)(r >> 20) % 100);
+      else if (r % 2)
+        written += fprintf(file, "%lu", (unsigned long)(r >> 8) % 1000000);
+      else
+        written += fprintf(file, "item-%lu", (unsigned long)(r >> 8) % 100000);
+    }
+    written += fprintf(file, "\n");
+  }
+
+  fclose(file);
+
+  return written;
+}
+
+static time_test bench_strtok(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  rewind(state->file);
+
+  char line[LINE_MAX_LEN];
+  unsigned long count = 0;
+
+  time_test test = time_test_start("fgets_strtok");
+  while (fgets(line, sizeof(line), state->file))
+    for (char* field = strtok(line, ",\n"); field; field = strtok(NULL, ",\n"))
+      count++;
+  time_test_end(&test);
+
+  test.state = (count ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_lines(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  text_splitter splitter = state->splitter;
+
+  text_span line;
+  unsigned long count = 0;
+
+  time_test test = time_test_start("text_splitter_next_line");
+  while (text_splitter_next_line(&splitter, &line))
+    count++;
+  time_test_end(&test);
+
+  test.state = (count ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static void* bench_worker_run(void* data) {
+  bench_worker* worker = data;
+
+  text_span line;
+  worker->count = 0;
+  while (text_splitter_next_line(&worker->chunk, &line)) {
+    worker->fields.num = 0;
+    worker->count += text_splitter_split(&worker->chunk, &line, &worker->fields);
+  }
+
+  return NULL;
+}
+
+static time_test bench_fields(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  text_splitter chunks[MAX_THREADS];
+  pthread_t threads[MAX_THREADS];
+
+  time_test test = time_test_start("text_splitter_split");
+  const unsigned long num = text_splitter_chunks(&state->splitter, chunks, state->threads);
+  for (unsigned long t = 0; t < num; t++) {
+    state->workers[t].chunk = chunks[t];
+    if (num > 1)
+      pthread_create(&threads[t], NULL, bench_worker_run, &state->workers[t]);
+    else
+      bench_worker_run(&state->workers[t]);
+  }
+
+  unsigned long count = 0;
+  for (unsigned long t = 0; t < num; t++) {
+    if (num > 1)
+      pthread_join(threads[t], NULL);
+    count += state->workers[t].count;
+  }
+  time_test_end(&test);
+
+  test.state = (count ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long mib = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_MIB);
+
+  static bench_state state;
+  char path[] = "/tmp/blib-splitter-XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd < 0) {
+    err("failed to create %s: %s", path, strerror(errno));
+    return 1;
+  }
+  close(fd);
+
+  state.path = path;
+  state.bytes = bench_generate(path, mib << 20);
+  state.file = fopen(path, "r");
+  if (!state.bytes || !state.file || !text_splitter_map(&state.splitter, path, ',', '"')) {
+    err("failed to prepare %s: %s", path, strerror(errno));
+    unlink(path);
+    return 1;
+  }
+
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  const unsigned long max_threads = (cpus > MAX_THREADS ? MAX_THREADS : (cpus > 0 ? cpus : 1));
+  for (unsigned long t = 0; t < MAX_THREADS; t++)
+    state.workers[t].fields = dynamic_arr_new(text_span);
+
+  info("%lu MiB of delimited text in %s", state.bytes >> 20, path);
+
+  time_testrun_results results[3 + MAX_THREADS];
+  unsigned long num = 0;
+
+  time_test (*const funcs[])(unsigned int, void*) = { bench_strtok, bench_lines };
+  const char* const captions[] = { "fgets_strtok", "text_splitter_next_line" };
+  for (int f = 0; f < 2; f++) {
+    time_testrun_template run = time_testrun_new(captions[f], tests, funcs[f], &state, TESTRUN_ENABLE_ALL);
+    time_testrun_set_warmup(&run, 1);
+    time_testrun_set_bytes(&run, state.bytes);
+
+    results[num] = time_testrun_run(&run);
+    time_testrun_print(&results[num++]);
+  }
+
+  /* Fields of every line, on chunks of 1 to `max_threads' threads */
+  for (unsigned long threads = 1; threads <= max_threads; threads <<= 1) {
+    char caption[64];
+    snprintf(caption, sizeof(caption), "text_splitter_split x%lu", threads);
+    state.threads = threads;
+
+    time_testrun_template run = time_testrun_new(caption, tests, bench_fields, &state, TESTRUN_ENABLE_ALL);
+    time_testrun_set_warmup(&run, 1);
+    time_testrun_set_bytes(&run, state.bytes);
+
+    results[num] = time_testrun_run(&run);
+    time_testrun_print(&results[num++]);
+  }
+
+  const int status = bench_report(results, num);
+
+  for (unsigned long r = 0; r < num; r++)
+    time_testrun_cleanup(&results[r]);
+  for (unsigned long t = 0; t < MAX_THREADS; t++)
+    dynamic_arr_cleanup(&state.workers[t].fields);
+  text_splitter_cleanup(&state.splitter);
+  fclose(state.file);
+  unlink(path);
+
+  return status;
+}
@@ -0,0 +1,153 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/arrays/tree.h>
+#include <blib/testing/time/time_tests.h>
+#include <util.h>
+
+#include "report.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_TESTS 16UL
+#define DEFAULT_MAX   1000000UL
+#define EDITS         256
+#define SIZES         8
+
+typedef struct {
+  dynamic_arr arr;
+  tree_arr tree;
+  uint64_t seed;
+} bench_state;
+
+static uint64_t bench_random(bench_state* state) {
+  state->seed ^= state->seed << 13;
+  state->seed ^= state->seed >> 7;
+  state->seed ^= state->seed << 17;
+  return state->seed;
+}
+
+/* Random-position edits keep the size, an insertion and a removal each */
+static time_test bench_arr_edits(unsigned int index, void* data) {
+  bench_state* state = data;
+  const uint32_t value = index;
+
+  time_test test = time_test_start("dynamic_arr");
+  for (int e = 0; e < EDITS; e++) {
+    dynamic_arr_insert_at(&state->arr, bench_random(state) % state->arr.num, &value);
+    dynamic_arr_remove_at(&state->arr, bench_random(state) % state->arr.num, NULL);
+  }
+  time_test_end(&test);
+
+  test.ops = 2 * EDITS;
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+static time_test bench_tree_edits(unsigned int index, void* data) {
+  bench_state* state = data;
+  const uint32_t value = index;
+
+  time_test test = time_test_start("tree_arr");
+  for (int e = 0; e < EDITS; e++) {
+    tree_arr_insert_at(&state->tree, bench_random(state) % state->tree.num, &value);
+    tree_arr_remove_at(&state->tree, bench_random(state) % state->tree.num, NULL);
+  }
+  time_test_end(&test);
+
+  test.ops = 2 * EDITS;
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+/* In-order reads, the price of the tree */
+static time_test bench_arr_scan(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  const uint32_t* values = dynamic_arr_get_start(&state->arr);
+  uint64_t sum = 0;
+
+  time_test test = time_test_start("dynamic_arr scan");
+  for (unsigned long i = 0; i < state->arr.num; i++)
+    sum += values[i];
+  time_test_end(&test);
+
+  test.ops = state->arr.num;
+  test.state = (sum ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+static time_test bench_tree_scan(unsigned int index, void* data) {
+  (void)index;
+  bench_state* state = data;
+  uint64_t sum = 0;
+
+  time_test test = time_test_start("tree_arr scan");
+  tree_arr_iter iter = tree_arr_iter_new(&state->tree, 0);
+  unsigned long num;
+  const uint32_t* block;
+  while ((block = tree_arr_iter_block(&iter, &num))) {
+    for (unsigned long i = 0; i < num; i++)
+      sum += block[i];
+  }
+  time_test_end(&test);
+
+  test.ops = state->tree.num;
+  test.state = (sum ? TEST_SUCCESS : TEST_FAILURE);
+
+  return test;
+}
+
+int main(int ac, const char** av) {
+  set_prog_name(av[0]);
+
+  const unsigned long tests = (ac > 1 ? strtoul(av[1], NULL, 0) : DEFAULT_TESTS);
+  const unsigned long max = (ac > 2 ? strtoul(av[2], NULL, 0) : DEFAULT_MAX);
+
+  enum { RUN_ARR, RUN_TREE, RUN_ARR_SCAN, RUN_TREE_SCAN, RUNS };
+  const char* const names[RUNS] = { "dynamic_arr edits", "tree_arr edits", "dynamic_arr scan", "tree_arr scan" };
+  time_test (*const funcs[RUNS])(unsigned int, void*) = { bench_arr_edits, bench_tree_edits, bench_arr_scan, bench_tree_scan };
+  char captions[SIZES][RUNS][64];
+  time_testrun_results results[SIZES * RUNS];
+  unsigned long num = 0;
+  unsigned long crossover = 0;
+
+  for (unsigned long size = 1000, s = 0; size <= max && s < SIZES; size *= 10, s++) {
+    bench_state state = { dynamic_arr_new(uint32_t), {0}, 0x9e3779b97f4a7c15ULL };
+    for (uint32_t i = 0; i < size; i++)
+      dynamic_arr_append(&state.arr, &(uint32_t){ i + 1 });
+    state.tree = tree_arr_from_dynamic(&state.arr);
+
+    for (int r = 0; r < RUNS; r++) {
+      snprintf(captions[s][r], sizeof(captions[s][r]), "%s (%lu)", names[r], size);
+
+      time_testrun_template run = time_testrun_new(captions[s][r], tests, funcs[r], &state, TESTRUN_ENABLE_ALL);
+      time_testrun_set_warmup(&run, 2);
+
+      results[num] = time_testrun_run(&run);
+      time_testrun_print(&results[num++]);
+    }
+
+    /* Smallest size the edits of the tree won at */
+    if (!crossover && results[num - RUNS + RUN_TREE].stats.median < results[num - RUNS + RUN_ARR].stats.median)
+      crossover = size;
+
+    dynamic_arr_cleanup(&state.arr);
+    tree_arr_cleanup(&state.tree);
+  }
+
+  if (crossover)
+    info("tree_arr edits are faster from %lu elements on", crossover);
+  else
+    info("dynamic_arr edits were faster at every size");
+
+  const int status = bench_report(results, num);
+
+  for (unsigned long r = 0; r < num; r++)
+    time_testrun_cleanup(&results[r]);
+
+  return status;
+}
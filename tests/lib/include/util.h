@@ -1,5 +1,7 @@
 #ifndef __UTIL_H__
 #define __UTIL_H__
+#include <blib/logging/logger.h>
+
 #include <stdio.h>
 
 #ifndef TESTS_INFO_PREFIX
@@ -27,25 +29,27 @@
 #endif
 
 /**
- * @brief Set program name 
+ * @brief Set program name, every log line starts with it
  * @param name Name of the program
  */
 void set_prog_name(const char* name);
-
-void __intern_log_base(FILE* file, const char* prefix, const char* srcfile, int srcline, const char* fmt, ...);
+/**
+ * @brief Get the program name set last, "unknown" before `set_prog_name()'
+ */
+const char* get_prog_name(void);
 
 /**
- * @brief Log information to TESTS_INFO_FILE with TESTS_INFO_PREFIX
+ * @brief Log information to TESTS_INFO_FILE with TESTS_INFO_PREFIX (see `logger_log_to()')
  */
-#define info(...) (__intern_log_base(TESTS_INFO_FILE, TESTS_INFO_PREFIX, __FILE__, __LINE__, __VA_ARGS__))
+#define info(...) logger_log_to(LOGGER_INFO, TESTS_INFO_FILE, TESTS_INFO_PREFIX, __VA_ARGS__)
 /**
- * @brief Log warnings to TESTS_WARN_FILE with TESTS_WARN_PREFIX
+ * @brief Log warnings to TESTS_WARN_FILE with TESTS_WARN_PREFIX (see `logger_log_to()')
  */
-#define warn(...) (__intern_log_base(TESTS_WARN_FILE, TESTS_WARN_PREFIX, __FILE__, __LINE__, __VA_ARGS__))
+#define warn(...) logger_log_to(LOGGER_WARN, TESTS_WARN_FILE, TESTS_WARN_PREFIX, __VA_ARGS__)
 /**
- * @brief Log error to TESTS_ERR_FILE with TESTS_ERR_PREFIX
+ * @brief Log error to TESTS_ERR_FILE with TESTS_ERR_PREFIX (see `logger_log_to()')
  */
-#define err(...)  (__intern_log_base(TESTS_ERR_FILE,  TESTS_ERR_PREFIX,  __FILE__, __LINE__, __VA_ARGS__))
+#define err(...)  logger_log_to(LOGGER_ERR,  TESTS_ERR_FILE,  TESTS_ERR_PREFIX,  __VA_ARGS__)
 
 typedef struct {
   unsigned int success;
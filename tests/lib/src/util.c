@@ -1,33 +1,28 @@
 #include <util.h>
 
-#include <stdarg.h>
 #include <stdio.h>
 #include <ctype.h>
 
-const char* progname = NULL;
+static const char* prog_name = "unknown";
 
-void set_prog_name(const char* name) {
-  progname = name;
+/* Lines logged before `set_prog_name()' start with "unknown: ", as they always did */
+__attribute__((constructor)) static void util_default_name(void) {
+  logger_set_name(prog_name);
 
   return;
 }
 
-void __intern_log_base(FILE* file, const char* prefix, const char* srcfile, int srcline, const char* fmt, ...) {
-  (void)srcfile;
-  (void)srcline;
-  va_list argp;
-
-  va_start(argp, fmt);
-
-  fprintf(file, "%s: %s ", (progname ? progname : "unknown"), prefix);
-  vfprintf(file, fmt, argp);
-  fputs("\n", file);
-
-  va_end(argp);
+void set_prog_name(const char* name) {
+  prog_name = name;
+  logger_set_name(name);
 
   return;
 }
 
+const char* get_prog_name(void) {
+  return prog_name;
+}
+
 void printcarray(const char* str, unsigned long len) {
   if (!len) 
     return;
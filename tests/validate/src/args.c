@@ -0,0 +1,185 @@
+#include <blib/parsing/arguments/args.h>
+
+#include "validate.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_ARGS 16
+
+/* Where the options of the table store their values */
+typedef struct {
+  bool verbose;
+  bool quiet;
+  bool all;
+  const char* output;
+  long count;
+  double ratio;
+  unsigned int mode;
+} values;
+
+static const char* const modes[] = { "fast", "slow", NULL };
+
+static values v;
+static const args_option options[] = {
+  { 'v', "verbose", ARGS_FLAG, &v.verbose, NULL },
+  { 'q', "quiet", ARGS_FLAG, &v.quiet, NULL },
+  { 'a', NULL, ARGS_FLAG, &v.all, NULL },
+  { 'o', "output", ARGS_STRING, &v.output, NULL },
+  { 'n', "count", ARGS_INT, &v.count, NULL },
+  { 0, "ratio", ARGS_FLOAT, &v.ratio, NULL },
+  { 'm', "mode", ARGS_ENUM, &v.mode, modes },
+};
+
+/* Parses a NULL-terminated list of arguments after the program name, `av' gets the positionals */
+static args_result parse(const args_parser* parser, const char** av, const char* const* args) {
+  int ac = 1;
+  av[0] = "validate";
+  while (*args)
+    av[ac++] = *args++;
+
+  v = (values) {0};
+
+  return args_parse(parser, ac, av);
+}
+
+static bool ok(const args_result* result, int positionals) {
+  return result->error == ARGS_OK && result->positionals == positionals;
+}
+
+/* Every way of giving an option, `--' and a lone `-' */
+static void validate_forms(test_results* results, const args_parser* parser) {
+  const char* av[MAX_ARGS];
+  args_result result;
+
+  /* Clustered flags, the option taking a value takes the rest of the cluster */
+  result = parse(parser, av, (const char*[]) { "-vqofile", NULL });
+  check(results, ok(&result, 0) && v.verbose && v.quiet && !v.all && !strcmp(v.output, "file"));
+
+  result = parse(parser, av, (const char*[]) { "-avo", "file", "-n42", NULL });
+  check(results, ok(&result, 0) && v.all && v.verbose && !strcmp(v.output, "file") && v.count == 42);
+
+  result = parse(parser, av, (const char*[]) { "--count=0x10", "--ratio", "2.5", "--mode=slow", "--output=a=b", NULL });
+  check(results, ok(&result, 0) && v.count == 16 && v.ratio == 2.5 && v.mode == 1 && !strcmp(v.output, "a=b"));
+
+  result = parse(parser, av, (const char*[]) { "--count", "-7", "--output=", "-m", "fast", NULL });
+  check(results, ok(&result, 0) && v.count == -7 && !strcmp(v.output, "") && v.mode == 0);
+
+  /* Positionals keep their order, everything after `--' is one, a lone `-' is one */
+  result = parse(parser, av, (const char*[]) { "in", "-v", "-", "--quiet", "out", "--", "-q", "--count=1", "--", NULL });
+  check(results, ok(&result, 6) && v.verbose && v.quiet && v.count == 0);
+  check(results, !strcmp(av[1], "in") && !strcmp(av[2], "-") && !strcmp(av[3], "out"));
+  check(results, !strcmp(av[4], "-q") && !strcmp(av[5], "--count=1") && !strcmp(av[6], "--"));
+
+  result = parse(parser, av, (const char*[]) { "--", NULL });
+  check(results, ok(&result, 0));
+
+  result = parse(parser, av, (const char*[]) { NULL });
+  check(results, ok(&result, 0));
+}
+
+/* Every error, the argument it is in and the option it is about */
+static void validate_errors(test_results* results, const args_parser* parser) {
+  static const struct {
+    const char* args[4];
+    enum args_error error;
+    int index;
+    const args_option* option;
+  } cases[] = {
+    { { "--nope", NULL }, ARGS_UNKNOWN, 1, NULL },
+    { { "-v", "-z", NULL }, ARGS_UNKNOWN, 2, NULL },
+    { { "-vz", NULL }, ARGS_UNKNOWN, 1, NULL },
+    { { "--verbos", NULL }, ARGS_UNKNOWN, 1, NULL },
+    { { "--verbosely", NULL }, ARGS_UNKNOWN, 1, NULL },
+    { { "-o", NULL }, ARGS_MISSING_VALUE, 1, &options[3] },
+    { { "-vo", NULL }, ARGS_MISSING_VALUE, 1, &options[3] },
+    { { "x", "--count", NULL }, ARGS_MISSING_VALUE, 2, &options[4] },
+    { { "--count=abc", NULL }, ARGS_INVALID_VALUE, 1, &options[4] },
+    { { "--count", "99999999999999999999", NULL }, ARGS_INVALID_VALUE, 1, &options[4] },
+    { { "-n", "", NULL }, ARGS_INVALID_VALUE, 1, &options[4] },
+    { { "--ratio=1.5x", NULL }, ARGS_INVALID_VALUE, 1, &options[5] },
+    { { "--mode=medium", NULL }, ARGS_INVALID_VALUE, 1, &options[6] },
+    { { "--verbose=1", NULL }, ARGS_UNEXPECTED_VALUE, 1, &options[0] },
+    { { "-v", "--quiet=", NULL }, ARGS_UNEXPECTED_VALUE, 2, &options[1] },
+  };
+  bool seen[ARGS_ERRORS] = { true };
+  const char* av[MAX_ARGS];
+
+  for (unsigned long c = 0; c < sizeof(cases) / sizeof(*cases); c++) {
+    const args_result result = parse(parser, av, cases[c].args);
+    check(results, result.error == cases[c].error && result.index == cases[c].index && result.option == cases[c].option);
+    seen[cases[c].error] = true;
+  }
+
+  /* Options before the error are set already */
+  parse(parser, av, (const char*[]) { "-v", "--count=3", "--nope", "-q", NULL });
+  check(results, v.verbose && v.count == 3 && !v.quiet);
+
+  /* Every error is covered and described differently */
+  for (int e = 0; e < ARGS_ERRORS; e++) {
+    check(results, seen[e]);
+    for (int other = 0; other < e; other++)
+      check(results, strcmp(args_error_str(e), args_error_str(other)));
+  }
+  check(results, !strcmp(args_error_str(ARGS_ERRORS), "unknown error"));
+}
+
+/* A full table of long names, found through the perfect hash, and names close to them that aren't */
+static void validate_full_table(test_results* results) {
+  static char names[ARGS_MAX_OPTIONS][24];
+  static bool set[ARGS_MAX_OPTIONS];
+  static args_option table[ARGS_MAX_OPTIONS];
+  const char* av[MAX_ARGS];
+
+  for (unsigned int o = 0; o < ARGS_MAX_OPTIONS; o++) {
+    /* Names of different lengths sharing prefixes */
+    snprintf(names[o], sizeof(names[o]), "%.*s%u", (int)(o % 7) + 1, "option-", o);
+    table[o] = (args_option) {
+      .short_name = (o < 26 ? 'a' + o : (o < 52 ? 'A' + o - 26 : 0)),
+      .long_name = names[o],
+      .type = ARGS_FLAG,
+      .value = &set[o],
+    };
+  }
+
+  const args_parser parser = args_parser_new(table, ARGS_MAX_OPTIONS);
+
+  bool found = true;
+  for (unsigned int o = 0; o < ARGS_MAX_OPTIONS; o++) {
+    char arg[32];
+    snprintf(arg, sizeof(arg), "--%s", names[o]);
+    memset(set, 0, sizeof(set));
+
+    av[0] = "validate";
+    av[1] = arg;
+    const args_result result = args_parse(&parser, 2, av);
+    found &= (result.error == ARGS_OK);
+    for (unsigned int other = 0; other < ARGS_MAX_OPTIONS; other++)
+      found &= (set[other] == (other == o));
+
+    /* One more character is no name, one less may be another one */
+    strcat(arg, "x");
+    found &= (args_parse(&parser, 2, av).error == ARGS_UNKNOWN);
+    arg[strlen(arg) - 2] = '\0';
+    bool known = false;
+    for (unsigned int other = 0; other < ARGS_MAX_OPTIONS; other++)
+      known |= !strcmp(arg + 2, names[other]);
+    found &= (args_parse(&parser, 2, av).error == (known ? ARGS_OK : ARGS_UNKNOWN));
+  }
+  check(results, found);
+
+  /* Short names of the same table, clustered */
+  memset(set, 0, sizeof(set));
+  av[1] = "-azAZ";
+  check(results, args_parse(&parser, 2, av).error == ARGS_OK && set[0] && set[25] && set[26] && set[51] && !set[1]);
+}
+
+void validate_args(test_results* results, unsigned long tests) {
+  (void)tests;
+
+  const args_parser parser = args_parser_new(options, sizeof(options) / sizeof(*options));
+  validate_forms(results, &parser);
+  validate_errors(results, &parser);
+  validate_full_table(results);
+}
@@ -0,0 +1,520 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/memory/alloc.h>
+
+#include "validate.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MODEL_MAX     512 /* Elements the randomized rounds keep at most */
+#define MODEL_BULK    24  /* Elements a bulk operation takes at most */
+#define ELEMENT_MAX   24  /* Largest element size tested */
+#define OPS_PER_ROUND 16
+#define COW_ELEMENTS  16
+#define ALIGN_ELEMENT 64  /* Largest padded element tested */
+#define ALIGN_MAX     256 /* Elements the aligned arrays keep at most */
+#define COW_MUTATORS  21
+#define COW_VIEW_ONLY 12 /* quick_precate only moves the start of the view, the memory stays shared */
+
+/* A plain array every operation is mirrored on */
+typedef struct {
+  unsigned int size;
+  unsigned long num;
+  uint8_t data[MODEL_MAX * ELEMENT_MAX];
+} model;
+
+static bool equals(const dynamic_arr* arr, const uint32_t* expected, unsigned long num) {
+  return arr->num == num && (!num || !memcmp(dynamic_arr_get_start(arr), expected, num * sizeof(*expected)));
+}
+
+static bool model_equals(const dynamic_arr* arr, const model* m) {
+  return arr->num == m->num && (!m->num || !memcmp(dynamic_arr_get_start(arr), m->data, m->num * m->size));
+}
+
+static void model_insert(model* m, unsigned long index, const uint8_t* elements, unsigned long num) {
+  memmove(m->data + (index + num) * m->size, m->data + index * m->size, (m->num - index) * m->size);
+  memcpy(m->data + index * m->size, elements, num * m->size);
+  m->num += num;
+}
+
+static void model_remove(model* m, unsigned long index, unsigned long num) {
+  memmove(m->data + index * m->size, m->data + (index + num) * m->size, (m->num - index - num) * m->size);
+  m->num -= num;
+}
+
+static void fill(dynamic_arr* arr, uint32_t num) {
+  for (uint32_t i = 0; i < num; i++)
+    dynamic_arr_append(arr, &i);
+}
+
+/* Regressions of the multi-element moves and the deadzone, on arrays of 0..9 */
+static void validate_moves(test_results* results) {
+  uint32_t inserts[3] = { 100, 101, 102 };
+  uint32_t removed[4];
+
+  dynamic_arr arr = dynamic_arr_new(uint32_t);
+  fill(&arr, 10);
+  dynamic_arr_bulk_insert_at(&arr, 5, inserts, 3);
+  const uint32_t bulk_insert[] = { 0, 1, 2, 3, 4, 100, 101, 102, 5, 6, 7, 8, 9 };
+  check(results, equals(&arr, bulk_insert, 13));
+
+  dynamic_arr_bulk_remove_at(&arr, 3, removed, 4);
+  const uint32_t bulk_remove[] = { 0, 1, 2, 102, 5, 6, 7, 8, 9 };
+  const uint32_t bulk_removed[] = { 3, 4, 100, 101 };
+  check(results, equals(&arr, bulk_remove, 9));
+  check(results, !memcmp(removed, bulk_removed, sizeof(removed)));
+  dynamic_arr_cleanup(&arr);
+
+  /* Two elements of deadzone, prepending three takes it and moves the rest */
+  arr = dynamic_arr_new(uint32_t);
+  fill(&arr, 10);
+  dynamic_arr_quick_precate(&arr, NULL);
+  dynamic_arr_quick_precate(&arr, NULL);
+  dynamic_arr_bulk_prepend(&arr, inserts, 3);
+  const uint32_t bulk_prepend[] = { 100, 101, 102, 2, 3, 4, 5, 6, 7, 8, 9 };
+  check(results, equals(&arr, bulk_prepend, 11));
+  dynamic_arr_cleanup(&arr);
+
+  arr = dynamic_arr_new(uint32_t);
+  fill(&arr, 10);
+  dynamic_arr_quick_precate(&arr, NULL);
+  dynamic_arr_insert_at(&arr, 2, &inserts[0]);
+  const uint32_t insert[] = { 1, 2, 100, 3, 4, 5, 6, 7, 8, 9 };
+  check(results, equals(&arr, insert, 10));
+
+  dynamic_arr_quick_precate(&arr, NULL);
+  dynamic_arr_quick_precate(&arr, NULL);
+  dynamic_arr_bulk_insert_at(&arr, 1, inserts, 2);
+  const uint32_t deadzone_insert[] = { 100, 100, 101, 3, 4, 5, 6, 7, 8, 9 };
+  check(results, equals(&arr, deadzone_insert, 10));
+  dynamic_arr_cleanup(&arr);
+}
+
+/* Flips of a full array and of one with a deadzone, where there is no spare room to swap through */
+static void validate_flips(test_results* results) {
+  dynamic_arr arr = dynamic_arr_new(uint32_t);
+  fill(&arr, 8);
+  dynamic_arr_trim(&arr);
+  dynamic_arr_flip(&arr, 0, 7);
+  dynamic_arr_bulk_flip(&arr, 1, 4, 3);
+  const uint32_t full[] = { 7, 4, 5, 6, 1, 2, 3, 0 };
+  check(results, equals(&arr, full, 8));
+  dynamic_arr_cleanup(&arr);
+
+  arr = dynamic_arr_new(uint32_t);
+  fill(&arr, 9);
+  dynamic_arr_quick_precate(&arr, NULL);
+  dynamic_arr_flip(&arr, 0, 5);
+  dynamic_arr_bulk_flip(&arr, 1, 5, 3);
+  const uint32_t deadzone[] = { 6, 1, 7, 8, 5, 2, 3, 4 };
+  check(results, equals(&arr, deadzone, 8));
+  dynamic_arr_cleanup(&arr);
+
+  /* Swapped in chunks through the stack */
+  arr = dynamic_arr_new(uint32_t);
+  fill(&arr, 400);
+  dynamic_arr_bulk_flip(&arr, 0, 200, 200);
+  bool flipped = true;
+  for (uint32_t i = 0; i < 400; i++) {
+    uint32_t value;
+    dynamic_arr_peek(&arr, i, &value);
+    flipped &= (value == (i + 200) % 400);
+  }
+  check(results, flipped);
+  dynamic_arr_cleanup(&arr);
+}
+
+/* Random operations on arrays of 1, 4 and 24 byte elements, mirrored on a plain array */
+static void validate_random_ops(test_results* results, unsigned long tests) {
+  static model m;
+  static const unsigned int sizes[] = { 1, 4, ELEMENT_MAX };
+  uint64_t seed = 0x2545f4914f6cdd1dULL;
+  uint8_t elements[MODEL_BULK * ELEMENT_MAX], out[MODEL_BULK * ELEMENT_MAX];
+
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+    dynamic_arr arr = __intern_dynamic_generic_arr_new(sizes[s]);
+    m.size = sizes[s];
+    m.num = 0;
+
+    for (unsigned long op = 0; op < tests * OPS_PER_ROUND; op++) {
+      for (unsigned int b = 0; b < sizeof(elements); b++)
+        elements[b] = validate_random(&seed);
+
+      const unsigned long num = 1 + validate_random(&seed) % MODEL_BULK;
+      const unsigned long index = validate_random(&seed) % (m.num + 1);
+      const bool room = (m.num + num <= MODEL_MAX);
+      const bool full = (m.num && index < m.num);
+      const unsigned long removable = (index + num <= m.num ? num : m.num - index);
+      bool outs = true;
+
+      switch (validate_random(&seed) % 19) {
+        case 0: if (room) { dynamic_arr_append(&arr, elements); model_insert(&m, m.num, elements, 1); } break;
+        case 1: if (room) { dynamic_arr_bulk_append(&arr, elements, num); model_insert(&m, m.num, elements, num); } break;
+        case 2: if (room) { dynamic_arr_prepend(&arr, elements); model_insert(&m, 0, elements, 1); } break;
+        case 3: if (room) { dynamic_arr_bulk_prepend(&arr, elements, num); model_insert(&m, 0, elements, num); } break;
+        case 4: if (room && full) { dynamic_arr_insert_at(&arr, index, elements); model_insert(&m, index, elements, 1); } break;
+        case 5: if (room && full) { dynamic_arr_bulk_insert_at(&arr, index, elements, num); model_insert(&m, index, elements, num); } break;
+        case 6:
+          if (m.num) {
+            dynamic_arr_precate(&arr, out);
+            outs = !memcmp(out, m.data, m.size);
+            model_remove(&m, 0, 1);
+          }
+          break;
+        case 7:
+          if (m.num) {
+            dynamic_arr_quick_precate(&arr, out);
+            outs = !memcmp(out, m.data, m.size);
+            model_remove(&m, 0, 1);
+          }
+          break;
+        case 8:
+          if (m.num) {
+            dynamic_arr_truncate(&arr, out);
+            outs = !memcmp(out, m.data + (m.num - 1) * m.size, m.size);
+            model_remove(&m, m.num - 1, 1);
+          }
+          break;
+        case 9:
+          if (full) {
+            dynamic_arr_remove_at(&arr, index, out);
+            outs = !memcmp(out, m.data + index * m.size, m.size);
+            model_remove(&m, index, 1);
+          }
+          break;
+        case 10:
+          if (full) {
+            dynamic_arr_quick_remove_at(&arr, index, out);
+            outs = !memcmp(out, m.data + index * m.size, m.size);
+            model_remove(&m, index, 1);
+          }
+          break;
+        case 11:
+          if (full) {
+            dynamic_arr_bulk_remove_at(&arr, index, out, removable);
+            outs = !memcmp(out, m.data + index * m.size, removable * m.size);
+            model_remove(&m, index, removable);
+          }
+          break;
+        case 12:
+          if (full) {
+            dynamic_arr_replace(&arr, index, elements);
+            memcpy(m.data + index * m.size, elements, m.size);
+          }
+          break;
+        case 13:
+          if (full) {
+            dynamic_arr_bulk_replace(&arr, index, elements, removable);
+            memcpy(m.data + index * m.size, elements, removable * m.size);
+          }
+          break;
+        case 14:
+          if (full) {
+            dynamic_arr_set(&arr, index, elements, removable);
+            for (unsigned long i = 0; i < removable; i++)
+              memcpy(m.data + (index + i) * m.size, elements, m.size);
+          }
+          break;
+        case 15:
+          if (full) {
+            const unsigned long other = validate_random(&seed) % m.num;
+            dynamic_arr_flip(&arr, index, other);
+            memcpy(out, m.data + index * m.size, m.size);
+            memcpy(m.data + index * m.size, m.data + other * m.size, m.size);
+            memcpy(m.data + other * m.size, out, m.size);
+          }
+          break;
+        case 16:
+          /* Two ranges that don't overlap, of up to half the array each */
+          if (m.num >= 2) {
+            const unsigned long len = 1 + validate_random(&seed) % (m.num / 2);
+            const unsigned long first = validate_random(&seed) % (m.num - 2 * len + 1);
+            const unsigned long second = first + len + validate_random(&seed) % (m.num - first - 2 * len + 1);
+            uint8_t swap[MODEL_MAX / 2 * ELEMENT_MAX];
+
+            dynamic_arr_bulk_flip(&arr, first, second, len);
+            memcpy(swap, m.data + first * m.size, len * m.size);
+            memcpy(m.data + first * m.size, m.data + second * m.size, len * m.size);
+            memcpy(m.data + second * m.size, swap, len * m.size);
+          }
+          break;
+        case 17:
+          dynamic_arr_trim(&arr);
+          break;
+        case 18:
+          if (full) {
+            dynamic_arr_bulk_peek(&arr, index, out, removable);
+            outs = !memcmp(out, m.data + index * m.size, removable * m.size);
+            dynamic_arr_peek(&arr, index, out);
+            outs &= !memcmp(out, m.data + index * m.size, m.size);
+          }
+          break;
+      }
+
+      check(results, outs && model_equals(&arr, &m));
+    }
+
+    /* Shrinking hands out the elements cut off */
+    const unsigned long half = m.num / 2;
+    uint8_t cut[MODEL_MAX * ELEMENT_MAX];
+    dynamic_arr_resize_to(&arr, cut, half);
+    check(results, !memcmp(cut, m.data + half * m.size, (m.num - half) * m.size));
+    m.num = half;
+    check(results, model_equals(&arr, &m));
+
+    dynamic_arr_cleanup(&arr);
+  }
+}
+
+/* Every modifying function once, with arguments that fit an array of COW_ELEMENTS */
+static void cow_mutate(dynamic_arr* arr, unsigned int op, uint32_t* out) {
+  uint32_t elements[4] = { 100, 101, 102, 103 };
+
+  switch (op) {
+    case 0: dynamic_arr_replace(arr, 3, elements); break;
+    case 1: dynamic_arr_bulk_replace(arr, 2, elements, 4); break;
+    case 2: dynamic_arr_set(arr, 5, elements, 3); break;
+    case 3: dynamic_arr_flip(arr, 0, 9); break;
+    case 4: dynamic_arr_bulk_flip(arr, 1, 8, 4); break;
+    case 5: dynamic_arr_append(arr, elements); break;
+    case 6: dynamic_arr_bulk_append(arr, elements, 4); break;
+    case 7: dynamic_arr_prepend(arr, elements); break;
+    case 8: dynamic_arr_bulk_prepend(arr, elements, 4); break;
+    case 9: dynamic_arr_insert_at(arr, 4, elements); break;
+    case 10: dynamic_arr_bulk_insert_at(arr, 4, elements, 4); break;
+    case 11: dynamic_arr_precate(arr, out); break;
+    case 12: dynamic_arr_quick_precate(arr, out); break;
+    case 13: dynamic_arr_truncate(arr, out); break;
+    case 14: dynamic_arr_resize_to(arr, out, 6); break;
+    case 15: dynamic_arr_reserve(arr, 64); break;
+    case 16: dynamic_arr_trim(arr); break;
+    case 17: dynamic_arr_remove_at(arr, 6, out); break;
+    case 18: dynamic_arr_bulk_remove_at(arr, 3, out, 5); break;
+    case 19: dynamic_arr_quick_remove_at(arr, 6, out); break;
+    case 20: dynamic_arr_unshare(arr); break;
+  }
+}
+
+/*
+ * Either side of a copy is modified by every mutator, with and without a deadzone in the shared
+ * memory. The other side keeps its elements, the modified one ends up like a private array
+ * modified the same way.
+ */
+static void validate_cow_mutators(test_results* results) {
+  for (unsigned int op = 0; op < COW_MUTATORS; op++) {
+    for (unsigned int deadzone = 0; deadzone <= 1; deadzone++) {
+      for (unsigned int side = 0; side <= 1; side++) {
+        uint32_t out[COW_ELEMENTS] = {0}, ref_out[COW_ELEMENTS] = {0}, before[COW_ELEMENTS];
+
+        dynamic_arr base = dynamic_arr_new(uint32_t);
+        fill(&base, COW_ELEMENTS + deadzone);
+        if (deadzone)
+          dynamic_arr_quick_precate(&base, NULL);
+        dynamic_arr ref = dynamic_arr_copy(&base);
+        memcpy(before, dynamic_arr_get_start(&base), sizeof(before));
+
+        dynamic_arr_enable_cow(&base);
+        dynamic_arr copy = dynamic_arr_copy(&base);
+        check(results, copy.__malloc_start__ == base.__malloc_start__ && *base.__refs__ == 2);
+
+        dynamic_arr* mutated = (side ? &copy : &base);
+        dynamic_arr* other = (side ? &base : &copy);
+        cow_mutate(mutated, op, out);
+        cow_mutate(&ref, op, ref_out);
+
+        check(results, equals(other, before, COW_ELEMENTS));
+        check(results, equals(mutated, dynamic_arr_get_start(&ref), ref.num));
+        check(results, !memcmp(out, ref_out, sizeof(out)));
+        check(results, (mutated->__malloc_start__ == other->__malloc_start__) == (op == COW_VIEW_ONLY));
+        check(results, *mutated->__refs__ == (op == COW_VIEW_ONLY ? 2UL : 1UL));
+
+        /* The other side holds its memory alone now and is modified without copying it */
+        const blib_alloc_stats alone = blib_alloc_stats_get();
+        cow_mutate(other, op, out);
+        check(results, equals(other, dynamic_arr_get_start(&ref), ref.num));
+        check(results, blib_alloc_stats_get().mallocs == alone.mallocs);
+
+        dynamic_arr_cleanup(&base);
+        dynamic_arr_cleanup(&copy);
+        dynamic_arr_cleanup(&ref);
+      }
+    }
+  }
+}
+
+/* Memory shared by three arrays is freed by the last one out, exactly once */
+static void validate_cow_holders(test_results* results) {
+  dynamic_arr base = dynamic_arr_new(uint32_t);
+  fill(&base, COW_ELEMENTS);
+  dynamic_arr_enable_cow(&base);
+  dynamic_arr first = dynamic_arr_copy(&base);
+  dynamic_arr second = dynamic_arr_copy(&first);
+  check(results, *base.__refs__ == 3);
+
+  uint32_t value = 100;
+  dynamic_arr_replace(&first, 0, &value);
+  check(results, *base.__refs__ == 2 && second.__malloc_start__ == base.__malloc_start__);
+
+  blib_alloc_stats stats = blib_alloc_stats_get();
+  dynamic_arr_cleanup(&base);
+  check(results, blib_alloc_stats_get().frees == stats.frees && *second.__refs__ == 1);
+
+  /* The buffer and its count */
+  dynamic_arr_cleanup(&second);
+  check(results, blib_alloc_stats_get().frees == stats.frees + 2);
+
+  dynamic_arr_cleanup(&first);
+  check(results, blib_alloc_stats_get().frees == stats.frees + 4);
+}
+
+/* Nothing shared is leaked or freed twice: every allocation is freed and the live bytes are back */
+static void validate_cow(test_results* results) {
+  const bool tracked = blib_alloc_track(true);
+  const blib_alloc_stats before = blib_alloc_stats_get();
+
+  validate_cow_mutators(results);
+  validate_cow_holders(results);
+
+  const blib_alloc_stats after = blib_alloc_stats_get();
+  check(results, after.mallocs - before.mallocs == after.frees - before.frees);
+  check(results, after.live == before.live);
+  blib_alloc_track(tracked);
+}
+
+typedef struct {
+  unsigned int size;
+  unsigned int alignment;
+  bool pad;
+} align_config;
+
+static bool aligned_equals(const dynamic_arr* arr, const dynamic_arr* ref) {
+  return ((uintptr_t)dynamic_arr_get_start(arr) % arr->__align__) == 0 && arr->num == ref->num &&
+    (!ref->num || !memcmp(dynamic_arr_get_start(arr), dynamic_arr_get_start(ref), ref->num * ref->element_size));
+}
+
+/*
+ * Random operations on an aligned array mirrored on an unaligned one, the start stays aligned
+ * through growth, shrinking, trimming, prepending into the deadzone and precating. Elements not
+ * a multiple of the alignment can't have a deadzone, the quick functions fall back.
+ */
+static void validate_aligned(test_results* results, const align_config* config, unsigned long tests, uint64_t* seed) {
+  uint8_t elements[MODEL_BULK * ALIGN_ELEMENT], out[ALIGN_MAX * ALIGN_ELEMENT] = {0}, ref_out[ALIGN_MAX * ALIGN_ELEMENT] = {0};
+
+  dynamic_arr arr = __intern_dynamic_generic_arr_new_aligned(config->size, config->alignment, config->pad);
+  dynamic_arr ref = __intern_dynamic_generic_arr_new(arr.element_size);
+  const unsigned int size = arr.element_size;
+  const bool deadzone = !(size % config->alignment);
+  check(results, !config->pad || size % config->alignment == 0);
+
+  for (unsigned long op = 0; op < tests; op++) {
+    for (unsigned int b = 0; b < MODEL_BULK * size; b++)
+      elements[b] = validate_random(seed);
+
+    const unsigned long num = 1 + validate_random(seed) % MODEL_BULK;
+    const unsigned long index = (ref.num ? validate_random(seed) % ref.num : 0);
+    const bool room = (ref.num + num <= ALIGN_MAX);
+    const unsigned long removable = (index + num <= ref.num ? num : ref.num - index);
+    unsigned long cut = 1; /* Elements written to `out' */
+
+    switch (validate_random(seed) % 12) {
+      case 0:
+        if (room) { dynamic_arr_bulk_append(&arr, elements, num); dynamic_arr_bulk_append(&ref, elements, num); }
+        break;
+      case 1:
+        if (room) { dynamic_arr_prepend(&arr, elements); dynamic_arr_prepend(&ref, elements); }
+        break;
+      case 2:
+        if (room) { dynamic_arr_bulk_prepend(&arr, elements, num); dynamic_arr_bulk_prepend(&ref, elements, num); }
+        break;
+      case 3:
+        if (room && ref.num) { dynamic_arr_bulk_insert_at(&arr, index, elements, num); dynamic_arr_bulk_insert_at(&ref, index, elements, num); }
+        break;
+      case 4:
+        if (ref.num) { dynamic_arr_precate(&arr, out); dynamic_arr_precate(&ref, ref_out); }
+        break;
+      case 5:
+        if (ref.num) {
+          const unsigned long before = arr.__deadzone__;
+          dynamic_arr_quick_precate(&arr, out);
+          dynamic_arr_quick_precate(&ref, ref_out);
+          check(results, (arr.__deadzone__ == before + 1) == deadzone);
+        }
+        break;
+      case 6:
+        if (ref.num) {
+          dynamic_arr_quick_remove_at(&arr, index, out);
+          dynamic_arr_quick_remove_at(&ref, index, ref_out);
+          check(results, deadzone || !arr.__deadzone__);
+        }
+        break;
+      case 7:
+        if (ref.num) { dynamic_arr_bulk_remove_at(&arr, index, out, removable); dynamic_arr_bulk_remove_at(&ref, index, ref_out, removable); }
+        cut = removable;
+        break;
+      case 8:
+        dynamic_arr_trim(&arr);
+        dynamic_arr_trim(&ref);
+        break;
+      case 9:
+        dynamic_arr_reserve(&arr, num * 8);
+        dynamic_arr_reserve(&ref, num * 8);
+        break;
+      case 10: {
+        const unsigned long had = ref.num;
+        const unsigned long to = validate_random(seed) % ALIGN_MAX;
+        dynamic_arr_resize_to(&arr, out, to);
+        dynamic_arr_resize_to(&ref, ref_out, to);
+        cut = (to < had ? had - to : 0);
+
+        /* Elements grown into aren't initialized */
+        if (to > had) {
+          dynamic_arr_set(&arr, had, elements, to - had);
+          dynamic_arr_set(&ref, had, elements, to - had);
+        }
+        break;
+      }
+      case 11:
+        if (ref.num) { dynamic_arr_truncate(&arr, out); dynamic_arr_truncate(&ref, ref_out); }
+        break;
+    }
+
+    check(results, aligned_equals(&arr, &ref) && !memcmp(out, ref_out, cut * size));
+  }
+
+  /* Copies, private or taken over from shared memory, are aligned as well */
+  dynamic_arr copy = dynamic_arr_copy(&arr);
+  check(results, copy.__align__ == config->alignment && aligned_equals(&copy, &ref));
+  dynamic_arr_enable_cow(&copy);
+  dynamic_arr shared = dynamic_arr_copy(&copy);
+  dynamic_arr_unshare(&shared);
+  check(results, aligned_equals(&shared, &ref));
+
+  dynamic_arr_cleanup(&shared);
+  dynamic_arr_cleanup(&copy);
+  dynamic_arr_cleanup(&arr);
+  dynamic_arr_cleanup(&ref);
+}
+
+static void validate_alignment(test_results* results, unsigned long tests) {
+  static const align_config configs[] = {
+    { 4, 32, false }, /* Deadzone falls back */
+    { 1, 4096, false }, /* Page aligned */
+    { 64, 64, false }, /* Element of a cache line, the deadzone keeps the alignment */
+    { 4, 64, true }, /* Padded to a cache line */
+    { 24, 32, true },
+    { 40, 16, true }, /* Padded to 48, three times the alignment */
+  };
+  uint64_t seed = 0x853c49e6748fea9bULL;
+
+  for (unsigned long c = 0; c < sizeof(configs) / sizeof(*configs); c++)
+    validate_aligned(results, &configs[c], tests * OPS_PER_ROUND, &seed);
+}
+
+void validate_dynamic_arr(test_results* results, unsigned long tests) {
+  validate_moves(results);
+  validate_flips(results);
+  validate_cow(results);
+  validate_random_ops(results, tests);
+  validate_alignment(results, tests);
+}
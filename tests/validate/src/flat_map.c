@@ -0,0 +1,144 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/flat/map.h>
+
+#include "validate.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define KEYS     512 /* Keys drawn from, batches repeat them */
+#define BULK_MAX 256
+#define OPS_PER_ROUND 4
+
+/* Value of every key in the map, the reference the maps are compared with */
+typedef struct {
+  bool present[KEYS];
+  uint64_t value[KEYS];
+} model;
+
+static int key_cmp(const void* a, const void* b) {
+  const uint32_t ka = *(const uint32_t*)a, kb = *(const uint32_t*)b;
+  return (ka > kb) - (ka < kb);
+}
+
+/* Keys sorted without duplicates, every value next to its key */
+static bool map_equals(const flat_map* map, const model* m) {
+  unsigned long i = 0;
+
+  for (uint32_t key = 0; key < KEYS; key++) {
+    if (!m->present[key])
+      continue;
+    if (i == flat_map_len(map))
+      return false;
+
+    uint32_t k;
+    uint64_t value;
+    flat_map_peek(map, i, &k, &value);
+    if (k != key || value != m->value[key])
+      return false;
+    i++;
+  }
+
+  return i == flat_map_len(map);
+}
+
+/* Values replace those of existing keys, of duplicates in the batch the last one wins */
+static void model_insert(model* m, const uint32_t* keys, const uint64_t* values, unsigned long num) {
+  for (unsigned long i = 0; i < num; i++) {
+    m->present[keys[i]] = true;
+    m->value[keys[i]] = values[i];
+  }
+}
+
+static void random_batch(uint32_t* keys, uint64_t* values, unsigned long num, uint64_t* seed) {
+  for (unsigned long i = 0; i < num; i++) {
+    keys[i] = validate_random(seed) % KEYS;
+    values[i] = validate_random(seed);
+  }
+}
+
+/* Random inserts, bulk inserts with duplicates, removes and lookups */
+static void validate_ops(test_results* results, unsigned long tests, uint64_t* seed) {
+  static model m;
+  uint32_t keys[BULK_MAX];
+  uint64_t values[BULK_MAX];
+
+  memset(&m, 0, sizeof(m));
+  flat_map map = flat_map_new(uint32_t, uint64_t, key_cmp);
+
+  for (unsigned long op = 0; op < tests; op++) {
+    const uint32_t key = validate_random(seed) % KEYS;
+    const uint64_t value = validate_random(seed);
+    uint64_t out = 0;
+    unsigned long index;
+
+    switch (validate_random(seed) % 4) {
+      case 0:
+        check(results, flat_map_insert(&map, &key, &value) == !m.present[key]);
+        model_insert(&m, &key, &value, 1);
+        break;
+      case 1: {
+        const unsigned long num = validate_random(seed) % BULK_MAX;
+        random_batch(keys, values, num, seed);
+        flat_map_bulk_insert(&map, keys, values, num);
+        model_insert(&m, keys, values, num);
+        break;
+      }
+      case 2:
+        check(results, flat_map_remove(&map, &key, &out) == m.present[key]);
+        check(results, !m.present[key] || out == m.value[key]);
+        m.present[key] = false;
+        break;
+      case 3: {
+        check(results, flat_map_get(&map, &key, &out) == m.present[key]);
+        check(results, !m.present[key] || out == m.value[key]);
+
+        const bool found = flat_map_find(&map, &key, &index);
+        check(results, found == m.present[key]);
+        if (found) {
+          uint32_t k;
+          flat_map_peek(&map, index, &k, &out);
+          check(results, k == key && out == m.value[key]);
+        }
+        break;
+      }
+    }
+
+    check(results, map_equals(&map, &m));
+  }
+
+  flat_map_cleanup(&map);
+}
+
+/* Maps from unsorted arrays with duplicate keys keep the last value */
+static void validate_from_arrs(test_results* results, uint64_t* seed) {
+  static const unsigned long sizes[] = { 0, 1, 2, 31, 32, 33, 1000, 5000 };
+  static model m;
+  static uint32_t keys[5000];
+  static uint64_t values[5000];
+
+  for (unsigned long s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+    memset(&m, 0, sizeof(m));
+    random_batch(keys, values, sizes[s], seed);
+    model_insert(&m, keys, values, sizes[s]);
+
+    dynamic_arr key_arr = dynamic_arr_new(uint32_t);
+    dynamic_arr value_arr = dynamic_arr_new(uint64_t);
+    if (sizes[s]) {
+      dynamic_arr_bulk_append(&key_arr, keys, sizes[s]);
+      dynamic_arr_bulk_append(&value_arr, values, sizes[s]);
+    }
+    flat_map map = flat_map_from_arrs(&key_arr, &value_arr, key_cmp);
+    check(results, map_equals(&map, &m));
+
+    flat_map_cleanup(&map);
+  }
+}
+
+void validate_flat_map(test_results* results, unsigned long tests) {
+  uint64_t seed = 0x14057b7ef767814fULL;
+
+  validate_ops(results, tests * OPS_PER_ROUND, &seed);
+  validate_from_arrs(results, &seed);
+}
@@ -0,0 +1,197 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/flat/set.h>
+
+#include "validate.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define KEYS     512 /* Keys drawn from, batches repeat them */
+#define BULK_MAX 256
+#define OPS_PER_ROUND 4
+
+/* Ordered by key only, the tag tells equal elements apart */
+typedef struct {
+  uint32_t key;
+  uint32_t tag;
+} element;
+
+/* Tag of every key in the set, the reference the sets are compared with */
+typedef struct {
+  bool present[KEYS];
+  uint32_t tag[KEYS];
+} model;
+
+static int element_cmp(const void* a, const void* b) {
+  const uint32_t ka = ((const element*)a)->key, kb = ((const element*)b)->key;
+  return (ka > kb) - (ka < kb);
+}
+
+/* Sorted, without duplicates, with exactly the keys and tags of the model */
+static bool set_equals(const flat_set* set, const model* m) {
+  const element* elements = flat_set_get_start(set);
+  unsigned long i = 0;
+
+  for (uint32_t key = 0; key < KEYS; key++) {
+    if (!m->present[key])
+      continue;
+    if (i == flat_set_len(set) || elements[i].key != key || elements[i].tag != m->tag[key])
+      return false;
+    i++;
+  }
+
+  return i == flat_set_len(set);
+}
+
+/* Elements already in the set are kept, of duplicates in the batch the first one is inserted */
+static void model_insert(model* m, const element* elements, unsigned long num) {
+  for (unsigned long i = 0; i < num; i++) {
+    if (m->present[elements[i].key])
+      continue;
+    m->present[elements[i].key] = true;
+    m->tag[elements[i].key] = elements[i].tag;
+  }
+}
+
+static void random_batch(element* batch, unsigned long num, uint32_t* tag, uint64_t* seed) {
+  for (unsigned long i = 0; i < num; i++)
+    batch[i] = (element) { validate_random(seed) % KEYS, (*tag)++ };
+}
+
+/* Random inserts, stable bulk inserts with duplicates, removes and lookups */
+static void validate_ops(test_results* results, unsigned long tests, uint64_t* seed) {
+  static model m;
+  element batch[BULK_MAX];
+  uint32_t tag = 0;
+
+  memset(&m, 0, sizeof(m));
+  flat_set set = flat_set_new(element, element_cmp);
+
+  for (unsigned long op = 0; op < tests; op++) {
+    const element e = { validate_random(seed) % KEYS, tag++ };
+    unsigned long index;
+
+    switch (validate_random(seed) % 4) {
+      case 0:
+        check(results, flat_set_insert(&set, &e) == !m.present[e.key]);
+        model_insert(&m, &e, 1);
+        break;
+      case 1: {
+        /* Up to half the keys, so batches repeat keys among themselves and with the set */
+        const unsigned long num = validate_random(seed) % BULK_MAX;
+        random_batch(batch, num, &tag, seed);
+        flat_set_bulk_insert(&set, batch, num);
+        model_insert(&m, batch, num);
+        break;
+      }
+      case 2:
+        check(results, flat_set_remove(&set, &e) == m.present[e.key]);
+        m.present[e.key] = false;
+        break;
+      case 3: {
+        const bool found = flat_set_find(&set, &e, &index);
+        check(results, found == m.present[e.key]);
+        if (found) {
+          element out;
+          flat_set_peek(&set, index, &out);
+          check(results, out.key == e.key && out.tag == m.tag[e.key]);
+        }
+
+        /* Every smaller key is before the lower bound */
+        unsigned long smaller = 0;
+        for (uint32_t key = 0; key < e.key; key++)
+          smaller += m.present[key];
+        check(results, flat_set_lower_bound(&set, &e) == smaller);
+        break;
+      }
+    }
+
+    check(results, set_equals(&set, &m));
+  }
+
+  flat_set_cleanup(&set);
+}
+
+/* Sets from unsorted arrays with duplicates keep the first of equal elements */
+static void validate_from_arr(test_results* results, uint64_t* seed) {
+  static const unsigned long sizes[] = { 0, 1, 2, 31, 32, 33, 1000, 5000 };
+  static model m;
+  static element elements[5000];
+  uint32_t tag = 0;
+
+  for (unsigned long s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+    memset(&m, 0, sizeof(m));
+    random_batch(elements, sizes[s], &tag, seed);
+    model_insert(&m, elements, sizes[s]);
+
+    dynamic_arr arr = dynamic_arr_new(element);
+    if (sizes[s])
+      dynamic_arr_bulk_append(&arr, elements, sizes[s]);
+    flat_set set = flat_set_from_arr(&arr, element_cmp);
+    check(results, set_equals(&set, &m));
+
+    flat_set_cleanup(&set);
+  }
+}
+
+/* Union, intersection and difference take the element of `a' for keys in both */
+static void validate_algebra(test_results* results, unsigned long tests, uint64_t* seed) {
+  static model ma, mb, expected;
+  element batch[BULK_MAX];
+  uint32_t tag = 0;
+
+  for (unsigned long round = 0; round < tests; round++) {
+    memset(&ma, 0, sizeof(ma));
+    memset(&mb, 0, sizeof(mb));
+    flat_set a = flat_set_new(element, element_cmp);
+    flat_set b = flat_set_new(element, element_cmp);
+
+    /* Either side may be empty */
+    const unsigned long an = validate_random(seed) % BULK_MAX, bn = validate_random(seed) % BULK_MAX;
+    random_batch(batch, an, &tag, seed);
+    flat_set_bulk_insert(&a, batch, an);
+    model_insert(&ma, batch, an);
+    random_batch(batch, bn, &tag, seed);
+    flat_set_bulk_insert(&b, batch, bn);
+    model_insert(&mb, batch, bn);
+
+    flat_set result = flat_set_union(&a, &b);
+    for (uint32_t key = 0; key < KEYS; key++) {
+      expected.present[key] = ma.present[key] || mb.present[key];
+      expected.tag[key] = (ma.present[key] ? ma.tag[key] : mb.tag[key]);
+    }
+    check(results, set_equals(&result, &expected));
+    flat_set_cleanup(&result);
+
+    result = flat_set_intersection(&a, &b);
+    for (uint32_t key = 0; key < KEYS; key++) {
+      expected.present[key] = ma.present[key] && mb.present[key];
+      expected.tag[key] = ma.tag[key];
+    }
+    check(results, set_equals(&result, &expected));
+    flat_set_cleanup(&result);
+
+    result = flat_set_difference(&a, &b);
+    for (uint32_t key = 0; key < KEYS; key++) {
+      expected.present[key] = ma.present[key] && !mb.present[key];
+      expected.tag[key] = ma.tag[key];
+    }
+    check(results, set_equals(&result, &expected));
+    flat_set_cleanup(&result);
+
+    /* The operands are left alone */
+    check(results, set_equals(&a, &ma) && set_equals(&b, &mb));
+
+    flat_set_cleanup(&a);
+    flat_set_cleanup(&b);
+  }
+}
+
+void validate_flat_set(test_results* results, unsigned long tests) {
+  uint64_t seed = 0x5851f42d4c957f2dULL;
+
+  validate_ops(results, tests * OPS_PER_ROUND, &seed);
+  validate_from_arr(results, &seed);
+  validate_algebra(results, tests / 4 + 1, &seed);
+}
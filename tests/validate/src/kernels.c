@@ -0,0 +1,198 @@
+#include <blib/memory/kernels.h>
+
+#include "validate.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BUFFER   8192
+#define GUARD    128 /* Bytes around every destination, kernels must not touch them */
+#define MAX_SIZE 72  /* Largest pattern, past the width of every vector */
+
+/* Variants the CPU runs, the scalar one is the reference of the others */
+static enum kernel_isa supported;
+
+static bool select_isa(enum kernel_isa isa) {
+  return kernel_isa_select(isa) && kernel_isa_selected() == isa;
+}
+
+static void random_bytes(uint8_t* bytes, unsigned long len, uint64_t* seed) {
+  for (unsigned long i = 0; i < len; i++)
+    bytes[i] = validate_random(seed);
+}
+
+/* Text of a few characters, sometimes only one, so every byte may match */
+static unsigned int random_text(char* text, unsigned long len, uint64_t* seed) {
+  const unsigned int alphabet = (validate_random(seed) % 4 ? 2 + validate_random(seed) % 30 : 1);
+  for (unsigned long i = 0; i < len; i++)
+    text[i] = 'a' + validate_random(seed) % alphabet;
+
+  return alphabet;
+}
+
+/* A character of the text, one that isn't in it or the null character past its end */
+static char random_char(unsigned int alphabet, uint64_t* seed) {
+  return (validate_random(seed) % 8 ? (char)('a' + validate_random(seed) % (alphabet + 2)) : '\0');
+}
+
+/* Lengths around the vector widths, sometimes long */
+static unsigned long random_len(uint64_t* seed) {
+  switch (validate_random(seed) % 4) {
+    case 0:
+      return validate_random(seed) % 4;
+    case 1:
+      return 64 * (1 + validate_random(seed) % 4) - 2 + validate_random(seed) % 5;
+    case 2:
+      return validate_random(seed) % 600;
+    default:
+      return validate_random(seed) % (BUFFER - 2 * GUARD);
+  }
+}
+
+static bool validate_fill(uint64_t* seed) {
+  static uint8_t expected[BUFFER], got[BUFFER];
+  uint8_t pattern[MAX_SIZE];
+
+  const unsigned long size = (validate_random(seed) % 2 ? 1UL << validate_random(seed) % 7 : 1 + validate_random(seed) % MAX_SIZE);
+  const unsigned long offset = GUARD + validate_random(seed) % 64;
+  const unsigned long num = random_len(seed) / size;
+  random_bytes(pattern, size, seed);
+
+  memset(expected, 0xcc, sizeof(expected));
+  select_isa(KERNEL_ISA_SCALAR);
+  kernel_fill(expected + offset, pattern, size, num);
+
+  bool same = true;
+  for (enum kernel_isa isa = KERNEL_ISA_SSE2; isa <= supported; isa++) {
+    memset(got, 0xcc, sizeof(got));
+    same &= select_isa(isa);
+    kernel_fill(got + offset, pattern, size, num);
+    if (memcmp(got, expected, sizeof(got))) {
+      err("kernel_fill of %s: %lu times %lu bytes at offset %lu", kernel_isa_str(isa), num, size, offset - GUARD);
+      same = false;
+    }
+  }
+
+  return same;
+}
+
+static bool validate_swap(uint64_t* seed) {
+  static uint8_t a[BUFFER], b[BUFFER], expected_a[BUFFER], expected_b[BUFFER];
+  static uint8_t original_a[BUFFER], original_b[BUFFER];
+
+  const unsigned long len = random_len(seed);
+  const unsigned long offset_a = GUARD + validate_random(seed) % 64, offset_b = GUARD + validate_random(seed) % 64;
+  random_bytes(original_a, BUFFER, seed);
+  random_bytes(original_b, BUFFER, seed);
+
+  memcpy(expected_a, original_a, BUFFER);
+  memcpy(expected_b, original_b, BUFFER);
+  select_isa(KERNEL_ISA_SCALAR);
+  kernel_swap(expected_a + offset_a, expected_b + offset_b, len);
+
+  bool same = true;
+  for (enum kernel_isa isa = KERNEL_ISA_SSE2; isa <= supported; isa++) {
+    memcpy(a, original_a, BUFFER);
+    memcpy(b, original_b, BUFFER);
+    same &= select_isa(isa);
+    kernel_swap(a + offset_a, b + offset_b, len);
+    if (memcmp(a, expected_a, BUFFER) || memcmp(b, expected_b, BUFFER)) {
+      err("kernel_swap of %s: %lu bytes at offsets %lu and %lu", kernel_isa_str(isa), len, offset_a - GUARD, offset_b - GUARD);
+      same = false;
+    }
+  }
+
+  return same;
+}
+
+/* Find and count of the same text, ending at the end of the buffer or before it */
+static bool validate_find_count(uint64_t* seed) {
+  static char text[BUFFER];
+
+  const unsigned long offset = validate_random(seed) % 64;
+  unsigned long len = random_len(seed);
+  if (validate_random(seed) % 4 == 0)
+    len = BUFFER - offset - validate_random(seed) % 4;
+  const unsigned int alphabet = random_text(text, BUFFER, seed);
+
+  const char* p = text + offset;
+  const char* end = p + len;
+  const char a = random_char(alphabet, seed), b = (validate_random(seed) % 4 ? random_char(alphabet, seed) : a);
+
+  select_isa(KERNEL_ISA_SCALAR);
+  const char* found = kernel_find(p, end, a, b);
+  const unsigned long count = kernel_count(p, end, a, b);
+
+  bool same = true;
+  for (enum kernel_isa isa = KERNEL_ISA_SSE2; isa <= supported; isa++) {
+    same &= select_isa(isa);
+    if (kernel_find(p, end, a, b) != found || kernel_count(p, end, a, b) != count) {
+      err("kernel_find or kernel_count of %s: '%c' or '%c' in %lu bytes at offset %lu", kernel_isa_str(isa), a, b, len, offset);
+      same = false;
+    }
+  }
+
+  return same;
+}
+
+/* Every width, with blocks not aligned to a vector */
+static bool validate_unpack(uint64_t* seed) {
+  uint32_t values[KERNEL_UNPACK_BLOCK], expected[KERNEL_UNPACK_BLOCK], got[KERNEL_UNPACK_BLOCK];
+  uint32_t packed[32 * 4 + 4];
+
+  bool same = true;
+  for (unsigned int bits = 0; bits <= 32; bits++) {
+    const uint32_t mask = (bits < 32 ? (UINT32_C(1) << bits) - 1 : ~UINT32_C(0));
+    for (unsigned int i = 0; i < KERNEL_UNPACK_BLOCK; i++)
+      values[i] = validate_random(seed) & mask;
+
+    uint32_t* block = packed + validate_random(seed) % 4;
+    kernel_pack(block, values, bits);
+
+    select_isa(KERNEL_ISA_SCALAR);
+    kernel_unpack(expected, block, bits);
+    same &= !memcmp(expected, values, sizeof(values));
+
+    for (enum kernel_isa isa = KERNEL_ISA_SSE2; isa <= supported; isa++) {
+      memset(got, 0xcc, sizeof(got));
+      same &= select_isa(isa);
+      kernel_unpack(got, block, bits);
+      if (memcmp(got, expected, sizeof(got))) {
+        err("kernel_unpack of %s: %u bits", kernel_isa_str(isa), bits);
+        same = false;
+      }
+    }
+  }
+
+  return same;
+}
+
+void validate_kernels(test_results* results, unsigned long tests) {
+  uint64_t seed = 0xbf58476d1ce4e5b9ULL;
+  const enum kernel_isa selected = kernel_isa_selected();
+  supported = kernel_isa_supported();
+
+  /* Every supported variant can be selected, the others can't */
+  for (enum kernel_isa isa = KERNEL_ISA_SCALAR; isa <= supported; isa++)
+    check(results, select_isa(isa));
+  for (unsigned int isa = supported + 1; isa <= KERNEL_ISAS; isa++) {
+    errno = 0;
+    check(results, !kernel_isa_select(isa) && errno == ENOTSUP && kernel_isa_selected() == supported);
+  }
+
+  bool fill = true, swap = true, find_count = true, unpack = true;
+  for (unsigned long t = 0; t < tests; t++) {
+    fill &= validate_fill(&seed);
+    swap &= validate_swap(&seed);
+    find_count &= validate_find_count(&seed);
+    unpack &= validate_unpack(&seed);
+  }
+  check(results, fill);
+  check(results, swap);
+  check(results, find_count);
+  check(results, unpack);
+
+  select_isa(selected);
+}
@@ -0,0 +1,294 @@
+#include <blib/logging/logger.h>
+
+#include "validate.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#define RING_SIZE (16UL * 1024) /* The smallest ring, records of a few KiB wrap around quickly */
+#define PADDING   3000 /* Characters of the records that fill the rings */
+#define DROPPED   1000 /* Records logged at once with LOGGER_DROP */
+#define THREADS   4
+#define FLUSH_EVERY 64
+
+/* What the logger has to write, every line formatted by `vsnprintf()' */
+static char* expected = NULL;
+static unsigned long expected_len = 0;
+static unsigned long expected_cap = 0;
+
+static char padding[PADDING + 1];
+
+/* "<name>: P ", how every line starts */
+static char header[256];
+static unsigned long header_len = 0;
+
+static void expect(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+static void expect(const char* fmt, ...) {
+  if (expected_len + header_len + LOGGER_MAX_MESSAGE + 1 > expected_cap) {
+    expected_cap = (expected_cap ? expected_cap * 2 : 1UL << 16);
+    expected = realloc(expected, expected_cap);
+  }
+
+  /* Every line starts with the name of the program */
+  memcpy(expected + expected_len, header, header_len);
+  expected_len += header_len;
+
+  va_list argp;
+  va_start(argp, fmt);
+  const int written = vsnprintf(expected + expected_len, LOGGER_MAX_MESSAGE, fmt, argp);
+  expected_len += (written < LOGGER_MAX_MESSAGE ? written : LOGGER_MAX_MESSAGE - 1);
+  expected[expected_len++] = '\n';
+  va_end(argp);
+}
+
+/* Logged with the prefix "P" and expected */
+#define logged(file, ...)                                 \
+  do {                                                    \
+    logger_log_to(LOGGER_INFO, file, "P", __VA_ARGS__);   \
+    expect(__VA_ARGS__);                                  \
+  } while (0)
+
+/* Everything written to the file, terminated */
+static char* read_output(FILE* file, unsigned long* len) {
+  const int fd = fileno(file);
+  const off_t size = lseek(fd, 0, SEEK_END);
+  char* data = malloc(size + 1);
+
+  *len = 0;
+  while (data && *len < (unsigned long)size) {
+    const ssize_t got = pread(fd, data + *len, size - *len, *len);
+    if (got <= 0)
+      break;
+    *len += got;
+  }
+  if (data)
+    data[*len] = 0;
+
+  return data;
+}
+
+static bool output_matches(FILE* file) {
+  unsigned long len;
+  char* data = read_output(file, &len);
+  const bool same = (data && len == expected_len && !memcmp(data, expected, len));
+  free(data);
+
+  return same;
+}
+
+/* Every conversion and length, deferred or formatted right away, reads like `vsnprintf()' */
+static void validate_formats(test_results* results) {
+  FILE* file = tmpfile();
+  expected_len = 0;
+
+  const ssize_t negative_size = -5;
+  int pointed = 0;
+
+  logged(file, "plain text, no arguments");
+  logged(file, "%% and %%%% aren't arguments");
+  logged(file, "%d %i %d %i", 0, -1, INT_MAX, INT_MIN);
+  logged(file, "%u %o %x %X", UINT_MAX, 0755U, 0xdeadbeefU, 0xcafeU);
+  logged(file, "%hhd %hhi %hhu %hhx", (signed char)-100, (signed char)27, (unsigned char)255, (unsigned char)0xab);
+  logged(file, "%hd %hi %hu %hx", (short)-30000, (short)1234, (unsigned short)65535, (unsigned short)0xbeef);
+  logged(file, "%ld %li %lu %lx", LONG_MIN, 42L, ULONG_MAX, 0x123456789abcdefUL);
+  logged(file, "%lld %lli %llu %llo %llX", LLONG_MIN, LLONG_MAX, ULLONG_MAX, 01777ULL, 0xfedcba9876543210ULL);
+  logged(file, "%zu %zx %zd", (size_t)-1, sizeof(padding), negative_size);
+  logged(file, "%jd %ju %jx", (intmax_t)INTMAX_MIN, (uintmax_t)UINTMAX_MAX, (uintmax_t)0x1234);
+  logged(file, "%td %tx", (ptrdiff_t)-77, (ptrdiff_t)0x77);
+  logged(file, "[%5d] [%-5d] [%05d] [%+d] [% d] [%.3d] [%8.3d] [%-+8.3d]", 42, 42, -42, 42, 42, 7, 7, -7);
+  logged(file, "[%#o] [%#x] [%#X] [%#.0x] [%08lx] [%-12llu] [%+hhd]", 8U, 255U, 255U, 0U, 0xabUL, 99ULL, (signed char)5);
+  logged(file, "%f %F %e %E %g %G %a %A", 3.14159, -2.5, 1e-300, 6.02e23, 0.0001, 1e20, 1.0, -0.5);
+  logged(file, "[%.0f] [%10.3f] [%-10.2e] [%+g] [%#g] [%010.4f] [%lf]", 2.5, -1.0 / 3, 12345.678, 1.5, 2.0, 3.25, 0.1);
+  logged(file, "%f %e %g", 1.0 / 0.0, -1.0 / 0.0, 0.0 / 0.0);
+  logged(file, "%c%c%c [%3c] [%-3c]", 'a', 'b', 'c', 'x', 'y');
+  logged(file, "[%s] [%10s] [%-10s] [%.2s] [%.10s] [%5.1s] [%s]", "abc", "right", "left", "truncated", "short", "z", "");
+  logged(file, "%p %p", (void*)&pointed, (void*)NULL);
+  logged(file, "%s=%d (%s) %lu%% of %.1f", "mixed", -3, "strings", 50UL, 99.95);
+  logged(file, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+
+  /* More arguments than a record holds, `*' widths, `L', wide characters: formatted right away */
+  logged(file, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17);
+  logged(file, "[%*d] [%-*d] [%.*s]", 6, 1, 4, 2, 3, "precision");
+  logged(file, "%Lf %Le", (long double)1.25, (long double)-3e100);
+  logged(file, "%lc %ls", (wint_t)'w', L"wide");
+
+  /* Longer than a message, truncated as a whole and within a deferred string */
+  logged(file, "%s%s", padding, padding);
+  logged(file, "%s %s %d", padding, padding, 1);
+  logged(file, "%-5000d|", 1);
+
+  logger_flush();
+  check(results, output_matches(file));
+
+  fclose(file);
+}
+
+/* Records of a few KiB skip the end of the ring with a marker, the order stays the same */
+static void validate_wrap(test_results* results) {
+  FILE* file = tmpfile();
+  expected_len = 0;
+
+  for (unsigned long i = 0; i < 64; i++) {
+    /* Deferred copies and eager messages of sizes that don't divide the ring */
+    const int len = (int)(i * 397 % PADDING);
+    if (i % 2)
+      logged(file, "%lu %.*s", i, len, padding);
+    else
+      logged(file, "%lu %.*s %5.1f", i, len, padding, i / 4.0);
+  }
+
+  logger_flush();
+  check(results, output_matches(file));
+
+  fclose(file);
+}
+
+/* Every record is written or counted, and the count is reported on stderr */
+static void validate_dropped(test_results* results) {
+  FILE* file = tmpfile();
+  FILE* reports = tmpfile();
+
+  fflush(stderr);
+  const int saved = dup(STDERR_FILENO);
+  dup2(fileno(reports), STDERR_FILENO);
+
+  const unsigned long before = logger_dropped();
+  for (unsigned long i = 0; i < DROPPED; i++)
+    logger_log_to(LOGGER_INFO, file, "P", "%lu %s", i, padding);
+  logger_flush();
+  const unsigned long dropped = logger_dropped() - before;
+
+  dup2(saved, STDERR_FILENO);
+  close(saved);
+
+  /* A ring of a few records can't keep up with all of them */
+  check(results, dropped > 0 && dropped < DROPPED);
+
+  unsigned long len;
+  char* data = read_output(file, &len);
+  unsigned long lines = 0;
+  long last = -1;
+  bool ordered = (data != NULL);
+  for (char* line = data; ordered && line < data + len; lines++) {
+    char* end = NULL;
+    const long i = strtol(line + header_len, &end, 10);
+    ordered = (!strncmp(line, header, header_len) && i > last && *end == ' ' && !strncmp(end + 1, padding, PADDING) && end[PADDING + 1] == '\n');
+    last = i;
+    line = end + PADDING + 2;
+  }
+  free(data);
+  check(results, ordered && lines + dropped == DROPPED);
+
+  unsigned long reported = 0;
+  data = read_output(reports, &len);
+  for (char* line = data; data && (line = strstr(line, "logger dropped ")); line++)
+    reported += strtoul(line + strlen("logger dropped "), NULL, 10);
+  free(data);
+  check(results, reported == dropped);
+
+  fclose(file);
+  fclose(reports);
+}
+
+typedef struct {
+  FILE* file;
+  unsigned int id;
+  unsigned long records;
+  bool flushed; /* Every record was written when `logger_flush()' returned */
+} producer;
+
+static void* produce(void* arg) {
+  producer* p = arg;
+  char last[32];
+
+  p->flushed = true;
+  for (unsigned long i = 0; i < p->records; i++) {
+    logger_log_to(LOGGER_INFO, p->file, "P", "%u %lu %.*s", p->id, i, (int)(i % 200), padding);
+
+    if (i % FLUSH_EVERY == FLUSH_EVERY - 1) {
+      logger_flush();
+
+      unsigned long len;
+      char* data = read_output(p->file, &len);
+      snprintf(last, sizeof(last), " P %u %lu ", p->id, i);
+      p->flushed &= (data && strstr(data, last) != NULL);
+      free(data);
+    }
+  }
+
+  return NULL;
+}
+
+/* Threads that block on full rings lose nothing, each one's records stay in order */
+static void validate_threads(test_results* results, unsigned long tests) {
+  FILE* file = tmpfile();
+  producer producers[THREADS];
+  pthread_t threads[THREADS];
+
+  for (unsigned int t = 0; t < THREADS; t++) {
+    producers[t] = (producer) { .file = file, .id = t, .records = tests + FLUSH_EVERY };
+    pthread_create(&threads[t], NULL, produce, &producers[t]);
+  }
+  for (unsigned int t = 0; t < THREADS; t++) {
+    pthread_join(threads[t], NULL);
+    check(results, producers[t].flushed);
+  }
+  logger_flush();
+
+  unsigned long len;
+  char* data = read_output(file, &len);
+  unsigned long next[THREADS] = {0};
+  bool ordered = (data != NULL);
+  for (char* line = data; ordered && line < data + len;) {
+    char* end = NULL;
+    const unsigned long t = strtoul(line + header_len, &end, 10);
+    const unsigned long i = strtoul(end, &end, 10);
+    ordered = (t < THREADS && i == next[t]);
+    if (ordered)
+      next[t]++;
+
+    line = strchr(end, '\n') + 1;
+  }
+  free(data);
+
+  for (unsigned int t = 0; t < THREADS; t++)
+    ordered &= (next[t] == producers[t].records);
+  check(results, ordered);
+
+  fclose(file);
+}
+
+void validate_logger(test_results* results, unsigned long tests) {
+  memset(padding, '.', PADDING);
+  padding[PADDING] = 0;
+  header_len = snprintf(header, sizeof(header), "%s: P ", get_prog_name());
+
+  /* Formatted right away before the start */
+  validate_formats(results);
+
+  /* The policy and the size of the rings are taken at the start */
+  check(results, logger_start(LOGGER_BLOCK, RING_SIZE));
+  check(results, !logger_start(LOGGER_BLOCK, RING_SIZE));
+  validate_formats(results);
+  validate_wrap(results);
+  validate_threads(results, tests);
+  logger_stop();
+
+  check(results, logger_start(LOGGER_DROP, RING_SIZE));
+  validate_dropped(results);
+  logger_stop();
+
+  free(expected);
+  expected = NULL;
+  expected_cap = 0;
+}
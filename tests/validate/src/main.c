@@ -1,7 +1,83 @@
+#include "validate.h"
+
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  const char* name;
+  void (*run)(test_results* results, unsigned long tests);
+} validate_suite;
+
+static const validate_suite suites[] = {
+  { "args", validate_args },
+  { "dynamic_arr", validate_dynamic_arr },
+  { "flat_set", validate_flat_set },
+  { "flat_map", validate_flat_map },
+  { "kernels", validate_kernels },
+  { "logger", validate_logger },
+  { "numbers", validate_numbers },
+  { "packed_arr", validate_packed_arr },
+  { "pool", validate_pool },
+  { "priority_queue", validate_priority_queue },
+  { "splitter", validate_splitter },
+  { "string_builder", validate_string_builder },
+  { "scheduler", validate_scheduler },
+  { "snapshot_arr", validate_snapshot_arr },
+  { "time_tests", validate_time_tests },
+  { "trace", validate_trace },
+  { "tree_arr", validate_tree_arr },
+};
+
+/* Every suite runs if none are named */
+static bool selected(const char* name, int ac, const char** av) {
+  if (ac == 2)
+    return true;
+
+  for (int a = 2; a < ac; a++) {
+    if (!strcmp(av[a], name))
+      return true;
+  }
+
+  return false;
+}
 
 int main(int ac, const char** av) {
-  if (ac != 2) {
+  set_prog_name(av[0]);
+
+  if (ac < 2) {
+    fprintf(stderr, "usage: %s <tests> [suite...]\n", av[0]);
+    return 1;
+  }
+
+  for (int a = 2; a < ac; a++) {
+    unsigned long s = 0;
+    while (s < sizeof(suites) / sizeof(*suites) && strcmp(av[a], suites[s].name))
+      s++;
 
+    if (s == sizeof(suites) / sizeof(*suites)) {
+      fprintf(stderr, "%s: unknown suite `%s'\n", av[0], av[a]);
+      return 1;
+    }
   }
+
+  const unsigned long tests = strtoul(av[1], NULL, 0);
+  test_results total = {0};
+
+  for (unsigned long s = 0; s < sizeof(suites) / sizeof(*suites); s++) {
+    if (!selected(suites[s].name, ac, av))
+      continue;
+
+    test_results results = {0};
+    suites[s].run(&results, tests);
+
+    info("%s: %u check(s), %u failed", suites[s].name, results.success + results.failure, results.failure);
+    total.success += results.success;
+    total.failure += results.failure;
+  }
+
+  printf("%lu test(s), %u check(s), %u failed\n", tests, total.success + total.failure, total.failure);
+
+  return (total.failure ? 1 : 0);
 }
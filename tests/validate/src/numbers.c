@@ -0,0 +1,395 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/parsing/text/numbers.h>
+
+#include "validate.h"
+
+#include <inttypes.h>
+#include <locale.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIELDS_MAX 64
+#define SENTINEL   0x5a5a5a5a5a5a5a5aLL /* Values are left alone on errors */
+
+static bool same_double(double a, double b) {
+  return (isnan(a) && isnan(b)) || !memcmp(&a, &b, sizeof(a));
+}
+
+/* Parses a float with the parser and with strtod, they have to agree to the bit, infinities from overflow are errors */
+static bool same_as_strtod(const char* text) {
+  double value = 7;
+  const enum number_error error = number_parse_f64(text, strlen(text), &value);
+  const double expected = strtod(text, NULL);
+  const bool overflow = (isinf(expected) && !strpbrk(text, "iI"));
+
+  const bool same = (overflow ? error == NUMBER_RANGE && value == 7 : error == NUMBER_OK && same_double(value, expected));
+  if (!same)
+    err("\"%s\": got %.17g (%s), expected %.17g", text, value, number_error_str(error), expected);
+
+  return same;
+}
+
+/* Edges of the integer types, blanks, signs and the eight digit chunks */
+static void validate_integers(test_results* results, uint64_t* seed) {
+  static const struct {
+    const char* text;
+    enum number_error error;
+    int64_t value;
+  } cases[] = {
+    { "0", NUMBER_OK, 0 },
+    { "-0", NUMBER_OK, 0 },
+    { "+5", NUMBER_OK, 5 },
+    { " \t42\r ", NUMBER_OK, 42 },
+    { "12345678", NUMBER_OK, 12345678 },
+    { "1234567890123456", NUMBER_OK, 1234567890123456LL },
+    { "12345678901234567", NUMBER_OK, 12345678901234567LL },
+    { "0000000000000000000000000123", NUMBER_OK, 123 },
+    { "9223372036854775807", NUMBER_OK, INT64_MAX },
+    { "-9223372036854775808", NUMBER_OK, INT64_MIN },
+    { "9223372036854775808", NUMBER_RANGE, 0 },
+    { "-9223372036854775809", NUMBER_RANGE, 0 },
+    { "18446744073709551615", NUMBER_RANGE, 0 },
+    { "18446744073709551616", NUMBER_RANGE, 0 },
+    { "99999999999999999999999", NUMBER_RANGE, 0 },
+    { "", NUMBER_EMPTY, 0 },
+    { " \t\r", NUMBER_EMPTY, 0 },
+    { "-", NUMBER_INVALID, 0 },
+    { "+", NUMBER_INVALID, 0 },
+    { "--1", NUMBER_INVALID, 0 },
+    { "1a", NUMBER_INVALID, 0 },
+    { "1 2", NUMBER_INVALID, 0 },
+    { "0x10", NUMBER_INVALID, 0 },
+    { "1.0", NUMBER_INVALID, 0 },
+    { "1234567a", NUMBER_INVALID, 0 },
+    { "12345678a", NUMBER_INVALID, 0 },
+    { "99999999999999999999x", NUMBER_INVALID, 0 },
+    { "1\n", NUMBER_INVALID, 0 },
+  };
+
+  for (unsigned long c = 0; c < sizeof(cases) / sizeof(*cases); c++) {
+    int64_t value = SENTINEL;
+    const enum number_error error = number_parse_i64(cases[c].text, strlen(cases[c].text), &value);
+    check(results, error == cases[c].error && value == (error ? SENTINEL : cases[c].value));
+  }
+
+  static const struct {
+    const char* text;
+    enum number_error error;
+    int32_t value;
+  } cases32[] = {
+    { "2147483647", NUMBER_OK, INT32_MAX },
+    { "-2147483648", NUMBER_OK, INT32_MIN },
+    { "2147483648", NUMBER_RANGE, 0 },
+    { "-2147483649", NUMBER_RANGE, 0 },
+    { "9223372036854775808", NUMBER_RANGE, 0 },
+    { " ", NUMBER_EMPTY, 0 },
+    { "1e3", NUMBER_INVALID, 0 },
+  };
+
+  for (unsigned long c = 0; c < sizeof(cases32) / sizeof(*cases32); c++) {
+    int32_t value = 7;
+    const enum number_error error = number_parse_i32(cases32[c].text, strlen(cases32[c].text), &value);
+    check(results, error == cases32[c].error && value == (error ? 7 : cases32[c].value));
+  }
+
+  /* Random integers of every length, with leading zeros and blanks */
+  bool same = true;
+  for (int i = 0; i < 4096; i++) {
+    const int64_t expected = (int64_t)validate_random(seed) >> (validate_random(seed) % 64);
+    char text[64];
+    const int len = snprintf(text, sizeof(text), "%*s%0*" PRId64 "%*s", (int)(validate_random(seed) % 3), "",
+        (int)(validate_random(seed) % 24), expected, (int)(validate_random(seed) % 3), "");
+
+    int64_t value;
+    int32_t value32 = 0;
+    same &= (number_parse_i64(text, len, &value) == NUMBER_OK && value == expected);
+    same &= (number_parse_i32(text, len, &value32) == (expected == (int32_t)expected ? NUMBER_OK : NUMBER_RANGE));
+    same &= (expected != (int32_t)expected || value32 == expected);
+  }
+  check(results, same);
+}
+
+/* Both paths of the float parser against strtod, and what it rejects */
+static void validate_floats(test_results* results, uint64_t* seed) {
+  static const char* const agree[] = {
+    /* Clinger's fast path, also with the exponent moved into the mantissa */
+    "0", "-0", "0.0", "-0.000", "1", "0.1", "-2.5", "3.14159", "1e22", "1e-22", "1e23", "12e30", "9007199254740992",
+    "123456789012345", ".5", "5.", "-.5e1", "+1E+2", "00000.00001", "4503599627370495.5", "1e0", "0e999",
+    /* Not exact, through strtod */
+    "9007199254740993", "1e-23", "1e38", "123456789012345678901234567890", "1.00000000000000000000001",
+    "0.1000000000000000055511151231257827", "2.2250738585072014e-308", "2.2250738585072011e-308",
+    "4.9e-324", "2.4703282292062328e-324", "2.4703282292062327e-324", "1e-400", "-1e-400",
+    "1.7976931348623157e308", "1.7976931348623158e308", "179769313486231570000000000000000000000e270",
+    "7.2057594037927933e16", "9007199254740993.0000000000000000001", "0.000000000000000000000000000001",
+    "100000000000000000000000", "1" "00000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000e-150",
+    /* Too large */
+    "1e309", "-1e400", "1.7976931348623159e308", "1e99999999",
+    "inf", "-Infinity", "INF", "nan", "NaN",
+  };
+  for (unsigned long a = 0; a < sizeof(agree) / sizeof(*agree); a++)
+    check(results, same_as_strtod(agree[a]));
+
+  static const struct {
+    const char* text;
+    enum number_error error;
+  } rejected[] = {
+    { "", NUMBER_EMPTY }, { "\t \r", NUMBER_EMPTY }, { ".", NUMBER_INVALID }, { "-", NUMBER_INVALID },
+    { "e5", NUMBER_INVALID }, { "1e", NUMBER_INVALID }, { "1e+", NUMBER_INVALID }, { "1.5.2", NUMBER_INVALID },
+    { "infx", NUMBER_INVALID }, { "in", NUMBER_INVALID }, { "0x1p3", NUMBER_INVALID }, { "1,5", NUMBER_INVALID },
+    { "1e309", NUMBER_RANGE }, { "-1e309", NUMBER_RANGE },
+  };
+  for (unsigned long r = 0; r < sizeof(rejected) / sizeof(*rejected); r++) {
+    double value = 7;
+    const enum number_error error = number_parse_f64(rejected[r].text, strlen(rejected[r].text), &value);
+    check(results, error == rejected[r].error && value == 7);
+  }
+
+  char text[128];
+  double value;
+
+  /* Short mantissas with small exponents take the fast path */
+  bool same = true;
+  for (int i = 0; i < 4096; i++) {
+    const uint64_t mantissa = validate_random(seed) % 1000000000000000ULL;
+    const int exponent = (int)(validate_random(seed) % 60) - 30;
+    snprintf(text, sizeof(text), "%s%" PRIu64 "e%d", (i & 1 ? "-" : ""), mantissa, exponent);
+    same &= same_as_strtod(text);
+  }
+  check(results, same);
+
+  /* Mantissas of more than 19 digits are truncated and take the slow path */
+  same = true;
+  for (int i = 0; i < 4096; i++) {
+    int len = snprintf(text, sizeof(text), "%" PRIu64 ".", validate_random(seed) % 10000000000UL);
+    const int digits = 10 + validate_random(seed) % 30;
+    for (int d = 0; d < digits; d++)
+      text[len++] = '0' + validate_random(seed) % 10;
+    snprintf(text + len, sizeof(text) - len, "e%d", (int)(validate_random(seed) % 640) - 320);
+    same &= same_as_strtod(text);
+  }
+  check(results, same);
+
+  /* Every double round trips through 17 significant digits */
+  same = true;
+  for (int i = 0; i < 4096; i++) {
+    uint64_t bits = validate_random(seed);
+    double expected;
+    memcpy(&expected, &bits, sizeof(expected));
+    if (!isfinite(expected))
+      continue;
+
+    const int len = snprintf(text, sizeof(text), "%.17g", expected);
+    same &= (number_parse_f64(text, len, &value) == NUMBER_OK && same_double(value, expected));
+  }
+  check(results, same);
+}
+
+/* Locales whose decimal point is a comma, the first one installed is used */
+static const char* const comma_locales[] = {
+  "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR", "ru_RU.UTF-8", "nl_NL.UTF-8",
+};
+
+/* The program's locale changes neither path of the float parser */
+static void validate_locale(test_results* results, uint64_t* seed) {
+  static const char* const texts[] = {
+    "3.14159", "-2.5e-3", "123456789012345678901234567890.5", "1.00000000000000000000001",
+    "2.2250738585072011e-308", "4.9e-324", "1.7976931348623157e308", "0.1000000000000000055511151231257827",
+  };
+  double expected[sizeof(texts) / sizeof(*texts)];
+  for (unsigned long t = 0; t < sizeof(texts) / sizeof(*texts); t++)
+    expected[t] = strtod(texts[t], NULL);
+
+  char text[128];
+  double random[64];
+  char randoms[64][128];
+  for (int i = 0; i < 64; i++) {
+    int len = snprintf(randoms[i], sizeof(randoms[i]), "%" PRIu64 ".", validate_random(seed) % 10000000000UL);
+    for (int d = 0; d < 25; d++)
+      randoms[i][len++] = '0' + validate_random(seed) % 10;
+    snprintf(randoms[i] + len, sizeof(randoms[i]) - len, "e%d", (int)(validate_random(seed) % 600) - 300);
+    random[i] = strtod(randoms[i], NULL);
+  }
+
+  char previous[64];
+  snprintf(previous, sizeof(previous), "%s", setlocale(LC_NUMERIC, NULL));
+  const char* name = NULL;
+  for (unsigned long l = 0; !name && l < sizeof(comma_locales) / sizeof(*comma_locales); l++)
+    if (setlocale(LC_NUMERIC, comma_locales[l]) && *localeconv()->decimal_point == ',')
+      name = comma_locales[l];
+  if (!name) {
+    setlocale(LC_NUMERIC, previous);
+    info("numbers: no locale with a decimal comma installed, skipped");
+    results->skipped++;
+    return;
+  }
+
+  /* `strtod()' of the program reads the comma now */
+  check(results, strtod("1.5", NULL) == 1 && strtod("1,5", NULL) == 1.5);
+
+  bool same = true;
+  double value;
+  for (unsigned long t = 0; t < sizeof(texts) / sizeof(*texts); t++)
+    same &= (number_parse_f64(texts[t], strlen(texts[t]), &value) == NUMBER_OK && same_double(value, expected[t]));
+  for (int i = 0; i < 64; i++)
+    same &= (number_parse_f64(randoms[i], strlen(randoms[i]), &value) == NUMBER_OK && same_double(value, random[i]));
+  check(results, same);
+  check(results, number_parse_f64("1,5", 3, &value) == NUMBER_INVALID);
+
+  /* Fields of the bulk parser too, with the comma as the delimiter */
+  const int len = snprintf(text, sizeof(text), "%s,%s,0.5", randoms[0], randoms[1]);
+  dynamic_arr values = dynamic_arr_new(double);
+  const text_span span = { text, len, false };
+  check(results, number_parse_f64_arr(&span, ',', &values, NULL) == 3);
+  const double* parsed = dynamic_arr_get_start(&values);
+  check(results, values.num == 3 && same_double(parsed[0], random[0]) && same_double(parsed[1], random[1]) && parsed[2] == 0.5);
+  dynamic_arr_cleanup(&values);
+
+  /* The locale of the program is left as it was */
+  check(results, *localeconv()->decimal_point == ',');
+  setlocale(LC_NUMERIC, previous);
+}
+
+/* Values and errors of the bulk parsers for each field */
+static void validate_bulk(test_results* results, uint64_t* seed) {
+  static const struct {
+    const char* text;
+    char delimiter;
+    unsigned long num;
+    int64_t values[8];
+    number_field_error errors[4];
+    unsigned long num_errors;
+  } cases[] = {
+    { "", ',', 0, { 0 }, { { 0 } }, 0 },
+    { "\n", ',', 1, { 0 }, { { 0, 0, NUMBER_EMPTY } }, 1 },
+    { "1,,x, 3 ,99999999999999999999\n-4\n", ',', 6, { 1, 0, 0, 3, 0, -4 },
+      { { 1, 2, NUMBER_EMPTY }, { 2, 3, NUMBER_INVALID }, { 4, 9, NUMBER_RANGE } }, 3 },
+    { "1,2,", ',', 3, { 1, 2, 0 }, { { 2, 4, NUMBER_EMPTY } }, 1 },
+    { "1\t\t 2\n\n3", '\t', 5, { 1, 0, 2, 0, 3 }, { { 1, 2, NUMBER_EMPTY }, { 3, 6, NUMBER_EMPTY } }, 2 },
+    { "-9223372036854775808;9223372036854775807;1 2", ';', 3, { INT64_MIN, INT64_MAX, 0 }, { { 2, 41, NUMBER_INVALID } }, 1 },
+  };
+
+  bool same = true;
+  for (unsigned long c = 0; c < sizeof(cases) / sizeof(*cases); c++) {
+    const text_span text = { cases[c].text, strlen(cases[c].text), false };
+    dynamic_arr values = dynamic_arr_new(int64_t);
+    dynamic_arr errors = dynamic_arr_new(number_field_error);
+
+    /* Fields are appended after what is in the array already */
+    const int64_t first = SENTINEL;
+    dynamic_arr_append(&values, &first);
+
+    same &= (number_parse_i64_arr(&text, cases[c].delimiter, &values, &errors) == cases[c].num);
+    same &= (values.num == cases[c].num + 1 && errors.num == cases[c].num_errors);
+    const int64_t* v = dynamic_arr_get_start(&values);
+    same &= (v[0] == SENTINEL && !memcmp(v + 1, cases[c].values, cases[c].num * sizeof(*v)));
+
+    const number_field_error* e = dynamic_arr_get_start(&errors);
+    for (unsigned long i = 0; i < cases[c].num_errors && i < errors.num; i++)
+      same &= (e[i].index == cases[c].errors[i].index && e[i].offset == cases[c].errors[i].offset
+          && e[i].error == cases[c].errors[i].error);
+
+    /* Without the errors array the values are the same */
+    values.num = 1;
+    number_parse_i64_arr(&text, cases[c].delimiter, &values, NULL);
+    same &= (values.num == cases[c].num + 1 && !memcmp(v + 1, cases[c].values, cases[c].num * sizeof(*v)));
+
+    dynamic_arr_cleanup(&errors);
+    dynamic_arr_cleanup(&values);
+  }
+  check(results, same);
+
+  /* Random fields: every value and error of the bulk parsers is the one of the single parsers */
+  static const char* const fields[] = {
+    "0", "-17", " 42 ", "2147483647", "-2147483648", "2147483648", "9223372036854775807",
+    "-9223372036854775808", "9223372036854775808", "", "  ", "x", "1x", "1.5", "-2.5e3", "1e400",
+    "inf", "nan", "0.1", "123456789012345678901234", "+", "1e",
+  };
+  static char text[FIELDS_MAX * 32];
+
+  same = true;
+  for (int round = 0; round < 256; round++) {
+    const unsigned long num = 1 + validate_random(seed) % FIELDS_MAX;
+    unsigned long index[FIELDS_MAX], offset[FIELDS_MAX];
+    unsigned long len = 0;
+
+    for (unsigned long f = 0; f < num; f++) {
+      if (f)
+        text[len++] = (validate_random(seed) % 4 ? ',' : '\n');
+      index[f] = validate_random(seed) % (sizeof(fields) / sizeof(*fields));
+      offset[f] = len;
+      len += snprintf(text + len, sizeof(text) - len, "%s", fields[index[f]]);
+    }
+    /* An empty text has no fields, a lone newline one, nor does a last empty line without its newline */
+    if (!len || text[len - 1] == '\n' || validate_random(seed) % 2)
+      text[len++] = '\n';
+
+    const text_span span = { text, len, false };
+    dynamic_arr i64 = dynamic_arr_new(int64_t), i32 = dynamic_arr_new(int32_t), f64 = dynamic_arr_new(double);
+    dynamic_arr i64_errors = dynamic_arr_new(number_field_error);
+    dynamic_arr i32_errors = dynamic_arr_new(number_field_error);
+    dynamic_arr f64_errors = dynamic_arr_new(number_field_error);
+
+    same &= (number_parse_i64_arr(&span, ',', &i64, &i64_errors) == num);
+    same &= (number_parse_i32_arr(&span, ',', &i32, &i32_errors) == num);
+    same &= (number_parse_f64_arr(&span, ',', &f64, &f64_errors) == num);
+
+    const number_field_error* errors[3] = {
+      dynamic_arr_get_start(&i64_errors), dynamic_arr_get_start(&i32_errors), dynamic_arr_get_start(&f64_errors),
+    };
+    unsigned long seen[3] = { 0 };
+
+    for (unsigned long f = 0; f < num; f++) {
+      const char* field = fields[index[f]];
+      int64_t v64 = 0;
+      int32_t v32 = 0;
+      double vf = 0;
+      const enum number_error expected[3] = {
+        number_parse_i64(field, strlen(field), &v64),
+        number_parse_i32(field, strlen(field), &v32),
+        number_parse_f64(field, strlen(field), &vf),
+      };
+
+      same &= (((int64_t*)dynamic_arr_get_start(&i64))[f] == v64);
+      same &= (((int32_t*)dynamic_arr_get_start(&i32))[f] == v32);
+      same &= same_double(((double*)dynamic_arr_get_start(&f64))[f], vf);
+
+      /* Rejected fields are reported in order, with the offset of the field */
+      for (int k = 0; k < 3; k++) {
+        if (!expected[k])
+          continue;
+        same &= (errors[k][seen[k]].index == f && errors[k][seen[k]].offset == offset[f]
+            && errors[k][seen[k]].error == expected[k]);
+        seen[k]++;
+      }
+    }
+    same &= (seen[0] == i64_errors.num && seen[1] == i32_errors.num && seen[2] == f64_errors.num);
+
+    dynamic_arr_cleanup(&i64);
+    dynamic_arr_cleanup(&i32);
+    dynamic_arr_cleanup(&f64);
+    dynamic_arr_cleanup(&i64_errors);
+    dynamic_arr_cleanup(&i32_errors);
+    dynamic_arr_cleanup(&f64_errors);
+  }
+  check(results, same);
+
+  /* Every error is described differently */
+  for (int e = 0; e < NUMBER_ERRORS; e++)
+    for (int other = 0; other < e; other++)
+      check(results, strcmp(number_error_str(e), number_error_str(other)));
+}
+
+void validate_numbers(test_results* results, unsigned long tests) {
+  (void)tests;
+  uint64_t seed = 0x9fb21c651e98df25ULL;
+
+  validate_integers(results, &seed);
+  validate_floats(results, &seed);
+  validate_locale(results, &seed);
+  validate_bulk(results, &seed);
+}
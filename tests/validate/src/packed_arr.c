@@ -0,0 +1,209 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/arrays/packed.h>
+
+#include "validate.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BLOCKS_MAX 8
+#define ELEMENTS_MAX (BLOCKS_MAX * PACKED_ARR_BLOCK + PACKED_ARR_BLOCK - 1)
+#define ROUNDS_PER_TEST 8
+
+/* How the integers of a block are generated, each favours one way of packing */
+enum shape {
+  SHAPE_CONSTANT, /* Offsets of 0 bits */
+  SHAPE_OFFSETS, /* Random offsets of up to 32 bits from a random base */
+  SHAPE_ASCENDING, /* Steps up, packed as differences */
+  SHAPE_DESCENDING, /* Steps down, negative differences */
+  SHAPE_WRAPPING, /* Around the largest integer, differences wrap */
+  SHAPE_SPREAD, /* Anywhere, 64-bit blocks stay unpacked */
+  SHAPES,
+};
+
+/* Tails of the arrays: none, one, half and all but one integer of a block */
+static const unsigned long tails[] = { 0, 1, PACKED_ARR_BLOCK / 2 - 1, PACKED_ARR_BLOCK - 1 };
+
+static uint64_t narrow(uint64_t value, unsigned int size) {
+  return (size == sizeof(uint32_t) ? (uint32_t)value : value);
+}
+
+static void generate(uint64_t* values, unsigned long num, enum shape shape, unsigned int size, uint64_t* seed) {
+  const uint64_t base = validate_random(seed);
+  const unsigned int bits = validate_random(seed) % 33;
+  const uint64_t mask = (bits ? UINT64_MAX >> (64 - bits) : 0);
+  const uint64_t step = 1 + validate_random(seed) % 1000;
+
+  for (unsigned long i = 0; i < num; i++) {
+    uint64_t value = 0;
+    switch (shape) {
+      case SHAPE_CONSTANT:
+        value = base;
+        break;
+      case SHAPE_OFFSETS:
+        value = base + (validate_random(seed) & mask);
+        break;
+      case SHAPE_ASCENDING:
+        value = base + i * step + validate_random(seed) % 4;
+        break;
+      case SHAPE_DESCENDING:
+        value = base - i * step - validate_random(seed) % 4;
+        break;
+      case SHAPE_WRAPPING:
+        value = (i % 2 ? UINT64_MAX - validate_random(seed) % 8 : validate_random(seed) % 8);
+        break;
+      case SHAPE_SPREAD:
+      case SHAPES:
+        value = validate_random(seed);
+        break;
+    }
+    values[i] = narrow(value, size);
+  }
+}
+
+static uint64_t get_value(const void* values, unsigned long i, unsigned int size) {
+  if (size == sizeof(uint32_t))
+    return ((const uint32_t*)values)[i];
+
+  return ((const uint64_t*)values)[i];
+}
+
+static void set_value(void* values, unsigned long i, uint64_t value, unsigned int size) {
+  if (size == sizeof(uint32_t))
+    ((uint32_t*)values)[i] = (uint32_t)value;
+  else
+    ((uint64_t*)values)[i] = value;
+}
+
+/* Every integer through peek, random ranges through bulk peek and the whole array unpacked */
+static bool packed_equals(const packed_arr* arr, const uint64_t* expected, unsigned long num, uint64_t* seed) {
+  static uint64_t out[ELEMENTS_MAX + 1];
+  const unsigned int size = arr->element_size;
+  if (arr->num != num)
+    return false;
+
+  for (unsigned long i = 0; i < num; i++) {
+    uint64_t value = 0;
+    packed_arr_peek(arr, i, &value);
+    if (get_value(&value, 0, size) != expected[i])
+      return false;
+  }
+
+  for (int r = 0; r < 16 && num; r++) {
+    const unsigned long index = validate_random(seed) % num;
+    const unsigned long len = (r ? validate_random(seed) % (num - index + 1) : num - index);
+    memset(out, 0xa5, sizeof(out));
+    packed_arr_bulk_peek(arr, index, out, len);
+    for (unsigned long i = 0; i < len; i++)
+      if (get_value(out, i, size) != expected[index + i])
+        return false;
+    /* Nothing past the range is written */
+    if (get_value(out, len, size) != narrow(0xa5a5a5a5a5a5a5a5ULL, size))
+      return false;
+  }
+
+  dynamic_arr arr_out = packed_arr_to_dynamic(arr);
+  bool same = (arr_out.num == num);
+  for (unsigned long i = 0; same && i < num; i++)
+    same = (get_value(dynamic_arr_get_start(&arr_out), i, size) == expected[i]);
+  dynamic_arr_cleanup(&arr_out);
+
+  return same;
+}
+
+/* Blocks of one shape each, appended one at a time, in bulk and from a dynamic array */
+static void validate_round_trips(test_results* results, unsigned int size, unsigned long tests, uint64_t* seed) {
+  static uint64_t values[ELEMENTS_MAX];
+  static uint64_t elements[ELEMENTS_MAX];
+
+  bool same = true;
+  for (unsigned long round = 0; round < tests; round++) {
+    const unsigned long blocks = validate_random(seed) % (BLOCKS_MAX + 1);
+    const unsigned long num = blocks * PACKED_ARR_BLOCK + tails[validate_random(seed) % 4];
+    for (unsigned long b = 0; b * PACKED_ARR_BLOCK < num; b++) {
+      const unsigned long len = (num - b * PACKED_ARR_BLOCK < PACKED_ARR_BLOCK ? num - b * PACKED_ARR_BLOCK : PACKED_ARR_BLOCK);
+      generate(values + b * PACKED_ARR_BLOCK, len, validate_random(seed) % SHAPES, size, seed);
+    }
+    for (unsigned long i = 0; i < num; i++)
+      set_value(elements, i, values[i], size);
+
+    packed_arr one = __intern_packed_arr_new(size);
+    for (unsigned long i = 0; i < num; i++)
+      packed_arr_append(&one, (const uint8_t*)elements + i * size);
+    same &= packed_equals(&one, values, num, seed);
+
+    /* Chunks of random sizes, starting and ending inside of blocks */
+    packed_arr bulk = __intern_packed_arr_new(size);
+    for (unsigned long i = 0; i < num;) {
+      unsigned long chunk = 1 + validate_random(seed) % (2 * PACKED_ARR_BLOCK);
+      chunk = (chunk < num - i ? chunk : num - i);
+      packed_arr_bulk_append(&bulk, (const uint8_t*)elements + i * size, chunk);
+      i += chunk;
+    }
+    same &= packed_equals(&bulk, values, num, seed);
+
+    dynamic_arr arr = __intern_dynamic_generic_arr_new(size);
+    if (num)
+      dynamic_arr_bulk_append(&arr, elements, num);
+    packed_arr from = packed_arr_from_dynamic(&arr);
+    same &= packed_equals(&from, values, num, seed);
+
+    /* However they were appended, the blocks are packed the same */
+    const packed_arr_stats a = packed_arr_stats_get(&one), b = packed_arr_stats_get(&bulk);
+    same &= (a.blocks == blocks && a.blocks == b.blocks && a.for_blocks == b.for_blocks
+        && a.delta_blocks == b.delta_blocks && a.raw_blocks == b.raw_blocks && a.bytes == b.bytes);
+    same &= (a.for_blocks + a.delta_blocks + a.raw_blocks == a.blocks && a.raw_bytes == num * size);
+
+    dynamic_arr_cleanup(&arr);
+    packed_arr_cleanup(&one);
+    packed_arr_cleanup(&bulk);
+    packed_arr_cleanup(&from);
+  }
+  check(results, same);
+}
+
+/* Single blocks of each shape are packed the way it favours */
+static void validate_modes(test_results* results, unsigned int size, uint64_t* seed) {
+  static const struct {
+    enum shape shape;
+    bool wide; /* Only 64-bit integers */
+    unsigned long for_blocks, delta_blocks, raw_blocks;
+  } cases[] = {
+    { SHAPE_CONSTANT, false, 1, 0, 0 },
+    { SHAPE_ASCENDING, false, 0, 1, 0 },
+    { SHAPE_DESCENDING, false, 0, 1, 0 },
+    { SHAPE_WRAPPING, false, 0, 1, 0 },
+    { SHAPE_SPREAD, true, 0, 0, 1 },
+  };
+  uint64_t values[PACKED_ARR_BLOCK + 1];
+  uint64_t elements[PACKED_ARR_BLOCK + 1];
+
+  for (unsigned long c = 0; c < sizeof(cases) / sizeof(*cases); c++) {
+    if (cases[c].wide && size != sizeof(uint64_t))
+      continue;
+
+    /* Differences four apart take about 3 bits more than a step, offsets 7 */
+    generate(values, PACKED_ARR_BLOCK + 1, cases[c].shape, size, seed);
+    for (unsigned long i = 0; i <= PACKED_ARR_BLOCK; i++)
+      set_value(elements, i, values[i], size);
+
+    packed_arr arr = __intern_packed_arr_new(size);
+    packed_arr_bulk_append(&arr, elements, PACKED_ARR_BLOCK + 1);
+    const packed_arr_stats stats = packed_arr_stats_get(&arr);
+
+    check(results, stats.for_blocks == cases[c].for_blocks && stats.delta_blocks == cases[c].delta_blocks
+        && stats.raw_blocks == cases[c].raw_blocks);
+    check(results, packed_equals(&arr, values, PACKED_ARR_BLOCK + 1, seed));
+    packed_arr_cleanup(&arr);
+  }
+}
+
+void validate_packed_arr(test_results* results, unsigned long tests) {
+  uint64_t seed = 0x8cb92ba72f3d8dd7ULL;
+
+  validate_round_trips(results, sizeof(uint32_t), tests / ROUNDS_PER_TEST + 1, &seed);
+  validate_round_trips(results, sizeof(uint64_t), tests / ROUNDS_PER_TEST + 1, &seed);
+  validate_modes(results, sizeof(uint32_t), &seed);
+  validate_modes(results, sizeof(uint64_t), &seed);
+}
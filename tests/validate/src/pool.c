@@ -0,0 +1,296 @@
+#include <blib/memory/alloc.h>
+#include <blib/memory/pool.h>
+
+#include "validate.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LIVE_MAX  2048 /* Objects alive at once at most */
+#define BULK_MAX  100  /* More than a magazine */
+#define HANDOFF   500  /* Objects every thread passes on to the next one */
+#define THREADS   4
+#define CROWD     (POOL_MAX_THREADS + 8) /* Threads alive at once, some have no magazine */
+#define OPS_PER_ROUND 4
+
+static const unsigned int sizes[] = { 1, 8, 24, 48, 100, 4096 };
+
+/* Objects alive, every one filled with a byte of its own so overlapping objects are noticed */
+typedef struct {
+  void* objects[LIVE_MAX];
+  uint8_t fill[LIVE_MAX];
+  unsigned long num;
+} live_set;
+
+static bool aligned(const pool* p, const void* object) {
+  const uintptr_t align = (p->element_size % 16 ? sizeof(void*) : 16);
+  return !((uintptr_t)object % align);
+}
+
+static bool intact(const pool* p, const void* object, uint8_t fill) {
+  const uint8_t* bytes = object;
+  for (unsigned int i = 0; i < p->element_size; i++)
+    if (bytes[i] != fill)
+      return false;
+
+  return true;
+}
+
+static void live_add(live_set* live, const pool* p, void* object, uint64_t* seed) {
+  const uint8_t fill = validate_random(seed);
+  memset(object, fill, p->element_size);
+  live->objects[live->num] = object;
+  live->fill[live->num] = fill;
+  live->num++;
+}
+
+/* Removes a random object, returns whether it was left intact */
+static bool live_take(live_set* live, const pool* p, void** object, uint64_t* seed) {
+  const unsigned long i = validate_random(seed) % live->num;
+  const bool ok = intact(p, live->objects[i], live->fill[i]);
+
+  *object = live->objects[i];
+  live->num--;
+  live->objects[i] = live->objects[live->num];
+  live->fill[i] = live->fill[live->num];
+
+  return ok;
+}
+
+/* The slabs add up and every live object is counted */
+static bool stats_match(pool* p, unsigned long live) {
+  const pool_stats stats = pool_stats_get(p);
+
+  return stats.live == live && stats.bytes == stats.slabs * p->__slab_size__
+      && stats.capacity == stats.slabs * p->__per_slab__ && stats.live + stats.cached <= stats.capacity;
+}
+
+/* Single and bulk allocations and frees, also of NULL, checked for overlaps, alignment and occupancy */
+static void validate_round_trips(test_results* results, unsigned int size, unsigned long tests, uint64_t* seed) {
+  static live_set live;
+  void* bulk[BULK_MAX];
+
+  live.num = 0;
+  pool p = pool_new_sized(size);
+
+  bool same = true;
+  for (unsigned long op = 0; op < tests; op++) {
+    const unsigned long num = validate_random(seed) % BULK_MAX;
+
+    switch (validate_random(seed) % 4) {
+      case 0:
+        if (live.num < LIVE_MAX) {
+          void* object = pool_alloc(&p);
+          same &= (object && aligned(&p, object));
+          live_add(&live, &p, object, seed);
+        }
+        break;
+      case 1:
+        if (live.num + num <= LIVE_MAX) {
+          same &= (pool_alloc_bulk(&p, bulk, num) == num);
+          for (unsigned long i = 0; i < num; i++) {
+            same &= aligned(&p, bulk[i]);
+            live_add(&live, &p, bulk[i], seed);
+          }
+        }
+        break;
+      case 2:
+        if (live.num) {
+          void* object;
+          same &= live_take(&live, &p, &object, seed);
+          pool_free(&p, object);
+        }
+        pool_free(&p, NULL);
+        break;
+      case 3: {
+        /* NULL objects in between are skipped */
+        unsigned long n = 0;
+        for (unsigned long i = 0; i < num && live.num; i++) {
+          if (validate_random(seed) % 8 == 0)
+            bulk[n++] = NULL;
+          else
+            same &= live_take(&live, &p, &bulk[n++], seed);
+        }
+        pool_free_bulk(&p, bulk, n);
+        break;
+      }
+    }
+
+    same &= stats_match(&p, live.num);
+  }
+  check(results, same);
+
+  /* Every object is intact until it is freed */
+  while (live.num) {
+    void* object;
+    same &= live_take(&live, &p, &object, seed);
+    pool_free(&p, object);
+  }
+  check(results, same && stats_match(&p, 0));
+
+  pool_cleanup(&p);
+}
+
+static int pointer_cmp(const void* a, const void* b) {
+  const uintptr_t pa = (uintptr_t)*(void* const*)a, pb = (uintptr_t)*(void* const*)b;
+  return (pa > pb) - (pa < pb);
+}
+
+/* A reset pool hands out the objects of its slabs again, without allocating */
+static void validate_reset(test_results* results, unsigned int size) {
+  static void* first[LIVE_MAX];
+  static void* second[LIVE_MAX];
+  pool p = pool_new_sized(size);
+
+  /* Whole magazine refills, so both rounds carve the same objects */
+  const unsigned long num = p.__per_slab__ * 3 / (POOL_MAGAZINE / 2) * (POOL_MAGAZINE / 2) + POOL_MAGAZINE / 2;
+  for (unsigned long i = 0; i < num; i++)
+    first[i] = pool_alloc(&p);
+  const pool_stats before = pool_stats_get(&p);
+
+  pool_reset(&p);
+  pool_stats stats = pool_stats_get(&p);
+  check(results, stats.slabs == before.slabs && !stats.live && !stats.cached);
+
+  const bool tracked = blib_alloc_track(true);
+  const blib_alloc_stats allocs = blib_alloc_stats_get();
+
+  for (unsigned long i = 0; i < num; i += POOL_MAGAZINE / 2)
+    pool_alloc_bulk(&p, second + i, POOL_MAGAZINE / 2);
+
+  check(results, blib_alloc_stats_get().mallocs == allocs.mallocs);
+  blib_alloc_track(tracked);
+
+  stats = pool_stats_get(&p);
+  check(results, stats.slabs == before.slabs && stats.live == num);
+
+  qsort(first, num, sizeof(*first), pointer_cmp);
+  qsort(second, num, sizeof(*second), pointer_cmp);
+  check(results, !memcmp(first, second, num * sizeof(*first)));
+
+  /* Objects freed before the reset are forgotten too */
+  pool_free_bulk(&p, second, num / 2);
+  pool_reset(&p);
+  for (unsigned long i = 0; i < num; i++)
+    second[i] = pool_alloc(&p);
+  qsort(second, num, sizeof(*second), pointer_cmp);
+  check(results, !memcmp(first, second, num * sizeof(*first)) && pool_stats_get(&p).slabs == before.slabs);
+
+  pool_cleanup(&p);
+}
+
+typedef struct {
+  pool* p;
+  void* objects[HANDOFF];
+  bool ok;
+  pthread_barrier_t* barrier;
+  void** neighbour; /* Object of the next thread of the crowd */
+  void* own;
+} worker;
+
+static void* allocate(void* arg) {
+  worker* w = arg;
+
+  w->ok = (pool_alloc_bulk(w->p, w->objects, HANDOFF / 2) == HANDOFF / 2);
+  for (unsigned long i = HANDOFF / 2; i < HANDOFF; i++)
+    w->ok &= ((w->objects[i] = pool_alloc(w->p)) != NULL);
+  for (unsigned long i = 0; i < HANDOFF; i++)
+    memset(w->objects[i], (int)(i & 0xff), w->p->element_size);
+
+  return NULL;
+}
+
+/* Frees the objects another thread allocated */
+static void* release(void* arg) {
+  worker* w = arg;
+
+  w->ok = true;
+  for (unsigned long i = 0; i < HANDOFF; i++)
+    w->ok &= intact(w->p, w->objects[i], i & 0xff);
+
+  pool_free_bulk(w->p, w->objects, HANDOFF / 2);
+  for (unsigned long i = HANDOFF / 2; i < HANDOFF; i++)
+    pool_free(w->p, w->objects[i]);
+
+  return NULL;
+}
+
+/* Every thread holds an object while all of them are alive and counted, then frees the one of its neighbour */
+static void* crowd(void* arg) {
+  worker* w = arg;
+
+  w->own = pool_alloc(w->p);
+  pthread_barrier_wait(w->barrier);
+  pthread_barrier_wait(w->barrier);
+  pool_free(w->p, *w->neighbour);
+  pthread_barrier_wait(w->barrier);
+
+  return NULL;
+}
+
+/* Objects freed by other threads than the allocating ones, and threads without a magazine */
+static void validate_threads(test_results* results, unsigned int size) {
+  static worker workers[CROWD];
+  pthread_t threads[CROWD];
+  pool p = pool_new_sized(size);
+
+  /* Each thread allocates, another one frees */
+  for (int t = 0; t < THREADS; t++) {
+    workers[t] = (worker) { .p = &p };
+    pthread_create(&threads[t], NULL, allocate, &workers[t]);
+  }
+  for (int t = 0; t < THREADS; t++) {
+    pthread_join(threads[t], NULL);
+    check(results, workers[t].ok);
+  }
+  check(results, stats_match(&p, THREADS * HANDOFF));
+
+  static void* moved[HANDOFF];
+  memcpy(moved, workers[0].objects, sizeof(moved));
+  for (int t = 0; t < THREADS; t++)
+    memcpy(workers[t].objects, (t + 1 < THREADS ? workers[t + 1].objects : moved), sizeof(moved));
+
+  for (int t = 0; t < THREADS; t++)
+    pthread_create(&threads[t], NULL, release, &workers[t]);
+  for (int t = 0; t < THREADS; t++) {
+    pthread_join(threads[t], NULL);
+    check(results, workers[t].ok);
+  }
+  check(results, stats_match(&p, 0));
+
+  /* More threads at once than magazines, the rest goes through the depot */
+  pthread_barrier_t barrier;
+  pthread_barrier_init(&barrier, NULL, CROWD + 1);
+  for (int t = 0; t < CROWD; t++)
+    workers[t] = (worker) { .p = &p, .barrier = &barrier, .neighbour = &workers[(t + 1) % CROWD].own };
+  for (int t = 0; t < CROWD; t++)
+    pthread_create(&threads[t], NULL, crowd, &workers[t]);
+
+  pthread_barrier_wait(&barrier);
+  check(results, stats_match(&p, CROWD));
+  pthread_barrier_wait(&barrier);
+  pthread_barrier_wait(&barrier);
+  for (int t = 0; t < CROWD; t++)
+    pthread_join(threads[t], NULL);
+  pthread_barrier_destroy(&barrier);
+
+  bool allocated = true;
+  for (int t = 0; t < CROWD; t++)
+    allocated &= (workers[t].own != NULL);
+  check(results, allocated && stats_match(&p, 0));
+
+  pool_cleanup(&p);
+}
+
+void validate_pool(test_results* results, unsigned long tests) {
+  uint64_t seed = 0x94d049bb133111ebULL;
+
+  for (unsigned long s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+    validate_round_trips(results, sizes[s], tests * OPS_PER_ROUND, &seed);
+    validate_reset(results, sizes[s]);
+    validate_threads(results, sizes[s]);
+  }
+}
@@ -0,0 +1,245 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/queues/priority.h>
+
+#include "validate.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define IDS      1024 /* Elements alive at once at most */
+#define BULK_MAX 64
+#define KEYS     256  /* Keys repeat, ties have to pop in any order */
+#define OPS_PER_ROUND 8
+
+typedef struct {
+  uint32_t key;
+  uint32_t id;
+} element;
+
+/* Heap index of every id as reported by the hook, and the key it has if it is in the queue */
+typedef struct {
+  unsigned long index[IDS];
+  bool alive[IDS];
+  uint32_t key[IDS];
+  unsigned long num;
+} handles;
+
+static const unsigned int arities[] = { 2, 3, 4, 8 };
+
+static int element_cmp(const void* a, const void* b) {
+  const uint32_t ka = ((const element*)a)->key, kb = ((const element*)b)->key;
+  return (ka > kb) - (ka < kb);
+}
+
+static void track(const void* e, unsigned long index, void* ctx) {
+  ((handles*)ctx)->index[((const element*)e)->id] = index;
+}
+
+/* Every parent comes before its children and every handle points at its element */
+static bool heap_valid(const priority_queue* q, const handles* h) {
+  const element* heap = dynamic_arr_get_start(&q->__storage__);
+  const unsigned long num = priority_queue_len(q);
+  if (num != h->num)
+    return false;
+
+  for (unsigned long i = 0; i < num; i++) {
+    if (i && element_cmp(&heap[(i - 1) / q->arity], &heap[i]) > 0)
+      return false;
+    if (!h->alive[heap[i].id] || h->index[heap[i].id] != i || h->key[heap[i].id] != heap[i].key)
+      return false;
+  }
+
+  return true;
+}
+
+static uint32_t min_key(const handles* h) {
+  uint32_t min = UINT32_MAX;
+  for (unsigned long id = 0; id < IDS; id++) {
+    if (h->alive[id] && h->key[id] < min)
+      min = h->key[id];
+  }
+
+  return min;
+}
+
+static unsigned long free_id(const handles* h, uint64_t* seed) {
+  unsigned long id = validate_random(seed) % IDS;
+  while (h->alive[id])
+    id = (id + 1) % IDS;
+
+  return id;
+}
+
+static unsigned long alive_id(const handles* h, uint64_t* seed) {
+  unsigned long id = validate_random(seed) % IDS;
+  while (!h->alive[id])
+    id = (id + 1) % IDS;
+
+  return id;
+}
+
+static element fresh(handles* h, uint64_t* seed) {
+  const element e = { validate_random(seed) % KEYS, free_id(h, seed) };
+  h->alive[e.id] = true;
+  h->key[e.id] = e.key;
+  h->num++;
+
+  return e;
+}
+
+/* Pushes, bulk pushes on both paths, pops, updates and removes through the handles */
+static void validate_ops(test_results* results, unsigned int arity, unsigned long tests, uint64_t* seed) {
+  static handles h;
+  element bulk[BULK_MAX];
+  element out;
+
+  memset(&h, 0, sizeof(h));
+  priority_queue q = priority_queue_new(element, arity, element_cmp);
+  priority_queue_set_hook(&q, track, &h);
+
+  for (unsigned long op = 0; op < tests; op++) {
+    const unsigned long num = 1 + validate_random(seed) % BULK_MAX;
+
+    switch (validate_random(seed) % 6) {
+      case 0:
+        if (h.num < IDS) {
+          const element e = fresh(&h, seed);
+          priority_queue_push(&q, &e);
+        }
+        break;
+      case 1:
+        /* Fewer elements than in the queue are pushed one at a time, at least as many rebuild it */
+        if (h.num + num <= IDS) {
+          for (unsigned long i = 0; i < num; i++)
+            bulk[i] = fresh(&h, seed);
+          priority_queue_bulk_push(&q, bulk, num);
+        }
+        break;
+      case 2:
+        if (h.num) {
+          const uint32_t min = min_key(&h);
+          priority_queue_pop(&q, &out);
+          check(results, out.key == min && h.alive[out.id]);
+          h.alive[out.id] = false;
+          h.num--;
+        }
+        break;
+      case 3:
+        /* Increase and decrease key */
+        if (h.num) {
+          const unsigned long id = alive_id(&h, seed);
+          const element e = { validate_random(seed) % KEYS, id };
+          priority_queue_update(&q, h.index[id], &e);
+          h.key[id] = e.key;
+        }
+        break;
+      case 4:
+        if (h.num) {
+          const unsigned long id = alive_id(&h, seed);
+          priority_queue_remove_at(&q, h.index[id], &out);
+          check(results, out.id == id && out.key == h.key[id]);
+          h.alive[id] = false;
+          h.num--;
+        }
+        break;
+      case 5:
+        if (h.num) {
+          const uint32_t min = min_key(&h);
+          priority_queue_peek(&q, &out);
+          check(results, out.key == min);
+        }
+        break;
+    }
+
+    check(results, heap_valid(&q, &h));
+  }
+
+  /* Draining pops in order */
+  uint32_t last = 0;
+  bool sorted = true;
+  while (priority_queue_len(&q)) {
+    priority_queue_pop(&q, &out);
+    sorted &= (out.key >= last);
+    last = out.key;
+  }
+  check(results, sorted);
+
+  priority_queue_cleanup(&q);
+}
+
+/* Both paths of bulk_push, into an empty queue, a larger one and a smaller one */
+static void validate_bulk_push(test_results* results, unsigned int arity, uint64_t* seed) {
+  static const unsigned long sizes[][2] = { { 0, 100 }, { 200, 50 }, { 50, 200 }, { 64, 64 } };
+  static handles h;
+  element bulk[256];
+
+  for (unsigned long s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+    memset(&h, 0, sizeof(h));
+    priority_queue q = priority_queue_new(element, arity, element_cmp);
+    priority_queue_set_hook(&q, track, &h);
+
+    for (unsigned long i = 0; i < sizes[s][0]; i++) {
+      const element e = fresh(&h, seed);
+      priority_queue_push(&q, &e);
+    }
+    for (unsigned long i = 0; i < sizes[s][1]; i++)
+      bulk[i] = fresh(&h, seed);
+    priority_queue_bulk_push(&q, bulk, sizes[s][1]);
+    check(results, heap_valid(&q, &h));
+
+    /* Every handle works right after the push */
+    for (unsigned long i = 0; i < sizes[s][1]; i += 3) {
+      element out;
+      priority_queue_remove_at(&q, h.index[bulk[i].id], &out);
+      check(results, out.id == bulk[i].id);
+      h.alive[out.id] = false;
+      h.num--;
+    }
+    check(results, heap_valid(&q, &h));
+
+    priority_queue_cleanup(&q);
+  }
+}
+
+/* Heaps built in place from an array pop every element in order */
+static void validate_from_arr(test_results* results, unsigned int arity, uint64_t* seed) {
+  static const unsigned long sizes[] = { 0, 1, 2, 7, 100, 1000 };
+
+  for (unsigned long s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+    dynamic_arr arr = dynamic_arr_new(element);
+    unsigned long counts[KEYS] = {0};
+    for (unsigned long i = 0; i < sizes[s]; i++) {
+      const element e = { validate_random(seed) % KEYS, i };
+      dynamic_arr_append(&arr, &e);
+      counts[e.key]++;
+    }
+
+    priority_queue q = priority_queue_from_arr(&arr, arity, element_cmp);
+    check(results, priority_queue_len(&q) == sizes[s]);
+
+    /* Pops are sorted and take every element once */
+    bool sorted = true;
+    uint32_t last = 0;
+    while (priority_queue_len(&q)) {
+      element out;
+      priority_queue_pop(&q, &out);
+      sorted &= (out.key >= last && counts[out.key]);
+      counts[out.key]--;
+      last = out.key;
+    }
+    check(results, sorted);
+
+    priority_queue_cleanup(&q);
+  }
+}
+
+void validate_priority_queue(test_results* results, unsigned long tests) {
+  uint64_t seed = 0xda942042e4dd58b5ULL;
+
+  for (unsigned long a = 0; a < sizeof(arities) / sizeof(*arities); a++) {
+    validate_ops(results, arities[a], tests * OPS_PER_ROUND, &seed);
+    validate_bulk_push(results, arities[a], &seed);
+    validate_from_arr(results, arities[a], &seed);
+  }
+}
@@ -0,0 +1,209 @@
+#include <blib/concurrency/scheduler.h>
+
+#include "validate.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#define WORKERS_MAX   8
+#define IDLE_NS       20000000L /* Workers are left without work this long */
+#define ELEMENTS      100000UL
+#define FIB           20 /* Tasks spawned from tasks, as many levels deep */
+#define WIDE          1024 /* Tasks pending at once on one worker, past the first size of its deque */
+#define RENDEZVOUS_NS 10000000000ULL /* Longest wait for every worker to run a task at once */
+
+static void sleep_ns(long ns) {
+  const struct timespec pause = { ns / 1000000000L, ns % 1000000000L };
+  nanosleep(&pause, NULL);
+}
+
+static uint64_t now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void sum_range(unsigned long begin, unsigned long end, void* data) {
+  uint64_t sum = 0;
+  for (unsigned long i = begin; i < end; i++)
+    sum += i;
+  __atomic_add_fetch((uint64_t*)data, sum, __ATOMIC_RELAXED);
+}
+
+static void increment(void* data) {
+  __atomic_add_fetch((unsigned long*)data, 1, __ATOMIC_RELAXED);
+}
+
+typedef struct {
+  scheduler* sched;
+  void (*func)(void* data);
+  void* data;
+  bool finished;
+} root_task;
+
+static void root(void* data) {
+  root_task* task = data;
+  task->func(task->data);
+  __atomic_store_n(&task->finished, true, __ATOMIC_RELEASE);
+}
+
+/* Runs a task on a worker: waiting for it would run it here, spawning everything to the queue of other threads */
+static void on_worker(scheduler* sched, void (*func)(void* data), void* data) {
+  root_task task = { sched, func, data, false };
+  scheduler_group group = scheduler_group_new();
+  scheduler_spawn(sched, &group, root, &task);
+  while (!__atomic_load_n(&task.finished, __ATOMIC_ACQUIRE))
+    sleep_ns(100000);
+  scheduler_wait(sched, &group);
+}
+
+typedef struct {
+  scheduler* sched;
+  unsigned int n;
+  unsigned long result;
+} fib_task;
+
+/* Spawns one half and computes the other, like most divide and conquer code */
+static void fib(void* data) {
+  fib_task* task = data;
+  if (task->n < 2) {
+    task->result = task->n;
+    return;
+  }
+
+  fib_task first = { task->sched, task->n - 1, 0 };
+  fib_task second = { task->sched, task->n - 2, 0 };
+  scheduler_group group = scheduler_group_new();
+  scheduler_spawn(task->sched, &group, fib, &first);
+  fib(&second);
+  scheduler_wait(task->sched, &group);
+
+  task->result = first.result + second.result;
+}
+
+typedef struct {
+  scheduler* sched;
+  unsigned long done;
+} wide_task;
+
+static void wide(void* data) {
+  wide_task* task = data;
+  scheduler_group group = scheduler_group_new();
+  for (unsigned int t = 0; t < WIDE; t++)
+    scheduler_spawn(task->sched, &group, increment, &task->done);
+  scheduler_wait(task->sched, &group);
+}
+
+/* Two per worker, stolen from the deque of the first one */
+static void wides(void* data) {
+  wide_task* tasks = data;
+  scheduler_group group = scheduler_group_new();
+  for (unsigned int w = 0; w < tasks->sched->workers * 2; w++)
+    scheduler_spawn(tasks->sched, &group, wide, &tasks[w]);
+  scheduler_wait(tasks->sched, &group);
+}
+
+typedef struct {
+  scheduler* sched;
+  unsigned long arrived; /* Bit per worker that ran a task of the rendezvous */
+  bool met;
+} rendezvous_task;
+
+/* Blocks its worker until every worker runs one, threads that aren't workers don't wait */
+static void meet(void* data) {
+  rendezvous_task* task = data;
+  const int worker = scheduler_worker(task->sched);
+  if (worker < 0)
+    return;
+
+  const unsigned long all = (1UL << task->sched->workers) - 1;
+  const uint64_t deadline = now_ns() + RENDEZVOUS_NS;
+  __atomic_or_fetch(&task->arrived, 1UL << worker, __ATOMIC_RELAXED);
+  while (__atomic_load_n(&task->arrived, __ATOMIC_RELAXED) != all && now_ns() < deadline)
+    sleep_ns(100000);
+  if (__atomic_load_n(&task->arrived, __ATOMIC_RELAXED) == all)
+    __atomic_store_n(&task->met, true, __ATOMIC_RELAXED);
+}
+
+static void rendezvous(void* data) {
+  rendezvous_task* task = data;
+  scheduler_group group = scheduler_group_new();
+  for (unsigned int t = 0; t <= task->sched->workers; t++)
+    scheduler_spawn(task->sched, &group, meet, task);
+  scheduler_wait(task->sched, &group);
+}
+
+/* Idle time is counted while the workers are still idle, not once they find work */
+static void validate_idle(test_results* results, scheduler* sched) {
+  uint64_t before[WORKERS_MAX];
+  for (unsigned int w = 0; w < sched->workers; w++)
+    before[w] = scheduler_stats_get(sched, w).idle_ns;
+
+  sleep_ns(IDLE_NS);
+
+  for (unsigned int w = 0; w < sched->workers; w++)
+    check(results, scheduler_stats_get(sched, w).idle_ns - before[w] >= (uint64_t)IDLE_NS * 3 / 4);
+}
+
+/* Tasks that spawn and wait for tasks, on their own deques or stolen from them */
+static void validate_nested(test_results* results, scheduler* sched) {
+  unsigned long expected[FIB + 1] = { 0, 1 };
+  for (unsigned int n = 2; n <= FIB; n++)
+    expected[n] = expected[n - 1] + expected[n - 2];
+
+  fib_task task = { sched, FIB, 0 };
+  on_worker(sched, fib, &task);
+  check(results, task.result == expected[FIB]);
+
+  /* Deques grow while tasks keep running, every worker spawns its own */
+  wide_task tasks[WORKERS_MAX * 2];
+  for (unsigned int w = 0; w < sched->workers * 2; w++)
+    tasks[w] = (wide_task) { sched, 0 };
+  on_worker(sched, wides, tasks);
+  bool done = true;
+  for (unsigned int w = 0; w < sched->workers * 2; w++)
+    done &= (tasks[w].done == WIDE);
+  check(results, done);
+
+  /* The tasks of one worker only run everywhere at once if the others steal them */
+  const uint64_t steals = scheduler_stats_total(sched).steals;
+  rendezvous_task meeting = { sched, 0, false };
+  on_worker(sched, rendezvous, &meeting);
+  check(results, meeting.met);
+  check(results, scheduler_stats_total(sched).steals - steals >= sched->workers - 1);
+}
+
+static void validate_workers(test_results* results, unsigned long tests, unsigned int workers) {
+  const uint64_t started = now_ns();
+  scheduler sched;
+  check(results, scheduler_start(&sched, workers, false));
+
+  validate_idle(results, &sched);
+  validate_nested(results, &sched);
+
+  for (unsigned long round = 0; round < tests / 64 + 1; round++) {
+    uint64_t sum = 0;
+    scheduler_for(&sched, 0, ELEMENTS, round % 4 * 100, sum_range, &sum);
+    check(results, sum == (uint64_t)ELEMENTS * (ELEMENTS - 1) / 2);
+
+    unsigned long done = 0;
+    scheduler_group group = scheduler_group_new();
+    for (unsigned int t = 0; t < 1000; t++)
+      scheduler_spawn(&sched, &group, increment, &done);
+    scheduler_wait(&sched, &group);
+    check(results, done == 1000);
+  }
+
+  /* Idle again after running tasks, no worker was idle longer than it existed */
+  validate_idle(results, &sched);
+  const scheduler_stats total = scheduler_stats_total(&sched);
+  check(results, total.idle_ns <= workers * (now_ns() - started));
+
+  scheduler_stop(&sched);
+}
+
+void validate_scheduler(test_results* results, unsigned long tests) {
+  for (unsigned int workers = 2; workers <= WORKERS_MAX; workers *= 2)
+    validate_workers(results, tests, workers);
+}
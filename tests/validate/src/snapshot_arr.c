@@ -0,0 +1,181 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/arrays/snapshot.h>
+
+#include "validate.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define READERS  (SNAPSHOT_ARR_MAX_READERS + 8) /* More readers than slots, some share the counter */
+#define ELEMENTS 64UL /* Versions hold this many elements plus up to 7 */
+#define HELD     3    /* Versions published while every reader holds the same one */
+#define KEEP     16   /* Reads a reader keeps its copy of a version for */
+
+typedef struct {
+  snapshot_arr snap;
+  pthread_barrier_t holding; /* Every reader is reading */
+  pthread_barrier_t published; /* The writer published while they were */
+  bool done;
+} validate_state;
+
+typedef struct {
+  validate_state* state;
+  bool valid;
+  unsigned long reads;
+} validate_reader;
+
+/* A complete version is ELEMENTS to ELEMENTS + 7 copies of its number */
+static bool complete(const dynamic_arr* version, uint64_t* value) {
+  if (version->num < ELEMENTS || version->num >= ELEMENTS + 8)
+    return false;
+
+  const uint64_t* elements = dynamic_arr_get_start(version);
+  for (unsigned long i = 1; i < version->num; i++) {
+    if (elements[i] != elements[0])
+      return false;
+  }
+
+  *value = elements[0];
+  return true;
+}
+
+static void edit(dynamic_arr* version, void* data) {
+  dynamic_arr_set(version, 0, data, version->num);
+  if (version->num < ELEMENTS + 7)
+    dynamic_arr_append(version, data);
+}
+
+/* Versions are published through both ways of writing */
+static void publish(snapshot_arr* snap, uint64_t value) {
+  if (value % 2) {
+    snapshot_arr_update(snap, edit, &value);
+    return;
+  }
+
+  dynamic_arr version = snapshot_arr_copy(snap);
+  dynamic_arr_resize_to(&version, NULL, ELEMENTS + value % 8);
+  dynamic_arr_set(&version, 0, &value, version.num);
+  snapshot_arr_publish(snap, &version);
+}
+
+static void* reader(void* data) {
+  validate_reader* self = data;
+  snapshot_arr* snap = &self->state->snap;
+  uint64_t last = 0;
+  uint64_t value = 0;
+
+  /* Every reader takes a slot or finds them all taken while the others are alive */
+  const dynamic_arr* held = snapshot_arr_read_begin(snap);
+  self->valid &= complete(held, &last);
+  pthread_barrier_wait(&self->state->holding);
+  pthread_barrier_wait(&self->state->published);
+  self->valid &= complete(held, &value) && value == last;
+  snapshot_arr_read_end(snap);
+
+  dynamic_arr kept = {0};
+  uint64_t kept_value = 0;
+  while (!__atomic_load_n(&self->state->done, __ATOMIC_ACQUIRE)) {
+    const dynamic_arr* version = snapshot_arr_read_begin(snap);
+    self->valid &= complete(version, &value) && value >= last;
+    last = value;
+
+    /* Nested reads see the same or a newer version */
+    const dynamic_arr* nested = snapshot_arr_read_begin(snap);
+    self->valid &= complete(nested, &value) && value >= last;
+    snapshot_arr_read_end(snap);
+
+    /* A copy outlives the read and the version being retired */
+    if (!(self->reads % KEEP)) {
+      if (kept.element_size) {
+        self->valid &= complete(&kept, &value) && value == kept_value;
+        dynamic_arr_cleanup(&kept);
+      }
+      kept = dynamic_arr_copy(version);
+      kept_value = last;
+    }
+
+    /* Still there and unchanged however many versions were published meanwhile */
+    self->valid &= complete(version, &value) && value == last;
+    snapshot_arr_read_end(snap);
+    self->reads++;
+  }
+
+  if (kept.element_size) {
+    self->valid &= complete(&kept, &value) && value == kept_value;
+    dynamic_arr_cleanup(&kept);
+  }
+
+  return NULL;
+}
+
+/*
+ * Readers hold a version while the writer publishes HELD more, then read while it publishes
+ * `tests' more. A reader with a slot lets the epoch advance once, which must not free the
+ * version it holds, readers without one keep it from advancing at all.
+ */
+static void validate_readers(test_results* results, unsigned int num, unsigned long tests) {
+  static validate_state state;
+  static validate_reader readers[READERS];
+  pthread_t threads[READERS];
+  uint64_t value = 0;
+
+  dynamic_arr first = dynamic_arr_new(uint64_t);
+  for (unsigned long i = 0; i < ELEMENTS; i++)
+    dynamic_arr_append(&first, &value);
+  state.snap = snapshot_arr_from_dynamic(&first);
+  state.done = false;
+  pthread_barrier_init(&state.holding, NULL, num + 1);
+  pthread_barrier_init(&state.published, NULL, num + 1);
+
+  unsigned int started = 0;
+  for (; started < num; started++) {
+    readers[started] = (validate_reader) { .state = &state, .valid = true };
+    if (pthread_create(&threads[started], NULL, reader, &readers[started]))
+      break;
+  }
+  check(results, started == num);
+  if (started != num) {
+    /* The started readers would wait at the barrier forever */
+    err("Failed to start reader %u of snapshot_arr", started);
+    abort();
+  }
+
+  pthread_barrier_wait(&state.holding);
+  const snapshot_arr_stats before = snapshot_arr_stats_get(&state.snap);
+  for (int h = 0; h < HELD; h++)
+    publish(&state.snap, ++value);
+  check(results, snapshot_arr_stats_get(&state.snap).epoch == before.epoch + (num < SNAPSHOT_ARR_MAX_READERS));
+  check(results, snapshot_arr_reclaim(&state.snap) == HELD);
+  pthread_barrier_wait(&state.published);
+
+  /* One writer, the readers only ever see complete versions in publication order */
+  for (unsigned long v = 0; v < tests; v++)
+    publish(&state.snap, ++value);
+  __atomic_store_n(&state.done, true, __ATOMIC_RELEASE);
+
+  for (unsigned int r = 0; r < num; r++) {
+    pthread_join(threads[r], NULL);
+    check(results, readers[r].valid);
+  }
+
+  /* Without readers every retired version can be freed */
+  const snapshot_arr_stats stats = snapshot_arr_stats_get(&state.snap);
+  check(results, stats.published == 1 + HELD + tests);
+  check(results, snapshot_arr_reclaim(&state.snap) == 0);
+  check(results, snapshot_arr_stats_get(&state.snap).retired == 0);
+
+  const dynamic_arr* last = snapshot_arr_read_begin(&state.snap);
+  check(results, complete(last, &value) && value == HELD + tests);
+  snapshot_arr_read_end(&state.snap);
+
+  pthread_barrier_destroy(&state.holding);
+  pthread_barrier_destroy(&state.published);
+  snapshot_arr_cleanup(&state.snap);
+}
+
+void validate_snapshot_arr(test_results* results, unsigned long tests) {
+  validate_readers(results, 1, tests);
+  validate_readers(results, READERS, tests);
+}
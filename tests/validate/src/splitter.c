@@ -0,0 +1,230 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/strings/builder.h>
+#include <blib/parsing/text/splitter.h>
+
+#include "validate.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEXT_MAX   16384
+#define MAX_CHUNKS 16
+
+/*
+ * Every line of a splitter as "[field]" for unquoted and "{field}" for quoted fields,
+ * unescaped, followed by a newline. Returns the number of lines.
+ */
+static unsigned long render(text_splitter* splitter, string_builder* out) {
+  static char unescaped[TEXT_MAX];
+  dynamic_arr fields = dynamic_arr_new(text_span);
+  unsigned long lines = 0;
+  text_span line;
+
+  while (text_splitter_next_line(splitter, &line)) {
+    fields.num = 0;
+    const unsigned long num = text_splitter_split(splitter, &line, &fields);
+    const text_span* spans = dynamic_arr_get_start(&fields);
+
+    for (unsigned long f = 0; f < num; f++) {
+      string_builder_append_char(out, spans[f].quoted ? '{' : '[');
+      string_builder_append_bytes(out, unescaped, text_span_unescape(&spans[f], splitter->quote, unescaped));
+      string_builder_append_char(out, spans[f].quoted ? '}' : ']');
+    }
+    string_builder_append_char(out, '\n');
+    lines++;
+  }
+
+  dynamic_arr_cleanup(&fields);
+
+  return lines;
+}
+
+/* Lines and fields of texts with quotes, doubled quotes, newlines in quotes and CRLF */
+static void validate_cases(test_results* results) {
+  static const struct {
+    const char* text;
+    char delimiter;
+    char quote;
+    const char* expected;
+  } cases[] = {
+    { "", ',', '"', "" },
+    { "a,b,c\n1,2,3\n", ',', '"', "[a][b][c]\n[1][2][3]\n" },
+    { "a,b", ',', '"', "[a][b]\n" },
+    { "a\n\n,\nb,\n", ',', '"', "[a]\n[]\n[][]\n[b][]\n" },
+    { "\n", ',', '"', "[]\n" },
+    /* CRLF, also on empty lines and inside of quotes where it is kept */
+    { "a,b\r\nc,d\r\n\r\ne", ',', '"', "[a][b]\n[c][d]\n[]\n[e]\n" },
+    { "\"x\r\ny\",z\r\n", ',', '"', "{x\r\ny}[z]\n" },
+    { "a\rb,c\r\n", ',', '"', "[a\rb][c]\n" },
+    /* Doubled quotes */
+    { "\"he said \"\"hi\"\"\",b\n", ',', '"', "{he said \"hi\"}[b]\n" },
+    { "\"\",\"\"\"\",\"\"\"\"\"\"\n", ',', '"', "{}{\"}{\"\"}\n" },
+    { "\"a,\"\"b\"\",\nc\"\n", ',', '"', "{a,\"b\",\nc}\n" },
+    /* Newlines in quotes don't end the line */
+    { "\"a\nb\",c\nd\n", ',', '"', "{a\nb}[c]\n[d]\n" },
+    { "1,\"\n\n\"\n2\n", ',', '"', "[1]{\n\n}\n[2]\n" },
+    /* Characters between the closing quote and the delimiter are dropped */
+    { "\"a\"x,b\n", ',', '"', "{a}[b]\n" },
+    /* Quotes not at the start of a field are characters */
+    { "a\"b\",c\n", ',', '"', "[a\"b\"][c]\n" },
+    /* An unterminated quote takes the rest of the text */
+    { "a,\"bc\nd,e\n", ',', '"', "[a]{bc\nd,e\n}\n" },
+    { "x\n\"", ',', '"', "[x]\n{}\n" },
+    /* Without quoting quotes are characters */
+    { "\"a,b\"\n", ',', 0, "[\"a][b\"]\n" },
+    { "a\tb;c\n", '\t', '\'', "[a][b;c]\n" },
+    { "'a;b';c\n", ';', '\'', "{a;b}[c]\n" },
+  };
+  string_builder out = string_builder_new();
+
+  for (unsigned long c = 0; c < sizeof(cases) / sizeof(*cases); c++) {
+    string_builder_clear(&out);
+    text_splitter splitter = text_splitter_new(cases[c].text, strlen(cases[c].text), cases[c].delimiter, cases[c].quote);
+    render(&splitter, &out);
+
+    const bool same = !strcmp(string_builder_cstr(&out), cases[c].expected);
+    if (!same)
+      err("case %lu: got \"%s\"", c, string_builder_cstr(&out));
+    check(results, same);
+  }
+
+  /* More fields than are batched at once */
+  char wide[1024];
+  unsigned long len = 0;
+  string_builder_clear(&out);
+  string_builder expected = string_builder_new();
+  for (unsigned int f = 0; f < 100; f++) {
+    len += snprintf(wide + len, sizeof(wide) - len, (f % 3 ? "%s%u" : "%s\"%u\""), (f ? "," : ""), f);
+    string_builder_appendf(&expected, (f % 3 ? "[%u]" : "{%u}"), f);
+  }
+  string_builder_append_char(&expected, '\n');
+  text_splitter splitter = text_splitter_new(wide, len, ',', '"');
+  render(&splitter, &out);
+  check(results, !strcmp(string_builder_cstr(&out), string_builder_cstr(&expected)));
+
+  string_builder_cleanup(&expected);
+  string_builder_cleanup(&out);
+}
+
+/* Short fields, often quoted with delimiters, newlines, CRLF and doubled quotes in them */
+static unsigned long random_text(char* text, uint64_t* seed) {
+  static const char alphabet[] = "ab,\n\r\"\"";
+  const unsigned long lines = validate_random(seed) % 200;
+  unsigned long len = 0;
+
+  for (unsigned long l = 0; l < lines && len + 256 < TEXT_MAX; l++) {
+    const unsigned long fields = validate_random(seed) % 6;
+    for (unsigned long f = 0; f < fields; f++) {
+      if (f)
+        text[len++] = ',';
+
+      const bool quoted = !(validate_random(seed) % 3);
+      const unsigned long chars = validate_random(seed) % 8;
+      if (quoted)
+        text[len++] = '"';
+      for (unsigned long c = 0; c < chars; c++) {
+        const char ch = (quoted ? alphabet[validate_random(seed) % 7] : (char)('a' + validate_random(seed) % 3));
+        text[len++] = ch;
+        if (ch == '"')
+          text[len++] = '"';
+      }
+      if (quoted)
+        text[len++] = '"';
+    }
+
+    if (validate_random(seed) % 4 == 0)
+      text[len++] = '\r';
+    text[len++] = '\n';
+  }
+
+  /* Sometimes the last line has no newline or an unterminated quote */
+  switch (validate_random(seed) % 4) {
+    case 0:
+      memcpy(text + len, "x,y", 3);
+      len += 3;
+      break;
+    case 1:
+      memcpy(text + len, "x,\"y\nz,\r\n", 9);
+      len += 9;
+      break;
+  }
+
+  return len;
+}
+
+/* Chunks cover the text without gaps and together give the lines and fields of a single splitter */
+static bool chunks_match(const char* text, unsigned long len, unsigned long skip, char quote, unsigned long num) {
+  text_splitter single = text_splitter_new(text, len, ',', quote);
+  text_span line;
+  for (unsigned long s = 0; s < skip && text_splitter_next_line(&single, &line); s++)
+    ;
+
+  text_splitter chunks[MAX_CHUNKS];
+  const unsigned long made = text_splitter_chunks(&single, chunks, num);
+  const char* pos = single.__pos__;
+
+  string_builder expected = string_builder_new();
+  string_builder got = string_builder_new();
+  const unsigned long lines = render(&single, &expected);
+
+  unsigned long chunk_lines = 0;
+  bool same = (made <= num && (made || !lines));
+  for (unsigned long c = 0; c < made; c++) {
+    /* Every chunk starts where the previous one ended and has at least one line */
+    same &= (chunks[c].__pos__ == pos && chunks[c].__pos__ < chunks[c].__end__);
+    pos = chunks[c].__end__;
+
+    const unsigned long n = render(&chunks[c], &got);
+    same &= (n > 0);
+    chunk_lines += n;
+  }
+  same &= (!made || pos == text + len);
+  same &= (chunk_lines == lines && !strcmp(string_builder_cstr(&got), string_builder_cstr(&expected)));
+
+  string_builder_cleanup(&got);
+  string_builder_cleanup(&expected);
+
+  return same;
+}
+
+static void validate_chunks(test_results* results, unsigned long tests, uint64_t* seed) {
+  static char text[TEXT_MAX];
+  static const struct {
+    const char* text;
+    unsigned long num;
+    unsigned long made;
+  } fixed[] = {
+    { "", 4, 0 },
+    { "a\n", 4, 1 },
+    { "a", 4, 1 },
+    { "a\nb\nc\nd\n", 2, 2 },
+    /* Long quoted fields with newlines hold chunk boundaries back */
+    { "\"\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\"\na\n", 4, 2 },
+    { "x\n\"\n\n\n\n\n\n\n\n\n\n\n\n\n", 4, 1 },
+  };
+
+  for (unsigned long f = 0; f < sizeof(fixed) / sizeof(*fixed); f++) {
+    text_splitter splitter = text_splitter_new(fixed[f].text, strlen(fixed[f].text), ',', '"');
+    text_splitter chunks[MAX_CHUNKS];
+    check(results, text_splitter_chunks(&splitter, chunks, fixed[f].num) == fixed[f].made);
+    check(results, chunks_match(fixed[f].text, strlen(fixed[f].text), 0, '"', fixed[f].num));
+  }
+
+  for (unsigned long t = 0; t < tests; t++) {
+    const unsigned long len = random_text(text, seed);
+    const unsigned long num = 1 + validate_random(seed) % MAX_CHUNKS;
+    const unsigned long skip = (validate_random(seed) % 4 ? 0 : validate_random(seed) % 8);
+
+    check(results, chunks_match(text, len, skip, '"', num));
+    check(results, chunks_match(text, len, skip, 0, num));
+  }
+}
+
+void validate_splitter(test_results* results, unsigned long tests) {
+  uint64_t seed = 0x2545f4914f6cdd1dULL;
+
+  validate_cases(results);
+  validate_chunks(results, tests / 4 + 1, &seed);
+}
@@ -0,0 +1,113 @@
+#include <blib/datastructures/strings/builder.h>
+#include <blib/memory/alloc.h>
+
+#include "validate.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DOUBLES_PER_ROUND 256
+#define MAX_PRECISION     12 /* Beyond the fixed point path, which ends at 9 */
+
+/* Formats a number with the builder and with snprintf, they have to agree */
+static bool same_as_printf(double value, unsigned int precision) {
+  char expected[512];
+  snprintf(expected, sizeof(expected), "%.*f", (int)precision, value);
+
+  string_builder sb = string_builder_new();
+  string_builder_append_double(&sb, value, precision);
+  const bool same = !strcmp(string_builder_cstr(&sb), expected);
+  string_builder_cleanup(&sb);
+
+  if (!same)
+    err("%.17g at precision %u: expected \"%s\"", value, precision, expected);
+
+  return same;
+}
+
+/* Products that round across a half, halfway cases and the ends of the fixed point path */
+static void validate_doubles(test_results* results) {
+  static const struct {
+    double value;
+    unsigned int precision;
+  } cases[] = {
+    { 2.675, 2 }, { 749.1010265, 6 }, { 1.005, 2 }, { 0.125, 2 }, { 0.375, 2 }, { 2.5, 0 }, { 3.5, 0 },
+    { -2.5, 0 }, { 0.5, 0 }, { 1.5, 0 }, { -0.0, 3 }, { 0.0, 0 }, { 1e-300, 9 }, { 123456789.987654321, 9 },
+    { 4503599627370495.5, 0 }, { 4503599627370496.0, 0 }, { 9007199254740993.0, 1 }, { 1e300, 2 },
+    { 0.1 + 0.2, 9 }, { 1.0 / 3.0, 12 }, { -1234.5678, 10 }, { INFINITY, 2 }, { -INFINITY, 0 },
+  };
+
+  for (unsigned int c = 0; c < sizeof(cases) / sizeof(*cases); c++)
+    check(results, same_as_printf(cases[c].value, cases[c].precision));
+
+  string_builder sb = string_builder_new();
+  string_builder_append_double(&sb, NAN, 3);
+  check(results, !strcmp(string_builder_cstr(&sb), "nan"));
+  string_builder_cleanup(&sb);
+}
+
+/* Random bit patterns, short decimals (close to halfway cases) and exact halves */
+static void validate_random_doubles(test_results* results, unsigned long tests) {
+  uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+  for (unsigned long round = 0; round < tests * DOUBLES_PER_ROUND; round++) {
+    const unsigned int precision = validate_random(&seed) % (MAX_PRECISION + 1);
+    const uint64_t bits = validate_random(&seed);
+    double value;
+
+    switch (round % 3) {
+      case 0:
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value))
+          value = 0.0;
+        break;
+      case 1:
+        value = (double)(bits % 10000000000ULL) / pow(10.0, 1 + bits % 10);
+        break;
+      default:
+        value = ((double)(bits % 1000000) + 0.5) / (double)(1ULL << (bits >> 60));
+        break;
+    }
+
+    check(results, same_as_printf((bits & 1 ? -value : value), precision));
+  }
+}
+
+static void validate_integers(test_results* results) {
+  static const long long ints[] = { 0, 1, -1, 9, 10, -10, 99, 100, 1234567890123LL, LLONG_MAX, LLONG_MIN };
+  char expected[64];
+
+  for (unsigned int i = 0; i < sizeof(ints) / sizeof(*ints); i++) {
+    string_builder sb = string_builder_new();
+    string_builder_append_int(&sb, ints[i]);
+    string_builder_append_char(&sb, ' ');
+    string_builder_append_uint(&sb, (unsigned long long)ints[i]);
+
+    snprintf(expected, sizeof(expected), "%lld %llu", ints[i], (unsigned long long)ints[i]);
+    check(results, !strcmp(string_builder_cstr(&sb), expected));
+    string_builder_cleanup(&sb);
+  }
+
+  /* Appends of every kind after each other, released with their length */
+  string_builder sb = string_builder_new();
+  string_builder_append_str(&sb, "pi = ");
+  string_builder_append_double(&sb, 3.14159, 2);
+  string_builder_appendf(&sb, ", %s = %d", "answer", 42);
+  string_builder_append_bytes(&sb, "!?", 1);
+
+  unsigned long len;
+  char* line = string_builder_release(&sb, &len);
+  check(results, !strcmp(line, "pi = 3.14, answer = 42!") && len == strlen(line));
+  blib_free(line);
+  string_builder_cleanup(&sb);
+}
+
+void validate_string_builder(test_results* results, unsigned long tests) {
+  validate_doubles(results);
+  validate_random_doubles(results, tests);
+  validate_integers(results);
+}
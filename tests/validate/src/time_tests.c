@@ -0,0 +1,409 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/memory/alloc.h>
+#include <blib/testing/time/time_tests.h>
+
+#include "validate.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TESTS 8
+#define THREADS 3
+#define BUSY_NS 200000 /* Long enough for the coarsest clock to tick */
+#define TARGET_NS 100000
+#define COEFFICIENT 3.0 /* Nanoseconds per f(n) of the synthetic complexities */
+
+static time_test allocate(unsigned int index, void* data) {
+  (void)data;
+
+  time_test test = time_test_start("allocate");
+  dynamic_arr arr = dynamic_arr_new(unsigned int);
+  dynamic_arr_append(&arr, &index);
+  dynamic_arr_cleanup(&arr);
+  time_test_end(&test);
+
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+/* Testruns measuring memory count the allocations and leave tracking as they found it */
+static void validate_memory(test_results* results, bool tracking, unsigned int threads) {
+  const bool previous = blib_alloc_track(tracking);
+
+  time_testrun_template run = time_testrun_new("allocate", TESTS, allocate, NULL, TESTRUN_ENABLE_ALL);
+  time_testrun_set_memory(&run, true);
+  if (threads > 1)
+    time_testrun_set_threads(&run, threads, false);
+
+  time_testrun_results measured = time_testrun_run(&run);
+  check(results, measured.memory.allocs.mallocs >= TESTS);
+  check(results, measured.memory.allocs.frees >= TESTS);
+  /* Only allocators reporting usable sizes count the peak, the others report it as unknown */
+#ifdef __GLIBC__
+  check(results, measured.memory.allocs.sized && measured.memory.peak > 0);
+#else
+  check(results, !measured.memory.allocs.sized && !measured.memory.peak);
+#endif
+  check(results, blib_alloc_track(previous) == tracking);
+
+  time_testrun_cleanup(&measured);
+}
+
+static bool near(double value, double expected) {
+  return fabs(value - expected) <= 1e-9 * (fabs(expected) > 1 ? fabs(expected) : 1);
+}
+
+/* Statistics of sample sets worked out by hand, in any order */
+static void validate_stats(test_results* results) {
+  time_stats stats = time_stats_compute(NULL, 0);
+  check(results, !stats.min && !stats.max && !stats.mean && !stats.stddev && !stats.median && !stats.mad
+      && !stats.ci_low && !stats.ci_high && !stats.outliers);
+
+  const double one = 42.5;
+  stats = time_stats_compute(&one, 1);
+  check(results, stats.min == one && stats.max == one && stats.mean == one && stats.median == one
+      && stats.p90 == one && stats.p99 == one && stats.p999 == one);
+  check(results, !stats.stddev && !stats.mad && !stats.outliers && stats.ci_low == one && stats.ci_high == one);
+
+  /* 1 to 10: the percentiles interpolate between neighbours, deviations from 5.5 are 0.5 to 4.5 twice */
+  const double ten[] = { 7, 3, 10, 1, 5, 9, 2, 8, 6, 4 };
+  stats = time_stats_compute(ten, 10);
+  check(results, stats.min == 1 && stats.max == 10 && near(stats.mean, 5.5) && near(stats.stddev, sqrt(82.5 / 9)));
+  check(results, near(stats.median, 5.5) && near(stats.p90, 9.1) && near(stats.p99, 9.91) && near(stats.p999, 9.991));
+  check(results, near(stats.mad, 2.5) && !stats.outliers);
+  /* t of 9 degrees of freedom */
+  const double margin = 2.262 * sqrt(82.5 / 9) / sqrt(10);
+  check(results, near(stats.ci_low, 5.5 - margin) && near(stats.ci_high, 5.5 + margin));
+  check(results, ten[0] == 7 && ten[9] == 4);
+
+  /* 100 is further than 3 * 1.4826 * 2.5 from the median, 1 isn't */
+  const double skewed[] = { 100, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  stats = time_stats_compute(skewed, 10);
+  check(results, near(stats.median, 5.5) && near(stats.mad, 2.5) && stats.outliers == 1 && near(stats.mean, 14.5));
+
+  /* Odd counts have a middle sample, without any spread there are no outliers */
+  const double odd[] = { 3, 1, 2 };
+  stats = time_stats_compute(odd, 3);
+  check(results, stats.median == 2 && stats.mad == 1 && near(stats.p90, 2.8) && near(stats.stddev, 1));
+  const double same[] = { 5, 5, 5, 5 };
+  stats = time_stats_compute(same, 4);
+  check(results, stats.median == 5 && !stats.mad && !stats.stddev && !stats.outliers && stats.ci_low == 5 && stats.ci_high == 5);
+
+  /* A MAD of 0 makes every sample off the median an outlier */
+  const double spike[] = { 10, 10, 10, 10, 10, 11 };
+  stats = time_stats_compute(spike, 6);
+  check(results, stats.median == 10 && !stats.mad && stats.outliers == 1);
+}
+
+static uint64_t now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static time_test busy(unsigned int index, void* data) {
+  (void)index;
+  (void)data;
+
+  time_test test = time_test_start("busy");
+  const uint64_t until = now_ns() + BUSY_NS;
+  while (now_ns() < until)
+    ;
+  time_test_end(&test);
+
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+/* Testruns measure with the clock they are set to and restore the selected one, unavailable clocks fall back */
+static void validate_clocks(test_results* results) {
+  const enum time_clock_source previous = time_clock_selected();
+
+  for (int c = TIME_CLOCK_MONOTONIC_RAW; c <= TIME_CLOCK_TSC; c++) {
+    const enum time_clock_source expected = (time_clock_available(c) ? c : TIME_CLOCK_MONOTONIC_RAW);
+    check(results, time_clock_name(c) && strcmp(time_clock_name(c), "unknown"));
+
+    time_testrun_template run = time_testrun_new("clock", 2, busy, NULL, TESTRUN_ENABLE_ALL);
+    time_testrun_set_clock(&run, c);
+    time_testrun_results measured = time_testrun_run(&run);
+
+    check(results, measured.clock == expected && time_clock_selected() == previous);
+    /* The CPU clocks of a spinning thread advance about as much as the wall clock */
+    check(results, measured.min >= BUSY_NS / 4 && measured.clock_overhead < BUSY_NS / 4);
+
+    time_testrun_cleanup(&measured);
+  }
+  check(results, time_clock_available(TIME_CLOCK_MONOTONIC_RAW));
+}
+
+/* Iterations passed to the batch, and how many batches got the most recent count */
+typedef struct {
+  unsigned long iterations;
+  unsigned long batches;
+  uint64_t sum;
+} batch_state;
+
+static enum TIMETEST_STATE sum_batch(unsigned long iterations, void* data) {
+  batch_state* state = data;
+  if (iterations != state->iterations)
+    state->batches = 0;
+  state->iterations = iterations;
+  state->batches++;
+
+  for (unsigned long i = 0; i < iterations; i++) {
+    state->sum += i;
+    time_do_not_optimize(state->sum);
+  }
+
+  return TEST_SUCCESS;
+}
+
+/* Iterations grow until a batch takes the target, every measured batch runs that many */
+static void validate_batched(test_results* results) {
+  batch_state state = {0};
+
+  time_testrun_template run = time_testrun_new_batched("batched", TESTS, sum_batch, &state, TESTRUN_ENABLE_ALL);
+  time_testrun_set_target(&run, TARGET_NS);
+  time_testrun_set_bytes(&run, 8);
+  time_testrun_results measured = time_testrun_run(&run);
+
+  check(results, measured.iterations > 1 && state.iterations == measured.iterations && state.batches >= TESTS);
+  check(results, measured.success == TESTS && measured.samples.num == TESTS && measured.ops == TESTS * measured.iterations);
+  /* Samples are per iteration */
+  check(results, measured.stats.median * measured.iterations >= TARGET_NS / 4);
+  check(results, measured.bytes_per_sec > 0 && near(measured.bytes_per_sec, measured.ops_per_sec * 8));
+
+  time_testrun_cleanup(&measured);
+}
+
+/* Counters of a busy loop, where `perf_event_open()' isn't permitted the run still measures and says why */
+static void validate_counters(test_results* results) {
+  time_testrun_template run = time_testrun_new("counters", TESTS, busy, NULL, TESTRUN_ENABLE_ALL);
+  time_testrun_set_counters(&run, true);
+  time_testrun_results measured = time_testrun_run(&run);
+
+  check(results, measured.counters.enabled && measured.success == TESTS && measured.samples.num == TESTS);
+  if (measured.counters.error) {
+    info("time_tests: counters unavailable (%s), skipped", strerror(measured.counters.error));
+    results->skipped++;
+    time_testrun_cleanup(&measured);
+    return;
+  }
+
+  for (int c = 0; c < TIME_COUNTERS; c++)
+    check(results, !measured.counters.available[c] || measured.counters.per_op[c] >= 0);
+  if (measured.counters.available[TIME_COUNTER_INSTRUCTIONS])
+    check(results, measured.counters.total[TIME_COUNTER_INSTRUCTIONS] > 0 && measured.counters.per_op[TIME_COUNTER_INSTRUCTIONS] > 0);
+  if (measured.counters.available[TIME_COUNTER_CYCLES] && measured.counters.available[TIME_COUNTER_INSTRUCTIONS])
+    check(results, measured.counters.ipc > 0);
+
+  time_testrun_cleanup(&measured);
+}
+
+static time_testrun_results summary(const char* caption, unsigned long size, unsigned long runs, double mean, double stddev) {
+  return (time_testrun_results) {
+    .caption = caption,
+    .size = size,
+    .num = runs,
+    .stats = { .mean = mean, .stddev = stddev },
+  };
+}
+
+/* The table of the comparison goes to /dev/null, errno is kept */
+static long compare_quietly(const char* baseline, const time_testrun_results* runs, unsigned long num, double threshold) {
+  fflush(stdout);
+  const int saved = dup(STDOUT_FILENO);
+  const int null = open("/dev/null", O_WRONLY);
+  dup2(null, STDOUT_FILENO);
+  close(null);
+
+  const long regressions = time_testrun_compare(baseline, runs, num, threshold);
+  const int error = errno;
+
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+  errno = error;
+
+  return regressions;
+}
+
+/* Runs exported as CSV are found again by caption and size, only significant slowdowns past the threshold count */
+static void validate_compare(test_results* results) {
+  const time_testrun_results baseline[] = {
+    summary("plain", 0, 100, 100, 1),
+    summary("with \"quotes\", and, commas", 0, 100, 100, 1),
+    summary("sized", 100, 100, 100, 1),
+    summary("sized", 200, 100, 1000, 1),
+    summary("small change", 0, 100, 100, 1),
+    summary("noisy", 0, 10, 100, 1000),
+    summary("faster", 0, 100, 100, 1),
+  };
+  const unsigned long num = sizeof(baseline) / sizeof(*baseline);
+
+  char path[32] = "/tmp/blib-baseline-XXXXXX";
+  const int fd = mkstemp(path);
+  FILE* file = (fd >= 0 ? fdopen(fd, "w") : NULL);
+  check(results, file != NULL);
+  if (!file)
+    return;
+  time_testrun_export_csv(file, baseline, num);
+  fclose(file);
+
+  check(results, compare_quietly(path, baseline, num, 0.05) == 0);
+
+  const time_testrun_results current[] = {
+    summary("plain", 0, 100, 100, 1),
+    summary("with \"quotes\", and, commas", 0, 100, 150, 1),
+    /* Would be a regression against the other size */
+    summary("sized", 200, 100, 1000, 1),
+    summary("sized", 100, 100, 150, 1),
+    summary("small change", 0, 100, 104, 1),
+    summary("noisy", 0, 10, 150, 1000),
+    summary("faster", 0, 100, 50, 1),
+    summary("not in the baseline", 0, 100, 1000, 1),
+  };
+  check(results, compare_quietly(path, current, sizeof(current) / sizeof(*current), 0.05) == 2);
+  /* The small change is significant, it only counts below its size */
+  check(results, compare_quietly(path, current, sizeof(current) / sizeof(*current), 0.01) == 3);
+
+  unlink(path);
+  errno = 0;
+  check(results, compare_quietly(path, current, 1, 0.05) == -1 && errno == ENOENT);
+
+  /* A file without the columns of a baseline */
+  file = fopen(path, "w");
+  fputs("name,value\nplain,100\n", file);
+  fclose(file);
+  errno = 0;
+  check(results, compare_quietly(path, current, 1, 0.05) == -1 && errno == EINVAL);
+  unlink(path);
+}
+
+/* Size of the testrun measured now, the tests report c * f(size) */
+typedef struct {
+  enum time_complexity complexity;
+  unsigned long size;
+} synthetic;
+
+static double f_of(enum time_complexity complexity, unsigned long size) {
+  const double n = (double)size;
+
+  switch (complexity) {
+    case TIME_O_1: return 1;
+    case TIME_O_LOG_N: return log2(n);
+    case TIME_O_N: return n;
+    case TIME_O_N_LOG_N: return n * log2(n);
+    case TIME_O_N_SQUARED: return n * n;
+  }
+
+  return 1;
+}
+
+static void set_size(unsigned long size, void* data) {
+  ((synthetic*)data)->size = size;
+}
+
+static time_test synthetic_test(unsigned int index, void* data) {
+  const synthetic* s = data;
+
+  time_test test = { .caption = "synthetic", .state = TEST_SUCCESS };
+  /* A little noise below a percent that doesn't shift the median */
+  test.taken = (uint64_t)(COEFFICIENT * f_of(s->complexity, s->size) * (1 + (index % 3) * 0.002));
+
+  return test;
+}
+
+/* Medians of c * f(n) are fitted to f with the coefficient c */
+static void validate_complexity(test_results* results) {
+  dynamic_arr sizes = time_testrun_sizes(16, 1UL << 16, 4);
+  const unsigned long* n = dynamic_arr_get_start(&sizes);
+  check(results, sizes.num == 7 && n[0] == 16 && n[6] == 1UL << 16);
+
+  for (int c = TIME_O_1; c < TIME_COMPLEXITIES; c++) {
+    synthetic s = { .complexity = c };
+    time_testrun_template run = time_testrun_new("synthetic", 3, synthetic_test, &s, TESTRUN_ENABLE_ALL);
+    time_complexity_results fit = time_testrun_complexity(&run, n, sizes.num, set_size);
+
+    const time_testrun_results* runs = dynamic_arr_get_start(&fit.results);
+    bool sized = (fit.results.num == sizes.num);
+    for (unsigned long i = 0; sized && i < sizes.num; i++)
+      sized = (runs[i].size == n[i]);
+    check(results, sized);
+
+    check(results, fit.best == (enum time_complexity)c && strcmp(time_complexity_name(c), "unknown"));
+    check(results, fabs(fit.coefficient - COEFFICIENT) <= 0.01 * COEFFICIENT && fit.coefficient == fit.coefficients[c]);
+    check(results, fit.rms[c] < 0.01);
+    for (int other = TIME_O_1; other < TIME_COMPLEXITIES; other++)
+      check(results, other == c || fit.rms[other] > 10 * fit.rms[c]);
+
+    time_complexity_cleanup(&fit);
+  }
+
+  dynamic_arr_cleanup(&sizes);
+}
+
+static time_test record_thread(unsigned int index, void* data) {
+  unsigned int* seen = data;
+
+  time_test test = time_test_start("threads");
+  __atomic_or_fetch(&seen[index], 1U << time_testrun_thread(), __ATOMIC_RELAXED);
+  time_test_end(&test);
+
+  test.state = TEST_SUCCESS;
+
+  return test;
+}
+
+/* Every index runs once, on the thread whose range it is in */
+static void validate_threads(test_results* results) {
+  unsigned int seen[TESTS * THREADS] = {0};
+
+  time_testrun_template run = time_testrun_new("threads", TESTS * THREADS, record_thread, seen, TESTRUN_ENABLE_ALL);
+  time_testrun_set_threads(&run, THREADS, false);
+  time_testrun_results measured = time_testrun_run(&run);
+
+  check(results, measured.threads == THREADS && measured.per_thread.num == THREADS);
+  check(results, measured.success == TESTS * THREADS && measured.samples.num == TESTS * THREADS);
+
+  const time_testrun_results* per_thread = dynamic_arr_get_start(&measured.per_thread);
+  unsigned long begin = 0;
+  bool ranges = true;
+  for (unsigned int t = 0; t < THREADS; t++) {
+    ranges &= (per_thread[t].num == TESTS && per_thread[t].success == TESTS && per_thread[t].samples.num == TESTS);
+    for (unsigned long i = begin; i < begin + per_thread[t].num; i++)
+      ranges &= (seen[i] == 1U << t);
+    begin += per_thread[t].num;
+  }
+  check(results, ranges && begin == TESTS * THREADS);
+  check(results, time_testrun_thread() == 0);
+
+  time_testrun_cleanup(&measured);
+}
+
+void validate_time_tests(test_results* results, unsigned long tests) {
+  (void)tests;
+
+  validate_stats(results);
+  validate_clocks(results);
+  validate_batched(results);
+  validate_counters(results);
+  validate_compare(results);
+  validate_complexity(results);
+  validate_threads(results);
+
+  for (unsigned int threads = 1; threads <= 2; threads++) {
+    validate_memory(results, true, threads);
+    validate_memory(results, false, threads);
+  }
+}
@@ -0,0 +1,466 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/arrays/trace.h>
+#include <blib/datastructures/flat/map.h>
+#include <blib/datastructures/flat/set.h>
+#include <blib/datastructures/strings/builder.h>
+#include <blib/parsing/text/numbers.h>
+
+#include "validate.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define RECORDS_MAX 8192
+#define ARRAYS_MAX  64
+#define ELEMENT_MAX 24
+#define BULK_MAX    16
+#define OPS_PER_ROUND 4
+
+/* Records the calls are expected to write, taken before each call like the trace does */
+typedef struct {
+  dynamic_arr_trace_record records[RECORDS_MAX];
+  unsigned long num;
+} expectation;
+
+static void expect(expectation* e, const dynamic_arr* arr, enum dynamic_arr_trace_op op, unsigned long index, unsigned long other, unsigned long count) {
+  e->records[e->num++] = (dynamic_arr_trace_record) {
+    .op = op,
+    .array = arr->__id__,
+    .element_size = arr->element_size,
+    .size = arr->num,
+    .index = index,
+    .other = other,
+    .count = count,
+  };
+}
+
+static bool record_equals(const dynamic_arr_trace_record* a, const dynamic_arr_trace_record* b) {
+  return a->op == b->op && a->array == b->array && a->element_size == b->element_size
+      && a->size == b->size && a->index == b->index && a->other == b->other && a->count == b->count;
+}
+
+/* Every record of a trace, false if there are more than fit */
+static bool read_trace(const char* path, dynamic_arr_trace_record* records, unsigned long* num) {
+  FILE* file = dynamic_arr_trace_open(path);
+  if (!file)
+    return false;
+
+  *num = 0;
+  while (*num < RECORDS_MAX && dynamic_arr_trace_read(file, &records[*num]))
+    (*num)++;
+  fclose(file);
+
+  return *num < RECORDS_MAX;
+}
+
+/* Number of elements of the array after a recorded call */
+static unsigned long size_after(const dynamic_arr_trace_record* r) {
+  switch (r->op) {
+    case DYNAMIC_ARR_TRACE_APPEND:
+    case DYNAMIC_ARR_TRACE_PREPEND:
+    case DYNAMIC_ARR_TRACE_INSERT_AT:
+      return r->size + 1;
+    case DYNAMIC_ARR_TRACE_BULK_APPEND:
+    case DYNAMIC_ARR_TRACE_BULK_PREPEND:
+    case DYNAMIC_ARR_TRACE_BULK_INSERT_AT:
+      return r->size + r->count;
+    case DYNAMIC_ARR_TRACE_PRECATE:
+    case DYNAMIC_ARR_TRACE_QUICK_PRECATE:
+    case DYNAMIC_ARR_TRACE_TRUNCATE:
+    case DYNAMIC_ARR_TRACE_REMOVE_AT:
+    case DYNAMIC_ARR_TRACE_QUICK_REMOVE_AT:
+      return r->size - 1;
+    case DYNAMIC_ARR_TRACE_BULK_REMOVE_AT:
+      return r->size - r->count;
+    case DYNAMIC_ARR_TRACE_RESIZE_TO:
+      return r->count;
+    case DYNAMIC_ARR_TRACE_NEW:
+    case DYNAMIC_ARR_TRACE_CLEANUP:
+      return 0;
+    default:
+      return r->size;
+  }
+}
+
+/* Sizes of the arrays of a trace while it is replayed */
+typedef struct {
+  unsigned long ids[ARRAYS_MAX];
+  unsigned long sizes[ARRAYS_MAX];
+  unsigned long num;
+} replay_sizes;
+
+static unsigned long* size_of(replay_sizes* replay, unsigned long id, unsigned long size) {
+  for (unsigned long a = 0; a < replay->num; a++)
+    if (replay->ids[a] == id)
+      return &replay->sizes[a];
+
+  if (replay->num == ARRAYS_MAX)
+    return NULL;
+
+  /* Arrays alive before the trace started begin at their recorded size */
+  replay->ids[replay->num] = id;
+  replay->sizes[replay->num] = size;
+  return &replay->sizes[replay->num++];
+}
+
+/* Replaying the records from the first one reaches the size recorded before every call */
+static bool replays(const dynamic_arr_trace_record* records, unsigned long num, replay_sizes* replay) {
+  replay->num = 0;
+
+  for (unsigned long r = 0; r < num; r++) {
+    unsigned long* size = size_of(replay, records[r].array, records[r].size);
+    if (!size)
+      return false;
+    if (records[r].op != DYNAMIC_ARR_TRACE_NEW && *size != records[r].size) {
+      err("record %lu (%s of array %lu): size %lu, replayed %lu",
+          r, dynamic_arr_trace_op_name(records[r].op), records[r].array, records[r].size, *size);
+      return false;
+    }
+
+    *size = size_after(&records[r]);
+    if (records[r].op == DYNAMIC_ARR_TRACE_COPY) {
+      unsigned long* copy = size_of(replay, records[r].other, 0);
+      if (!copy)
+        return false;
+      *copy = records[r].size;
+    }
+  }
+
+  return true;
+}
+
+static void temp_path(char* path) {
+  strcpy(path, "/tmp/blib-trace-XXXXXX");
+  const int fd = mkstemp(path);
+  if (fd >= 0)
+    close(fd);
+}
+
+/* Every operation once, then random ones on two arrays, read back field by field */
+static void validate_round_trip(test_results* results, unsigned long tests, uint64_t* seed) {
+  static expectation e;
+  static dynamic_arr_trace_record records[RECORDS_MAX];
+  static replay_sizes replay;
+  uint8_t elements[BULK_MAX * ELEMENT_MAX] = {0}, out[BULK_MAX * ELEMENT_MAX];
+  char path[32];
+  temp_path(path);
+  e.num = 0;
+
+  check(results, dynamic_arr_trace_start(path));
+  errno = 0;
+  const bool again = dynamic_arr_trace_start(path);
+  const int again_errno = errno;
+
+  dynamic_arr a = dynamic_arr_new(uint32_t);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_NEW, 0, 0, 0);
+  dynamic_arr b = __intern_dynamic_generic_arr_new_aligned(ELEMENT_MAX, 4096, false);
+  expect(&e, &b, DYNAMIC_ARR_TRACE_NEW, 4096, 0, 0);
+
+  expect(&e, &a, DYNAMIC_ARR_TRACE_APPEND, 0, 0, 1);
+  dynamic_arr_append(&a, elements);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_BULK_APPEND, 0, 0, 6);
+  dynamic_arr_bulk_append(&a, elements, 6);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_PREPEND, 0, 0, 1);
+  dynamic_arr_prepend(&a, elements);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_BULK_PREPEND, 0, 0, 3);
+  dynamic_arr_bulk_prepend(&a, elements, 3);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_INSERT_AT, 4, 0, 1);
+  dynamic_arr_insert_at(&a, 4, elements);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_BULK_INSERT_AT, 2, 0, 2);
+  dynamic_arr_bulk_insert_at(&a, 2, elements, 2);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_REPLACE, 3, 0, 1);
+  dynamic_arr_replace(&a, 3, elements);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_BULK_REPLACE, 1, 0, 4);
+  dynamic_arr_bulk_replace(&a, 1, elements, 4);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_SET, 5, 0, 3);
+  dynamic_arr_set(&a, 5, elements, 3);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_FLIP, 0, 9, 1);
+  dynamic_arr_flip(&a, 0, 9);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_BULK_FLIP, 1, 6, 3);
+  dynamic_arr_bulk_flip(&a, 1, 6, 3);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_PEEK, 7, 0, 1);
+  dynamic_arr_peek(&a, 7, out);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_BULK_PEEK, 2, 0, 5);
+  dynamic_arr_bulk_peek(&a, 2, out, 5);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_PRECATE, 0, 0, 1);
+  dynamic_arr_precate(&a, out);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_QUICK_PRECATE, 0, 0, 1);
+  dynamic_arr_quick_precate(&a, out);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_TRUNCATE, 0, 0, 1);
+  dynamic_arr_truncate(&a, out);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_RESIZE_TO, 0, 0, 200);
+  dynamic_arr_resize_to(&a, NULL, 200);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_RESERVE, 0, 0, 100000);
+  dynamic_arr_reserve(&a, 100000);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_TRIM, 0, 0, 0);
+  dynamic_arr_trim(&a);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_REMOVE_AT, 150, 0, 1);
+  dynamic_arr_remove_at(&a, 150, out);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_BULK_REMOVE_AT, 140, 0, 9);
+  dynamic_arr_bulk_remove_at(&a, 140, out, 9);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_QUICK_REMOVE_AT, 0, 0, 1);
+  dynamic_arr_quick_remove_at(&a, 0, out);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_ENABLE_COW, 0, 0, 0);
+  dynamic_arr_enable_cow(&a);
+
+  dynamic_arr copy = dynamic_arr_copy(&a);
+  expect(&e, &a, DYNAMIC_ARR_TRACE_COPY, 0, copy.__id__, 0);
+  expect(&e, &copy, DYNAMIC_ARR_TRACE_APPEND, 0, 0, 1);
+  dynamic_arr_append(&copy, elements);
+  expect(&e, &copy, DYNAMIC_ARR_TRACE_CLEANUP, 0, 0, 0);
+  dynamic_arr_cleanup(&copy);
+
+  /* Random operations that stay in bounds */
+  dynamic_arr* arrays[2] = { &a, &b };
+  for (unsigned long op = 0; op < tests * OPS_PER_ROUND && e.num + 2 < RECORDS_MAX; op++) {
+    dynamic_arr* arr = arrays[validate_random(seed) % 2];
+    const unsigned long num = 1 + validate_random(seed) % BULK_MAX;
+    const unsigned long index = (arr->num ? validate_random(seed) % arr->num : 0);
+    const unsigned long fits = (index + num <= arr->num ? num : arr->num - index);
+
+    switch (validate_random(seed) % 8) {
+      case 0:
+        expect(&e, arr, DYNAMIC_ARR_TRACE_BULK_APPEND, 0, 0, num);
+        dynamic_arr_bulk_append(arr, elements, num);
+        break;
+      case 1:
+        expect(&e, arr, DYNAMIC_ARR_TRACE_BULK_PREPEND, 0, 0, num);
+        dynamic_arr_bulk_prepend(arr, elements, num);
+        break;
+      case 2:
+        if (arr->num) {
+          expect(&e, arr, DYNAMIC_ARR_TRACE_BULK_INSERT_AT, index, 0, num);
+          dynamic_arr_bulk_insert_at(arr, index, elements, num);
+        }
+        break;
+      case 3:
+        if (arr->num) {
+          expect(&e, arr, DYNAMIC_ARR_TRACE_BULK_REMOVE_AT, index, 0, fits);
+          dynamic_arr_bulk_remove_at(arr, index, out, fits);
+        }
+        break;
+      case 4:
+        /* A deadzone would shift `b' off its alignment, the call is a precate and recorded as one */
+        if (arr->num) {
+          expect(&e, arr, (arr == &b ? DYNAMIC_ARR_TRACE_PRECATE : DYNAMIC_ARR_TRACE_QUICK_PRECATE), 0, 0, 1);
+          dynamic_arr_quick_precate(arr, out);
+        }
+        break;
+      case 5:
+        if (arr->num) {
+          expect(&e, arr, DYNAMIC_ARR_TRACE_BULK_PEEK, index, 0, fits);
+          dynamic_arr_bulk_peek(arr, index, out, fits);
+        }
+        break;
+      case 6:
+        expect(&e, arr, DYNAMIC_ARR_TRACE_RESIZE_TO, 0, 0, num);
+        dynamic_arr_resize_to(arr, NULL, num);
+        break;
+      case 7:
+        if (arr->num) {
+          expect(&e, arr, DYNAMIC_ARR_TRACE_FLIP, index, arr->num - 1, 1);
+          dynamic_arr_flip(arr, index, arr->num - 1);
+        }
+        break;
+    }
+  }
+
+  expect(&e, &a, DYNAMIC_ARR_TRACE_CLEANUP, 0, 0, 0);
+  dynamic_arr_cleanup(&a);
+  expect(&e, &b, DYNAMIC_ARR_TRACE_CLEANUP, 0, 0, 0);
+  dynamic_arr_cleanup(&b);
+  dynamic_arr_trace_stop();
+
+  check(results, !again && again_errno == EBUSY);
+
+  unsigned long num = 0;
+  check(results, read_trace(path, records, &num));
+  check(results, num == e.num);
+
+  bool same = true;
+  for (unsigned long r = 0; r < num && r < e.num; r++) {
+    if (!record_equals(&records[r], &e.records[r])) {
+      err("record %lu: got %s of array %lu, expected %s of array %lu", r,
+          dynamic_arr_trace_op_name(records[r].op), records[r].array, dynamic_arr_trace_op_name(e.records[r].op), e.records[r].array);
+      same = false;
+      break;
+    }
+  }
+  check(results, same);
+  check(results, replays(records, num, &replay));
+
+  /* Every operation was recorded and has a name of its own */
+  bool named = true;
+  for (int op = 0; op < DYNAMIC_ARR_TRACE_OPS; op++) {
+    bool recorded = false;
+    for (unsigned long r = 0; r < num && !recorded; r++)
+      recorded = (records[r].op == (enum dynamic_arr_trace_op)op);
+    named &= recorded && strcmp(dynamic_arr_trace_op_name(op), "unknown");
+    for (int other = 0; other < op; other++)
+      named &= !!strcmp(dynamic_arr_trace_op_name(op), dynamic_arr_trace_op_name(other));
+  }
+  check(results, named);
+  check(results, !strcmp(dynamic_arr_trace_op_name(DYNAMIC_ARR_TRACE_OPS), "unknown"));
+
+  remove(path);
+}
+
+static int u32_cmp(const void* a, const void* b) {
+  const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+  return (x > y) - (x < y);
+}
+
+/* Containers filling arrays through their memory record the sizes, so their traces replay */
+static void validate_containers(test_results* results) {
+  static dynamic_arr_trace_record records[RECORDS_MAX];
+  static replay_sizes replay;
+  char path[32];
+  temp_path(path);
+
+  check(results, dynamic_arr_trace_start(path));
+
+  dynamic_arr values = dynamic_arr_new(int64_t);
+  const text_span text = { "1,2,3", 5, false };
+  const unsigned long parsed = number_parse_i64_arr(&text, ',', &values, NULL);
+  int64_t last = 0;
+  dynamic_arr_peek(&values, 2, &last);
+
+  dynamic_arr reals = dynamic_arr_new(double);
+  const text_span real_text = { "0.5\n-1e3\n", 9, false };
+  number_parse_f64_arr(&real_text, '\n', &reals, NULL);
+
+  string_builder builder = string_builder_new();
+  string_builder_append_str(&builder, "values: ");
+  string_builder_append_int(&builder, -42);
+  string_builder_append_char(&builder, ' ');
+  string_builder_append_double(&builder, 0.25, 2);
+  string_builder_appendf(&builder, " %s", "ok");
+  const unsigned long built = string_builder_len(&builder);
+  string_builder_cstr(&builder);
+  string_builder_clear(&builder);
+  string_builder_append_uint(&builder, 7);
+
+  flat_set a = flat_set_new(uint32_t, u32_cmp), b = flat_set_new(uint32_t, u32_cmp);
+  for (uint32_t i = 0; i < 20; i++) {
+    const uint32_t odd = 2 * i + 1;
+    flat_set_insert(&a, &i);
+    flat_set_insert(&b, &odd);
+  }
+  flat_set both = flat_set_union(&a, &b);
+  flat_set common = flat_set_intersection(&a, &b);
+  flat_set_insert(&both, &(uint32_t) { 1000 });
+  flat_set_insert(&common, &(uint32_t) { 1000 });
+
+  flat_map map = flat_map_new(uint32_t, uint32_t, u32_cmp);
+  const uint32_t keys[] = { 5, 1, 3, 1 }, map_values[] = { 50, 10, 30, 11 };
+  flat_map_bulk_insert(&map, keys, map_values, 4);
+  flat_map_insert(&map, &(uint32_t) { 2 }, &(uint32_t) { 20 });
+
+  const unsigned long sizes[] = { values.num, reals.num, builder.__storage__.num, flat_set_len(&both), flat_set_len(&common), flat_map_len(&map) };
+  const unsigned long ids[] = { values.__id__, reals.__id__, builder.__storage__.__id__, both.__storage__.__id__, common.__storage__.__id__, map.__keys__.__id__ };
+
+  dynamic_arr_cleanup(&values);
+  dynamic_arr_cleanup(&reals);
+  string_builder_cleanup(&builder);
+  flat_set_cleanup(&a);
+  flat_set_cleanup(&b);
+  flat_set_cleanup(&both);
+  flat_set_cleanup(&common);
+  flat_map_cleanup(&map);
+  dynamic_arr_trace_stop();
+
+  check(results, parsed == 3 && last == 3 && built == 19);
+
+  unsigned long num = 0;
+  check(results, read_trace(path, records, &num));
+  check(results, replays(records, num, &replay));
+
+  /* The peek of the parsed numbers sees all three of them */
+  bool peeked = false;
+  for (unsigned long r = 0; r < num; r++)
+    if (records[r].op == DYNAMIC_ARR_TRACE_PEEK && records[r].array == ids[0])
+      peeked = (records[r].size == 3 && records[r].index == 2);
+  check(results, peeked);
+
+  /* The replayed sizes before the cleanups are those of the containers */
+  bool same = true;
+  for (unsigned long i = 0; i < sizeof(ids) / sizeof(*ids); i++) {
+    unsigned long cleaned = RECORDS_MAX;
+    for (unsigned long r = 0; r < num; r++)
+      if (records[r].op == DYNAMIC_ARR_TRACE_CLEANUP && records[r].array == ids[i])
+        cleaned = records[r].size;
+    same &= (cleaned == sizes[i]);
+  }
+  check(results, same);
+
+  remove(path);
+}
+
+/* Files that aren't traces, and traces cut off in the middle of a record */
+static void validate_files(test_results* results) {
+  char path[32], cut[32];
+  temp_path(path);
+  temp_path(cut);
+
+  errno = 0;
+  check(results, !dynamic_arr_trace_open("/nonexistent/blib.trace") && errno == ENOENT);
+
+  FILE* file = fopen(path, "wb");
+  fputs("BLIBTRX\1", file);
+  fclose(file);
+  errno = 0;
+  check(results, !dynamic_arr_trace_open(path) && errno == EINVAL);
+
+  /* A trace without records */
+  check(results, dynamic_arr_trace_start(path));
+  dynamic_arr_trace_stop();
+  dynamic_arr_trace_record record;
+  file = dynamic_arr_trace_open(path);
+  check(results, file && !dynamic_arr_trace_read(file, &record));
+  if (file)
+    fclose(file);
+
+  check(results, dynamic_arr_trace_start(path));
+  dynamic_arr arr = dynamic_arr_new(uint64_t);
+  dynamic_arr_resize_to(&arr, NULL, 1000);
+  dynamic_arr_cleanup(&arr);
+  dynamic_arr_trace_stop();
+
+  /* Every byte cut off loses the last record */
+  file = fopen(path, "rb");
+  uint8_t bytes[256];
+  const unsigned long len = fread(bytes, 1, sizeof(bytes), file);
+  fclose(file);
+
+  bool truncated = true;
+  for (unsigned long keep = len - 1; keep > len - 4; keep--) {
+    file = fopen(cut, "wb");
+    fwrite(bytes, 1, keep, file);
+    fclose(file);
+
+    unsigned long records = 0;
+    file = dynamic_arr_trace_open(cut);
+    while (file && dynamic_arr_trace_read(file, &record))
+      records++;
+    truncated &= (file && records == 2);
+    if (file)
+      fclose(file);
+  }
+  check(results, truncated);
+
+  remove(path);
+  remove(cut);
+}
+
+void validate_trace(test_results* results, unsigned long tests) {
+  uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+  validate_round_trip(results, tests, &seed);
+  validate_containers(results);
+  validate_files(results);
+}
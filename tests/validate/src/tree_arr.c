@@ -0,0 +1,255 @@
+#include <blib/datastructures/arrays/dynamic.h>
+#include <blib/datastructures/arrays/tree.h>
+#include <blib/memory/alloc.h>
+
+#include "validate.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FANOUT    32 /* Children of an inner node, as in tree.c */
+#define BULK_MAX  3  /* Bulk operations take up to this many leaves of elements */
+
+/* Element sizes giving leaves of 256, 16 and TREE_ARR_MIN_LEAF elements */
+static const unsigned int sizes[] = { 4, 64, 200 };
+
+static unsigned long leaf_cap(unsigned int size) {
+  const unsigned long cap = TREE_ARR_LEAF_BYTES / size;
+  return (cap < TREE_ARR_MIN_LEAF ? TREE_ARR_MIN_LEAF : cap);
+}
+
+/* Elements are stamped byte by byte so moved or duplicated ones are told apart */
+static void stamp(uint8_t* elements, unsigned int size, unsigned long num, uint32_t* next) {
+  for (unsigned long i = 0; i < num; i++, (*next)++) {
+    for (unsigned int b = 0; b < size; b++)
+      elements[i * size + b] = (uint8_t)(*next * 131 + b * 7 + (*next >> 8));
+  }
+}
+
+/* The dynamic array is the reference, it can't insert at its end */
+static void reference_insert(dynamic_arr* ref, unsigned long index, uint8_t* elements, unsigned long num) {
+  if (index == ref->num)
+    dynamic_arr_bulk_append(ref, elements, num);
+  else
+    dynamic_arr_bulk_insert_at(ref, index, elements, num);
+}
+
+/* Every way of reading the tree gives the elements of the reference */
+static bool tree_equals(const tree_arr* tree, const dynamic_arr* ref, uint64_t* seed) {
+  if (tree->num != ref->num)
+    return false;
+
+  const unsigned int size = tree->element_size;
+  const uint8_t* expected = dynamic_arr_get_start(ref);
+
+  dynamic_arr copy = tree_arr_to_dynamic(tree);
+  const bool copied = copy.num == ref->num && (!ref->num || !memcmp(dynamic_arr_get_start(&copy), expected, ref->num * size));
+  dynamic_arr_cleanup(&copy);
+  if (!copied)
+    return false;
+
+  unsigned long seen = 0;
+  unsigned long num;
+  tree_arr_iter iter = tree_arr_iter_new(tree, 0);
+  for (const uint8_t* block; (block = tree_arr_iter_block(&iter, &num)); seen += num) {
+    if (seen + num > ref->num || memcmp(block, expected + seen * size, num * size))
+      return false;
+  }
+  if (seen != ref->num)
+    return false;
+
+  if (ref->num) {
+    const unsigned long index = validate_random(seed) % ref->num;
+    if (memcmp(tree_arr_get(tree, index), expected + index * size, size))
+      return false;
+  }
+
+  return true;
+}
+
+/*
+ * Trees built from exactly FANOUT full leaves, the operations split a full leaf, overflow the
+ * root and merge leaves back, at and around the boundaries of leaves
+ */
+static void validate_boundaries(test_results* results, unsigned int size, uint64_t* seed) {
+  const unsigned long cap = leaf_cap(size);
+  const unsigned long full = cap * FANOUT;
+  const unsigned long at[] = { 0, cap - 1, cap, cap + 1, 2 * cap, full / 2, full - cap, full - 1, full };
+
+  uint8_t* elements = blib_malloc((full + BULK_MAX * cap) * size);
+  uint8_t* out = blib_malloc(BULK_MAX * cap * size);
+  uint8_t* expected = blib_malloc(BULK_MAX * cap * size);
+  uint32_t next = 0;
+
+  dynamic_arr base = __intern_dynamic_generic_arr_new(size);
+  stamp(elements, size, full, &next);
+  dynamic_arr_bulk_append(&base, elements, full);
+
+  for (unsigned long a = 0; a < sizeof(at) / sizeof(*at); a++) {
+    const unsigned long index = at[a];
+    const unsigned long counts[] = { 1, cap - 1, cap, cap + 1, BULK_MAX * cap };
+
+    for (unsigned long c = 0; c < sizeof(counts) / sizeof(*counts); c++) {
+      /* Inserting one or many into full leaves */
+      tree_arr tree = tree_arr_from_dynamic(&base);
+      dynamic_arr ref = dynamic_arr_copy(&base);
+      stamp(elements, size, counts[c], &next);
+      if (counts[c] == 1) {
+        tree_arr_insert_at(&tree, index, elements);
+      } else {
+        tree_arr_bulk_insert_at(&tree, index, elements, counts[c]);
+      }
+      reference_insert(&ref, index, elements, counts[c]);
+      check(results, tree_equals(&tree, &ref, seed));
+
+      /* Removing the same amount again, straddling the leaves the insert touched */
+      const unsigned long start = (index >= cap / 2 ? index - cap / 2 : 0);
+      const unsigned long num = (counts[c] < ref.num - start ? counts[c] : ref.num - start);
+      dynamic_arr_bulk_peek(&ref, start, expected, num);
+      tree_arr_bulk_remove_at(&tree, start, out, num);
+      dynamic_arr_bulk_remove_at(&ref, start, NULL, num);
+      check(results, !memcmp(out, expected, num * size));
+      check(results, tree_equals(&tree, &ref, seed));
+
+      tree_arr_cleanup(&tree);
+      dynamic_arr_cleanup(&ref);
+    }
+
+    /* Removing from full leaves only, down to merging them */
+    if (index < full) {
+      for (unsigned long c = 0; c < sizeof(counts) / sizeof(*counts); c++) {
+        const unsigned long num = (counts[c] < full - index ? counts[c] : full - index);
+        tree_arr tree = tree_arr_from_dynamic(&base);
+        dynamic_arr ref = dynamic_arr_copy(&base);
+        tree_arr_bulk_remove_at(&tree, index, NULL, num);
+        dynamic_arr_bulk_remove_at(&ref, index, NULL, num);
+        check(results, tree_equals(&tree, &ref, seed));
+
+        tree_arr_cleanup(&tree);
+        dynamic_arr_cleanup(&ref);
+      }
+    }
+  }
+
+  /* Emptying the whole tree leaves a tree that can be filled again */
+  tree_arr tree = tree_arr_from_dynamic(&base);
+  tree_arr_bulk_remove_at(&tree, 0, NULL, full);
+  check(results, tree.num == 0);
+  tree_arr_bulk_insert_at(&tree, 0, elements, cap + 1);
+  dynamic_arr ref = __intern_dynamic_generic_arr_new(size);
+  dynamic_arr_bulk_append(&ref, elements, cap + 1);
+  check(results, tree_equals(&tree, &ref, seed));
+
+  tree_arr_cleanup(&tree);
+  dynamic_arr_cleanup(&ref);
+  dynamic_arr_cleanup(&base);
+  blib_free(elements);
+  blib_free(out);
+  blib_free(expected);
+}
+
+/* Trees built from dynamic arrays one or two levels deep, just below and above every boundary */
+static void validate_from_dynamic(test_results* results, unsigned int size, uint64_t* seed) {
+  const unsigned long cap = leaf_cap(size);
+  const unsigned long nums[] = {
+    0, 1, cap - 1, cap, cap + 1, cap * FANOUT - 1, cap * FANOUT, cap * FANOUT + 1,
+    cap * FANOUT * FANOUT + 1,
+  };
+  uint32_t next = 0;
+
+  for (unsigned long n = 0; n < sizeof(nums) / sizeof(*nums); n++) {
+    dynamic_arr ref = __intern_dynamic_generic_arr_new(size);
+    if (nums[n]) {
+      uint8_t* elements = blib_malloc(nums[n] * size);
+      stamp(elements, size, nums[n], &next);
+      dynamic_arr_bulk_append(&ref, elements, nums[n]);
+      blib_free(elements);
+    }
+
+    tree_arr tree = tree_arr_from_dynamic(&ref);
+    check(results, tree_equals(&tree, &ref, seed));
+
+    /* The tree built bottom-up takes inserts and removes like one built by inserting */
+    uint8_t element[200];
+    stamp(element, size, 1, &next);
+    const unsigned long index = validate_random(seed) % (ref.num + 1);
+    tree_arr_insert_at(&tree, index, element);
+    reference_insert(&ref, index, element, 1);
+    check(results, tree_equals(&tree, &ref, seed));
+
+    const unsigned long start = validate_random(seed) % ref.num;
+    const unsigned long num = (ref.num - start < cap + 1 ? ref.num - start : cap + 1);
+    tree_arr_bulk_remove_at(&tree, start, NULL, num);
+    dynamic_arr_bulk_remove_at(&ref, start, NULL, num);
+    check(results, tree_equals(&tree, &ref, seed));
+
+    tree_arr_cleanup(&tree);
+    dynamic_arr_cleanup(&ref);
+  }
+}
+
+/* Random inserts and removes growing the tree past two levels and shrinking it again */
+static void validate_random_ops(test_results* results, unsigned int size, unsigned long tests, uint64_t* seed) {
+  const unsigned long cap = leaf_cap(size);
+  const unsigned long limit = 2 * cap * FANOUT;
+
+  uint8_t* elements = blib_malloc(BULK_MAX * cap * size);
+  uint8_t* out = blib_malloc(BULK_MAX * cap * size);
+  uint8_t* expected = blib_malloc(BULK_MAX * cap * size);
+  uint32_t next = 0;
+
+  tree_arr tree = __intern_tree_arr_new(size);
+  dynamic_arr ref = __intern_dynamic_generic_arr_new(size);
+
+  for (unsigned long op = 0; op < tests; op++) {
+    /* Grows for the first half of the rounds, then shrinks */
+    const bool grow = (op < tests / 2 ? validate_random(seed) % 4 != 0 : validate_random(seed) % 4 == 0);
+    const unsigned long num = 1 + validate_random(seed) % (BULK_MAX * cap);
+
+    if ((grow && ref.num + num <= limit) || !ref.num) {
+      const unsigned long index = validate_random(seed) % (ref.num + 1);
+      if (validate_random(seed) % 2) {
+        stamp(elements, size, 1, &next);
+        tree_arr_insert_at(&tree, index, elements);
+        reference_insert(&ref, index, elements, 1);
+      } else {
+        stamp(elements, size, num, &next);
+        tree_arr_bulk_insert_at(&tree, index, elements, num);
+        reference_insert(&ref, index, elements, num);
+      }
+    } else {
+      const unsigned long index = validate_random(seed) % ref.num;
+      const unsigned long removed = (num < ref.num - index ? num : ref.num - index);
+      dynamic_arr_bulk_peek(&ref, index, expected, removed);
+      tree_arr_bulk_remove_at(&tree, index, out, removed);
+      dynamic_arr_bulk_remove_at(&ref, index, NULL, removed);
+      check(results, !memcmp(out, expected, removed * size));
+    }
+
+    check(results, tree_equals(&tree, &ref, seed));
+  }
+
+  /* Round trip of the final tree through a dynamic array */
+  dynamic_arr copy = tree_arr_to_dynamic(&tree);
+  tree_arr back = tree_arr_from_dynamic(&copy);
+  check(results, tree_equals(&back, &ref, seed));
+
+  tree_arr_cleanup(&back);
+  dynamic_arr_cleanup(&copy);
+  tree_arr_cleanup(&tree);
+  dynamic_arr_cleanup(&ref);
+  blib_free(elements);
+  blib_free(out);
+  blib_free(expected);
+}
+
+void validate_tree_arr(test_results* results, unsigned long tests) {
+  uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+  for (unsigned long s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+    validate_boundaries(results, sizes[s], &seed);
+    validate_from_dynamic(results, sizes[s], &seed);
+    validate_random_ops(results, sizes[s], tests, &seed);
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef __VALIDATE_H__
+#define __VALIDATE_H__
+#include <util.h>
+
+#include <stdint.h>
+
+/**
+ * @brief Count a check of a suite, failures are logged with the condition and where it is
+ * @param results Results of the suite
+ * @param cond Condition that has to hold
+ */
+#define check(results, cond)                                              \
+  do {                                                                    \
+    if (cond) {                                                           \
+      (results)->success++;                                               \
+    } else {                                                              \
+      (results)->failure++;                                               \
+      err("%s:%d: check failed: %s", __FILE__, __LINE__, #cond);          \
+    }                                                                     \
+  } while(0)
+
+/**
+ * @brief Next number of a xorshift generator, suites are seeded so failures can be reproduced
+ * @param seed State of the generator, not 0
+ */
+static inline uint64_t validate_random(uint64_t* seed) {
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 7;
+  *seed ^= *seed << 17;
+  return *seed;
+}
+
+/* Suites, `tests' scales the number of randomized rounds */
+void validate_args(test_results* results, unsigned long tests);
+void validate_dynamic_arr(test_results* results, unsigned long tests);
+void validate_flat_set(test_results* results, unsigned long tests);
+void validate_flat_map(test_results* results, unsigned long tests);
+void validate_kernels(test_results* results, unsigned long tests);
+void validate_logger(test_results* results, unsigned long tests);
+void validate_numbers(test_results* results, unsigned long tests);
+void validate_packed_arr(test_results* results, unsigned long tests);
+void validate_pool(test_results* results, unsigned long tests);
+void validate_priority_queue(test_results* results, unsigned long tests);
+void validate_splitter(test_results* results, unsigned long tests);
+void validate_string_builder(test_results* results, unsigned long tests);
+void validate_scheduler(test_results* results, unsigned long tests);
+void validate_snapshot_arr(test_results* results, unsigned long tests);
+void validate_time_tests(test_results* results, unsigned long tests);
+void validate_trace(test_results* results, unsigned long tests);
+void validate_tree_arr(test_results* results, unsigned long tests);
+
+#endif // !__VALIDATE_H__